@@ -5,10 +5,17 @@
 #include "ChiliUtil.h"
 #include "Testing.h"
 #include "PerfLog.h"
+#include "ConstantRingBuffer.h"
 #include "TestModelProbe.h"
 #include "Testing.h"
 #include "Camera.h"
 #include "Channels.h"
+#include "DepthStencil.h"
+#include "TextureResource.h"
+#include "BindableCodex.h"
+#include "MaterialTable.h"
+#include "Trace.h"
+#include <stdexcept>
 
 namespace dx = DirectX;
 
@@ -19,6 +26,7 @@ App::App( const std::string& commandLine )
 	scriptCommander( TokenizeQuoted( commandLine ) ),
 	dLight(wnd.Gfx(), { 10.0f,9.0f,2.5f }, 63.0f * PI / 180.0f, 84.0f * PI / 180.0f)
 {
+	Trace::SetThreadName( "Main" );
 	pointLight = std::make_unique<PointLight>(wnd.Gfx(), dx::XMFLOAT3{ 16.5f, 9.0f, 1.5f }, 1.0f, 4u);
 	//pointLight = std::make_unique<PointLight>(wnd.Gfx(), dx::XMFLOAT3{  27.f + 9 * 0.666666f, 20.0f, 1.7f }, 1.0f, 4u);
 	//pointLight2 = std::make_unique<PointLight>(wnd.Gfx(), dx::XMFLOAT3{ 27.f - 9 * 0.333333f, 20.0f, 1.7f + 9 * 0.577350f }, 1.0f, 7u);
@@ -68,19 +76,54 @@ App::App( const std::string& commandLine )
 	//pCams.emplace_back(pointLight2);
 	//pCams.emplace_back(pointLight3);
 	rg.BindShadowCamera(wnd.Gfx(), *dLight.ShareCamera(), pCams);
+
+	// lights are recorded into / played back from camera paths alongside the cameras
+	cameras.AddPathTrack( "light:Directional",
+		[this]() { return CameraPath::Pose{ dLight.GetPos(),dLight.GetPitch(),dLight.GetYaw() }; },
+		[this]( const CameraPath::Pose& pose ) { dLight.SetPose( pose.pos,pose.pitch,pose.yaw ); } );
+	cameras.AddPathTrack( "light:Point",
+		[this]() { return CameraPath::Pose{ pointLight->GetPos(),0.0f,0.0f }; },
+		[this]( const CameraPath::Pose& pose ) { pointLight->SetPos( pose.pos ); } );
+	if( auto settings = FlythroughBenchmark::TakeRequest() )
+	{
+		flythrough.emplace( wnd.Gfx(),std::move( *settings ) );
+		const auto& s = flythrough->GetSettings();
+		TAA = s.TAA.value_or( TAA );
+		HBAO = s.HBAO.value_or( HBAO );
+		lodBias = s.lodBias.value_or( lodBias );
+		shadowLodBias = s.shadowLodBias.value_or( shadowLodBias );
+		if( s.activeCamera && !cameras.SetActiveCamera( *s.activeCamera ) )
+		{
+			throw std::runtime_error{ "Benchmark camera not found: " + *s.activeCamera };
+		}
+		rg.SetProfiler( &flythrough->GetProfiler() );
+	}
 }
 
 void App::DoFrame( float dt )
 {
+	TRACE_ZONE( "App::DoFrame" );
 	time += dt;
+	// gpu side of whatever finished loading since last frame, bounded so frames stay responsive
+	streamer.Pump( wnd.Gfx(),0.004f );
 	UpdateCommonVar(wnd.Gfx(), { time,DirectX::XMMatrixRotationRollPitchYaw(skybox.pitch, skybox.yaw, skybox.roll),
 		(unsigned int)pCams.size(),{(float)wnd.Gfx().GetWidth(),(float)wnd.Gfx().GetHeight(),1.0f / wnd.Gfx().GetWidth(),1.0f / wnd.Gfx().GetHeight()},
 		TAA, HBAO});
 	//wnd.Gfx().BeginFrame( 0.07f,0.0f,0.12f );
 	wnd.Gfx().BeginFrame(0.1f, 0.1f, 0.1f);
+	if( flythrough )
+	{
+		flythrough->BeginFrame( wnd.Gfx(),cameras,streamer.GetPendingCount() == 0 );
+	}
 	//wnd.Gfx().SetCamera(cameras->GetMatrix() );
 	rg.BindMainCamera(cameras.GetActiveCamera());
 	cameras->Bind(wnd.Gfx());
+	const auto viewProj = cameras->GetMatrix() * cameras->GetProjection();
+	occlusion.Update(wnd.Gfx(), viewProj);
+	const auto mainView = SubmitView::Make(cameras->GetMatrix(), cameras->GetProjection(), lodBias, &occlusion);
+	// shadow lods are picked from the main viewpoint since that's where the shadows are seen from
+	auto shadowView = SubmitView::Make(cameras->GetMatrix(), cameras->GetProjection(), shadowLodBias);
+	shadowView.cullClusters = false;
 
 	GameLogic(dt, time);
 
@@ -99,9 +142,9 @@ void App::DoFrame( float dt )
 	
 	cameras.Submit(Chan::main);
 
-	sponza.Submit(Chan::shadow);
+	sponza.Submit(Chan::shadow, &shadowView);
 	//gobber.Submit(Chan::shadow);
-	nano.Submit(Chan::shadow);
+	nano.Submit(Chan::shadow, &shadowView);
 	//cube.Submit(Chan::shadow);
 	//cube2.Submit(Chan::shadow);
 	sphere.Submit(Chan::shadow);
@@ -119,13 +162,14 @@ void App::DoFrame( float dt )
 	else
 	{
 	#ifdef USE_DEFERRED
-		sponza.Submit(Chan::gbuffer);
+		sponza.Submit(Chan::gbuffer, &mainView);
 		sphere.Submit(Chan::gbuffer);
-		nano.Submit(Chan::main);
+		nano.Submit(Chan::main, &mainView);
 	#endif
 	}
 
 	rg.Execute( wnd.Gfx() );
+	occlusion.Capture(wnd.Gfx(), rg.GetMasterDepth(), viewProj);
 	
 	//if (savingDepth)
 	//{
@@ -153,6 +197,8 @@ void App::DoFrame( float dt )
 	sphere.SpawnControlWindow(wnd.Gfx(), "Sphere");
 	//water.SpawnControlWindow(wnd.Gfx(), "Water");
 	rg.RenderWindows( wnd.Gfx() );
+	rg.RenderStatsWindow( wnd.Gfx() );
+	occlusion.SpawnControlWindow();
 	RenderMainWindows(wnd.Gfx());
 
 	//if (ImGui::Begin("Delete"))
@@ -164,9 +210,31 @@ void App::DoFrame( float dt )
 	//}
 	//ImGui::End();
 
+	if( flythrough )
+	{
+		flythrough->EndFrame( wnd.Gfx(),rg );
+	}
 	// present
 	wnd.Gfx().EndFrame();
 	rg.Reset();
+
+	if( !timeToFirstFrame )
+	{
+		timeToFirstFrame = startupTimer.Peek();
+		OutputDebugStringA( ("Time to first frame: " + std::to_string( *timeToFirstFrame ) + " s\n").c_str() );
+	}
+	if( !timeToFullyLoaded && streamer.GetPendingCount() == 0 )
+	{
+		timeToFullyLoaded = startupTimer.Peek();
+		OutputDebugStringA( ("Time to fully loaded: " + std::to_string( *timeToFullyLoaded ) + " s, "
+			+ std::to_string( streamer.GetCompletedCount() ) + " streamed jobs\n").c_str() );
+		// how much sharing images between slots saved while loading the scene
+		OutputDebugStringA( Bind::TextureResource::GetStatsReport().c_str() );
+		// whatever loading resolved and let go of is only dropped on a miss otherwise (no-op without a budget)
+		Bind::Codex::Evict();
+		OutputDebugStringA( Bind::Codex::GetStatsReport().c_str() );
+		OutputDebugStringA( Bind::MaterialTable::GetStatsReport().c_str() );
+	}
 }
 
 void App::ShowImguiDemoWindow()
@@ -191,9 +259,19 @@ int App::Go()
 			return *ecode;
 		}
 		// execute the game logic
-		const auto dt = timer.Mark() * speed_factor;
-		HandleInput( dt );
+		// benchmark runs step the same simulated time every frame and ignore input
+		const auto dt = flythrough ? flythrough->GetTimestep() : timer.Mark() * speed_factor;
+		if( !flythrough )
+		{
+			HandleInput( dt );
+		}
 		DoFrame( dt );
+		TRACE_FRAME();
+		if( flythrough && flythrough->IsDone() )
+		{
+			flythrough->Finish( wnd.Gfx() );
+			return 0;
+		}
 	}
 }
 
@@ -397,6 +475,16 @@ void App::HandleInput( float dt )
 
 void App::UpdateCommonVar(Graphics& gfx, const CommonVar& cvar) noxnd
 {
+	if (auto pRing = Bind::ConstantRingBuffer::Get(gfx))
+	{
+		const auto range = pRing->Write(gfx, &cvar, sizeof(cvar));
+		Bind::ConstantRingBuffer::BindVS(gfx, 2u, range);
+		Bind::ConstantRingBuffer::BindPS(gfx, 2u, range);
+		Bind::ConstantRingBuffer::BindDS(gfx, 2u, range);
+		gfx.isTAA = TAA;
+		gfx.isHBAO = HBAO;
+		return;
+	}
 	cVBuf->Update(gfx, cvar);
 	cVBuf->Bind(gfx);
 	cPBuf->Update(gfx, cvar);
@@ -420,6 +508,16 @@ void App::RenderMainWindows(Graphics& gfx)
 		//ImGui::SliderFloat("W", &extentSpeed, 0.0f, 2.0f, "%.1f");
 		ImGui::Checkbox("TAA", &TAA);
 		ImGui::Checkbox("HBAO+", &HBAO);
+		ImGui::SliderFloat("LOD Bias", &lodBias, 0.1f, 4.0f, "%.2f");
+		ImGui::SliderFloat("Shadow LOD Bias", &shadowLodBias, 0.1f, 4.0f, "%.2f");
+		if (Trace::IsCapturing())
+		{
+			ImGui::Text("Capturing trace...");
+		}
+		else if (ImGui::Button("Capture trace (120 frames)"))
+		{
+			Trace::Capture("trace.json", 120u);
+		}
 	}
 	ImGui::End();
 }
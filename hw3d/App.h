@@ -18,6 +18,11 @@
 #include "TestSphere.h"
 #include "ConstantBuffers.h"
 #include "PlaneWater.h"
+#include "HiZOcclusion.h"
+#include "SubmitView.h"
+#include "AssetStreamer.h"
+#include "FlythroughBenchmark.h"
+#include <optional>
 
 class App
 {
@@ -50,14 +55,21 @@ private:
 private:
 	std::string commandLine;
 	bool showDemoWindow = false;
+	// started first so the load timings below cover everything App constructs
+	ChiliTimer startupTimer;
 	ImguiManager imgui;
 	Window wnd;
 	ScriptCommander scriptCommander;
+	// declared before anything that loads assets so they can stream
+	AssetStreamer streamer;
+	std::optional<float> timeToFirstFrame;
+	std::optional<float> timeToFullyLoaded;
 #ifdef USE_DEFERRED
 	Rgph::DeferredRenderGraph rg{ wnd.Gfx() };
 #else
 	Rgph::BlurOutlineRenderGraph rg{ wnd.Gfx() };
 #endif
+	HiZOcclusion occlusion{ wnd.Gfx() };
 	ChiliTimer timer;
 	float speed_factor = 1.0f;
 	CameraContainer cameras;
@@ -66,9 +78,10 @@ private:
 	//std::shared_ptr<PointLight> pointLight3;
 	//TestCube cube{ wnd.Gfx(),4.0f };
 	//TestCube cube2{ wnd.Gfx(),4.0f };
-	Model sponza{ wnd.Gfx(),"Models\\sponza\\sponza.obj",1.0f / 20.0f, true};
+	Model sponza{ wnd.Gfx(),"Models\\sponza\\sponza.obj",1.0f / 20.0f, true,
+		ModelOptions{ .lodCount = 3u,.lodReduction = 0.5f,.lodMaxError = 0.02f,.lodScreenSize = 0.25f,.clusters = true,.staticBatching = true,.textureArrays = true,.async = true } };
 	//Model gobber{ wnd.Gfx(),"Models\\gobber\\GoblinX.obj",4.0f };
-	Model nano{ wnd.Gfx(),"Models\\nano_textured\\nanosuit.obj",2.0f };
+	Model nano{ wnd.Gfx(),"Models\\nano_textured\\nanosuit.obj",2.0f,false,ModelOptions{ .async = true } };
 	SkyBox skybox{ wnd.Gfx(),4.0f };
 	DirectionalLight dLight;
 	//bool savingDepth = false;
@@ -82,4 +95,8 @@ private:
 	std::vector<std::shared_ptr<PointLight>> pCams;
 	bool TAA = true;
 	bool HBAO = true;
+	float lodBias = 1.0f;
+	float shadowLodBias = 0.5f;
+	// set when the benchmark script command asked for a flythrough, the app quits once it has run
+	std::optional<FlythroughBenchmark> flythrough;
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "AssetStreamer.h"
+#include "ChiliWin.h"
+#include "ChiliTimer.h"
+#include "Trace.h"
+#include <objbase.h>
+#include <algorithm>
+#include <cassert>
+
+AssetStreamer* AssetStreamer::pActive = nullptr;
+
+AssetStreamer::AssetStreamer( unsigned int threads )
+{
+	assert( pActive == nullptr );
+	if( threads == 0u )
+	{
+		threads = std::max( std::thread::hardware_concurrency(),2u ) - 1u;
+	}
+	for( unsigned int i = 0; i < threads; i++ )
+	{
+		workers.emplace_back( &AssetStreamer::WorkerLoop,this );
+	}
+	pActive = this;
+}
+
+AssetStreamer::~AssetStreamer()
+{
+	pActive = nullptr;
+	{
+		std::lock_guard lock{ mutex };
+		stopping = true;
+		queue.clear();
+	}
+	cv.notify_all();
+	for( auto& w : workers )
+	{
+		w.join();
+	}
+}
+
+bool AssetStreamer::IsActive() noexcept
+{
+	return pActive != nullptr;
+}
+
+void AssetStreamer::Enqueue( Work work )
+{
+	assert( pActive != nullptr );
+	pActive->Push( std::move( work ) );
+}
+
+void AssetStreamer::Push( Work work )
+{
+	{
+		std::lock_guard lock{ mutex };
+		queue.push_back( std::move( work ) );
+	}
+	cv.notify_one();
+}
+
+void AssetStreamer::Pump( Graphics& gfx,float budgetSeconds )
+{
+	TRACE_ZONE( "AssetStreamer::Pump" );
+	ChiliTimer timer;
+	do
+	{
+		Finalizer finalize;
+		{
+			std::lock_guard lock{ mutex };
+			if( ready.empty() )
+			{
+				return;
+			}
+			finalize = std::move( ready.front() );
+			ready.pop_front();
+		}
+		finalize( gfx );
+		std::lock_guard lock{ mutex };
+		completed++;
+	}
+	while( timer.Peek() < budgetSeconds );
+}
+
+size_t AssetStreamer::GetPendingCount() const noexcept
+{
+	std::lock_guard lock{ mutex };
+	return queue.size() + running + ready.size();
+}
+
+size_t AssetStreamer::GetCompletedCount() const noexcept
+{
+	std::lock_guard lock{ mutex };
+	return completed;
+}
+
+void AssetStreamer::WorkerLoop()
+{
+	// wic decoding needs com on every thread that uses it
+	const bool com = SUCCEEDED( CoInitializeEx( nullptr,COINIT_MULTITHREADED ) );
+	Trace::SetThreadName( "AssetStreamer" );
+	while( true )
+	{
+		Work work;
+		{
+			std::unique_lock lock{ mutex };
+			cv.wait( lock,[this] { return stopping || !queue.empty(); } );
+			if( stopping )
+			{
+				break;
+			}
+			work = std::move( queue.front() );
+			queue.pop_front();
+			running++;
+		}
+		Finalizer finalize;
+		try
+		{
+			TRACE_ZONE( "AssetStreamer::Work" );
+			finalize = work();
+		}
+		catch( ... )
+		{
+			// surfaced on the render thread where the usual error reporting happens
+			finalize = [e = std::current_exception()]( Graphics& )
+			{
+				std::rethrow_exception( e );
+			};
+		}
+		std::lock_guard lock{ mutex };
+		running--;
+		if( finalize )
+		{
+			ready.push_back( std::move( finalize ) );
+		}
+		else
+		{
+			completed++;
+		}
+	}
+	if( com )
+	{
+		CoUninitialize();
+	}
+}
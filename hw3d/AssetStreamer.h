@@ -0,0 +1,50 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+class Graphics;
+
+// background loading: decoding / importing runs on worker threads, gpu resource creation is handed back
+// to the render thread through Pump; while one of these exists, Texture, TextureCube and async Models
+// hand out placeholders immediately and fill them in when their data arrives
+class AssetStreamer
+{
+public:
+	// main thread part of a job, typically creating gpu resources from the decoded data
+	using Finalizer = std::function<void( Graphics& )>;
+	// worker thread part, must not touch the immediate context or the bindable codex
+	using Work = std::function<Finalizer()>;
+public:
+	// 0 threads uses all hardware threads but one
+	AssetStreamer( unsigned int threads = 0u );
+	AssetStreamer( const AssetStreamer& ) = delete;
+	AssetStreamer& operator=( const AssetStreamer& ) = delete;
+	// waits for running work, queued work and unfinalized results are dropped
+	~AssetStreamer();
+	static bool IsActive() noexcept;
+	static void Enqueue( Work work );
+	// runs finished finalizers on the calling thread until about budgetSeconds have passed (at least one runs)
+	// exceptions thrown by workers are rethrown here
+	void Pump( Graphics& gfx,float budgetSeconds );
+	// jobs queued, running or waiting to be finalized
+	size_t GetPendingCount() const noexcept;
+	size_t GetCompletedCount() const noexcept;
+private:
+	void WorkerLoop();
+	void Push( Work work );
+private:
+	static AssetStreamer* pActive;
+	mutable std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<Work> queue;
+	std::deque<Finalizer> ready;
+	size_t running = 0;
+	size_t completed = 0;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+};
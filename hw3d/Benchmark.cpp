@@ -0,0 +1,943 @@
+#include "Benchmark.h"
+#include "DynamicConstant.h"
+#include "LayoutCodex.h"
+#include "StaticLayout.h"
+#include "ConstantRing.h"
+#include "VertexFormat.h"
+#include "ChiliTimer.h"
+#include "Graphics.h"
+#include "BindableCommon.h"
+#include "BindableCodex.h"
+#include "TransformCbuf.h"
+#include "Drawable.h"
+#include "Step.h"
+#include "Node.h"
+#include "RenderQueuePass.h"
+#include "Cube.h"
+#include "TexturePreprocessor.h"
+#include "json.hpp"
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <functional>
+#include <numeric>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	// min and median of a set of timings
+	std::pair<float,float> Summarize( std::vector<float> seconds )
+	{
+		std::sort( seconds.begin(),seconds.end() );
+		return { seconds.front(),seconds[seconds.size() / 2] };
+	}
+
+	template<typename F>
+	std::pair<float,float> Time( unsigned int iterations,F&& f )
+	{
+		std::vector<float> seconds;
+		for( unsigned int i = 0; i < iterations; i++ )
+		{
+			ChiliTimer timer;
+			f();
+			seconds.push_back( timer.Peek() );
+		}
+		return Summarize( std::move( seconds ) );
+	}
+
+	using MaterialParams = Dcb::StaticLayout<
+		Dcb::Member<Dcb::Float,"metallic">,
+		Dcb::Member<Dcb::Float,"roughness">,
+		Dcb::Member<Dcb::Float,"normalMapWeight">,
+		Dcb::Member<Dcb::Float,"specularGloss">,
+		Dcb::Member<Dcb::Float,"specularWeight">,
+		Dcb::Member<Dcb::Float,"scale">,
+		Dcb::Member<Dcb::Float,"offset">,
+		Dcb::Member<Dcb::Float,"occlusion">
+	>;
+
+	// one read-modify-write of every member at its compile-time offset
+	template<typename... Members>
+	void TouchStatic( Dcb::Buffer& buf,const Dcb::StaticLayout<Members...>* )
+	{
+		((Dcb::StaticLayout<Members...>::template Get<Members::name>( buf ) += 1.0f),...);
+	}
+
+	// what TexturePreprocessor did before its row kernels: every texel through Get / PutPixel and an XMVECTOR
+	DirectX::XMVECTOR DecodeTexel( Surface::Color c ) noexcept
+	{
+		using namespace DirectX;
+		return XMVectorSubtract( XMVectorScale( XMVectorSet( (float)c.GetR(),(float)c.GetG(),(float)c.GetB(),0.0f ),2.0f / 255.0f ),g_XMOne );
+	}
+
+	void FlipYPerTexel( Surface& surf )
+	{
+		using namespace DirectX;
+		const auto flipY = XMVectorSet( 1.0f,-1.0f,1.0f,1.0f );
+		for( unsigned int y = 0; y < surf.GetHeight(); y++ )
+		{
+			for( unsigned int x = 0; x < surf.GetWidth(); x++ )
+			{
+				XMFLOAT3 c;
+				XMStoreFloat3( &c,XMVectorScale( XMVectorAdd( XMVectorMultiply( DecodeTexel( surf.GetPixel( x,y ) ),flipY ),g_XMOne ),255.0f / 2.0f ) );
+				surf.PutPixel( x,y,{ (unsigned char)std::round( c.x ),(unsigned char)std::round( c.y ),(unsigned char)std::round( c.z ) } );
+			}
+		}
+	}
+
+	TexturePreprocessor::NormalMapReport ValidatePerTexel( const Surface& surf,float thresholdMin,float thresholdMax )
+	{
+		using namespace DirectX;
+		TexturePreprocessor::NormalMapReport report;
+		auto sum = XMVectorZero();
+		for( unsigned int y = 0; y < surf.GetHeight(); y++ )
+		{
+			for( unsigned int x = 0; x < surf.GetWidth(); x++ )
+			{
+				const auto n = DecodeTexel( surf.GetPixel( x,y ) );
+				const float len = XMVectorGetX( XMVector3Length( n ) );
+				report.badLength += len < thresholdMin || len > thresholdMax ? 1u : 0u;
+				report.badZ += XMVectorGetZ( n ) < 0.0f ? 1u : 0u;
+				sum = XMVectorAdd( sum,n );
+			}
+		}
+		report.texels = size_t( surf.GetWidth() ) * surf.GetHeight();
+		report.biasX = XMVectorGetX( sum );
+		report.biasY = XMVectorGetY( sum );
+		return report;
+	}
+}
+
+void Benchmark::DcbAccess( const std::string& reportPath,unsigned int iterations,unsigned int passes )
+{
+	iterations = std::max( iterations,1u );
+	passes = std::max( passes,1u );
+
+	// flat material block, all three paths
+	const auto flatLayout = MaterialParams::Make();
+	Dcb::Buffer flat{ flatLayout };
+	const std::vector<std::string> keys = {
+		"metallic","roughness","normalMapWeight","specularGloss","specularWeight","scale","offset","occlusion"
+	};
+	std::vector<Dcb::Accessor<float>> flatAccessors;
+	for( const auto& key : keys )
+	{
+		flatAccessors.push_back( flatLayout.Compile<float>( key ) );
+	}
+
+	// deep paths, lights[16].cascades[4]
+	Dcb::RawLayout raw;
+	raw.Add<Dcb::Array>( "lights" );
+	raw["lights"].Set<Dcb::Struct>( 16 );
+	raw["lights"].T().Add<Dcb::Float3>( "color" );
+	raw["lights"].T().Add<Dcb::Float>( "intensity" );
+	raw["lights"].T().Add<Dcb::Array>( "cascades" );
+	raw["lights"].T()["cascades"].Set<Dcb::Float>( 4 );
+	const auto nestedLayout = Dcb::LayoutCodex::Resolve( std::move( raw ) );
+	Dcb::Buffer nested{ nestedLayout };
+	std::vector<std::string> paths;
+	for( size_t i = 0; i < 16; i++ )
+	{
+		for( size_t j = 0; j < 4; j++ )
+		{
+			paths.push_back( "lights[" + std::to_string( i ) + "].cascades[" + std::to_string( j ) + "]" );
+		}
+	}
+	std::vector<Dcb::Accessor<float>> nestedAccessors;
+	const auto compile = Time( iterations,[&]() {
+		nestedAccessors.clear();
+		for( const auto& path : paths )
+		{
+			nestedAccessors.push_back( nestedLayout.Compile<float>( path ) );
+		}
+	} );
+
+	const auto flatKeys = Time( iterations,[&]() {
+		for( unsigned int p = 0; p < passes; p++ )
+		{
+			for( const auto& key : keys )
+			{
+				auto ref = flat[key];
+				ref = (float)ref + 1.0f;
+			}
+		}
+	} );
+	const auto flatAccessor = Time( iterations,[&]() {
+		for( unsigned int p = 0; p < passes; p++ )
+		{
+			for( const auto& acc : flatAccessors )
+			{
+				flat[acc] += 1.0f;
+			}
+		}
+	} );
+	const auto flatStatic = Time( iterations,[&]() {
+		for( unsigned int p = 0; p < passes; p++ )
+		{
+			TouchStatic( flat,(const MaterialParams*)nullptr );
+		}
+	} );
+	const auto nestedKeys = Time( iterations,[&]() {
+		for( unsigned int p = 0; p < passes; p++ )
+		{
+			for( size_t i = 0; i < 16; i++ )
+			{
+				for( size_t j = 0; j < 4; j++ )
+				{
+					auto ref = nested["lights"][i]["cascades"][j];
+					ref = (float)ref + 1.0f;
+				}
+			}
+		}
+	} );
+	const auto nestedAccessor = Time( iterations,[&]() {
+		for( unsigned int p = 0; p < passes; p++ )
+		{
+			for( const auto& acc : nestedAccessors )
+			{
+				nested[acc] += 1.0f;
+			}
+		}
+	} );
+
+	// every leaf saw the same sequence of increments on every path, so any leaf that differs from
+	// its neighbours was missed or hit twice by one of them
+	bool consistent = true;
+	for( const auto& acc : flatAccessors )
+	{
+		consistent = consistent && flat[acc] == flat[flatAccessors.front()];
+	}
+	for( const auto& acc : nestedAccessors )
+	{
+		consistent = consistent && nested[acc] == nested[nestedAccessors.front()];
+	}
+
+	std::ofstream report( reportPath );
+	report << "dcb access benchmark" << std::endl
+		<< "iterations " << iterations << "  passes " << passes << "  (min / median over iterations)" << std::endl << std::endl
+		<< std::left << std::setw( 20 ) << "path" << std::right
+		<< std::setw( 12 ) << "accesses" << std::setw( 11 ) << "min ms" << std::setw( 11 ) << "median ms"
+		<< std::setw( 12 ) << "ns/access" << std::setw( 10 ) << "speedup" << std::endl;
+	const auto row = [&]( const char* name,size_t accesses,std::pair<float,float> t,std::pair<float,float> baseline )
+	{
+		report << std::left << std::setw( 20 ) << name << std::right << std::fixed
+			<< std::setw( 12 ) << accesses
+			<< std::setw( 11 ) << std::setprecision( 3 ) << t.first * 1000.0f
+			<< std::setw( 11 ) << t.second * 1000.0f
+			<< std::setw( 12 ) << std::setprecision( 2 ) << t.second * 1.0e9f / float( accesses )
+			<< std::setw( 9 ) << std::setprecision( 1 ) << baseline.second / std::max( t.second,1.0e-9f ) << "x" << std::endl;
+	};
+	const size_t flatAccesses = size_t( passes ) * keys.size();
+	const size_t nestedAccesses = size_t( passes ) * paths.size();
+	row( "flat keys",flatAccesses,flatKeys,flatKeys );
+	row( "flat accessor",flatAccesses,flatAccessor,flatKeys );
+	row( "flat static",flatAccesses,flatStatic,flatKeys );
+	row( "nested keys",nestedAccesses,nestedKeys,nestedKeys );
+	row( "nested accessor",nestedAccesses,nestedAccessor,nestedKeys );
+	report << std::endl << std::setprecision( 1 )
+		<< "accessor compile    " << compile.second * 1.0e9f / float( paths.size() ) << " ns per nested path (median)" << std::endl
+		<< "results agree       " << (consistent ? "yes" : "NO") << std::endl;
+}
+
+
+void Benchmark::VertexFormats( const std::string& reportPath,unsigned int iterations,unsigned int vertices )
+{
+	using Dvtx::VertexLayout;
+	iterations = std::max( iterations,1u );
+	vertices = std::max( vertices,1u );
+	using Format = Dvtx::VertexFormat<VertexLayout::Position3D,VertexLayout::Normal,VertexLayout::Texture2D,
+		VertexLayout::Tangent,VertexLayout::Binormal>;
+	const auto layout = Format::MakeLayout();
+	const auto position = [vertices]( unsigned int i )
+	{
+		const float a = float( i ) * 6.2831853f / float( vertices );
+		return DirectX::XMFLOAT3{ std::cos( a ),float( i ) / float( vertices ),std::sin( a ) };
+	};
+	const auto texcoord = [vertices]( unsigned int i )
+	{
+		return DirectX::XMFLOAT2{ float( i ) / float( vertices ),0.5f };
+	};
+	constexpr DirectX::XMFLOAT3 n = { 0.0f,1.0f,0.0f };
+	constexpr DirectX::XMFLOAT3 t = { 1.0f,0.0f,0.0f };
+	constexpr DirectX::XMFLOAT3 b = { 0.0f,0.0f,1.0f };
+
+	// procedural construction
+	Dvtx::VertexBuffer builtDynamic{ layout };
+	const auto buildDynamic = Time( iterations,[&]() {
+		builtDynamic = Dvtx::VertexBuffer{ layout };
+		for( unsigned int i = 0; i < vertices; i++ )
+		{
+			builtDynamic.EmplaceBack( position( i ),n,texcoord( i ),t,b );
+		}
+	} );
+	Dvtx::VertexBuffer builtStatic{ layout };
+	const auto buildStatic = Time( iterations,[&]() {
+		std::vector<Format::Vertex> v;
+		v.reserve( vertices );
+		for( unsigned int i = 0; i < vertices; i++ )
+		{
+			v.push_back( Format::Make( position( i ),n,texcoord( i ),t,b ) );
+		}
+		builtStatic = Format::MakeBuffer( v );
+	} );
+	const bool buildsAgree = builtDynamic.SizeBytes() == builtStatic.SizeBytes() &&
+		std::memcmp( builtDynamic.GetData(),builtStatic.GetData(),builtDynamic.SizeBytes() ) == 0;
+
+	// IndexedTriangleList::Transform style pass over the positions
+	const auto scalePositions = [&]( auto&& positionAt,size_t count )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			auto& p = positionAt( i );
+			p.x *= 1.0001f;
+			p.y *= 1.0001f;
+			p.z *= 1.0001f;
+		}
+	};
+	const auto transformAttr = Time( iterations,[&]() {
+		scalePositions( [&]( size_t i ) -> auto& { return builtDynamic[i].Attr<VertexLayout::Position3D>(); },builtDynamic.Size() );
+	} );
+	const auto transformStream = Time( iterations,[&]() {
+		const auto positions = builtDynamic.Stream<VertexLayout::Position3D>();
+		scalePositions( [&]( size_t i ) -> auto& { return positions[i]; },positions.Size() );
+	} );
+	const auto transformStatic = Time( iterations,[&]() {
+		const auto view = Format::View( builtStatic );
+		scalePositions( [&]( size_t i ) -> auto& { return view[i].Attr<VertexLayout::Position3D>(); },view.size() );
+	} );
+
+	// import, aiMesh frees its own arrays
+	aiMesh mesh;
+	mesh.mNumVertices = vertices;
+	mesh.mVertices = new aiVector3D[vertices];
+	mesh.mNormals = new aiVector3D[vertices];
+	mesh.mTangents = new aiVector3D[vertices];
+	mesh.mBitangents = new aiVector3D[vertices];
+	mesh.mTextureCoords[0] = new aiVector3D[vertices];
+	for( unsigned int i = 0; i < vertices; i++ )
+	{
+		const auto p = position( i );
+		const auto tc = texcoord( i );
+		mesh.mVertices[i] = { p.x,p.y,p.z };
+		mesh.mNormals[i] = { n.x,n.y,n.z };
+		mesh.mTangents[i] = { t.x,t.y,t.z };
+		mesh.mBitangents[i] = { b.x,b.y,b.z };
+		mesh.mTextureCoords[0][i] = { tc.x,tc.y,0.0f };
+	}
+	Dvtx::VertexBuffer importedDynamic{ layout };
+	const auto importDynamic = Time( iterations,[&]() {
+		importedDynamic = Dvtx::VertexBuffer{ layout,mesh };
+	} );
+	Dvtx::VertexBuffer importedStatic{ layout };
+	const auto importStatic = Time( iterations,[&]() {
+		importedStatic = Format::MakeBuffer( Format::Extract( mesh ) );
+	} );
+
+	const bool consistent = buildsAgree &&
+		importedDynamic.SizeBytes() == importedStatic.SizeBytes() &&
+		std::memcmp( importedDynamic.GetData(),importedStatic.GetData(),importedDynamic.SizeBytes() ) == 0;
+
+	std::ofstream report( reportPath );
+	report << "vertex format benchmark" << std::endl
+		<< "iterations " << iterations << "  vertices " << vertices << "  layout " << layout.GetCode()
+		<< " (" << layout.Size() << " bytes)  (min / median over iterations)" << std::endl << std::endl
+		<< std::left << std::setw( 20 ) << "path" << std::right
+		<< std::setw( 11 ) << "min ms" << std::setw( 11 ) << "median ms"
+		<< std::setw( 12 ) << "ns/vertex" << std::setw( 10 ) << "speedup" << std::endl;
+	const auto row = [&]( const char* name,std::pair<float,float> t,std::pair<float,float> baseline )
+	{
+		report << std::left << std::setw( 20 ) << name << std::right << std::fixed
+			<< std::setw( 11 ) << std::setprecision( 3 ) << t.first * 1000.0f
+			<< std::setw( 11 ) << t.second * 1000.0f
+			<< std::setw( 12 ) << std::setprecision( 2 ) << t.second * 1.0e9f / float( vertices )
+			<< std::setw( 9 ) << std::setprecision( 1 ) << baseline.second / std::max( t.second,1.0e-9f ) << "x" << std::endl;
+	};
+	row( "build emplace",buildDynamic,buildDynamic );
+	row( "build format",buildStatic,buildDynamic );
+	row( "transform attr",transformAttr,transformAttr );
+	row( "transform stream",transformStream,transformAttr );
+	row( "transform format",transformStatic,transformAttr );
+	row( "import layout",importDynamic,importDynamic );
+	row( "import format",importStatic,importDynamic );
+	report << std::endl << "results agree       " << (consistent ? "yes" : "NO") << std::endl;
+}
+
+void Benchmark::ConstantRing( const std::string& reportPath,unsigned int frames,unsigned int draws )
+{
+	frames = std::max( frames,1u );
+	draws = std::max( draws,1u );
+	// what the renderer feeds the ring per draw: a transform block and a shadow camera matrix
+	constexpr size_t transformBytes = 192u;
+	constexpr size_t cameraBytes = 64u;
+	const std::vector<char> source( transformBytes,1 );
+
+	::ConstantRing ring{ 1u << 20u,3u };
+	std::vector<std::vector<char>> mirrors;
+	std::vector<float> frameSeconds;
+	size_t spikePages = 0u;
+	for( unsigned int f = 0; f < frames; f++ )
+	{
+		const unsigned int frameDraws = f == frames / 2u ? draws * 4u : draws;
+		ChiliTimer timer;
+		ring.BeginFrame( f );
+		for( unsigned int d = 0; d < frameDraws; d++ )
+		{
+			for( auto size : { transformBytes,cameraBytes } )
+			{
+				const auto a = ring.Allocate( size );
+				if( a.page >= mirrors.size() )
+				{
+					mirrors.resize( a.page + 1u );
+				}
+				if( mirrors[a.page].empty() )
+				{
+					mirrors[a.page].resize( ring.GetPageSize() );
+				}
+				std::memcpy( &mirrors[a.page][a.offset],source.data(),size );
+			}
+		}
+		const float seconds = timer.Peek();
+		if( frameDraws == draws )
+		{
+			frameSeconds.push_back( seconds / float( frameDraws * 2u ) );
+		}
+		if( f == frames / 2u )
+		{
+			spikePages = ring.GetPageCount();
+		}
+	}
+	const auto perAllocation = Summarize( frameSeconds.empty() ? std::vector<float>{ 0.0f } : frameSeconds );
+	const auto stats = ring.GetStats();
+
+	std::ofstream report( reportPath );
+	report << "constant ring benchmark" << std::endl
+		<< "frames " << frames << "  draws " << draws << " (x4 on frame " << frames / 2u << ")"
+		<< "  page " << ring.GetPageSize() << " bytes" << std::endl << std::endl << std::fixed
+		<< "ns/allocation       " << std::setprecision( 2 ) << perAllocation.first * 1.0e9f << " min, "
+		<< perAllocation.second * 1.0e9f << " median (allocate + copy)" << std::endl
+		<< "allocations         " << stats.allocations << std::endl
+		<< "pages               " << stats.pages << " (" << spikePages << " after the spike)" << std::endl
+		<< "recycles            " << stats.recycles << std::endl
+		<< "alignment overhead  " << std::setprecision( 1 )
+		<< 100.0f * float( stats.allocatedBytes - stats.requestedBytes ) / float( std::max( stats.allocatedBytes,size_t( 1u ) ) )
+		<< "% of allocated bytes" << std::endl;
+}
+
+void Benchmark::TexturePreprocess( const std::string& reportPath,unsigned int iterations,unsigned int size,unsigned int threads )
+{
+	iterations = std::max( iterations,1u );
+	size = std::max( size,4u );
+	if( threads == 0u )
+	{
+		threads = std::max( std::thread::hardware_concurrency(),1u );
+	}
+	// a bumpy but valid normal map, with a band of bad texels for the validation to find
+	Surface source( size,size );
+	for( unsigned int y = 0; y < size; y++ )
+	{
+		const auto row = source.GetRow( y );
+		for( unsigned int x = 0; x < size; x++ )
+		{
+			const float nx = 0.4f * std::sin( float( x ) * 0.05f );
+			const float ny = 0.4f * std::cos( float( y ) * 0.07f );
+			const float nz = y < size / 64u ? -0.5f : std::sqrt( 1.0f - nx * nx - ny * ny );
+			const auto encode = []( float n ) { return (unsigned char)std::round( (n + 1.0f) * 127.5f ); };
+			row[x] = { encode( nx ),encode( ny ),encode( nz ) };
+		}
+	}
+	Surface work( size,size );
+	const auto reload = [&]()
+	{
+		for( unsigned int y = 0; y < size; y++ )
+		{
+			std::ranges::copy( source.GetRow( y ),work.GetRow( y ).begin() );
+		}
+	};
+
+	// flips time the transform only, the copy back to the source texels runs between iterations
+	const auto timeFlip = [&]( auto&& flip )
+	{
+		std::vector<float> seconds;
+		for( unsigned int i = 0; i < iterations; i++ )
+		{
+			reload();
+			ChiliTimer timer;
+			flip();
+			seconds.push_back( timer.Peek() );
+		}
+		return Summarize( std::move( seconds ) );
+	};
+	const auto flipTexel = timeFlip( [&]() { FlipYPerTexel( work ); } );
+	Surface flippedTexel( size,size );
+	for( unsigned int y = 0; y < size; y++ )
+	{
+		std::ranges::copy( work.GetRow( y ),flippedTexel.GetRow( y ).begin() );
+	}
+	const auto flipRows = timeFlip( [&]() { TexturePreprocessor::FlipYNormalMap( work,1u ); } );
+	const auto flipThreads = timeFlip( [&]() { TexturePreprocessor::FlipYNormalMap( work,threads ); } );
+	bool flipsAgree = true;
+	for( unsigned int y = 0; y < size; y++ )
+	{
+		flipsAgree = flipsAgree && std::ranges::equal( work.GetRow( y ),flippedTexel.GetRow( y ),
+			[]( Surface::Color a,Surface::Color b ) { return a.dword == b.dword; } );
+	}
+
+	TexturePreprocessor::NormalMapReport texelReport;
+	TexturePreprocessor::NormalMapReport rowsReport;
+	TexturePreprocessor::NormalMapReport threadsReport;
+	const auto validateTexel = Time( iterations,[&]() { texelReport = ValidatePerTexel( source,0.9f,1.1f ); } );
+	const auto validateRows = Time( iterations,[&]() { rowsReport = TexturePreprocessor::ValidateNormalMap( source,0.9f,1.1f,false,1u ); } );
+	const auto validateThreads = Time( iterations,[&]() { threadsReport = TexturePreprocessor::ValidateNormalMap( source,0.9f,1.1f,false,threads ); } );
+	// the per texel bias is summed in floats, so only close; the row kernels sum exactly whatever the thread count
+	const bool validationsAgree = texelReport.badLength == rowsReport.badLength && texelReport.badZ == rowsReport.badZ &&
+		std::abs( texelReport.biasX - rowsReport.biasX ) <= 1.0e-3 * double( rowsReport.texels ) &&
+		std::abs( texelReport.biasY - rowsReport.biasY ) <= 1.0e-3 * double( rowsReport.texels ) &&
+		rowsReport.badLength == threadsReport.badLength && rowsReport.badZ == threadsReport.badZ &&
+		rowsReport.biasX == threadsReport.biasX && rowsReport.biasY == threadsReport.biasY;
+
+	const float megapixels = float( size ) * float( size ) / 1.0e6f;
+	std::ofstream report( reportPath );
+	report << "texture preprocessor benchmark" << std::endl
+		<< "iterations " << iterations << "  surface " << size << "x" << size << "  threads " << threads
+		<< "  (min / median over iterations)" << std::endl << std::endl
+		<< std::left << std::setw( 20 ) << "path" << std::right
+		<< std::setw( 11 ) << "min ms" << std::setw( 11 ) << "median ms"
+		<< std::setw( 12 ) << "ms/MP" << std::setw( 10 ) << "MP/s" << std::setw( 10 ) << "speedup" << std::endl;
+	const auto row = [&]( const char* name,std::pair<float,float> t,std::pair<float,float> baseline )
+	{
+		const float median = std::max( t.second,1.0e-9f );
+		report << std::left << std::setw( 20 ) << name << std::right << std::fixed
+			<< std::setw( 11 ) << std::setprecision( 3 ) << t.first * 1000.0f
+			<< std::setw( 11 ) << t.second * 1000.0f
+			<< std::setw( 12 ) << median * 1000.0f / megapixels
+			<< std::setw( 10 ) << std::setprecision( 1 ) << megapixels / median
+			<< std::setw( 9 ) << baseline.second / median << "x" << std::endl;
+	};
+	row( "flip per texel",flipTexel,flipTexel );
+	row( "flip rows",flipRows,flipTexel );
+	row( "flip rows threaded",flipThreads,flipTexel );
+	row( "validate per texel",validateTexel,validateTexel );
+	row( "validate rows",validateRows,validateTexel );
+	row( "validate threaded",validateThreads,validateTexel );
+	report << std::endl << "bad texels          " << rowsReport.badLength << " length, " << rowsReport.badZ << " z" << std::endl
+		<< "bias                " << std::setprecision( 3 ) << rowsReport.biasX << ", " << rowsReport.biasY
+		<< " (per texel path " << texelReport.biasX << ", " << texelReport.biasY << ")" << std::endl
+		<< "results agree       " << (flipsAgree && validationsAgree ? "yes" : "NO") << std::endl;
+}
+
+namespace
+{
+	// somewhere for results to go so the optimizer can't drop the work producing them
+	volatile float sink = 0.0f;
+
+	struct SuiteCase
+	{
+		std::string name;
+		// operations done by one run, timings are reported per operation
+		size_t ops;
+		std::function<void()> run;
+		// between samples, untimed
+		std::function<void()> reset;
+	};
+
+	struct CaseStats
+	{
+		size_t repeats;
+		float min;
+		float median;
+		float mean;
+		float p90;
+		// median absolute deviation from the median, the noise figure regressions are judged against
+		float mad;
+	};
+
+	CaseStats Measure( const SuiteCase& c,unsigned int samples,float sampleSeconds )
+	{
+		// one run to warm caches and lazily built state, one to size the samples with
+		c.run();
+		ChiliTimer timer;
+		c.run();
+		const float once = std::max( timer.Peek(),1.0e-7f );
+		const auto repeats = std::max( size_t( std::ceil( sampleSeconds / once ) ),size_t( 1u ) );
+		if( c.reset )
+		{
+			c.reset();
+		}
+		std::vector<float> ns;
+		for( unsigned int s = 0; s < samples; s++ )
+		{
+			ChiliTimer sample;
+			for( size_t r = 0; r < repeats; r++ )
+			{
+				c.run();
+			}
+			ns.push_back( sample.Peek() * 1.0e9f / float( repeats * c.ops ) );
+			if( c.reset )
+			{
+				c.reset();
+			}
+		}
+		std::sort( ns.begin(),ns.end() );
+		CaseStats stats;
+		stats.repeats = repeats;
+		stats.min = ns.front();
+		stats.median = ns[ns.size() / 2];
+		stats.mean = std::accumulate( ns.begin(),ns.end(),0.0f ) / float( ns.size() );
+		stats.p90 = ns[std::min( ns.size() * 9u / 10u,ns.size() - 1u )];
+		std::vector<float> deviations;
+		for( const auto t : ns )
+		{
+			deviations.push_back( std::abs( t - stats.median ) );
+		}
+		std::sort( deviations.begin(),deviations.end() );
+		stats.mad = deviations[deviations.size() / 2];
+		return stats;
+	}
+
+	// stands in for real bindables where only the codex itself is measured
+	class NullBindable : public Bind::Bindable
+	{
+	public:
+		void Bind( Graphics& ) noxnd override
+		{}
+		static std::uint64_t GenerateKey( unsigned int id ) noexcept
+		{
+			return Bind::Codex::Hasher{ Bind::Codex::TypeKey<NullBindable>() }.Add( id ).Get();
+		}
+		static std::string GenerateUID( unsigned int id )
+		{
+			return "null#" + std::to_string( id );
+		}
+	};
+
+	class SuiteDrawable : public Drawable
+	{
+	public:
+		SuiteDrawable( Graphics& gfx,DirectX::XMFLOAT3 pos,const Step& prototype )
+			:
+			pos( pos ),
+			step( prototype )
+		{
+			auto model = Cube::MakePosOnly();
+			pVertices = Bind::VertexBuffer::Resolve( gfx,"$benchmark.cube",model.vertices );
+			pIndices = Bind::IndexBuffer::Resolve( gfx,"$benchmark.cube",model.indices );
+			pTopology = Bind::Topology::Resolve( gfx,D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+			step.InitializeParentReferences( *this );
+		}
+		DirectX::XMMATRIX GetTransformXM() const noexcept override
+		{
+			return DirectX::XMMatrixTranslation( pos.x,pos.y,pos.z );
+		}
+		const Step& GetStep() const noexcept
+		{
+			return step;
+		}
+	private:
+		DirectX::XMFLOAT3 pos;
+		Step step;
+	};
+
+	class SuitePass : public Rgph::RenderQueuePass
+	{
+	public:
+		SuitePass( Graphics& gfx )
+			:
+			RenderQueuePass( "benchmark" )
+		{
+			renderTarget = gfx.GetTarget();
+		}
+	};
+
+	class SuiteTransformCbuf : public Bind::TransformCbuf
+	{
+	public:
+		using TransformCbuf::TransformCbuf;
+		using TransformCbuf::GetTransforms;
+	};
+}
+
+size_t Benchmark::Suite( const SuiteOptions& options )
+{
+	namespace dx = DirectX;
+	namespace jso = nlohmann;
+	using Dvtx::VertexLayout;
+	const auto samples = std::max( options.samples,3u );
+	std::vector<SuiteCase> cases;
+
+	// dcb: a material block cooked through the layout codex, buffers made from it, key / accessor lookups
+	const auto makeMaterialLayout = []()
+	{
+		Dcb::RawLayout raw;
+		for( const auto key : { "metallic","roughness","normalMapWeight","specularGloss","specularWeight","scale","offset","occlusion" } )
+		{
+			raw.Add<Dcb::Float>( key );
+		}
+		raw.Add<Dcb::Float3>( "tint" );
+		raw.Add<Dcb::Array>( "cascades" );
+		raw["cascades"].Set<Dcb::Float4>( 4 );
+		return raw;
+	};
+	const auto materialLayout = Dcb::LayoutCodex::Resolve( makeMaterialLayout() );
+	Dcb::Buffer material{ materialLayout };
+	const std::vector<std::string> keys = {
+		"metallic","roughness","normalMapWeight","specularGloss","specularWeight","scale","offset","occlusion"
+	};
+	std::vector<Dcb::Accessor<float>> accessors;
+	for( const auto& key : keys )
+	{
+		accessors.push_back( materialLayout.Compile<float>( key ) );
+	}
+	cases.push_back( { "dcb.layout.resolve",1u,[&]() {
+		const auto layout = Dcb::LayoutCodex::Resolve( makeMaterialLayout() );
+		sink = sink + float( layout.GetSizeInBytes() );
+	} } );
+	cases.push_back( { "dcb.buffer.make",1u,[&]() {
+		const Dcb::Buffer buf{ materialLayout };
+		sink = sink + float( buf.GetSizeInBytes() );
+	} } );
+	cases.push_back( { "dcb.lookup.key",keys.size(),[&]() {
+		for( const auto& key : keys )
+		{
+			auto ref = material[key];
+			ref = (float)ref + 1.0f;
+		}
+	} } );
+	cases.push_back( { "dcb.lookup.accessor",accessors.size(),[&]() {
+		for( const auto& acc : accessors )
+		{
+			material[acc] += 1.0f;
+		}
+	} } );
+
+	// dvtx: procedural vertex construction, dynamic layout and compile-time format
+	constexpr unsigned int nVertices = 4096u;
+	using Format = Dvtx::VertexFormat<VertexLayout::Position3D,VertexLayout::Normal,VertexLayout::Texture2D>;
+	const auto vertexLayout = Format::MakeLayout();
+	cases.push_back( { "dvtx.emplace",nVertices,[&]() {
+		Dvtx::VertexBuffer vb{ vertexLayout };
+		for( unsigned int i = 0; i < nVertices; i++ )
+		{
+			vb.EmplaceBack( dx::XMFLOAT3{ float( i ),0.0f,1.0f },dx::XMFLOAT3{ 0.0f,1.0f,0.0f },dx::XMFLOAT2{ 0.5f,float( i ) } );
+		}
+		sink = sink + float( vb.SizeBytes() );
+	} } );
+	cases.push_back( { "dvtx.format",nVertices,[&]() {
+		std::vector<Format::Vertex> v;
+		v.reserve( nVertices );
+		for( unsigned int i = 0; i < nVertices; i++ )
+		{
+			v.push_back( Format::Make( dx::XMFLOAT3{ float( i ),0.0f,1.0f },dx::XMFLOAT3{ 0.0f,1.0f,0.0f },dx::XMFLOAT2{ 0.5f,float( i ) } ) );
+		}
+		const auto vb = Format::MakeBuffer( v );
+		sink = sink + float( vb.SizeBytes() );
+	} } );
+
+	// headless device for everything that binds or needs a camera
+	Graphics gfx{ 64u,64u };
+	gfx.SetCamera( dx::XMMatrixLookAtLH( dx::XMVectorSet( 0.0f,5.0f,-20.0f,1.0f ),dx::XMVectorZero(),dx::XMVectorSet( 0.0f,1.0f,0.0f,0.0f ) ) );
+	gfx.SetProjection( dx::XMMatrixPerspectiveFovLH( 1.0f,1.0f,0.5f,400.0f ) );
+
+	// codex: hits through uid strings (topology) and through direct keys (sampler), misses with inserts
+	constexpr unsigned int nResolves = 64u;
+	cases.push_back( { "codex.resolve.hit-uid",nResolves,[&]() {
+		for( unsigned int i = 0; i < nResolves; i++ )
+		{
+			sink = sink + float( Bind::Topology::Resolve( gfx ).use_count() );
+		}
+	} } );
+	cases.push_back( { "codex.resolve.hit-key",nResolves,[&]() {
+		for( unsigned int i = 0; i < nResolves; i++ )
+		{
+			sink = sink + float( Bind::Sampler::Resolve( gfx ).use_count() );
+		}
+	} } );
+	unsigned int nextNull = 0u;
+	cases.push_back( { "codex.resolve.miss",nResolves,[&]() {
+		for( unsigned int i = 0; i < nResolves; i++ )
+		{
+			const auto id = nextNull++;
+			sink = sink + float( Bind::Codex::ResolveDeferred<NullBindable>( []() { return std::make_shared<NullBindable>(); },id ).use_count() );
+		}
+	},[]() {
+		Bind::Codex::Evict( true );
+	} } );
+
+	// node: one root with a wide fan of children, and a deep binary tree, no meshes so only the hierarchy walk
+	// and transform accumulation are timed
+	int nextId = 0;
+	const auto makeNode = [&]( float offset )
+	{
+		return std::make_unique<Node>( nextId++,"node",std::vector<Mesh*>{},dx::XMMatrixTranslation( offset,0.0f,0.0f ) );
+	};
+	constexpr size_t nWide = 4096u;
+	auto pWide = makeNode( 0.0f );
+	for( size_t i = 1; i < nWide; i++ )
+	{
+		pWide->AddChild( makeNode( float( i ) ) );
+	}
+	constexpr int treeDepth = 12;
+	const auto grow = [&]( auto& self,Node& parent,int depth ) -> void
+	{
+		if( depth < treeDepth )
+		{
+			for( int c = 0; c < 2; c++ )
+			{
+				auto pChild = makeNode( float( c ) );
+				self( self,*pChild,depth + 1 );
+				parent.AddChild( std::move( pChild ) );
+			}
+		}
+	};
+	auto pTree = makeNode( 0.0f );
+	grow( grow,*pTree,0 );
+	const auto identity = dx::XMMatrixIdentity();
+	cases.push_back( { "node.submit.wide",nWide,[&]() {
+		pWide->Submit( 0b1u,identity );
+	} } );
+	cases.push_back( { "node.submit.tree",(size_t( 2u ) << treeDepth) - 1u,[&]() {
+		pTree->Submit( 0b1u,identity );
+	} } );
+
+	// render queue: the jobs of many draws of a few distinct drawables through a pass on the null device
+	Step prototype{ "benchmark" };
+	{
+		const auto cube = Cube::MakePosOnly();
+		auto pvs = Bind::VertexShader::Resolve( gfx,"Solid_VS.cso" );
+		prototype.AddBindable( Bind::InputLayout::Resolve( gfx,cube.vertices.GetLayout(),*pvs ) );
+		prototype.AddBindable( std::move( pvs ) );
+		prototype.AddBindable( Bind::PixelShader::Resolve( gfx,"Solid_PS.cso" ) );
+		prototype.AddBindable( std::make_shared<Bind::PixelConstantBuffer<dx::XMFLOAT4>>( gfx,dx::XMFLOAT4{ 1.0f,1.0f,1.0f,1.0f },10u ) );
+		prototype.AddBindable( std::make_shared<Bind::TransformCbuf>( gfx ) );
+		prototype.AddBindable( Bind::Rasterizer::Resolve( gfx,false ) );
+	}
+	std::vector<std::unique_ptr<SuiteDrawable>> drawables;
+	for( int i = 0; i < 64; i++ )
+	{
+		drawables.push_back( std::make_unique<SuiteDrawable>( gfx,dx::XMFLOAT3{ float( i % 8 ),0.0f,float( i / 8 ) },prototype ) );
+	}
+	constexpr size_t nJobs = 4096u;
+	const auto acceptAll = [&]( Rgph::RenderQueuePass& pass )
+	{
+		for( size_t i = 0; i < nJobs; i++ )
+		{
+			const auto& d = *drawables[i % drawables.size()];
+			pass.Accept( Rgph::Job{ &d.GetStep(),&d } );
+		}
+	};
+	SuitePass acceptPass{ gfx };
+	cases.push_back( { "rqp.accept",nJobs,[&]() {
+		acceptAll( acceptPass );
+		acceptPass.Reset();
+	} } );
+	// keeps its jobs, executed again every run
+	SuitePass executePass{ gfx };
+	acceptAll( executePass );
+	cases.push_back( { "rqp.execute",nJobs,[&]() {
+		executePass.Execute( gfx );
+		// a frame per run so the constant ring recycles like it does in the app
+		gfx.EndFrame();
+	} } );
+
+	// transform constants as TransformCbuf builds them for every draw
+	constexpr unsigned int nTransforms = 1024u;
+	SuiteTransformCbuf transformCbuf{ gfx };
+	transformCbuf.InitializeParentReference( *drawables.front() );
+	cases.push_back( { "transformcbuf.get-transforms",nTransforms,[&]() {
+		for( unsigned int i = 0; i < nTransforms; i++ )
+		{
+			const auto tf = transformCbuf.GetTransforms( gfx );
+			sink = sink + dx::XMVectorGetX( tf.matrix_MVP.r[0] );
+		}
+	} } );
+
+	// texture preprocessing on in-memory surfaces, row kernels on one thread so samples don't fight over cores
+	std::vector<std::unique_ptr<Surface>> surfaces;
+	for( const unsigned int size : { 256u,1024u } )
+	{
+		auto pSurf = std::make_unique<Surface>( size,size );
+		for( unsigned int y = 0; y < size; y++ )
+		{
+			for( unsigned int x = 0; x < size; x++ )
+			{
+				pSurf->PutPixel( x,y,{ (unsigned char)(x * 255u / size),(unsigned char)(y * 255u / size),255u } );
+			}
+		}
+		const auto pRaw = pSurf.get();
+		cases.push_back( { "texture.flip-y." + std::to_string( size ),size_t( size ) * size,[pRaw]() {
+			TexturePreprocessor::FlipYNormalMap( *pRaw,1u );
+		} } );
+		cases.push_back( { "texture.validate." + std::to_string( size ),size_t( size ) * size,[pRaw]() {
+			sink = sink + float( TexturePreprocessor::ValidateNormalMap( *pRaw,0.9f,1.1f,false,1u ).badLength );
+		} } );
+		surfaces.push_back( std::move( pSurf ) );
+	}
+
+	auto results = jso::json::array();
+	std::map<std::string,CaseStats> measured;
+	for( const auto& c : cases )
+	{
+		if( c.name.find( options.filter ) == std::string::npos )
+		{
+			continue;
+		}
+		const auto stats = Measure( c,samples,options.sampleSeconds );
+		measured[c.name] = stats;
+		results.push_back( {
+			{ "name",c.name },
+			{ "ops",c.ops },
+			{ "repeats",stats.repeats },
+			{ "ns",{ { "min",stats.min },{ "median",stats.median },{ "mean",stats.mean },{ "p90",stats.p90 },{ "mad",stats.mad } } }
+		} );
+	}
+
+	// a case regresses when its median moved by more than the tolerance and clearly out of either run's noise
+	auto regressions = jso::json::array();
+	if( !options.baselinePath.empty() )
+	{
+		std::ifstream baselineFile( options.baselinePath );
+		const auto baseline = jso::json::parse( baselineFile );
+		for( const auto& b : baseline.at( "cases" ) )
+		{
+			const auto i = measured.find( b.at( "name" ).get<std::string>() );
+			if( i == measured.end() )
+			{
+				continue;
+			}
+			const auto& now = i->second;
+			const auto before = b.at( "ns" ).at( "median" ).get<float>();
+			const auto noise = 3.0f * std::max( now.mad,b.at( "ns" ).at( "mad" ).get<float>() );
+			if( now.median > before * (1.0f + options.tolerance) && now.median - before > noise )
+			{
+				regressions.push_back( {
+					{ "name",i->first },
+					{ "baselineMedian",before },
+					{ "median",now.median },
+					{ "change",now.median / before - 1.0f }
+				} );
+			}
+		}
+	}
+
+	const jso::json report = {
+		{ "suite","engine-core" },
+		{ "label",options.label },
+#ifdef NDEBUG
+		{ "config","release" },
+#else
+		{ "config","debug" },
+#endif
+		{ "unit","ns/op" },
+		{ "samples",samples },
+		{ "sampleSeconds",options.sampleSeconds },
+		{ "baseline",options.baselinePath },
+		{ "cases",std::move( results ) },
+		{ "regressions",regressions }
+	};
+	std::ofstream out( options.reportPath );
+	out << report.dump( 1,'\t' ) << std::endl;
+	return regressions.size();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+
+// headless cpu micro-benchmarks of engine systems, driven from ScriptCommander
+class Benchmark
+{
+public:
+	struct SuiteOptions
+	{
+		std::string reportPath = "benchmark_suite.json";
+		// an earlier report to compare against, none when empty
+		std::string baselinePath;
+		// only runs the cases whose name contains this
+		std::string filter;
+		// stored in the report as is (commit, machine, ...)
+		std::string label;
+		unsigned int samples = 15u;
+		// each sample repeats its case until it takes at least this long
+		float sampleSeconds = 0.01f;
+		// a median more than this much slower than the baseline's (and by more than 3 MADs) is a regression
+		float tolerance = 0.05f;
+	};
+public:
+	// engine core suite: dcb layouts and lookups, vertex construction, codex resolves, Node::Submit over
+	// large hierarchies, RenderQueuePass accept / execute and TransformCbuf on a headless (null driver)
+	// device, and TexturePreprocessor transforms on in-memory surfaces
+	// every case is warmed up and timed over samples sized to sampleSeconds, the json report holds
+	// min / median / mean / p90 / median absolute deviation in ns per operation for each
+	// returns the number of regressions against the baseline (0 without one)
+	static size_t Suite( const SuiteOptions& options );
+	// read-modify-writes every leaf of a material sized layout through string keys, through Accessors compiled
+	// once and through a StaticLayout, plus deep paths into nested arrays (keys vs Accessors), and writes
+	// the time per access for each (release builds only give meaningful numbers, Debug adds layout checks)
+	static void DcbAccess( const std::string& reportPath,unsigned int iterations,unsigned int passes );
+	// builds, transforms and imports (from a synthetic aiMesh) vertex buffers through the dynamic VertexLayout
+	// path and through a VertexFormat of the same elements, and writes the time per vertex for each
+	static void VertexFormats( const std::string& reportPath,unsigned int iterations,unsigned int vertices );
+	// plays frames of per-draw constant writes through a ConstantRing (copying into cpu mirrors of its pages),
+	// with a four times heavier frame in the middle, and writes the cost per allocation, the page count
+	// the spike left behind, the alignment overhead and how often pages were recycled
+	static void ConstantRing( const std::string& reportPath,unsigned int frames,unsigned int draws );
+	// flips and validates a size x size normal map through a per texel reference of the old TexturePreprocessor
+	// path, through its row kernels on one thread and on threads (0 = all cores), and writes min / median
+	// times, megapixels per second and the speedup over the reference, and whether the results agree
+	static void TexturePreprocess( const std::string& reportPath,unsigned int iterations,unsigned int size,unsigned int threads );
+};
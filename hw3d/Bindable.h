@@ -2,6 +2,7 @@
 #include "GraphicsResource.h"
 #include <memory>
 #include <string>
+#include <cstdint>
 #include <filesystem>
 #include "ConditionalNoexcept.h"
 
@@ -24,6 +25,11 @@ namespace Bind
 			assert( false );
 			return "";
 		}
+		// gpu memory owned, for the codex budget (0 for state objects and other small things)
+		virtual size_t GetSizeBytes() const noexcept
+		{
+			return 0u;
+		}
 		virtual ~Bindable() = default;
 	};
 
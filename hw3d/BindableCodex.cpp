@@ -0,0 +1,100 @@
+#include "BindableCodex.h"
+#include <vector>
+#include <algorithm>
+#include <sstream>
+
+namespace Bind
+{
+	void Codex::SetBudget( size_t bytes ) noexcept
+	{
+		Get().budget = bytes;
+	}
+	size_t Codex::Evict( bool force )
+	{
+		return Get().Evict_( force );
+	}
+	Codex::Stats Codex::GetStats() noexcept
+	{
+		auto& codex = Get();
+		Stats stats;
+		stats.hits = codex.hits;
+		stats.misses = codex.misses;
+		stats.evictions = codex.evictions;
+		stats.bytes = codex.totalBytes;
+		stats.budget = codex.budget;
+		for( auto& shard : codex.shards )
+		{
+			std::lock_guard lock{ shard.mutex };
+			stats.entries += shard.binds.size();
+		}
+		return stats;
+	}
+	std::string Codex::GetStatsReport()
+	{
+		const auto stats = GetStats();
+		const auto lookups = stats.hits + stats.misses;
+		std::ostringstream oss;
+		oss << "Codex: " << stats.entries << " bindables (" << stats.bytes / (1024 * 1024) << " MB), "
+			<< stats.hits << " hits / " << stats.misses << " misses ("
+			<< (lookups ? 100 * stats.hits / lookups : 0) << "% hit rate), "
+			<< stats.evictions << " evicted\n";
+		return oss.str();
+	}
+	size_t Codex::Evict_( bool force )
+	{
+		std::lock_guard evictLock{ evictMutex };
+		if( !force && (budget == 0 || totalBytes <= budget) )
+		{
+			return 0;
+		}
+		// only the codex holds these, nothing is bound or waiting to bind them
+		struct Candidate
+		{
+			std::uint64_t lastUse;
+			Key key;
+		};
+		std::vector<Candidate> candidates;
+		for( auto& shard : shards )
+		{
+			std::lock_guard lock{ shard.mutex };
+			for( const auto& [key,entry] : shard.binds )
+			{
+				if( entry.pBind.use_count() == 1 )
+				{
+					candidates.push_back( { entry.lastUse,key } );
+				}
+			}
+		}
+		std::sort( candidates.begin(),candidates.end(),[]( const Candidate& a,const Candidate& b )
+		{
+			return a.lastUse < b.lastUse;
+		} );
+		size_t nEvicted = 0;
+		for( const auto& c : candidates )
+		{
+			if( !force && totalBytes <= budget )
+			{
+				break;
+			}
+			std::shared_ptr<Bindable> pDoomed;
+			{
+				auto& shard = shards[c.key % nShards];
+				std::lock_guard lock{ shard.mutex };
+				const auto i = shard.binds.find( c.key );
+				// picked up again since the scan
+				if( i == shard.binds.end() || i->second.pBind.use_count() != 1 || i->second.lastUse != c.lastUse )
+				{
+					continue;
+				}
+				pDoomed = std::move( i->second.pBind );
+				totalBytes -= i->second.bytes;
+				shard.binds.erase( i );
+			}
+			// released outside the lock
+			pDoomed.reset();
+			nEvicted++;
+		}
+		evictions += nEvicted;
+		return nEvicted;
+	}
+}
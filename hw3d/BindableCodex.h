@@ -1,45 +1,207 @@
 #pragma once
 
 #include "Bindable.h"
-#include "BindableCodex.h"
 #include <type_traits>
 #include <memory>
 #include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <typeinfo>
+#include <cassert>
+#include "Trace.h"
 
 namespace Bind
 {
+	// shared bindables, keyed by a 64-bit hash of the type and its construction parameters
+	// types can supply static GenerateKey( params... ) to hash their parameters directly,
+	// otherwise the GenerateUID( params... ) string is hashed (debug builds always build the string
+	// and assert that no two different uids ever share a key)
+	// the codex itself is safe to resolve from any thread (bindables whose constructors touch the
+	// immediate context, like textures, still have to be created on the render thread); with a budget set, bindables nothing outside the codex holds
+	// any more are dropped least recently used first once the total size goes over it
 	class Codex
 	{
+	public:
+		using Key = std::uint64_t;
+		// fnv-1a, chained over the parts of a key
+		class Hasher
+		{
+		public:
+			Hasher() = default;
+			explicit Hasher( Key seed ) noexcept
+				:
+				h( seed )
+			{}
+			Hasher& Add( const void* pData,size_t size ) noexcept
+			{
+				const auto p = static_cast<const unsigned char*>( pData );
+				for( size_t i = 0; i < size; i++ )
+				{
+					h = (h ^ p[i]) * 1099511628211ull;
+				}
+				return *this;
+			}
+			Hasher& Add( std::string_view s ) noexcept
+			{
+				// length first so ("ab","c") and ("a","bc") differ
+				Add( s.size() );
+				return Add( s.data(),s.size() );
+			}
+			Hasher& Add( const std::string& s ) noexcept
+			{
+				return Add( std::string_view{ s } );
+			}
+			template<typename V>
+			Hasher& Add( const V& v ) noexcept
+			{
+				static_assert( std::is_trivially_copyable_v<V>,"Only plain values can be hashed bytewise" );
+				return Add( &v,sizeof( v ) );
+			}
+			Key Get() const noexcept
+			{
+				return h;
+			}
+		private:
+			Key h = 14695981039346656037ull;
+		};
+		struct Stats
+		{
+			size_t hits = 0;
+			size_t misses = 0;
+			size_t evictions = 0;
+			size_t entries = 0;
+			// sum of Bindable::GetSizeBytes() over the entries
+			size_t bytes = 0;
+			size_t budget = 0;
+		};
 	public:
 		template<class T,typename...Params>
 		static std::shared_ptr<T> Resolve( Graphics& gfx,Params&&...p ) noxnd
 		{
 			static_assert( std::is_base_of<Bindable,T>::value,"Can only resolve classes derived from Bindable" );
-			return Get().Resolve_<T>( gfx,std::forward<Params>( p )... );
+			return Get().Resolve_<T>( [&]() { return std::make_shared<T>( gfx,std::forward<Params>( p )... ); },p... );
 		}
+		// keyed on keyParams like Resolve, but make() only runs on a miss and returns the new bindable,
+		// so whatever is expensive to gather for construction (vertices, indices) is never built for a hit
+		template<class T,typename Make,typename...KeyParams>
+		static std::shared_ptr<T> ResolveDeferred( Make&& make,const KeyParams&...keyParams ) noxnd
+		{
+			static_assert( std::is_base_of<Bindable,T>::value,"Can only resolve classes derived from Bindable" );
+			return Get().Resolve_<T>( std::forward<Make>( make ),keyParams... );
+		}
+		// seed for the keys of T, so equal parameters of different types never meet
+		template<class T>
+		static Key TypeKey() noexcept
+		{
+			static const Key key = Hasher{}.Add( std::string_view{ typeid(T).name() } ).Get();
+			return key;
+		}
+		// 0 (the default) keeps everything for the lifetime of the program
+		static void SetBudget( size_t bytes ) noexcept;
+		// drops unreferenced entries, oldest use first, until under budget (all of them with force)
+		// returns how many were dropped
+		static size_t Evict( bool force = false );
+		static Stats GetStats() noexcept;
+		// one line summary of the stats for logs
+		static std::string GetStatsReport();
+	private:
+		struct Entry
+		{
+			std::shared_ptr<Bindable> pBind;
+			size_t bytes = 0;
+			// value of the use clock at the last resolve
+			std::uint64_t lastUse = 0;
+#ifndef NDEBUG
+			std::string uid;
+#endif
+		};
+		struct Shard
+		{
+			std::mutex mutex;
+			std::unordered_map<Key,Entry> binds;
+		};
+		static constexpr size_t nShards = 16u;
 	private:
 		template<class T,typename...Params>
-		std::shared_ptr<T> Resolve_( Graphics& gfx,Params&&...p ) noxnd
+		static Key MakeKey( const Params&...p )
 		{
-			const auto key = T::GenerateUID( std::forward<Params>( p )... );
-			const auto i = binds.find( key );
-			if( i == binds.end() )
+			if constexpr( requires { T::GenerateKey( p... ); } )
 			{
-				auto bind = std::make_shared<T>( gfx,std::forward<Params>( p )... );
-				binds[key] = bind;
-				return bind;
+				return T::GenerateKey( p... );
 			}
 			else
 			{
-				return std::static_pointer_cast<T>( i->second );
+				return Hasher{ TypeKey<T>() }.Add( T::GenerateUID( p... ) ).Get();
+			}
+		}
+		template<class T,typename Make,typename...Params>
+		std::shared_ptr<T> Resolve_( Make&& make,const Params&...p ) noxnd
+		{
+			TRACE_ZONE( "Codex::Resolve" );
+			const auto key = MakeKey<T>( p... );
+#ifndef NDEBUG
+			const auto uid = T::GenerateUID( p... );
+#endif
+			auto& shard = shards[key % nShards];
+			{
+				std::lock_guard lock{ shard.mutex };
+				if( const auto i = shard.binds.find( key ); i != shard.binds.end() )
+				{
+					assert( i->second.uid == uid && "Bindable codex key collision" );
+					i->second.lastUse = ++useClock;
+					hits++;
+					return std::static_pointer_cast<T>( i->second.pBind );
+				}
+			}
+			// constructed outside the lock, construction may resolve other bindables from the same shard
+			TRACE_ZONE( "Codex::Make" );
+			std::shared_ptr<T> bind = make();
+			const auto bytes = bind->GetSizeBytes();
+			{
+				std::lock_guard lock{ shard.mutex };
+				auto [i,inserted] = shard.binds.try_emplace( key );
+				if( !inserted )
+				{
+					// another thread got there first, share theirs
+					assert( i->second.uid == uid && "Bindable codex key collision" );
+					i->second.lastUse = ++useClock;
+					hits++;
+					return std::static_pointer_cast<T>( i->second.pBind );
+				}
+				i->second.pBind = bind;
+				i->second.bytes = bytes;
+				i->second.lastUse = ++useClock;
+#ifndef NDEBUG
+				i->second.uid = uid;
+#endif
+				misses++;
+			}
+			totalBytes += bytes;
+			if( const auto b = budget.load(); b != 0 && totalBytes.load() > b )
+			{
+				Evict_( false );
 			}
+			return bind;
 		}
+		size_t Evict_( bool force );
 		static Codex& Get()
 		{
 			static Codex codex;
 			return codex;
 		}
 	private:
-		std::unordered_map<std::string,std::shared_ptr<Bindable>> binds;
+		std::array<Shard,nShards> shards;
+		std::atomic<std::uint64_t> useClock{ 0 };
+		std::atomic<size_t> budget{ 0 };
+		std::atomic<size_t> totalBytes{ 0 };
+		std::atomic<size_t> hits{ 0 };
+		std::atomic<size_t> misses{ 0 };
+		std::atomic<size_t> evictions{ 0 };
+		// one eviction pass at a time
+		std::mutex evictMutex;
 	};
-}
\ No newline at end of file
+}
@@ -24,6 +24,7 @@ namespace Rgph
 		for( auto& bind : binds )
 		{
 			bind->Bind( gfx );
+			gfx.CountBind( *bind );
 		}
 	}
 
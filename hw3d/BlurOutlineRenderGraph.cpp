@@ -235,7 +235,7 @@ namespace Rgph
 	void BlurOutlineRenderGraph::SetKernelGauss( int radius,float sigma ) noxnd
 	{
 		assert( radius <= maxRadius );
-		auto k = blurKernel->GetBuffer();
+		auto& k = blurKernel->EditBuffer();
 		const int nTaps = radius * 2 + 1;
 		k["nTaps"] = nTaps;
 		float sum = 0.0f;
@@ -250,13 +250,12 @@ namespace Rgph
 		{
 			k["coefficients"][i] = (float)k["coefficients"][i] / sum;
 		}
-		blurKernel->SetBuffer( k );
 	}
 	
 	void BlurOutlineRenderGraph::SetKernelBox( int radius ) noxnd
 	{
 		assert( radius <= maxRadius );
-		auto k = blurKernel->GetBuffer();
+		auto& k = blurKernel->EditBuffer();
 		const int nTaps = radius * 2 + 1;
 		k["nTaps"] = nTaps;
 		const float c = 1.0f / nTaps;
@@ -264,7 +263,6 @@ namespace Rgph
 		{
 			k["coefficients"][i] = c;
 		}
-		blurKernel->SetBuffer( k );
 	}
 	
 	void BlurOutlineRenderGraph::RenderWindows( Graphics& gfx )
@@ -165,6 +165,16 @@ void Camera::SetPos( const DirectX::XMFLOAT3& pos ) noexcept
 	proj.SetPos( pos );
 }
 
+float Camera::GetPitch() const noexcept
+{
+	return pitch;
+}
+
+float Camera::GetYaw() const noexcept
+{
+	return yaw;
+}
+
 const std::string& Camera::GetName() const noexcept
 {
 	return name;
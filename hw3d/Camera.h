@@ -28,6 +28,8 @@ public:
 	void Translate( DirectX::XMFLOAT3 translation ) noexcept;
 	DirectX::XMFLOAT3 GetPos() const noexcept;
 	void SetPos( const DirectX::XMFLOAT3& pos ) noexcept;
+	float GetPitch() const noexcept;
+	float GetYaw() const noexcept;
 	const std::string& GetName() const noexcept;
 	void LinkTechniques( Rgph::RenderGraph& rg );
 	void Submit( size_t channel ) const;
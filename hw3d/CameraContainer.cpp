@@ -35,8 +35,33 @@ void CameraContainer::SpawnWindow( Graphics& gfx )
 		}
 
 		GetControlledCamera().SpawnControlWidgets( gfx );
+
+		// every camera and light is keyed each frame while recording, for the flythrough benchmark
+		bool recording = recordingPath;
+		if( ImGui::Checkbox( "Record Path",&recording ) )
+		{
+			if( recording )
+			{
+				recordedPath = {};
+				pathTimer.Mark();
+			}
+			else
+			{
+				recordedPath.Save( "camera_path.json" );
+			}
+			recordingPath = recording;
+		}
+		if( recordingPath || !recordedPath.IsEmpty() )
+		{
+			ImGui::Text( "%s %.1f s, %d keys",recordingPath ? "Recording" : "Saved camera_path.json,",
+				recordedPath.GetDuration(),int( recordedPath.GetKeyCount() ) );
+		}
 	}
 	ImGui::End();
+	if( recordingPath )
+	{
+		RecordPathKeys();
+	}
 }
 
 void CameraContainer::Bind( Graphics& gfx )
@@ -86,6 +111,61 @@ Camera& CameraContainer::GetControlledCamera()
 	return *cameras[controlled];
 }
 
+bool CameraContainer::SetActiveCamera( const std::string& name ) noexcept
+{
+	for( int i = 0; i < std::size( cameras ); i++ )
+	{
+		if( cameras[i]->GetName() == name )
+		{
+			active = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+void CameraContainer::AddPathTrack( std::string name,std::function<CameraPath::Pose()> get,std::function<void( const CameraPath::Pose& )> set )
+{
+	pathTracks.push_back( { std::move( name ),std::move( get ),std::move( set ) } );
+}
+
+void CameraContainer::ApplyPath( const CameraPath& path,float time )
+{
+	for( auto& pCam : cameras )
+	{
+		if( const auto pose = path.Sample( pCam->GetName(),time ) )
+		{
+			pCam->SetPos( pose->pos );
+			pCam->SetRotation( pose->pitch,pose->yaw );
+		}
+	}
+	for( auto& t : pathTracks )
+	{
+		if( const auto pose = path.Sample( t.name,time ) )
+		{
+			t.set( *pose );
+		}
+	}
+}
+
+bool CameraContainer::IsRecordingPath() const noexcept
+{
+	return recordingPath;
+}
+
+void CameraContainer::RecordPathKeys()
+{
+	const auto time = pathTimer.Peek();
+	for( const auto& pCam : cameras )
+	{
+		recordedPath.AddKey( pCam->GetName(),time,{ pCam->GetPos(),pCam->GetPitch(),pCam->GetYaw() } );
+	}
+	for( const auto& t : pathTracks )
+	{
+		recordedPath.AddKey( t.name,time,t.get() );
+	}
+}
+
 void CameraContainer::DeleteCamera(std::shared_ptr<Camera> pCam)
 {
 	for (std::vector<std::shared_ptr<Camera>>::iterator itr = cameras.begin(); itr != cameras.end(); itr++)
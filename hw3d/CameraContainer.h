@@ -1,6 +1,10 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <string>
+#include <functional>
+#include "CameraPath.h"
+#include "ChiliTimer.h"
 
 class Camera;
 class Graphics;
@@ -21,11 +25,29 @@ public:
 	void Submit( size_t channels ) const;
 	Camera& GetActiveCamera();
 	void DeleteCamera(std::shared_ptr<Camera> pCam);
+	// false if no camera has the name
+	bool SetActiveCamera( const std::string& name ) noexcept;
+	// something besides the cameras (a light) that recorded paths also follow
+	void AddPathTrack( std::string name,std::function<CameraPath::Pose()> get,std::function<void( const CameraPath::Pose& )> set );
+	// moves every camera and extra track the path has a track for to its pose at time
+	void ApplyPath( const CameraPath& path,float time );
+	bool IsRecordingPath() const noexcept;
 private:
 	Camera& GetControlledCamera();
+	void RecordPathKeys();
 
 private:
+	struct PathTrack
+	{
+		std::string name;
+		std::function<CameraPath::Pose()> get;
+		std::function<void( const CameraPath::Pose& )> set;
+	};
 	std::vector<std::shared_ptr<Camera>> cameras;
 	int active = 0;
 	int controlled = 0;
+	std::vector<PathTrack> pathTracks;
+	bool recordingPath = false;
+	CameraPath recordedPath;
+	ChiliTimer pathTimer;
 };
\ No newline at end of file
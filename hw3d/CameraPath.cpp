@@ -0,0 +1,127 @@
+#include "CameraPath.h"
+#include "ChiliMath.h"
+#include "json.hpp"
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+
+namespace jso = nlohmann;
+
+void CameraPath::AddKey( const std::string& track,float time,const Pose& pose )
+{
+	auto& keys = tracks[track];
+	assert( keys.empty() || keys.back().time <= time );
+	keys.push_back( { time,pose } );
+}
+
+std::optional<CameraPath::Pose> CameraPath::Sample( const std::string& track,float time ) const noexcept
+{
+	const auto i = tracks.find( track );
+	if( i == tracks.end() || i->second.empty() )
+	{
+		return {};
+	}
+	const auto& keys = i->second;
+	const auto next = std::upper_bound( keys.begin(),keys.end(),time,[]( float t,const Key& k )
+	{
+		return t < k.time;
+	} );
+	if( next == keys.begin() )
+	{
+		return keys.front().pose;
+	}
+	if( next == keys.end() )
+	{
+		return keys.back().pose;
+	}
+	const auto& a = *(next - 1);
+	const auto& b = *next;
+	const float span = b.time - a.time;
+	const float f = span > 0.0f ? (time - a.time) / span : 1.0f;
+	const auto lerp = [f]( float x,float y )
+	{
+		return x + (y - x) * f;
+	};
+	const auto lerpAngle = [f]( float x,float y )
+	{
+		return wrap_angle( x + wrap_angle( y - x ) * f );
+	};
+	return Pose{
+		{ lerp( a.pose.pos.x,b.pose.pos.x ),lerp( a.pose.pos.y,b.pose.pos.y ),lerp( a.pose.pos.z,b.pose.pos.z ) },
+		lerpAngle( a.pose.pitch,b.pose.pitch ),
+		lerpAngle( a.pose.yaw,b.pose.yaw )
+	};
+}
+
+float CameraPath::GetDuration() const noexcept
+{
+	float duration = 0.0f;
+	for( const auto& [name,keys] : tracks )
+	{
+		if( !keys.empty() )
+		{
+			duration = std::max( duration,keys.back().time );
+		}
+	}
+	return duration;
+}
+
+size_t CameraPath::GetKeyCount() const noexcept
+{
+	size_t count = 0u;
+	for( const auto& [name,keys] : tracks )
+	{
+		count += keys.size();
+	}
+	return count;
+}
+
+bool CameraPath::IsEmpty() const noexcept
+{
+	return GetKeyCount() == 0u;
+}
+
+void CameraPath::Save( const std::string& path ) const
+{
+	// one [time, x, y, z, pitch, yaw] row per key
+	jso::json top;
+	auto& out = top["tracks"];
+	out = jso::json::object();
+	for( const auto& [name,keys] : tracks )
+	{
+		auto rows = jso::json::array();
+		for( const auto& k : keys )
+		{
+			rows.push_back( { k.time,k.pose.pos.x,k.pose.pos.y,k.pose.pos.z,k.pose.pitch,k.pose.yaw } );
+		}
+		out[name] = std::move( rows );
+	}
+	std::ofstream file( path );
+	file << top.dump( 1,'\t' );
+}
+
+CameraPath CameraPath::Load( const std::string& path )
+{
+	std::ifstream file( path );
+	if( !file.is_open() )
+	{
+		throw std::runtime_error{ "Unable to open camera path: " + path };
+	}
+	jso::json top;
+	file >> top;
+	CameraPath cameraPath;
+	for( const auto& [name,rows] : top.at( "tracks" ).items() )
+	{
+		for( const auto& r : rows )
+		{
+			const auto v = r.get<std::vector<float>>();
+			if( v.size() != 6u )
+			{
+				throw std::runtime_error{ "Bad key in camera path: " + path };
+			}
+			cameraPath.AddKey( name,v[0],{ { v[1],v[2],v[3] },v[4],v[5] } );
+		}
+	}
+	return cameraPath;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <DirectXMath.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+
+// a recorded flythrough: named tracks (cameras, lights) of poses over time, saved as json
+// sampled at any time, poses between keys are interpolated (angles the short way round)
+class CameraPath
+{
+public:
+	struct Pose
+	{
+		DirectX::XMFLOAT3 pos;
+		float pitch;
+		float yaw;
+	};
+	struct Key
+	{
+		float time;
+		Pose pose;
+	};
+public:
+	// keys of a track have to come in time order
+	void AddKey( const std::string& track,float time,const Pose& pose );
+	// clamped to the first / last key, empty for tracks the path doesn't have
+	std::optional<Pose> Sample( const std::string& track,float time ) const noexcept;
+	// time of the last key over all tracks
+	float GetDuration() const noexcept;
+	size_t GetKeyCount() const noexcept;
+	bool IsEmpty() const noexcept;
+	void Save( const std::string& path ) const;
+	static CameraPath Load( const std::string& path );
+private:
+	std::map<std::string,std::vector<Key>> tracks;
+};
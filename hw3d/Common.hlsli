@@ -21,23 +21,49 @@ static const float zn = 0.5f;
 static const float c1 = zf / (zf - zn);
 static const float c0 = -zn * zf / (zf - zn);
 
-float3 MapNormal(
+float3 UnpackTangentNormal(
     const in float3 tan,
     const in float3 binor,
     const in float3 normal,
-    const in float2 tc,
-    uniform Texture2D nmap,
-    uniform SamplerState splr)
+    const in float3 encoded)
 {
     // build the tranform (rotation) into same space as tan/binor/normal (target space)
 	const float3x3 tanToTarget = float3x3(tan, binor, normal);
-    // sample and unpack the normal from texture into target space   
-	const float3 normalSample = nmap.Sample(splr, tc).xyz;
-	const float3 tanNormal = normalSample * 2.0f - 1.0f;
+	// cooked normal maps are two channel (BC5), blue samples as 0 and z is rebuilt from the unit length
+	// other maps keep the z they were authored with: a tangent space normal never points below the surface
+	// (the preprocessor rejects those), so a z of ~0 or less only ever marks a two channel source (the streaming
+	// placeholder's grey included), and for a real normal lying in the surface the rebuilt z is ~0 as well
+	const float3 normalSample = encoded * 2.0f - 1.0f;
+	const float rebuiltZ = sqrt(saturate(1.0f - dot(normalSample.xy, normalSample.xy)));
+	const float3 tanNormal = float3(normalSample.xy, normalSample.z > 2.0f / 255.0f ? normalSample.z : rebuiltZ);
     // bring normal from tanspace into target space
 	return normalize(mul(tanNormal, tanToTarget));
 }
 
+float3 MapNormal(
+    const in float3 tan,
+    const in float3 binor,
+    const in float3 normal,
+    const in float2 tc,
+    uniform Texture2D nmap,
+    uniform SamplerState splr)
+{
+	return UnpackTangentNormal(tan, binor, normal, nmap.Sample(splr, tc).xyz);
+}
+
+// image at rect (uv offset xy, scale zw) of one slice of a texture array (see TextureAtlas)
+// the uv is wrapped by hand to stay inside the rect, gradients come from the unwrapped uv so the seam keeps its mip
+float4 SampleAtlas(
+    uniform Texture2DArray atlas,
+    uniform SamplerState splr,
+    const in float2 tc,
+    const in float4 rect,
+    const in float slice)
+{
+	const float2 uv = rect.xy + frac(tc) * rect.zw;
+	return atlas.SampleGrad(splr, float3(uv, slice), ddx(tc) * rect.zw, ddy(tc) * rect.zw);
+}
+
 float3 RGB2YCoCg(float3 RGB)
 {
 	float Y = dot(RGB, float3(1, 2, 1));
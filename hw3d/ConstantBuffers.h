@@ -21,6 +21,7 @@ namespace Bind
 			) );
 			memcpy( msr.pData,&consts,sizeof( consts ) );
 			GetContext( gfx )->Unmap( pConstantBuffer.Get(),0u );
+			gfx.CountConstantUpload( sizeof( consts ) );
 		}
 		ConstantBuffer( Graphics& gfx,const C& consts,UINT slot = 0u )
 			:
@@ -3,6 +3,7 @@
 #include "GraphicsThrowMacros.h"
 #include "DynamicConstant.h"
 #include "TechniqueProbe.h"
+#include <algorithm>
 
 namespace Bind
 {
@@ -10,18 +11,41 @@ namespace Bind
 	{
 	public:
 		void Update( Graphics& gfx,const Dcb::Buffer& buf )
+		{
+			Update( gfx,buf,{ 0u,buf.GetSizeInBytes() } );
+		}
+		// uploads the 16 byte rows (constants) overlapping range when the device takes partial constant
+		// buffer updates, otherwise the whole buffer is rewritten
+		void Update( Graphics& gfx,const Dcb::Buffer& buf,Dcb::Buffer::Range range )
 		{
 			assert( &buf.GetRootLayoutElement() == &GetRootLayoutElement() );
 			INFOMAN( gfx );
 
-			D3D11_MAPPED_SUBRESOURCE msr;
-			GFX_THROW_INFO( GetContext( gfx )->Map(
-				pConstantBuffer.Get(),0u,
-				D3D11_MAP_WRITE_DISCARD,0u,
-				&msr
-			) );
-			memcpy( msr.pData,buf.GetData(),buf.GetSizeInBytes() );
-			GetContext( gfx )->Unmap( pConstantBuffer.Get(),0u );
+			const auto size = buf.GetSizeInBytes();
+			if( partialUpdates )
+			{
+				const UINT begin = UINT( range.begin & ~size_t( 15u ) );
+				const UINT end = UINT( std::min( (range.end + 15u) & ~size_t( 15u ),size ) );
+				const D3D11_BOX box = { begin,0u,0u,end,1u,1u };
+				// a full rewrite lets the driver rename instead of versioning the old contents
+				const UINT flags = end - begin == size ? D3D11_COPY_DISCARD : 0u;
+				GFX_THROW_INFO_ONLY( GetContext1( gfx )->UpdateSubresource1(
+					pConstantBuffer.Get(),0u,&box,buf.GetData() + begin,0u,0u,flags
+				) );
+				gfx.CountConstantUpload( end - begin );
+			}
+			else
+			{
+				D3D11_MAPPED_SUBRESOURCE msr;
+				GFX_THROW_INFO( GetContext( gfx )->Map(
+					pConstantBuffer.Get(),0u,
+					D3D11_MAP_WRITE_DISCARD,0u,
+					&msr
+				) );
+				memcpy( msr.pData,buf.GetData(),size );
+				GetContext( gfx )->Unmap( pConstantBuffer.Get(),0u );
+				gfx.CountConstantUpload( size );
+			}
 		}
 		// this exists for validation of the update buffer layout
 		// reason why it's not getbuffer is becasue nocache doesn't store buffer
@@ -29,14 +53,16 @@ namespace Bind
 	protected:
 		ConstantBufferEx( Graphics& gfx,const Dcb::LayoutElement& layoutRoot,UINT slot,const Dcb::Buffer* pBuf )
 			:
-			slot( slot )
+			slot( slot ),
+			partialUpdates( GetContext1( gfx ) != nullptr && GetOptions( gfx ).ConstantBufferPartialUpdate )
 		{
 			INFOMAN( gfx );
 
 			D3D11_BUFFER_DESC cbd;
 			cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-			cbd.Usage = D3D11_USAGE_DYNAMIC;
-			cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			// partial updates go through UpdateSubresource1, which needs a default usage buffer
+			cbd.Usage = partialUpdates ? D3D11_USAGE_DEFAULT : D3D11_USAGE_DYNAMIC;
+			cbd.CPUAccessFlags = partialUpdates ? 0u : D3D11_CPU_ACCESS_WRITE;
 			cbd.MiscFlags = 0u;
 			cbd.ByteWidth = (UINT)layoutRoot.GetSizeInBytes();
 			cbd.StructureByteStride = 0u;
@@ -55,6 +81,7 @@ namespace Bind
 	protected:
 		Microsoft::WRL::ComPtr<ID3D11Buffer> pConstantBuffer;
 		UINT slot;
+		bool partialUpdates;
 	};
 
 	class VertexConstantBufferEx : public ConstantBufferEx
@@ -123,29 +150,35 @@ namespace Bind
 		{
 			return buf;
 		}
+		// edit in place: the buffer tracks what was written and the next Bind uploads just that
+		Dcb::Buffer& EditBuffer() noexcept
+		{
+			return buf;
+		}
 		void SetBuffer( const Dcb::Buffer& buf_in )
 		{
 			buf.CopyFrom( buf_in );
-			dirty = true;
 		}
 		void Bind( Graphics& gfx ) noxnd override
 		{
-			if( dirty )
+			if( buf.IsDirty() )
 			{
-				T::Update( gfx,buf );
-				dirty = false;
+				T::Update( gfx,buf,buf.GetDirtyRange() );
+				buf.ClearDirty();
 			}
 			T::Bind( gfx );
 		}
 		void Accept( TechniqueProbe& probe ) override
 		{
-			if( probe.VisitBuffer( buf ) )
+			// widgets take mutable pointers into the buffer, which counts as writing them;
+			// forget that when the probe changed nothing and no edit was pending anyway
+			const bool pending = buf.IsDirty();
+			if( !probe.VisitBuffer( buf ) && !pending )
 			{
-				dirty = true;
+				buf.ClearDirty();
 			}
 		}
 	private:
-		bool dirty = false;
 		Dcb::Buffer buf;
 	};
 
@@ -0,0 +1,88 @@
+#include "ConstantRing.h"
+#include <cassert>
+
+ConstantRing::ConstantRing( size_t pageSize,unsigned int framesInFlight ) noexcept
+	:
+	pageSize( pageSize ),
+	framesInFlight( framesInFlight )
+{
+	assert( pageSize % alignment == 0u && pageSize != 0u );
+}
+
+void ConstantRing::BeginFrame( std::uint64_t frame_in ) noexcept
+{
+	assert( frame_in >= frame );
+	frame = frame_in;
+}
+
+ConstantRing::Allocation ConstantRing::Allocate( size_t size )
+{
+	assert( size != 0u && size <= pageSize );
+	const auto aligned = (size + alignment - 1u) & ~(alignment - 1u);
+	if( order.empty() || pages[order[current]].head + aligned > pageSize )
+	{
+		Advance();
+	}
+	const auto index = order[current];
+	auto& page = pages[index];
+	const Allocation allocation = { index,page.head,aligned };
+	page.head += aligned;
+	page.lastFrame = frame;
+	stats.allocations++;
+	stats.requestedBytes += size;
+	stats.allocatedBytes += aligned;
+	return allocation;
+}
+
+size_t ConstantRing::GetPageSize() const noexcept
+{
+	return pageSize;
+}
+
+size_t ConstantRing::GetPageCount() const noexcept
+{
+	return pages.size();
+}
+
+std::uint64_t ConstantRing::GetFrame() const noexcept
+{
+	return frame;
+}
+
+ConstantRing::Stats ConstantRing::GetStats() const noexcept
+{
+	auto s = stats;
+	s.pages = pages.size();
+	return s;
+}
+
+bool ConstantRing::IsRetired( const Page& page ) const noexcept
+{
+	return page.lastFrame + framesInFlight < frame;
+}
+
+void ConstantRing::Advance()
+{
+	if( order.size() > 1u )
+	{
+		const auto next = (current + 1u) % order.size();
+		if( IsRetired( pages[order[next]] ) )
+		{
+			current = next;
+			pages[order[current]].head = 0u;
+			stats.recycles++;
+			return;
+		}
+	}
+	else if( order.size() == 1u && IsRetired( pages[order[current]] ) )
+	{
+		// a lone page that filled up across frames can wrap onto itself once they retire
+		pages[order[current]].head = 0u;
+		stats.recycles++;
+		return;
+	}
+	pages.emplace_back();
+	const auto position = order.empty() ? 0u : current + 1u;
+	order.insert( order.begin() + position,(unsigned int)(pages.size() - 1u) );
+	current = position;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// sub-allocates per-draw constant data from a ring of large pages, in 256 byte aligned chunks
+// (the granularity *SetConstantBuffers1 binds at)
+// nothing is reused while the gpu may still read it: every page remembers the last frame that allocated
+// from it and is only recycled once that frame is framesInFlight frames behind the one being recorded;
+// when the next page in the ring is still in flight a new page is inserted there instead
+// cpu bookkeeping only, the pages' gpu buffers belong to whoever owns the ring (see ConstantRingBuffer)
+class ConstantRing
+{
+public:
+	static constexpr size_t alignment = 256u;
+	struct Allocation
+	{
+		// index of the page, stable for the ring's lifetime
+		unsigned int page;
+		size_t offset;
+		// aligned size
+		size_t size;
+	};
+	struct Stats
+	{
+		size_t allocations = 0;
+		size_t requestedBytes = 0;
+		size_t allocatedBytes = 0;
+		// pages taken over again after their frames retired
+		size_t recycles = 0;
+		size_t pages = 0;
+	};
+public:
+	ConstantRing( size_t pageSize,unsigned int framesInFlight ) noexcept;
+	// frames must be increasing; pages last used by frame - framesInFlight - 1 or earlier become reusable
+	void BeginFrame( std::uint64_t frame ) noexcept;
+	// size must not exceed the page size
+	Allocation Allocate( size_t size );
+	size_t GetPageSize() const noexcept;
+	size_t GetPageCount() const noexcept;
+	std::uint64_t GetFrame() const noexcept;
+	Stats GetStats() const noexcept;
+private:
+	struct Page
+	{
+		size_t head = 0u;
+		std::uint64_t lastFrame = 0u;
+	};
+	bool IsRetired( const Page& page ) const noexcept;
+	// moves on to the next reusable page in ring order, or inserts a fresh one
+	void Advance();
+private:
+	size_t pageSize;
+	unsigned int framesInFlight;
+	std::uint64_t frame = 0u;
+	std::vector<Page> pages;
+	// ring order of page indices, and the position of the page being filled
+	std::vector<unsigned int> order;
+	size_t current = 0u;
+	Stats stats;
+};
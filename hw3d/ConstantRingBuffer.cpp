@@ -0,0 +1,121 @@
+#include "ConstantRingBuffer.h"
+#include "GraphicsThrowMacros.h"
+#include <cstring>
+#include <thread>
+
+namespace Bind
+{
+	ConstantRingBuffer* ConstantRingBuffer::Get( Graphics& gfx ) noexcept
+	{
+		return gfx.GetConstantRing();
+	}
+
+	ConstantRingBuffer::ConstantRingBuffer( Graphics& gfx )
+		:
+		ring( pageSize,framesInFlight )
+	{
+		INFOMAN( gfx );
+		D3D11_QUERY_DESC qd = {};
+		qd.Query = D3D11_QUERY_EVENT;
+		for( auto& pFence : fences )
+		{
+			GFX_THROW_INFO( GetDevice( gfx )->CreateQuery( &qd,&pFence ) );
+		}
+	}
+
+	void ConstantRingBuffer::EndFrame( Graphics& gfx ) noxnd
+	{
+		const auto frame = gfx.GetFrameIndex();
+		const auto slot = size_t( frame % fenceCount );
+		GetContext( gfx )->End( fences[slot].Get() );
+		fenceFrames[slot] = frame + 1u;
+	}
+
+	void ConstantRingBuffer::WaitForFrame( Graphics& gfx,std::uint64_t frame ) noxnd
+	{
+		const auto slot = size_t( frame % fenceCount );
+		if( fenceFrames[slot] != frame + 1u )
+		{
+			return;
+		}
+		INFOMAN( gfx );
+		BOOL done = FALSE;
+		while( true )
+		{
+			GFX_THROW_INFO( GetContext( gfx )->GetData( fences[slot].Get(),&done,sizeof( done ),0u ) );
+			if( hr == S_OK && done )
+			{
+				break;
+			}
+			std::this_thread::yield();
+		}
+		fenceFrames[slot] = 0u;
+	}
+
+	ConstantRingBuffer::Range ConstantRingBuffer::Write( Graphics& gfx,const void* pData,size_t size ) noxnd
+	{
+		INFOMAN( gfx );
+		assert( size <= D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16u );
+		if( gfx.GetFrameIndex() != ring.GetFrame() )
+		{
+			// pages last written in frame - framesInFlight - 1 become reusable, make sure the gpu is really done with them
+			if( gfx.GetFrameIndex() > framesInFlight )
+			{
+				WaitForFrame( gfx,gfx.GetFrameIndex() - framesInFlight - 1u );
+			}
+			ring.BeginFrame( gfx.GetFrameIndex() );
+		}
+		const auto allocation = ring.Allocate( size );
+		// a page that was never mapped has to be discarded once before no-overwrite maps are allowed on it
+		auto mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+		if( allocation.page == pages.size() )
+		{
+			D3D11_BUFFER_DESC cbd = {};
+			cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+			cbd.Usage = D3D11_USAGE_DYNAMIC;
+			cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			cbd.MiscFlags = 0u;
+			cbd.ByteWidth = (UINT)pageSize;
+			cbd.StructureByteStride = 0u;
+			pages.emplace_back();
+			GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &cbd,nullptr,&pages.back() ) );
+			mapType = D3D11_MAP_WRITE_DISCARD;
+		}
+		auto pBuffer = pages[allocation.page].Get();
+		D3D11_MAPPED_SUBRESOURCE msr;
+		GFX_THROW_INFO( GetContext( gfx )->Map( pBuffer,0u,mapType,0u,&msr ) );
+		std::memcpy( static_cast<char*>(msr.pData) + allocation.offset,pData,size );
+		GetContext( gfx )->Unmap( pBuffer,0u );
+		gfx.CountConstantUpload( size );
+		return { pBuffer,UINT( allocation.offset / 16u ),UINT( allocation.size / 16u ) };
+	}
+
+	void ConstantRingBuffer::BindVS( Graphics& gfx,UINT slot,const Range& range ) noxnd
+	{
+		INFOMAN_NOHR( gfx );
+		GFX_THROW_INFO_ONLY( GetContext1( gfx )->VSSetConstantBuffers1( slot,1u,&range.pBuffer,&range.firstConstant,&range.numConstants ) );
+	}
+
+	void ConstantRingBuffer::BindHS( Graphics& gfx,UINT slot,const Range& range ) noxnd
+	{
+		INFOMAN_NOHR( gfx );
+		GFX_THROW_INFO_ONLY( GetContext1( gfx )->HSSetConstantBuffers1( slot,1u,&range.pBuffer,&range.firstConstant,&range.numConstants ) );
+	}
+
+	void ConstantRingBuffer::BindDS( Graphics& gfx,UINT slot,const Range& range ) noxnd
+	{
+		INFOMAN_NOHR( gfx );
+		GFX_THROW_INFO_ONLY( GetContext1( gfx )->DSSetConstantBuffers1( slot,1u,&range.pBuffer,&range.firstConstant,&range.numConstants ) );
+	}
+
+	void ConstantRingBuffer::BindPS( Graphics& gfx,UINT slot,const Range& range ) noxnd
+	{
+		INFOMAN_NOHR( gfx );
+		GFX_THROW_INFO_ONLY( GetContext1( gfx )->PSSetConstantBuffers1( slot,1u,&range.pBuffer,&range.firstConstant,&range.numConstants ) );
+	}
+
+	ConstantRing::Stats ConstantRingBuffer::GetStats() const noexcept
+	{
+		return ring.GetStats();
+	}
+}
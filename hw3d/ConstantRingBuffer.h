@@ -0,0 +1,56 @@
+#pragma once
+#include "GraphicsResource.h"
+#include "ConstantRing.h"
+#include <vector>
+#include <array>
+#include <cstdint>
+
+namespace Bind
+{
+	// gpu side of a ConstantRing: one large dynamic constant buffer per page, written with no-overwrite maps
+	// and bound by offset through *SetConstantBuffers1, so per-draw constants share a few buffers instead of
+	// each small buffer being renamed by its own Map( DISCARD )
+	// needs d3d11.1 (constant buffer offsetting and no-overwrite maps on dynamic constant buffers), without
+	// it Get() returns null and callers keep using their own buffers
+	// owned by Graphics, one per device; an event query ends every frame and a frame's pages are only
+	// recycled once the gpu has passed its query, so the ring never relies on dxgi's frame latency alone
+	class ConstantRingBuffer : public GraphicsResource
+	{
+	public:
+		// what *SetConstantBuffers1 takes, in 16 byte constants; only valid during the frame it was written in
+		struct Range
+		{
+			ID3D11Buffer* pBuffer = nullptr;
+			UINT firstConstant = 0u;
+			UINT numConstants = 0u;
+		};
+	public:
+		// the ring of gfx's device (Graphics::GetConstantRing), null when it can't bind constant buffers by offset
+		static ConstantRingBuffer* Get( Graphics& gfx ) noexcept;
+		ConstantRingBuffer( Graphics& gfx );
+		// copies the constants into the ring (at most 64KB, one cbuffer binding)
+		Range Write( Graphics& gfx,const void* pData,size_t size ) noxnd;
+		// marks the end of the frame's gpu work, Graphics calls this before presenting moves on
+		void EndFrame( Graphics& gfx ) noxnd;
+		static void BindVS( Graphics& gfx,UINT slot,const Range& range ) noxnd;
+		static void BindHS( Graphics& gfx,UINT slot,const Range& range ) noxnd;
+		static void BindDS( Graphics& gfx,UINT slot,const Range& range ) noxnd;
+		static void BindPS( Graphics& gfx,UINT slot,const Range& range ) noxnd;
+		ConstantRing::Stats GetStats() const noexcept;
+	public:
+		static constexpr size_t pageSize = 1u << 20u;
+		// dxgi's default maximum frame latency, the cpu never gets further ahead of the gpu than that
+		static constexpr unsigned int framesInFlight = 3u;
+	private:
+		// blocks until the gpu has finished frame (if it ended with a query that is still pending)
+		void WaitForFrame( Graphics& gfx,std::uint64_t frame ) noxnd;
+	private:
+		// frame n's query sits in slot n % fenceCount, which comes round again only after that frame has been waited on
+		static constexpr unsigned int fenceCount = framesInFlight + 1u;
+		ConstantRing ring;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> pages;
+		std::array<Microsoft::WRL::ComPtr<ID3D11Query>,fenceCount> fences;
+		// frame + 1 that each fence was ended for, 0 for none
+		std::array<std::uint64_t,fenceCount> fenceFrames = {};
+	};
+}
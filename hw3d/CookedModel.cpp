@@ -0,0 +1,594 @@
+#include "CookedModel.h"
+#include "ChiliWin.h"
+#include <assimp/scene.h>
+#include <assimp/material.h>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cassert>
+#include <type_traits>
+#include "ModelException.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexConverter.h"
+#include "Trace.h"
+
+namespace
+{
+	// bump whenever the layout of the blob or the processing that feeds it changes
+	constexpr std::uint32_t cookVersion = 3u;
+	constexpr std::uint32_t cookMagic = 'C' | ('M' << 8) | ('D' << 16) | ('L' << 24);
+
+	// marked two-sided, or cut out through an opacity map (obj map_d, sponza's foliage and chains)
+	bool IsTwoSided( const aiMaterial& material ) noexcept
+	{
+		int twoSided = 0;
+		material.Get( AI_MATKEY_TWOSIDED,twoSided );
+		return twoSided != 0 || material.GetTextureCount( aiTextureType_OPACITY ) > 0;
+	}
+
+	class Fnv1a
+	{
+	public:
+		void Add( const void* pBytes,size_t size ) noexcept
+		{
+			const auto p = static_cast<const unsigned char*>(pBytes);
+			for( size_t i = 0; i < size; i++ )
+			{
+				hash = (hash ^ p[i]) * 1099511628211ull;
+			}
+		}
+		template<typename T>
+		void Add( const T& value ) noexcept
+		{
+			static_assert( std::is_arithmetic<T>::value,"hash fields one at a time, padding is not stable" );
+			Add( &value,sizeof( value ) );
+		}
+		std::uint64_t Get() const noexcept
+		{
+			return hash;
+		}
+	private:
+		std::uint64_t hash = 14695981039346656037ull;
+	};
+
+	// false when the file can't be opened
+	bool AddFile( Fnv1a& hash,const std::string& path )
+	{
+		std::ifstream file( path,std::ios::binary );
+		if( !file )
+		{
+			return false;
+		}
+		std::vector<char> chunk( 1 << 16 );
+		while( file.read( chunk.data(),chunk.size() ) || file.gcount() > 0 )
+		{
+			hash.Add( chunk.data(),size_t( file.gcount() ) );
+		}
+		return true;
+	}
+
+	// the .mtl files an .obj pulls in, resolved like assimp does: the rest of the mtllib line,
+	// relative to the .obj
+	std::vector<std::string> GetMaterialLibraries( const std::string& objPath )
+	{
+		std::vector<std::string> libraries;
+		const auto dir = std::filesystem::path( objPath ).parent_path();
+		std::ifstream file( objPath );
+		std::string line;
+		while( std::getline( file,line ) )
+		{
+			const auto start = line.find_first_not_of( " \t" );
+			if( start == std::string::npos || line.compare( start,6,"mtllib" ) != 0 ||
+				line.size() <= start + 6 || !std::isspace( (unsigned char)line[start + 6] ) )
+			{
+				continue;
+			}
+			const auto first = line.find_first_not_of( " \t",start + 6 );
+			const auto last = line.find_last_not_of( " \t\r" );
+			if( first != std::string::npos && last >= first )
+			{
+				libraries.push_back( (dir / line.substr( first,last - first + 1 )).string() );
+			}
+		}
+		return libraries;
+	}
+
+	// everything is 4-byte aligned so indices, floats and clusters can be read in place
+	class Writer
+	{
+	public:
+		Writer( std::vector<char>& out ) noexcept
+			:
+			out( out )
+		{}
+		template<typename T>
+		void Pod( const T& value )
+		{
+			Bytes( &value,sizeof( value ) );
+		}
+		void Bytes( const void* pBytes,size_t size )
+		{
+			const auto p = static_cast<const char*>(pBytes);
+			out.insert( out.end(),p,p + size );
+			out.resize( (out.size() + 3) & ~size_t( 3 ),0 );
+		}
+		void String( const std::string& s )
+		{
+			Pod( (std::uint32_t)s.size() );
+			Bytes( s.data(),s.size() );
+		}
+		void Indices( const std::vector<unsigned int>& indices )
+		{
+			const bool wide = !indices.empty() && *std::max_element( indices.begin(),indices.end() ) > 0xFFFF;
+			Pod( (std::uint32_t)( wide ? 1u : 0u ) );
+			Pod( (std::uint32_t)indices.size() );
+			if( wide )
+			{
+				Bytes( indices.data(),indices.size() * sizeof( unsigned int ) );
+			}
+			else
+			{
+				const std::vector<unsigned short> narrow( indices.begin(),indices.end() );
+				Bytes( narrow.data(),narrow.size() * sizeof( unsigned short ) );
+			}
+		}
+	private:
+		std::vector<char>& out;
+	};
+
+	class Reader
+	{
+	public:
+		Reader( const char* pData,size_t size ) noexcept
+			:
+			p( pData ),
+			end( pData + size )
+		{}
+		template<typename T>
+		T Pod()
+		{
+			T value;
+			std::memcpy( &value,Bytes( sizeof( T ) ),sizeof( T ) );
+			return value;
+		}
+		const char* Bytes( size_t size )
+		{
+			const auto padded = (size + 3) & ~size_t( 3 );
+			if( size_t( end - p ) < padded )
+			{
+				throw ModelException( __LINE__,__FILE__,"Cooked model is truncated" );
+			}
+			const auto pBytes = p;
+			p += padded;
+			return pBytes;
+		}
+		std::string String()
+		{
+			const auto length = Pod<std::uint32_t>();
+			return { Bytes( length ),length };
+		}
+		CookedModel::Indices Indices()
+		{
+			CookedModel::Indices indices;
+			indices.wide = Pod<std::uint32_t>() != 0;
+			indices.count = Pod<std::uint32_t>();
+			indices.pData = Bytes( size_t( indices.count ) * (indices.wide ? sizeof( unsigned int ) : sizeof( unsigned short )) );
+			return indices;
+		}
+	private:
+		const char* p;
+		const char* end;
+	};
+
+	void WriteNode( Writer& w,const aiNode& node )
+	{
+		w.String( node.mName.C_Str() );
+		w.Pod( node.mTransformation );
+		w.Pod( node.mNumMeshes );
+		w.Bytes( node.mMeshes,node.mNumMeshes * sizeof( unsigned int ) );
+		w.Pod( node.mNumChildren );
+		for( unsigned int i = 0; i < node.mNumChildren; i++ )
+		{
+			WriteNode( w,*node.mChildren[i] );
+		}
+	}
+
+	CookedModel::NodeView ReadNode( Reader& r,size_t meshCount )
+	{
+		CookedModel::NodeView node;
+		node.name = r.String();
+		std::memcpy( node.transform,r.Bytes( sizeof( node.transform ) ),sizeof( node.transform ) );
+		const auto nMeshes = r.Pod<std::uint32_t>();
+		const auto pMeshes = r.Bytes( nMeshes * sizeof( unsigned int ) );
+		node.meshes.resize( nMeshes );
+		std::memcpy( node.meshes.data(),pMeshes,nMeshes * sizeof( unsigned int ) );
+		if( std::any_of( node.meshes.begin(),node.meshes.end(),[=]( unsigned int m ) { return m >= meshCount; } ) )
+		{
+			throw ModelException( __LINE__,__FILE__,"Cooked model node references a missing mesh" );
+		}
+		const auto nChildren = r.Pod<std::uint32_t>();
+		node.children.reserve( nChildren );
+		for( std::uint32_t i = 0; i < nChildren; i++ )
+		{
+			node.children.push_back( ReadNode( r,meshCount ) );
+		}
+		return node;
+	}
+}
+
+// read-only view of a whole file, unmapped on destruction
+class CookedModel::MappedFile
+{
+public:
+	MappedFile( const std::string& path ) noexcept
+	{
+		hFile = CreateFileA( path.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,nullptr );
+		if( hFile == INVALID_HANDLE_VALUE )
+		{
+			return;
+		}
+		LARGE_INTEGER fileSize;
+		if( !GetFileSizeEx( hFile,&fileSize ) || fileSize.QuadPart == 0 )
+		{
+			return;
+		}
+		hMapping = CreateFileMappingA( hFile,nullptr,PAGE_READONLY,0,0,nullptr );
+		if( hMapping == nullptr )
+		{
+			return;
+		}
+		pView = MapViewOfFile( hMapping,FILE_MAP_READ,0,0,0 );
+		if( pView != nullptr )
+		{
+			size = size_t( fileSize.QuadPart );
+		}
+	}
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+	~MappedFile()
+	{
+		if( pView != nullptr )
+		{
+			UnmapViewOfFile( pView );
+		}
+		if( hMapping != nullptr )
+		{
+			CloseHandle( hMapping );
+		}
+		if( hFile != INVALID_HANDLE_VALUE )
+		{
+			CloseHandle( hFile );
+		}
+	}
+	const char* GetData() const noexcept
+	{
+		return static_cast<const char*>(pView);
+	}
+	size_t GetSize() const noexcept
+	{
+		return size;
+	}
+private:
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+	HANDLE hMapping = nullptr;
+	void* pView = nullptr;
+	size_t size = 0u;
+};
+
+CookedModel::CookedModel() noexcept = default;
+
+CookedModel::~CookedModel() = default;
+
+std::uint64_t CookedModel::MakeKey( const std::string& sourcePath,unsigned int importFlags,float scale,bool isPBR,const ModelOptions& options )
+{
+	Fnv1a hash;
+	if( !AddFile( hash,sourcePath ) )
+	{
+		throw ModelException( __LINE__,__FILE__,"Unable to open model source: " + sourcePath );
+	}
+	// the materials come from the .mtl, editing it has to re-cook just like editing the .obj
+	auto extension = std::filesystem::path( sourcePath ).extension().string();
+	std::transform( extension.begin(),extension.end(),extension.begin(),[]( unsigned char c ) { return (char)std::tolower( c ); } );
+	if( extension == ".obj" )
+	{
+		for( const auto& library : GetMaterialLibraries( sourcePath ) )
+		{
+			// a missing library imports with default materials, so its absence is part of the key too
+			hash.Add( AddFile( hash,library ) );
+		}
+	}
+	hash.Add( MakeSettingsKey( importFlags,scale,isPBR,options ) );
+	return hash.Get();
+}
+
+std::uint64_t CookedModel::MakeSettingsKey( unsigned int importFlags,float scale,bool isPBR,const ModelOptions& options ) noexcept
+{
+	Fnv1a hash;
+	hash.Add( cookVersion );
+	hash.Add( importFlags );
+	hash.Add( scale );
+	hash.Add( isPBR );
+	hash.Add( options.lodCount );
+	hash.Add( options.lodReduction );
+	hash.Add( options.lodMaxError );
+	hash.Add( options.lodScreenSize );
+	hash.Add( options.clusters );
+	hash.Add( options.clusterMaxVertices );
+	hash.Add( options.clusterMaxTriangles );
+	hash.Add( options.optimizeMeshes );
+	hash.Add( options.overdrawThreshold );
+	hash.Add( options.quantizeVertices );
+	hash.Add( options.quantizePositions );
+	return hash.Get();
+}
+
+std::string CookedModel::MakeCachePath( const std::string& sourcePath )
+{
+	return sourcePath + ".cooked";
+}
+
+std::unique_ptr<CookedModel> CookedModel::Load( const std::string& cachePath,std::uint64_t key )
+{
+	TRACE_ZONE( "CookedModel::Load" );
+	std::unique_ptr<CookedModel> pCooked{ new CookedModel };
+	pCooked->pMapping = std::make_unique<MappedFile>( cachePath );
+	pCooked->pData = pCooked->pMapping->GetData();
+	pCooked->size = pCooked->pMapping->GetSize();
+	if( pCooked->pData == nullptr )
+	{
+		return nullptr;
+	}
+	try
+	{
+		pCooked->Parse( key );
+	}
+	catch( const ModelException& )
+	{
+		// stale or damaged, the caller re-imports and overwrites it
+		return nullptr;
+	}
+	return pCooked;
+}
+
+std::unique_ptr<CookedModel> CookedModel::Cook( const aiScene& scene,const std::vector<Dvtx::VertexLayout>& layouts,
+	float scale,const ModelOptions& options,std::uint64_t key )
+{
+	assert( layouts.size() == scene.mNumMaterials );
+	TRACE_ZONE( "CookedModel::Cook" );
+	std::unique_ptr<CookedModel> pCooked{ new CookedModel };
+	auto& blob = pCooked->blob;
+	Writer w{ blob };
+	w.Pod( cookMagic );
+	w.Pod( cookVersion );
+	w.Pod( key );
+	// total size, patched at the end
+	w.Pod( std::uint64_t( 0 ) );
+
+	w.Pod( scene.mNumMaterials );
+	for( unsigned int i = 0; i < scene.mNumMaterials; i++ )
+	{
+		const auto& material = *scene.mMaterials[i];
+		w.Pod( material.mNumProperties );
+		for( unsigned int p = 0; p < material.mNumProperties; p++ )
+		{
+			const auto& prop = *material.mProperties[p];
+			w.String( prop.mKey.C_Str() );
+			w.Pod( prop.mSemantic );
+			w.Pod( prop.mIndex );
+			w.Pod( (std::uint32_t)prop.mType );
+			w.Pod( prop.mDataLength );
+			w.Bytes( prop.mData,prop.mDataLength );
+		}
+	}
+
+	w.Pod( scene.mNumMeshes );
+	for( unsigned int m = 0; m < scene.mNumMeshes; m++ )
+	{
+		auto& mesh = *scene.mMeshes[m];
+		if( options.optimizeMeshes )
+		{
+			MeshOptimizer::Optimize( mesh,options.overdrawThreshold );
+		}
+		const auto& layout = layouts.at( mesh.mMaterialIndex );
+		w.String( mesh.mName.C_Str() );
+		w.Pod( mesh.mMaterialIndex );
+		w.Pod( (std::uint32_t)IsTwoSided( *scene.mMaterials[mesh.mMaterialIndex] ) );
+		w.String( layout.GetCode() );
+
+		// vertices exactly as the vertex buffer wants them, scaled on the way
+		// (quantized positions keep the scale in their dequantization instead)
+		VertexConverter::Options conversion;
+		conversion.scale = scale;
+		const auto converted = VertexConverter::Convert( layout,mesh,conversion );
+		const auto& vertices = converted.vertices;
+		const auto& quantization = converted.positionQuantization;
+		w.Pod( mesh.mNumVertices );
+		w.Pod( (std::uint64_t)vertices.SizeBytes() );
+		w.Bytes( vertices.GetData(),vertices.SizeBytes() );
+
+		std::vector<unsigned int> indices;
+		indices.reserve( size_t( mesh.mNumFaces ) * 3 );
+		for( unsigned int i = 0; i < mesh.mNumFaces; i++ )
+		{
+			const auto& face = mesh.mFaces[i];
+			assert( face.mNumIndices == 3 );
+			indices.insert( indices.end(),face.mIndices,face.mIndices + 3 );
+		}
+
+		// lods are simplified from the full-detail order, before clustering reorders it
+		std::vector<MeshSimplifier::Result> chain;
+		if( options.lodCount > 1 )
+		{
+			chain = MeshSimplifier::BuildLodChain( &mesh.mVertices[0].x,mesh.mNumVertices,sizeof( aiVector3D ),indices,
+				options.lodCount,options.lodReduction,options.lodMaxError
+			);
+		}
+		std::vector<float> positions;
+		positions.reserve( size_t( mesh.mNumVertices ) * 3 );
+		for( unsigned int i = 0; i < mesh.mNumVertices; i++ )
+		{
+			positions.push_back( mesh.mVertices[i].x * scale );
+			positions.push_back( mesh.mVertices[i].y * scale );
+			positions.push_back( mesh.mVertices[i].z * scale );
+		}
+		MeshClusters clusters;
+		if( options.clusters )
+		{
+			// culled against the scaled vertices that end up in the vertex buffer
+			clusters = MeshClusters::Build( positions.data(),mesh.mNumVertices,sizeof( float ) * 3,indices,
+				options.clusterMaxVertices,options.clusterMaxTriangles
+			);
+		}
+		w.Indices( indices );
+
+		DirectX::BoundingBox bounds;
+		DirectX::BoundingBox::CreateFromPoints( bounds,mesh.mNumVertices,
+			reinterpret_cast<const DirectX::XMFLOAT3*>(positions.data()),sizeof( float ) * 3
+		);
+		w.Pod( bounds.Center );
+		w.Pod( bounds.Extents );
+		w.Pod( (std::uint32_t)quantization.has_value() );
+		w.Pod( quantization.value_or( Dvtx::PositionQuantization{} ) );
+
+		w.Pod( (std::uint32_t)chain.size() );
+		float screenSize = options.lodScreenSize;
+		for( const auto& level : chain )
+		{
+			w.Pod( screenSize );
+			w.Indices( level.indices );
+			screenSize *= 0.5f;
+		}
+		const auto& clusterList = clusters.GetClusters();
+		w.Pod( (std::uint32_t)clusterList.size() );
+		w.Bytes( clusterList.data(),clusterList.size() * sizeof( MeshClusters::Cluster ) );
+	}
+
+	WriteNode( w,*scene.mRootNode );
+
+	const std::uint64_t total = blob.size();
+	std::memcpy( blob.data() + sizeof( std::uint32_t ) * 2 + sizeof( std::uint64_t ),&total,sizeof( total ) );
+	pCooked->pData = blob.data();
+	pCooked->size = blob.size();
+	pCooked->Parse( key );
+	return pCooked;
+}
+
+void CookedModel::Parse( std::uint64_t key )
+{
+	Reader r{ pData,size };
+	if( r.Pod<std::uint32_t>() != cookMagic || r.Pod<std::uint32_t>() != cookVersion || r.Pod<std::uint64_t>() != key )
+	{
+		throw ModelException( __LINE__,__FILE__,"Cooked model is stale" );
+	}
+	if( r.Pod<std::uint64_t>() != size )
+	{
+		throw ModelException( __LINE__,__FILE__,"Cooked model size mismatch" );
+	}
+
+	const auto nMaterials = r.Pod<std::uint32_t>();
+	for( std::uint32_t i = 0; i < nMaterials; i++ )
+	{
+		auto pMaterial = std::make_unique<aiMaterial>();
+		const auto nProperties = r.Pod<std::uint32_t>();
+		for( std::uint32_t p = 0; p < nProperties; p++ )
+		{
+			const auto propKey = r.String();
+			const auto semantic = r.Pod<std::uint32_t>();
+			const auto index = r.Pod<std::uint32_t>();
+			const auto type = r.Pod<std::uint32_t>();
+			const auto length = r.Pod<std::uint32_t>();
+			pMaterial->AddBinaryProperty( r.Bytes( length ),length,propKey.c_str(),semantic,index,aiPropertyTypeInfo( type ) );
+		}
+		materials.push_back( std::move( pMaterial ) );
+	}
+
+	const auto nMeshes = r.Pod<std::uint32_t>();
+	meshes.reserve( nMeshes );
+	for( std::uint32_t m = 0; m < nMeshes; m++ )
+	{
+		MeshView mesh;
+		mesh.name = r.String();
+		mesh.materialIndex = r.Pod<std::uint32_t>();
+		if( mesh.materialIndex >= materials.size() )
+		{
+			throw ModelException( __LINE__,__FILE__,"Cooked model mesh references a missing material" );
+		}
+		mesh.twoSided = r.Pod<std::uint32_t>() != 0u;
+		mesh.layoutCode = r.String();
+		mesh.vertexCount = r.Pod<std::uint32_t>();
+		mesh.vertexBytes = size_t( r.Pod<std::uint64_t>() );
+		mesh.pVertices = r.Bytes( mesh.vertexBytes );
+		mesh.indices = r.Indices();
+		mesh.bounds.Center = r.Pod<DirectX::XMFLOAT3>();
+		mesh.bounds.Extents = r.Pod<DirectX::XMFLOAT3>();
+		const auto quantized = r.Pod<std::uint32_t>();
+		const auto quantization = r.Pod<Dvtx::PositionQuantization>();
+		if( quantized )
+		{
+			mesh.positionQuantization = quantization;
+		}
+		const auto nLods = r.Pod<std::uint32_t>();
+		for( std::uint32_t l = 0; l < nLods; l++ )
+		{
+			Lod lod;
+			lod.screenSize = r.Pod<float>();
+			lod.indices = r.Indices();
+			mesh.lods.push_back( lod );
+		}
+		const auto nClusters = r.Pod<std::uint32_t>();
+		const auto pClusters = r.Bytes( nClusters * sizeof( MeshClusters::Cluster ) );
+		mesh.clusters.resize( nClusters );
+		std::memcpy( mesh.clusters.data(),pClusters,nClusters * sizeof( MeshClusters::Cluster ) );
+		meshes.push_back( std::move( mesh ) );
+	}
+
+	root = ReadNode( r,meshes.size() );
+}
+
+void CookedModel::Save( const std::string& cachePath ) const
+{
+	const auto tempPath = cachePath + ".tmp";
+	{
+		std::ofstream file( tempPath,std::ios::binary | std::ios::trunc );
+		file.write( pData,std::streamsize( size ) );
+		if( !file )
+		{
+			throw ModelException( __LINE__,__FILE__,"Unable to write cooked model: " + tempPath );
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename( tempPath,cachePath,ec );
+	if( ec )
+	{
+		std::filesystem::remove( tempPath,ec );
+		throw ModelException( __LINE__,__FILE__,"Unable to replace cooked model: " + cachePath );
+	}
+}
+
+size_t CookedModel::GetMaterialCount() const noexcept
+{
+	return materials.size();
+}
+
+const aiMaterial& CookedModel::GetMaterial( size_t i ) const noexcept
+{
+	return *materials[i];
+}
+
+const std::vector<CookedModel::MeshView>& CookedModel::GetMeshes() const noexcept
+{
+	return meshes;
+}
+
+const CookedModel::NodeView& CookedModel::GetRoot() const noexcept
+{
+	return root;
+}
+
+size_t CookedModel::GetSizeBytes() const noexcept
+{
+	return size;
+}
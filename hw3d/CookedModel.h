@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <optional>
+#include <DirectXCollision.h>
+#include "Vertex.h"
+#include "MeshClusters.h"
+#include "ModelOptions.h"
+
+struct aiScene;
+struct aiMaterial;
+
+// a model after all import-time processing, in the exact form the gpu buffers are created from:
+// per-mesh interleaved vertices in the material's layout, indices (16 or 32-bit), lods, clusters,
+// bounds, the node hierarchy and the raw material properties
+// everything lives in one flat blob that is written next to the source after an import and
+// memory-mapped on later loads, so a cached load skips assimp and does no per-vertex work
+class CookedModel
+{
+public:
+	struct Indices
+	{
+		const void* pData = nullptr;
+		unsigned int count = 0u;
+		// 32-bit, otherwise 16-bit
+		bool wide = false;
+	};
+	struct Lod
+	{
+		Indices indices;
+		float screenSize;
+	};
+	struct MeshView
+	{
+		std::string name;
+		unsigned int materialIndex;
+		// the material shows back faces, so clusters must not be backface (cone) culled
+		bool twoSided = false;
+		// Dvtx::VertexLayout::GetCode() the vertices were written with
+		std::string layoutCode;
+		const char* pVertices;
+		size_t vertexBytes;
+		unsigned int vertexCount;
+		// full-detail level, in cluster order when there are clusters
+		Indices indices;
+		// object space, scaled
+		DirectX::BoundingBox bounds;
+		std::vector<Lod> lods;
+		std::vector<MeshClusters::Cluster> clusters;
+		// set when the vertices hold QuantizedPosition3D, maps them back to (scaled) object space
+		std::optional<Dvtx::PositionQuantization> positionQuantization;
+	};
+	struct NodeView
+	{
+		std::string name;
+		// aiNode::mTransformation as stored by assimp (row-major, column vectors)
+		float transform[16];
+		std::vector<unsigned int> meshes;
+		std::vector<NodeView> children;
+	};
+public:
+	// hash of the source file contents (and of the .mtl files of an .obj) and everything that changes the cooked result
+	static std::uint64_t MakeKey( const std::string& sourcePath,unsigned int importFlags,float scale,bool isPBR,const ModelOptions& options );
+	// the part of the key that does not depend on the source file
+	static std::uint64_t MakeSettingsKey( unsigned int importFlags,float scale,bool isPBR,const ModelOptions& options ) noexcept;
+	static std::string MakeCachePath( const std::string& sourcePath );
+	// null when there is no cache file, it was cooked from something else (key mismatch) or it is malformed
+	static std::unique_ptr<CookedModel> Load( const std::string& cachePath,std::uint64_t key );
+	// runs the import-time processing on a freshly imported scene, one vertex layout per scene material
+	// meshes are reordered in place when options.optimizeMeshes is set
+	static std::unique_ptr<CookedModel> Cook( const aiScene& scene,const std::vector<Dvtx::VertexLayout>& layouts,
+		float scale,const ModelOptions& options,std::uint64_t key );
+	// written to a temporary first and renamed, so a crash never leaves a half written cache
+	void Save( const std::string& cachePath ) const;
+	size_t GetMaterialCount() const noexcept;
+	const aiMaterial& GetMaterial( size_t i ) const noexcept;
+	const std::vector<MeshView>& GetMeshes() const noexcept;
+	const NodeView& GetRoot() const noexcept;
+	size_t GetSizeBytes() const noexcept;
+	~CookedModel();
+private:
+	CookedModel() noexcept;
+	// builds materials, mesh and node views over pData
+	void Parse( std::uint64_t key );
+private:
+	class MappedFile;
+	std::unique_ptr<MappedFile> pMapping;
+	// backing store when freshly cooked
+	std::vector<char> blob;
+	const char* pData = nullptr;
+	size_t size = 0u;
+	std::vector<std::unique_ptr<aiMaterial>> materials;
+	std::vector<MeshView> meshes;
+	NodeView root;
+};
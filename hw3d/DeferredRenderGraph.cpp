@@ -90,9 +90,7 @@ namespace Rgph
 		}
 
 		{
-			Dcb::RawLayout l;
-			l.Add<Dcb::Integer>("TAAIndex");
-			Dcb::Buffer buf{ std::move(l) };
+			Dcb::Buffer buf{ TAAIndexLayout::Make() };
 			TAAIndex = std::make_shared<Bind::CachingPixelConstantBufferEx>(gfx, buf, 10u);
 			AddGlobalSource(DirectBindableSource<Bind::CachingPixelConstantBufferEx>::Make("TAAIndex", TAAIndex));
 		}
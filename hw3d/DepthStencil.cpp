@@ -231,6 +231,44 @@ namespace Bind
 		return { std::move( pTexTemp ),srcTextureDesc };
 	}
 
+	void DepthStencil::CopyToStaging( Graphics& gfx,Microsoft::WRL::ComPtr<ID3D11Texture2D>& pStaging ) const
+	{
+		INFOMAN( gfx );
+
+		wrl::ComPtr<ID3D11Resource> pResSource;
+		pDepthStencilView->GetResource( &pResSource );
+		wrl::ComPtr<ID3D11Texture2D> pTexSource;
+		pResSource.As( &pTexSource );
+		D3D11_TEXTURE2D_DESC srcTextureDesc{};
+		pTexSource->GetDesc( &srcTextureDesc );
+
+		// only reallocate when the source changed shape, this is called every frame
+		bool recreate = pStaging == nullptr;
+		if( !recreate )
+		{
+			D3D11_TEXTURE2D_DESC stagingDesc{};
+			pStaging->GetDesc( &stagingDesc );
+			recreate = stagingDesc.Width != srcTextureDesc.Width ||
+				stagingDesc.Height != srcTextureDesc.Height ||
+				stagingDesc.Format != srcTextureDesc.Format;
+		}
+		if( recreate )
+		{
+			D3D11_TEXTURE2D_DESC tmpTextureDesc = srcTextureDesc;
+			tmpTextureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+			tmpTextureDesc.Usage = D3D11_USAGE_STAGING;
+			tmpTextureDesc.BindFlags = 0;
+			tmpTextureDesc.MiscFlags = 0;
+			tmpTextureDesc.ArraySize = 1;
+			pStaging.Reset();
+			GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D(
+				&tmpTextureDesc,nullptr,&pStaging
+			) );
+		}
+
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->CopySubresourceRegion( pStaging.Get(),0,0,0,0,pTexSource.Get(),0,nullptr ) );
+	}
+
 	//Surface Bind::DepthStencil::ToSurface( Graphics& gfx,bool linearlize ) const
 	Surface Bind::DepthStencil::ToSurface( Graphics& gfx,bool linearlize ) const
 	{
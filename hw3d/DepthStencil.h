@@ -31,6 +31,8 @@ namespace Bind
 		void Clear( Graphics& gfx ) noxnd override;
 		Surface ToSurface( Graphics& gfx,bool linearlize = true ) const;
 		void Dumpy( Graphics& gfx,const std::string& path ) const;
+		// copies the depth into a cpu readable texture, (re)creating it when it does not match
+		void CopyToStaging( Graphics& gfx,Microsoft::WRL::ComPtr<ID3D11Texture2D>& pStaging ) const;
 		unsigned int GetWidth() const;
 		unsigned int GetHeight() const;
 	private:
@@ -68,9 +68,7 @@ void DirectionalLight::Reset() noexcept
 	pos = home.pos;
 	pitch = home.pitch;
 	yaw = home.yaw;
-	auto buf = arrow.cbuf->GetBuffer();
-	buf["length"] = home.length;
-	arrow.cbuf->SetBuffer(buf);
+	arrow.cbuf->EditBuffer()["length"] = home.length;
 }
 
 void DirectionalLight::Submit(size_t channels) const noxnd
@@ -116,6 +114,25 @@ DirectX::XMFLOAT3 DirectionalLight::GetDirection() noexcept
 	return cbData.direction;
 }
 
+float DirectionalLight::GetPitch() const noexcept
+{
+	return pitch;
+}
+
+float DirectionalLight::GetYaw() const noexcept
+{
+	return yaw;
+}
+
+void DirectionalLight::SetPose(DirectX::XMFLOAT3 pos_in, float pitch_in, float yaw_in) noexcept
+{
+	pos = pos_in;
+	pitch = pitch_in;
+	yaw = yaw_in;
+	pCamera->SetPos({ pos.x,pos.y + 100.0f,pos.z });
+	pCamera->SetRotation(pitch, yaw);
+}
+
 void DirectionalLight::Rotate(float dx, float dy) noexcept
 {
 	yaw = wrap_angle(yaw + dx * rotationSpeed);
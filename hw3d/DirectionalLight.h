@@ -25,6 +25,10 @@ public:
 	void LinkTechniques(Rgph::RenderGraph&);
 	DirectX::XMFLOAT3 GetPos() noexcept;
 	DirectX::XMFLOAT3 GetDirection() noexcept;
+	float GetPitch() const noexcept;
+	float GetYaw() const noexcept;
+	// moves the light and its shadow camera together, for scripted paths
+	void SetPose(DirectX::XMFLOAT3 pos, float pitch, float yaw) noexcept;
 	void Rotate(float dx, float dy) noexcept;
 	std::shared_ptr<Camera> ShareCamera() const noexcept;
 private:
@@ -4,15 +4,16 @@
 #include "BindableCodex.h"
 #include <assimp/scene.h>
 #include "Material.h"
+#include "Job.h"
 
 using namespace Bind;
 
 
-void Drawable::Submit( size_t channelFilter ) const noexcept
+void Drawable::Submit( size_t channelFilter,const Rgph::DrawOverride& draw ) const noexcept
 {
 	for( const auto& tech : techniques )
 	{
-		tech.Submit( *this,channelFilter );
+		tech.Submit( *this,channelFilter,draw );
 	}
 }
 
@@ -34,11 +35,22 @@ void Drawable::AddTechnique( Technique tech_in ) noexcept
 	techniques.push_back( std::move( tech_in ) );
 }
 
-void Drawable::Bind( Graphics& gfx ) const noxnd
+void Drawable::Bind( Graphics& gfx,Rgph::BoundInputs& bound,Bind::IndexBuffer* pIndicesOverride ) const noxnd
 {
-	pTopology->Bind( gfx );
-	pIndices->Bind( gfx );
-	pVertices->Bind( gfx );
+	const auto bind = [&gfx]( Bindable& b,const Bindable*& pBound )
+	{
+		if( pBound == &b )
+		{
+			gfx.GetStatsCounters().bindsAvoided++;
+			return;
+		}
+		b.Bind( gfx );
+		gfx.CountBind( b );
+		pBound = &b;
+	};
+	bind( *pTopology,bound.pTopology );
+	bind( pIndicesOverride ? *pIndicesOverride : *pIndices,bound.pIndices );
+	bind( *pVertices,bound.pVertices );
 }
 
 void Drawable::Accept( TechniqueProbe& probe )
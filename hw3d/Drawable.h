@@ -12,6 +12,7 @@ struct aiMesh;
 namespace Rgph
 {
 	class RenderGraph;
+	struct BoundInputs;
 }
 
 namespace Bind
@@ -30,8 +31,10 @@ public:
 	Drawable( const Drawable& ) = delete;
 	void AddTechnique( Technique tech_in ) noexcept;
 	virtual DirectX::XMMATRIX GetTransformXM() const noexcept = 0;
-	void Submit( size_t channelFilter ) const noexcept;
-	void Bind( Graphics& gfx ) const noxnd;
+	// draw changes the index buffer / ranges used by the jobs generated by this submission
+	void Submit( size_t channelFilter,const Rgph::DrawOverride& draw = {} ) const noexcept;
+	// skips what bound already holds, pIndicesOverride replaces the drawable's own index buffer
+	void Bind( Graphics& gfx,Rgph::BoundInputs& bound,Bind::IndexBuffer* pIndicesOverride = nullptr ) const noxnd;
 	void Accept( TechniqueProbe& probe );
 	UINT GetIndexCount() const noxnd;
 	void LinkTechniques( Rgph::RenderGraph& );
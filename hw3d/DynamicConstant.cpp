@@ -3,6 +3,8 @@
 #include <string>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <tuple>
 #include "LayoutCodex.h"
 
 
@@ -49,6 +51,63 @@ namespace Dcb
 		assert( index < data.size );
 		return { offset + data.element_size * index,&*data.layoutElement };
 	}
+	std::pair<size_t,const LayoutElement*> LayoutElement::ResolvePath( std::string_view path ) const noxnd
+	{
+		const std::pair<size_t,const LayoutElement*> missing = { 0u,&GetEmptyElement() };
+		size_t offset = 0u;
+		const LayoutElement* pElement = this;
+		size_t i = 0u;
+		while( i < path.size() )
+		{
+			if( path[i] == '[' )
+			{
+				const auto close = path.find( ']',i );
+				if( close == std::string_view::npos || pElement->type != Array )
+				{
+					return missing;
+				}
+				size_t index = 0u;
+				const auto first = path.data() + i + 1u;
+				const auto last = path.data() + close;
+				const auto result = std::from_chars( first,last,index );
+				if( result.ec != std::errc{} || result.ptr != last ||
+					index >= static_cast<ExtraData::Array&>(*pElement->pExtraData).size )
+				{
+					return missing;
+				}
+				std::tie( offset,pElement ) = pElement->CalculateIndexingOffset( offset,index );
+				i = close + 1u;
+			}
+			else
+			{
+				// a key either starts the path or follows a '.'
+				if( (path[i] == '.') != (i != 0u) )
+				{
+					return missing;
+				}
+				if( i != 0u )
+				{
+					i++;
+				}
+				const auto end = std::min( path.find_first_of( ".[",i ),path.size() );
+				if( end == i || pElement->type != Struct )
+				{
+					return missing;
+				}
+				pElement = &(*pElement)[std::string( path.substr( i,end - i ) )];
+				if( !pElement->Exists() )
+				{
+					return missing;
+				}
+				i = end;
+			}
+		}
+		return { offset,pElement };
+	}
+	Type LayoutElement::GetType() const noexcept
+	{
+		return type;
+	}
 	LayoutElement& LayoutElement::operator[]( const std::string& key ) noxnd
 	{
 		assert( "Keying into non-struct" && type == Struct );
@@ -317,23 +376,28 @@ namespace Dcb
 	}
 	ElementRef ElementRef::operator[]( const std::string& key ) const noxnd
 	{
-		return { &(*pLayout)[key],pBytes,offset };
+		return { &(*pLayout)[key],pBuffer,offset };
 	}
 	ElementRef ElementRef::operator[]( size_t index ) const noxnd
 	{
 		const auto indexingData = pLayout->CalculateIndexingOffset( offset,index );
-		return { indexingData.second,pBytes,indexingData.first };
+		return { indexingData.second,pBuffer,indexingData.first };
 	}
 	ElementRef::Ptr ElementRef::operator&() const noxnd
 	{
 		return Ptr{ const_cast<ElementRef*>(this) };
 	}
-	ElementRef::ElementRef( const LayoutElement* pLayout,char* pBytes,size_t offset ) noexcept
+	ElementRef::ElementRef( const LayoutElement* pLayout,Buffer* pBuffer,size_t offset ) noexcept
 		:
 		offset( offset ),
 		pLayout( pLayout ),
-		pBytes( pBytes )
+		pBuffer( pBuffer ),
+		pBytes( pBuffer->bytes.data() )
 	{}
+	void ElementRef::MarkWritten( size_t leafOffset,size_t size ) const noexcept
+	{
+		pBuffer->MarkDirty( leafOffset,size );
+	}
 	ElementRef::Ptr::Ptr( ElementRef* ref ) noexcept : ref( ref )
 	{}
 
@@ -366,7 +430,7 @@ namespace Dcb
 	{}
 	ElementRef Buffer::operator[]( const std::string& key ) noxnd
 	{
-		return { &(*pLayoutRoot)[key],bytes.data(),0u };
+		return { &(*pLayoutRoot)[key],this,0u };
 	}
 	ConstElementRef Buffer::operator[]( const std::string& key ) const noxnd
 	{
@@ -387,10 +451,29 @@ namespace Dcb
 	void Buffer::CopyFrom( const Buffer& other ) noxnd
 	{
 		assert( &GetRootLayoutElement() == &other.GetRootLayoutElement() );
+		const auto first = std::mismatch( bytes.begin(),bytes.end(),other.bytes.begin() ).first;
+		if( first == bytes.end() )
+		{
+			return;
+		}
+		const auto last = std::mismatch( bytes.rbegin(),bytes.rend(),other.bytes.rbegin() ).first.base();
 		std::copy( other.bytes.begin(),other.bytes.end(),bytes.begin() );
+		MarkDirty( size_t( first - bytes.begin() ),size_t( last - first ) );
 	}
 	std::shared_ptr<LayoutElement> Buffer::ShareLayoutRoot() const noexcept
 	{
 		return pLayoutRoot;
 	}
+	Buffer::Range Buffer::GetDirtyRange() const noexcept
+	{
+		return dirty;
+	}
+	bool Buffer::IsDirty() const noexcept
+	{
+		return dirty.begin != dirty.end;
+	}
+	void Buffer::ClearDirty() noexcept
+	{
+		dirty = {};
+	}
 }
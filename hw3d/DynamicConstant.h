@@ -6,6 +6,9 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
 
 // master list of leaf types that generates enum elements and various switches etc.
 #define LEAF_ELEMENT_TYPES \
@@ -134,6 +137,11 @@ namespace Dcb
 		bool Exists() const noexcept;
 		// calculate array indexing offset
 		std::pair<size_t,const LayoutElement*> CalculateIndexingOffset( size_t offset,size_t index ) const noxnd;
+		// walk a path of keys and indices like "lights[2].color" down from this element in one go
+		// returns the accumulated array indexing offset and the element reached, which is the Empty
+		// element if any step does not exist (unknown key, out of range index, keying a non-struct...)
+		std::pair<size_t,const LayoutElement*> ResolvePath( std::string_view path ) const noxnd;
+		Type GetType() const noexcept;
 		// [] only works for Structs; access member (child node in tree) by name
 		LayoutElement& operator[]( const std::string& key ) noxnd;
 		const LayoutElement& operator[]( const std::string& key ) const noxnd;
@@ -208,6 +216,44 @@ namespace Dcb
 		Type type = Empty;
 		std::unique_ptr<ExtraDataBase> pExtraData;
 	};
+
+
+	// a path into a layout resolved ahead of time to a byte offset of a leaf of type T
+	// compile once (from the cooked layout, or from any Buffer's root) and then index Buffers with it:
+	// buf[acc] costs one add instead of a string compare per key on the path
+	// valid for every Buffer sharing the layout root it was compiled from, which is every Buffer of that
+	// signature since the codex hands out one root per signature (checked in Debug)
+	template<typename T>
+	class Accessor
+	{
+		static_assert(ReverseMap<std::remove_const_t<T>>::valid,"Unsupported SysType used in Accessor");
+		friend class Buffer;
+	public:
+		// empty accessor, Exists() is false
+		Accessor() noexcept = default;
+		// path must lead to a leaf of type T if it exists at all; a missing path gives an empty accessor
+		Accessor( const LayoutElement& root,std::string_view path ) noxnd
+		{
+			const auto [indexingOffset,pElement] = root.ResolvePath( path );
+			if( pElement->Exists() )
+			{
+				assert( "Accessor type does not match the layout" && pElement->GetType() == ReverseMap<std::remove_const_t<T>>::type );
+				offset = indexingOffset + pElement->GetOffsetBegin();
+				pRoot = &root;
+			}
+		}
+		bool Exists() const noexcept
+		{
+			return pRoot != nullptr;
+		}
+		size_t GetOffset() const noexcept
+		{
+			return offset;
+		}
+	private:
+		size_t offset = 0u;
+		const LayoutElement* pRoot = nullptr;
+	};
 	
 
 	// the layout class serves as a shell to hold the root of the LayoutElement tree
@@ -261,6 +307,12 @@ namespace Dcb
 	public:
 		// key into the root Struct (const to disable mutation of the layout)
 		const LayoutElement& operator[]( const std::string& key ) const noxnd;
+		// resolve a path (see LayoutElement::ResolvePath) once for use with any Buffer of this layout
+		template<typename T>
+		Accessor<T> Compile( std::string_view path ) const noxnd
+		{
+			return { *pRoot,path };
+		}
 		// get a share on layout tree root
 		std::shared_ptr<LayoutElement> ShareRoot() const noexcept;
 	private:
@@ -273,6 +325,8 @@ namespace Dcb
 
 
 
+	class Buffer;
+
 	// proxy type that is emitted when keying/indexing into a Buffer
 	// implement conversions/assignment that allows manipulation of the
 	// raw bytes of the Buffer. This version is const, only supports reading
@@ -332,6 +386,9 @@ namespace Dcb
 
 	// version of ConstElementRef that also allows writing to the bytes of Buffer
 	// see above in ConstElementRef for detailed description
+	// writes are recorded in the Buffer's dirty range; assignments that leave the bytes unchanged are not,
+	// while taking a mutable reference / pointer is (the caller might write through it), so read through
+	// a const Buffer where that matters
 	class ElementRef
 	{
 		friend class Buffer;
@@ -373,20 +430,31 @@ namespace Dcb
 		operator T&() const noxnd
 		{
 			static_assert(ReverseMap<std::remove_const_t<T>>::valid,"Unsupported SysType used in conversion");
-			return *reinterpret_cast<T*>(pBytes + offset + pLayout->Resolve<T>());
+			const auto leafOffset = offset + pLayout->Resolve<T>();
+			MarkWritten( leafOffset,sizeof( T ) );
+			return *reinterpret_cast<T*>(pBytes + leafOffset);
 		}
 		// assignment for writing to as a supported SysType
 		template<typename T>
 		T& operator=( const T& rhs ) const noxnd
 		{
 			static_assert(ReverseMap<std::remove_const_t<T>>::valid,"Unsupported SysType used in assignment");
-			return static_cast<T&>(*this) = rhs;
+			const auto leafOffset = offset + pLayout->Resolve<T>();
+			auto& dest = *reinterpret_cast<T*>(pBytes + leafOffset);
+			if( std::memcmp( &dest,&rhs,sizeof( T ) ) != 0 )
+			{
+				dest = rhs;
+				MarkWritten( leafOffset,sizeof( T ) );
+			}
+			return dest;
 		}
 	private:
 		// refs should only be constructable by other refs or by the buffer
-		ElementRef( const LayoutElement* pLayout,char* pBytes,size_t offset ) noexcept;
+		ElementRef( const LayoutElement* pLayout,Buffer* pBuffer,size_t offset ) noexcept;
+		void MarkWritten( size_t leafOffset,size_t size ) const noexcept;
 		size_t offset;
 		const LayoutElement* pLayout;
+		Buffer* pBuffer;
 		char* pBytes;
 	};
 
@@ -413,18 +481,62 @@ namespace Dcb
 		ElementRef operator[]( const std::string& key ) noxnd;
 		// if Buffer is const, you only get to index into the buffer with a read-only proxy
 		ConstElementRef operator[]( const std::string& key ) const noxnd;
+		// pre-resolved access, no lookups (the accessor must exist and come from this buffer's layout)
+		// the mutable version counts as a write of the leaf
+		template<typename T>
+		T& operator[]( const Accessor<T>& acc ) noxnd
+		{
+			assert( "Accessor from another layout (or empty)" && acc.pRoot == pLayoutRoot.get() );
+			MarkDirty( acc.offset,sizeof( T ) );
+			return *reinterpret_cast<T*>(bytes.data() + acc.offset);
+		}
+		template<typename T>
+		const T& operator[]( const Accessor<T>& acc ) const noxnd
+		{
+			assert( "Accessor from another layout (or empty)" && acc.pRoot == pLayoutRoot.get() );
+			return *reinterpret_cast<const T*>(bytes.data() + acc.offset);
+		}
 		// get the raw bytes
 		const char* GetData() const noexcept;
 		// size of the raw byte buffer
 		size_t GetSizeInBytes() const noexcept;
 		const LayoutElement& GetRootLayoutElement() const noexcept;
-		// copy bytes from another buffer (layouts must match)
+		// copy bytes from another buffer (layouts must match), only the bytes that differ are marked dirty
 		void CopyFrom( const Buffer& ) noxnd;
 		// return another sptr to the layout root
 		std::shared_ptr<LayoutElement> ShareLayoutRoot() const noexcept;
+		// half-open byte range written since the last ClearDirty (a new Buffer starts clean), empty when
+		// begin == end; consumers upload just that part and clear it
+		struct Range
+		{
+			size_t begin = 0u;
+			size_t end = 0u;
+		};
+		Range GetDirtyRange() const noexcept;
+		bool IsDirty() const noexcept;
+		void ClearDirty() noexcept;
+		// grow the dirty range to cover bytes written behind the buffer's back
+		// (inline, it sits on the accessor write path)
+		void MarkDirty( size_t offset,size_t size ) noexcept
+		{
+			if( dirty.begin == dirty.end )
+			{
+				dirty = { offset,offset + size };
+			}
+			else
+			{
+				dirty.begin = std::min( dirty.begin,offset );
+				dirty.end = std::max( dirty.end,offset + size );
+			}
+		}
 	private:
+		// refs write to the bytes and mark them dirty, StaticLayout does the same at its compile-time offsets
+		friend class ElementRef;
+		template<typename... Members>
+		friend class StaticLayout;
 		std::shared_ptr<LayoutElement> pLayoutRoot;
 		std::vector<char> bytes;
+		Range dirty;
 	};
 }
 
@@ -0,0 +1,252 @@
+#include "FlythroughBenchmark.h"
+#include "CameraContainer.h"
+#include "Graphics.h"
+#include "RenderGraph.h"
+#include "cnpy.h"
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	// written as empty csv cells / nan
+	constexpr float missing = std::numeric_limits<float>::quiet_NaN();
+
+	// nearest rank on sorted values
+	float Percentile( const std::vector<float>& sorted,float p ) noexcept
+	{
+		const auto rank = size_t( std::ceil( p / 100.0f * float( sorted.size() ) ) );
+		return sorted[std::clamp( rank,size_t( 1u ),sorted.size() ) - 1u];
+	}
+}
+
+std::optional<FlythroughBenchmark::Settings> FlythroughBenchmark::request;
+
+void FlythroughBenchmark::Request( Settings settings )
+{
+	request = std::move( settings );
+}
+
+std::optional<FlythroughBenchmark::Settings> FlythroughBenchmark::TakeRequest()
+{
+	auto taken = std::move( request );
+	request.reset();
+	return taken;
+}
+
+FlythroughBenchmark::FlythroughBenchmark( Graphics& gfx,Settings settings_in )
+	:
+	settings( std::move( settings_in ) ),
+	path( CameraPath::Load( settings.pathFile ) ),
+	duration( path.GetDuration() ),
+	profiler( gfx ),
+	warmupLeft( settings.warmupFrames )
+{
+	if( path.IsEmpty() )
+	{
+		throw std::runtime_error{ "Camera path has no keys: " + settings.pathFile };
+	}
+	if( !(settings.timestep > 0.0f) )
+	{
+		throw std::runtime_error{ "Flythrough timestep must be positive" };
+	}
+}
+
+const FlythroughBenchmark::Settings& FlythroughBenchmark::GetSettings() const noexcept
+{
+	return settings;
+}
+
+float FlythroughBenchmark::GetTimestep() const noexcept
+{
+	return settings.timestep;
+}
+
+FrameProfiler& FlythroughBenchmark::GetProfiler() noexcept
+{
+	return profiler;
+}
+
+void FlythroughBenchmark::BeginFrame( Graphics& gfx,CameraContainer& cameras,bool loaded )
+{
+	TakeStats( gfx );
+	if( !recording && loaded )
+	{
+		if( warmupLeft == 0u )
+		{
+			recording = true;
+		}
+		else
+		{
+			warmupLeft--;
+		}
+	}
+	// warmup frames hold the first pose
+	const float time = recording ? float( rows.size() ) * settings.timestep : 0.0f;
+	cameras.ApplyPath( path,time );
+	if( recording )
+	{
+		rows.push_back( { gfx.GetFrameIndex(),time,0.0f,missing } );
+		rows.back().passValues.resize( passNames.size() * valuesPerPass,missing );
+		profiler.BeginFrame( gfx );
+		frameOpen = true;
+		cpuTimer.Mark();
+	}
+}
+
+void FlythroughBenchmark::EndFrame( Graphics& gfx,const Rgph::RenderGraph& rg )
+{
+	if( !frameOpen )
+	{
+		return;
+	}
+	rows.back().cpuMs = cpuTimer.Peek() * 1000.0f;
+	for( const auto& p : rg.GetPassStats() )
+	{
+		const auto slot = GetPassSlot( p.name );
+		rows.back().passValues[slot * valuesPerPass + 2u] = float( p.stats.draws );
+	}
+	profiler.EndFrame( gfx );
+	frameOpen = false;
+	countsPending = true;
+	Gather( profiler.Collect( gfx ) );
+}
+
+bool FlythroughBenchmark::IsDone() const noexcept
+{
+	return recording && !frameOpen && float( rows.size() ) * settings.timestep > duration;
+}
+
+void FlythroughBenchmark::Finish( Graphics& gfx )
+{
+	TakeStats( gfx );
+	Gather( profiler.Collect( gfx,true ) );
+	WriteReports();
+}
+
+void FlythroughBenchmark::TakeStats( Graphics& gfx ) noexcept
+{
+	if( countsPending )
+	{
+		rows.back().stats = gfx.GetFrameStats();
+		countsPending = false;
+	}
+}
+
+size_t FlythroughBenchmark::GetPassSlot( const std::string& name )
+{
+	const auto i = size_t( std::find( passNames.begin(),passNames.end(),name ) - passNames.begin() );
+	if( i == passNames.size() )
+	{
+		passNames.push_back( name );
+		for( auto& r : rows )
+		{
+			r.passValues.resize( passNames.size() * valuesPerPass,missing );
+		}
+	}
+	return i;
+}
+
+void FlythroughBenchmark::Gather( std::vector<FrameProfiler::Frame> frames )
+{
+	for( const auto& f : frames )
+	{
+		// recorded frames are consecutive, so the row is found by offset
+		if( rows.empty() || f.index < rows.front().frameIndex || f.index - rows.front().frameIndex >= rows.size() )
+		{
+			continue;
+		}
+		auto& row = rows[size_t( f.index - rows.front().frameIndex )];
+		if( f.gpuValid )
+		{
+			row.gpuMs = f.gpuMs;
+		}
+		for( const auto& p : f.passes )
+		{
+			const auto slot = GetPassSlot( p.name );
+			row.passValues[slot * valuesPerPass] = p.cpuMs;
+			row.passValues[slot * valuesPerPass + 1u] = f.gpuValid ? p.gpuMs : missing;
+		}
+	}
+}
+
+void FlythroughBenchmark::WriteReports() const
+{
+	std::vector<std::string> columns = { "frame","time","cpu_ms","gpu_ms","draws","indices","binds","binds_avoided",
+		"cb_uploads","cb_bytes","jobs_submitted","jobs_executed" };
+	for( const auto& name : passNames )
+	{
+		columns.push_back( name + "_cpu_ms" );
+		columns.push_back( name + "_gpu_ms" );
+		columns.push_back( name + "_draws" );
+	}
+	const size_t nColumns = columns.size();
+	std::vector<float> table;
+	table.reserve( rows.size() * nColumns );
+	for( size_t i = 0; i < rows.size(); i++ )
+	{
+		const auto& r = rows[i];
+		const auto& s = r.stats;
+		table.insert( table.end(),{ float( i ),r.time,r.cpuMs,r.gpuMs,float( s.draws ),float( s.indices ),float( s.binds ),
+			float( s.bindsAvoided ),float( s.constantUploads ),float( s.constantBytes ),float( s.jobsSubmitted ),float( s.jobsExecuted ) } );
+		table.insert( table.end(),r.passValues.begin(),r.passValues.end() );
+	}
+
+	// gpu times of frames the timestamps were unreliable over are left empty
+	{
+		std::ofstream file( settings.dest + ".csv" );
+		for( size_t c = 0; c < nColumns; c++ )
+		{
+			file << (c ? "," : "") << columns[c];
+		}
+		file << "\n";
+		for( size_t i = 0; i < rows.size(); i++ )
+		{
+			for( size_t c = 0; c < nColumns; c++ )
+			{
+				const auto v = table[i * nColumns + c];
+				file << (c ? "," : "");
+				if( !std::isnan( v ) )
+				{
+					file << v;
+				}
+			}
+			file << "\n";
+		}
+	}
+
+	// same table with nan for the missing times, for numpy
+	if( !rows.empty() )
+	{
+		cnpy::npy_save( settings.dest + ".npy",table.data(),{ rows.size(),nColumns } );
+	}
+
+	// the frame number and time columns aren't measurements
+	{
+		std::ofstream file( settings.dest + "_summary.csv" );
+		file << "metric,samples,mean,p50,p90,p95,p99,max\n";
+		for( size_t c = 2; c < nColumns; c++ )
+		{
+			std::vector<float> values;
+			for( size_t i = 0; i < rows.size(); i++ )
+			{
+				if( const auto v = table[i * nColumns + c]; !std::isnan( v ) )
+				{
+					values.push_back( v );
+				}
+			}
+			file << columns[c] << "," << values.size();
+			if( !values.empty() )
+			{
+				std::sort( values.begin(),values.end() );
+				const double mean = std::accumulate( values.begin(),values.end(),0.0 ) / double( values.size() );
+				file << "," << mean << "," << Percentile( values,50.0f ) << "," << Percentile( values,90.0f ) << ","
+					<< Percentile( values,95.0f ) << "," << Percentile( values,99.0f ) << "," << values.back();
+			}
+			file << "\n";
+		}
+	}
+}
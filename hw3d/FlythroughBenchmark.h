@@ -0,0 +1,88 @@
+#pragma once
+#include "CameraPath.h"
+#include "FrameProfiler.h"
+#include "ChiliTimer.h"
+#include "FrameStats.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+class Graphics;
+class CameraContainer;
+namespace Rgph
+{
+	class RenderGraph;
+}
+
+// plays a recorded camera / light path through the scene at a fixed timestep and records every frame:
+// cpu and gpu time, the frame's work counters (FrameStats) and per pass timings and draws of the render graph
+// frame times stop before present, so vsync waits and the imgui draw aren't in them
+// recording starts once streaming has finished and a few warmup frames have gone by, so runs compare
+// writes <dest>.csv (one row per frame), <dest>.npy (the same as a float32 frames x columns matrix) and
+// <dest>_summary.csv (mean / percentiles per column)
+class FlythroughBenchmark
+{
+public:
+	struct Settings
+	{
+		std::string pathFile = "camera_path.json";
+		// output paths without extension
+		std::string dest = "flythrough";
+		// simulated seconds per frame, so the path is sampled at the same times every run
+		float timestep = 1.0f / 60.0f;
+		unsigned int warmupFrames = 30u;
+		// scene settings, left as the app has them when not given
+		std::optional<bool> TAA;
+		std::optional<bool> HBAO;
+		std::optional<float> lodBias;
+		std::optional<float> shadowLodBias;
+		std::optional<std::string> activeCamera;
+	};
+public:
+	// the script commands run before the app exists, so the run is queued for it to pick up
+	static void Request( Settings settings );
+	static std::optional<Settings> TakeRequest();
+	FlythroughBenchmark( Graphics& gfx,Settings settings );
+	const Settings& GetSettings() const noexcept;
+	float GetTimestep() const noexcept;
+	FrameProfiler& GetProfiler() noexcept;
+	// call after Graphics::BeginFrame, before anything binds the cameras; poses the scene for this frame
+	void BeginFrame( Graphics& gfx,CameraContainer& cameras,bool loaded );
+	// call right before Graphics::EndFrame, after the graph has executed
+	void EndFrame( Graphics& gfx,const Rgph::RenderGraph& rg );
+	// the whole path has been recorded
+	bool IsDone() const noexcept;
+	// waits for the outstanding gpu timings and writes the reports
+	void Finish( Graphics& gfx );
+private:
+	struct Row
+	{
+		std::uint64_t frameIndex;
+		float time;
+		float cpuMs;
+		float gpuMs = 0.0f;
+		FrameStats stats;
+		// cpu ms, gpu ms, draws per pass, in the order of passNames
+		std::vector<float> passValues;
+	};
+	static constexpr size_t valuesPerPass = 3u;
+	// the counters of the last frame are only out once it has been presented
+	void TakeStats( Graphics& gfx ) noexcept;
+	// index of the pass in passNames, added (to every row) the first time it comes up
+	size_t GetPassSlot( const std::string& name );
+	void Gather( std::vector<FrameProfiler::Frame> frames );
+	void WriteReports() const;
+private:
+	static std::optional<Settings> request;
+	Settings settings;
+	CameraPath path;
+	float duration;
+	FrameProfiler profiler;
+	ChiliTimer cpuTimer;
+	unsigned int warmupLeft;
+	bool recording = false;
+	bool frameOpen = false;
+	bool countsPending = false;
+	std::vector<Row> rows;
+	std::vector<std::string> passNames;
+};
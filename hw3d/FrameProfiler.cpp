@@ -0,0 +1,157 @@
+#include "FrameProfiler.h"
+#include "GraphicsThrowMacros.h"
+#include <cassert>
+
+namespace wrl = Microsoft::WRL;
+
+FrameProfiler::FrameProfiler( Graphics& gfx,size_t maxPasses )
+	:
+	maxPasses( maxPasses )
+{
+	INFOMAN( gfx );
+	const auto makeQuery = [&]( D3D11_QUERY type )
+	{
+		D3D11_QUERY_DESC desc = {};
+		desc.Query = type;
+		wrl::ComPtr<ID3D11Query> pQuery;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateQuery( &desc,&pQuery ) );
+		return pQuery;
+	};
+	for( auto& s : slots )
+	{
+		s.pDisjoint = makeQuery( D3D11_QUERY_TIMESTAMP_DISJOINT );
+		s.pBegin = makeQuery( D3D11_QUERY_TIMESTAMP );
+		s.pEnd = makeQuery( D3D11_QUERY_TIMESTAMP );
+		for( size_t i = 0; i < maxPasses; i++ )
+		{
+			s.passBegin.push_back( makeQuery( D3D11_QUERY_TIMESTAMP ) );
+			s.passEnd.push_back( makeQuery( D3D11_QUERY_TIMESTAMP ) );
+		}
+	}
+}
+
+void FrameProfiler::BeginFrame( Graphics& gfx )
+{
+	assert( !inFrame );
+	auto& s = slots[current];
+	if( s.pending )
+	{
+		// every slot in flight, this one has to come back before its queries can be reused
+		Resolve( gfx,s,true );
+	}
+	s.frame = {};
+	s.frame.index = gfx.GetFrameIndex();
+	GetContext( gfx )->Begin( s.pDisjoint.Get() );
+	GetContext( gfx )->End( s.pBegin.Get() );
+	inFrame = true;
+}
+
+void FrameProfiler::EndFrame( Graphics& gfx )
+{
+	assert( inFrame );
+	auto& s = slots[current];
+	GetContext( gfx )->End( s.pEnd.Get() );
+	GetContext( gfx )->End( s.pDisjoint.Get() );
+	s.pending = true;
+	inFrame = false;
+	current = (current + 1u) % latency;
+}
+
+void FrameProfiler::BeginPass( Graphics& gfx,const std::string& name )
+{
+	if( !inFrame )
+	{
+		return;
+	}
+	auto& s = slots[current];
+	const auto i = s.frame.passes.size();
+	s.frame.passes.push_back( { name } );
+	if( i < maxPasses )
+	{
+		GetContext( gfx )->End( s.passBegin[i].Get() );
+	}
+	passTimer.Mark();
+}
+
+void FrameProfiler::EndPass( Graphics& gfx )
+{
+	if( !inFrame )
+	{
+		return;
+	}
+	auto& s = slots[current];
+	assert( !s.frame.passes.empty() );
+	const auto i = s.frame.passes.size() - 1u;
+	s.frame.passes[i].cpuMs = passTimer.Peek() * 1000.0f;
+	if( i < maxPasses )
+	{
+		GetContext( gfx )->End( s.passEnd[i].Get() );
+	}
+}
+
+std::vector<FrameProfiler::Frame> FrameProfiler::Collect( Graphics& gfx,bool wait )
+{
+	// oldest slot first, stopping at the first one still out so frames stay in order
+	for( size_t n = 0; n < latency; n++ )
+	{
+		auto& s = slots[(current + n) % latency];
+		if( s.pending && !Resolve( gfx,s,wait ) )
+		{
+			break;
+		}
+	}
+	std::vector<Frame> frames( std::make_move_iterator( ready.begin() ),std::make_move_iterator( ready.end() ) );
+	ready.clear();
+	return frames;
+}
+
+bool FrameProfiler::Resolve( Graphics& gfx,Slot& slot,bool wait )
+{
+	const auto pContext = GetContext( gfx );
+	const auto getData = [&]( ID3D11Query* pQuery,void* pData,UINT size )
+	{
+		HRESULT hr;
+		while( (hr = pContext->GetData( pQuery,pData,size,wait ? 0u : D3D11_ASYNC_GETDATA_DONOTFLUSH )) == S_FALSE )
+		{
+			if( !wait )
+			{
+				return false;
+			}
+		}
+		return SUCCEEDED( hr );
+	};
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+	if( !getData( slot.pDisjoint.Get(),&disjoint,sizeof( disjoint ) ) )
+	{
+		return false;
+	}
+	auto& frame = slot.frame;
+	frame.gpuValid = !disjoint.Disjoint && disjoint.Frequency != 0u;
+	const auto toMs = [&]( UINT64 begin,UINT64 end )
+	{
+		return float( double( end - begin ) * 1000.0 / double( disjoint.Frequency ) );
+	};
+	UINT64 begin = 0u;
+	UINT64 end = 0u;
+	if( frame.gpuValid && getData( slot.pBegin.Get(),&begin,sizeof( begin ) ) && getData( slot.pEnd.Get(),&end,sizeof( end ) ) )
+	{
+		frame.gpuMs = toMs( begin,end );
+		for( size_t i = 0; i < frame.passes.size() && i < maxPasses; i++ )
+		{
+			UINT64 passBegin = 0u;
+			UINT64 passEnd = 0u;
+			if( getData( slot.passBegin[i].Get(),&passBegin,sizeof( passBegin ) ) &&
+				getData( slot.passEnd[i].Get(),&passEnd,sizeof( passEnd ) ) )
+			{
+				frame.passes[i].gpuMs = toMs( passBegin,passEnd );
+			}
+		}
+	}
+	else
+	{
+		frame.gpuValid = false;
+	}
+	ready.push_back( std::move( frame ) );
+	slot.pending = false;
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "GraphicsResource.h"
+#include "ChiliTimer.h"
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// cpu and gpu time of whole frames and of the render graph's passes
+// gpu time comes from timestamp queries, read back a few frames later without stalling (unless the
+// queries of every in-flight frame are still pending, then the oldest is waited for)
+class FrameProfiler : public GraphicsResource
+{
+public:
+	struct Pass
+	{
+		std::string name;
+		float cpuMs = 0.0f;
+		float gpuMs = 0.0f;
+	};
+	struct Frame
+	{
+		// Graphics::GetFrameIndex() when the frame began
+		std::uint64_t index = 0u;
+		float gpuMs = 0.0f;
+		// false when the gpu clock was unreliable over the frame (gpu times are then 0)
+		bool gpuValid = false;
+		std::vector<Pass> passes;
+	};
+public:
+	FrameProfiler( Graphics& gfx,size_t maxPasses = 64u );
+	void BeginFrame( Graphics& gfx );
+	void EndFrame( Graphics& gfx );
+	// passes past maxPasses in a frame only get cpu times
+	void BeginPass( Graphics& gfx,const std::string& name );
+	void EndPass( Graphics& gfx );
+	// frames whose timestamps have come back since the last call, oldest first
+	// wait blocks until every ended frame is in
+	std::vector<Frame> Collect( Graphics& gfx,bool wait = false );
+private:
+	struct Slot
+	{
+		Microsoft::WRL::ComPtr<ID3D11Query> pDisjoint;
+		Microsoft::WRL::ComPtr<ID3D11Query> pBegin;
+		Microsoft::WRL::ComPtr<ID3D11Query> pEnd;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> passBegin;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> passEnd;
+		Frame frame;
+		bool pending = false;
+	};
+	static constexpr size_t latency = 4u;
+	// reads the slot's queries back into its frame, false if they aren't in yet (and not waiting)
+	bool Resolve( Graphics& gfx,Slot& slot,bool wait );
+private:
+	std::array<Slot,latency> slots;
+	size_t current = 0u;
+	size_t maxPasses;
+	bool inFrame = false;
+	ChiliTimer passTimer;
+	std::deque<Frame> ready;
+};
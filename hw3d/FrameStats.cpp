@@ -0,0 +1,86 @@
+#include "FrameStats.h"
+#include <cstring>
+
+namespace
+{
+	// one binary, so a type has exactly one type_info and slots can be matched by address
+	std::array<const std::type_info*,FrameStats::maxBindTypes> bindTypes = {};
+	size_t bindTypeCount = 0u;
+}
+
+FrameStats& FrameStats::operator+=( const FrameStats& rhs ) noexcept
+{
+	draws += rhs.draws;
+	indices += rhs.indices;
+	binds += rhs.binds;
+	bindsAvoided += rhs.bindsAvoided;
+	constantUploads += rhs.constantUploads;
+	constantBytes += rhs.constantBytes;
+	jobsSubmitted += rhs.jobsSubmitted;
+	jobsExecuted += rhs.jobsExecuted;
+	for( size_t i = 0; i < maxBindTypes; i++ )
+	{
+		bindsByType[i] += rhs.bindsByType[i];
+	}
+	return *this;
+}
+
+FrameStats& FrameStats::operator-=( const FrameStats& rhs ) noexcept
+{
+	draws -= rhs.draws;
+	indices -= rhs.indices;
+	binds -= rhs.binds;
+	bindsAvoided -= rhs.bindsAvoided;
+	constantUploads -= rhs.constantUploads;
+	constantBytes -= rhs.constantBytes;
+	jobsSubmitted -= rhs.jobsSubmitted;
+	jobsExecuted -= rhs.jobsExecuted;
+	for( size_t i = 0; i < maxBindTypes; i++ )
+	{
+		bindsByType[i] -= rhs.bindsByType[i];
+	}
+	return *this;
+}
+
+size_t FrameStats::GetBindType( const std::type_info& type ) noexcept
+{
+	for( size_t i = 0; i < bindTypeCount; i++ )
+	{
+		if( bindTypes[i] == &type )
+		{
+			return i;
+		}
+	}
+	if( bindTypeCount >= maxBindTypes - 1u )
+	{
+		// the last slot collects every type past the others
+		bindTypeCount = maxBindTypes;
+		return maxBindTypes - 1u;
+	}
+	bindTypes[bindTypeCount] = &type;
+	return bindTypeCount++;
+}
+
+const char* FrameStats::GetBindTypeName( size_t slot ) noexcept
+{
+	if( slot >= bindTypeCount )
+	{
+		return nullptr;
+	}
+	if( slot == maxBindTypes - 1u )
+	{
+		return "(other)";
+	}
+	// msvc names read "class Bind::PixelShader", keep the class name
+	const char* name = bindTypes[slot]->name();
+	if( const auto pSpace = std::strrchr( name,' ' ) )
+	{
+		name = pSpace + 1;
+	}
+	return name;
+}
+
+size_t FrameStats::GetBindTypeCount() noexcept
+{
+	return bindTypeCount;
+}
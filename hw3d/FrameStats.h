@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <typeinfo>
+
+// work issued over a frame, or over one render graph pass of it
+// every field is a plain counter bumped where the work is issued (no locks, no allocation), so they
+// stay on in release builds; only binds made through passes, steps and drawables are counted
+struct FrameStats
+{
+	// distinct bindable types that get their own count, later ones all go into the last slot
+	static constexpr size_t maxBindTypes = 32u;
+	size_t draws = 0u;
+	size_t indices = 0u;
+	size_t binds = 0u;
+	// binds skipped because the previous job of the pass left the same state bound
+	size_t bindsAvoided = 0u;
+	size_t constantUploads = 0u;
+	size_t constantBytes = 0u;
+	// jobs queued to render queue passes, and those of them that drew something
+	size_t jobsSubmitted = 0u;
+	size_t jobsExecuted = 0u;
+	// indexed by GetBindType
+	std::array<size_t,maxBindTypes> bindsByType = {};
+
+	// assumes triangle lists, which is everything but the debug line drawables
+	size_t GetTriangles() const noexcept
+	{
+		return indices / 3u;
+	}
+	FrameStats& operator+=( const FrameStats& rhs ) noexcept;
+	FrameStats& operator-=( const FrameStats& rhs ) noexcept;
+	// slot of a bindable type, assigned the first time the type is seen (render thread only)
+	static size_t GetBindType( const std::type_info& type ) noexcept;
+	// readable name of a slot, null for slots not assigned yet
+	static const char* GetBindTypeName( size_t slot ) noexcept;
+	static size_t GetBindTypeCount() noexcept;
+};
@@ -43,9 +43,7 @@ namespace Rgph
 			static int mOffsetIdx = 0;
 			mOffsetIdx = (mOffsetIdx + 1) & (TAASamples - 1);
 
-			auto buf = TAAIndex->GetBuffer();
-			buf["TAAIndex"] = mOffsetIdx;
-			TAAIndex->SetBuffer(buf);
+			TAAIndexLayout::Get<"TAAIndex">(TAAIndex->EditBuffer()) = mOffsetIdx;
 			TAAIndex->Bind(gfx);
 
 			auto TemporalHalton = [](int Index, int Base)
@@ -2,11 +2,15 @@
 #include "RenderQueuePass.h"
 #include "Camera.h"
 #include "ConstantBuffersEx.h"
+#include "StaticLayout.h"
 
 class Graphics;
 
 namespace Rgph
 {
+	// layout of the "TAAIndex" buffer this pass writes every frame, offsets resolved at compile time
+	using TAAIndexLayout = Dcb::StaticLayout<Dcb::Member<Dcb::Integer,"TAAIndex">>;
+
 	class GbufferPass : public RenderQueuePass
 	{
 	public:
@@ -10,6 +10,9 @@
 #include "imgui/imgui_impl_win32.h"
 #include "DepthStencil.h"
 #include "RenderTarget.h"
+#include "Bindable.h"
+#include "ConstantRingBuffer.h"
+#include "Trace.h"
 
 namespace wrl = Microsoft::WRL;
 namespace dx = DirectX;
@@ -67,8 +70,87 @@ Graphics::Graphics( HWND hWnd,int width,int height )
 	// gain access to texture subresource in swap chain (back buffer)
 	wrl::ComPtr<ID3D11Texture2D> pBackBuffer;
 	GFX_THROW_INFO( pSwap->GetBuffer( 0,__uuidof(ID3D11Texture2D),&pBackBuffer ) );
-	pTarget = std::shared_ptr<Bind::RenderTarget>{ new Bind::OutputOnlyRenderTarget( *this,pBackBuffer.Get() ) };
+	InitContext( pBackBuffer.Get() );
 	
+	// init imgui d3d impl
+	ImGui_ImplDX11_Init( pDevice.Get(),pContext.Get() );
+}
+
+Graphics::Graphics( UINT width,UINT height )
+	:
+	width( width ),
+	height( height ),
+	imguiEnabled( false )
+{
+	UINT createFlags = 0u;
+#ifndef NDEBUG
+	createFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	HRESULT hr;
+
+	// the null driver comes with the sdk layers (graphics tools), machines without them get warp
+	if( FAILED( D3D11CreateDevice( nullptr,D3D_DRIVER_TYPE_NULL,nullptr,createFlags,nullptr,0,
+		D3D11_SDK_VERSION,&pDevice,nullptr,&pContext ) ) )
+	{
+		GFX_THROW_INFO( D3D11CreateDevice( nullptr,D3D_DRIVER_TYPE_WARP,nullptr,createFlags,nullptr,0,
+			D3D11_SDK_VERSION,&pDevice,nullptr,&pContext ) );
+	}
+
+	// offscreen stand-in for the back buffer
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+	wrl::ComPtr<ID3D11Texture2D> pBackBuffer;
+	GFX_THROW_INFO( pDevice->CreateTexture2D( &textureDesc,nullptr,&pBackBuffer ) );
+	InitContext( pBackBuffer.Get() );
+}
+
+void Graphics::InitContext( ID3D11Texture2D* pBackBuffer )
+{
+	// d3d11.1 constant buffer features (partial updates, binding by offset), left off on 11.0 runtimes
+	if( SUCCEEDED( pContext.As( &pContext1 ) ) )
+	{
+		if( FAILED( pDevice->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS,&options,sizeof( options ) ) ) )
+		{
+			options = {};
+		}
+	}
+	if( pContext1 && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer )
+	{
+		pConstantRing = std::make_unique<Bind::ConstantRingBuffer>( *this );
+	}
+
+	// mid grey: neutral as a colour and a flat normal once MapNormal rebuilds z
+	{
+		HRESULT hr;
+		const unsigned int grey = 0xFF808080u;
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = 1;
+		textureDesc.Height = 1;
+		textureDesc.MipLevels = 1;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		D3D11_SUBRESOURCE_DATA data = {};
+		data.pSysMem = &grey;
+		data.SysMemPitch = sizeof( grey );
+		wrl::ComPtr<ID3D11Texture2D> pTexture;
+		GFX_THROW_INFO( pDevice->CreateTexture2D( &textureDesc,&data,&pTexture ) );
+		GFX_THROW_INFO( pDevice->CreateShaderResourceView( pTexture.Get(),nullptr,&pPlaceholderView ) );
+	}
+
+	pTarget = std::shared_ptr<Bind::RenderTarget>{ new Bind::OutputOnlyRenderTarget( *this,pBackBuffer ) };
+
 	// viewport always fullscreen (for now)
 	D3D11_VIEWPORT vp;
 	vp.Width = (float)width;
@@ -78,18 +160,19 @@ Graphics::Graphics( HWND hWnd,int width,int height )
 	vp.TopLeftX = 0.0f;
 	vp.TopLeftY = 0.0f;
 	pContext->RSSetViewports( 1u,&vp );
-	
-	// init imgui d3d impl
-	ImGui_ImplDX11_Init( pDevice.Get(),pContext.Get() );
 }
 
 Graphics::~Graphics()
 {
-	ImGui_ImplDX11_Shutdown();
+	if( !IsHeadless() )
+	{
+		ImGui_ImplDX11_Shutdown();
+	}
 }
 
 void Graphics::EndFrame()
 {
+	TRACE_ZONE( "Graphics::EndFrame" );
 	// imgui frame end
 	if( imguiEnabled )
 	{
@@ -101,7 +184,7 @@ void Graphics::EndFrame()
 #ifndef NDEBUG
 	infoManager.Set();
 #endif
-	if( FAILED( hr = pSwap->Present( 1u,0u ) ) )
+	if( !IsHeadless() && FAILED( hr = pSwap->Present( 1u,0u ) ) )
 	{
 		if( hr == DXGI_ERROR_DEVICE_REMOVED )
 		{
@@ -112,10 +195,18 @@ void Graphics::EndFrame()
 			throw GFX_EXCEPT( hr );
 		}
 	}
+	if( pConstantRing )
+	{
+		pConstantRing->EndFrame( *this );
+	}
+	lastStats = stats;
+	stats = {};
+	frameIndex++;
 }
 
 void Graphics::BeginFrame( float red,float green,float blue ) noexcept
 {
+	TRACE_ZONE( "Graphics::BeginFrame" );
 	// imgui begin frame
 	if( imguiEnabled )
 	{
@@ -152,9 +243,18 @@ void Graphics::ClearConstantBuffers(UINT slot) noexcept
 
 void Graphics::DrawIndexed( UINT count ) noxnd
 {
+	stats.draws++;
+	stats.indices += count;
 	GFX_THROW_INFO_ONLY( pContext->DrawIndexed( count,0u,0u ) );
 }
 
+void Graphics::DrawIndexed( UINT count,UINT startIndex,INT baseVertex ) noxnd
+{
+	stats.draws++;
+	stats.indices += count;
+	GFX_THROW_INFO_ONLY( pContext->DrawIndexed( count,startIndex,baseVertex ) );
+}
+
 void Graphics::SetProjection( DirectX::FXMMATRIX proj ) noexcept
 {
 	projection = proj;
@@ -177,7 +277,8 @@ DirectX::XMMATRIX Graphics::GetCamera() const noexcept
 
 void Graphics::EnableImgui() noexcept
 {
-	imguiEnabled = true;
+	// headless devices never set imgui up
+	imguiEnabled = !IsHeadless();
 }
 
 void Graphics::DisableImgui() noexcept
@@ -219,6 +320,53 @@ float Graphics::GetFOV() const noexcept
 {
 	return mFOV;
 }
+
+void Graphics::CountConstantUpload( size_t bytes ) noexcept
+{
+	stats.constantUploads++;
+	stats.constantBytes += bytes;
+}
+
+void Graphics::CountBind( const Bind::Bindable& bind ) noexcept
+{
+	stats.binds++;
+	stats.bindsByType[FrameStats::GetBindType( typeid( bind ) )]++;
+}
+
+FrameStats& Graphics::GetStatsCounters() noexcept
+{
+	return stats;
+}
+
+const FrameStats& Graphics::GetStatsCounters() const noexcept
+{
+	return stats;
+}
+
+const FrameStats& Graphics::GetFrameStats() const noexcept
+{
+	return lastStats;
+}
+
+bool Graphics::IsHeadless() const noexcept
+{
+	return pSwap == nullptr;
+}
+
+std::uint64_t Graphics::GetFrameIndex() const noexcept
+{
+	return frameIndex;
+}
+
+Bind::ConstantRingBuffer* Graphics::GetConstantRing() noexcept
+{
+	return pConstantRing.get();
+}
+
+ID3D11ShaderResourceView* Graphics::GetPlaceholderView() const noexcept
+{
+	return pPlaceholderView.Get();
+}
 // Graphics exception stuff
 Graphics::HrException::HrException( int line,const char* file,HRESULT hr,std::vector<std::string> infoMsgs ) noexcept
 	:
@@ -1,7 +1,7 @@
 #pragma once
 #include "ChiliWin.h"
 #include "ChiliException.h"
-#include <d3d11.h>
+#include <d3d11_1.h>
 #include "ChiliWRL.h"
 #include <vector>
 #include "DxgiInfoManager.h"
@@ -9,7 +9,9 @@
 #include <DirectXMath.h>
 #include <memory>
 #include <random>
+#include <cstdint>
 #include "ConditionalNoexcept.h"
+#include "FrameStats.h"
 
 #define USE_DEFERRED
 
@@ -17,6 +19,7 @@ namespace Bind
 {
 	class Bindable;
 	class RenderTarget;
+	class ConstantRingBuffer;
 }
 
 class Graphics
@@ -61,12 +64,16 @@ public:
 	};
 public:
 	Graphics( HWND hWnd,int width,int height );
+	// device without a window for benchmarks and tools: d3d's null driver (or warp), no swap chain, no imgui,
+	// and an offscreen target in place of the back buffer
+	Graphics( UINT width,UINT height );
 	Graphics( const Graphics& ) = delete;
 	Graphics& operator=( const Graphics& ) = delete;
 	~Graphics();
 	void EndFrame();
 	void BeginFrame( float red,float green,float blue ) noexcept;
 	void DrawIndexed( UINT count ) noxnd;
+	void DrawIndexed( UINT count,UINT startIndex,INT baseVertex ) noxnd;
 	void SetProjection( DirectX::FXMMATRIX proj ) noexcept;
 	DirectX::XMMATRIX GetProjection() const noexcept;
 	void SetCamera( DirectX::FXMMATRIX cam ) noexcept;
@@ -82,6 +89,22 @@ public:
 	void ClearConstantBuffers(UINT slot) noexcept;
 	void SetFOV(float FOV) noexcept;
 	float GetFOV() const noexcept;
+	void CountConstantUpload( size_t bytes ) noexcept;
+	void CountBind( const Bind::Bindable& bind ) noexcept;
+	// counters of the frame being recorded, for the code issuing work to add to
+	FrameStats& GetStatsCounters() noexcept;
+	const FrameStats& GetStatsCounters() const noexcept;
+	// totals of the last presented frame
+	const FrameStats& GetFrameStats() const noexcept;
+	// frames presented so far, i.e. the index of the frame being recorded
+	std::uint64_t GetFrameIndex() const noexcept;
+	// this device's ring for per-draw constants, null when it can't bind constant buffers by offset
+	Bind::ConstantRingBuffer* GetConstantRing() noexcept;
+	// 1x1 mid grey on this device, bound by textures whose pixels are still streaming in
+	ID3D11ShaderResourceView* GetPlaceholderView() const noexcept;
+	bool IsHeadless() const noexcept;
+private:
+	void InitContext( ID3D11Texture2D* pBackBuffer );
 private:
 	UINT width;
 	UINT height;
@@ -95,7 +118,15 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11Device> pDevice;
 	Microsoft::WRL::ComPtr<IDXGISwapChain> pSwap;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> pContext;
+	// null, and no options, on d3d11.0 runtimes
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> pContext1;
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	std::uint64_t frameIndex = 0u;
 	std::shared_ptr<Bind::RenderTarget> pTarget;
+	std::unique_ptr<Bind::ConstantRingBuffer> pConstantRing;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pPlaceholderView;
+	FrameStats stats;
+	FrameStats lastStats;
 public:
 	bool isWireFrame = false;
 	bool isTAA;
@@ -7,6 +7,16 @@ ID3D11DeviceContext* GraphicsResource::GetContext( Graphics& gfx ) noexcept
 	return gfx.pContext.Get();
 }
 
+ID3D11DeviceContext1* GraphicsResource::GetContext1( Graphics& gfx ) noexcept
+{
+	return gfx.pContext1.Get();
+}
+
+const D3D11_FEATURE_DATA_D3D11_OPTIONS& GraphicsResource::GetOptions( Graphics& gfx ) noexcept
+{
+	return gfx.options;
+}
+
 ID3D11Device* GraphicsResource::GetDevice( Graphics& gfx ) noexcept
 {
 	return gfx.pDevice.Get();
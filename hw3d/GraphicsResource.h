@@ -7,6 +7,10 @@ class GraphicsResource
 {
 protected:
 	static ID3D11DeviceContext* GetContext( Graphics& gfx ) noexcept;
+	// null on d3d11.0 runtimes
+	static ID3D11DeviceContext1* GetContext1( Graphics& gfx ) noexcept;
+	// d3d11.1 optional features, all false on 11.0 runtimes
+	static const D3D11_FEATURE_DATA_D3D11_OPTIONS& GetOptions( Graphics& gfx ) noexcept;
 	static ID3D11Device* GetDevice( Graphics& gfx ) noexcept;
 	static DxgiInfoManager& GetInfoManager( Graphics& gfx );
 };
\ No newline at end of file
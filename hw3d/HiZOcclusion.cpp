@@ -0,0 +1,339 @@
+#include "HiZOcclusion.h"
+#include "DepthStencil.h"
+#include "GraphicsThrowMacros.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cassert>
+
+namespace dx = DirectX;
+
+// HiZPyramid
+void HiZPyramid::Build( const float* pDepth,unsigned int width,unsigned int height,unsigned int baseWidth,unsigned int baseHeight )
+{
+	assert( pDepth != nullptr && width > 0 && height > 0 );
+	baseWidth = std::clamp( baseWidth,1u,width );
+	baseHeight = std::clamp( baseHeight,1u,height );
+
+	levels.clear();
+	// base level: each texel takes the max over every source pixel it overlaps (even partially)
+	{
+		Level base{ baseWidth,baseHeight,std::vector<float>( size_t( baseWidth ) * baseHeight ) };
+		for( unsigned int by = 0; by < baseHeight; by++ )
+		{
+			const unsigned int y0 = (unsigned int)( (unsigned long long)by * height / baseHeight );
+			const unsigned int y1 = std::max( y0 + 1,(unsigned int)( ((unsigned long long)(by + 1) * height + baseHeight - 1) / baseHeight ) );
+			for( unsigned int bx = 0; bx < baseWidth; bx++ )
+			{
+				const unsigned int x0 = (unsigned int)( (unsigned long long)bx * width / baseWidth );
+				const unsigned int x1 = std::max( x0 + 1,(unsigned int)( ((unsigned long long)(bx + 1) * width + baseWidth - 1) / baseWidth ) );
+				float farthest = 0.0f;
+				for( unsigned int y = y0; y < y1; y++ )
+				{
+					const float* pRow = pDepth + size_t( y ) * width;
+					for( unsigned int x = x0; x < x1; x++ )
+					{
+						farthest = std::max( farthest,pRow[x] );
+					}
+				}
+				base.texels[size_t( by ) * baseWidth + bx] = farthest;
+			}
+		}
+		levels.push_back( std::move( base ) );
+	}
+	// coarser levels: texel (x,y) of level k covers base texels [x<<k,(x+1)<<k)
+	while( levels.back().width > 1 || levels.back().height > 1 )
+	{
+		const auto& src = levels.back();
+		Level dst{ (src.width + 1) / 2,(src.height + 1) / 2,{} };
+		dst.texels.resize( size_t( dst.width ) * dst.height );
+		for( unsigned int y = 0; y < dst.height; y++ )
+		{
+			const unsigned int sy0 = y * 2;
+			const unsigned int sy1 = std::min( sy0 + 1,src.height - 1 );
+			for( unsigned int x = 0; x < dst.width; x++ )
+			{
+				const unsigned int sx0 = x * 2;
+				const unsigned int sx1 = std::min( sx0 + 1,src.width - 1 );
+				dst.texels[size_t( y ) * dst.width + x] = std::max(
+					std::max( src.texels[size_t( sy0 ) * src.width + sx0],src.texels[size_t( sy0 ) * src.width + sx1] ),
+					std::max( src.texels[size_t( sy1 ) * src.width + sx0],src.texels[size_t( sy1 ) * src.width + sx1] )
+				);
+			}
+		}
+		levels.push_back( std::move( dst ) );
+	}
+}
+
+void HiZPyramid::Clear() noexcept
+{
+	levels.clear();
+}
+
+bool HiZPyramid::IsEmpty() const noexcept
+{
+	return levels.empty();
+}
+
+bool HiZPyramid::IsOccluded( const ScreenRect& rect,float depthBias ) const noexcept
+{
+	if( levels.empty() )
+	{
+		return false;
+	}
+	// the depth outside the captured view is unknown, so only fully contained rects can be culled
+	if( rect.minX < -1.0f || rect.maxX > 1.0f || rect.minY < -1.0f || rect.maxY > 1.0f ||
+		rect.minX > rect.maxX || rect.minY > rect.maxY )
+	{
+		return false;
+	}
+
+	const auto& base = levels.front();
+	const auto toTexel = []( float t,unsigned int size )
+	{
+		return std::min( (unsigned int)( std::max( t,0.0f ) * size ),size - 1 );
+	};
+	// ndc y is up, texel rows go down
+	const unsigned int x0 = toTexel( rect.minX * 0.5f + 0.5f,base.width );
+	const unsigned int x1 = toTexel( rect.maxX * 0.5f + 0.5f,base.width );
+	const unsigned int y0 = toTexel( 0.5f - rect.maxY * 0.5f,base.height );
+	const unsigned int y1 = toTexel( 0.5f - rect.minY * 0.5f,base.height );
+
+	// pick the finest level where the footprint spans at most 4x4 texels
+	// (2x2 is the classic choice but loses too much precision to texel alignment)
+	unsigned int level = 0;
+	while( level + 1 < levels.size() &&
+		((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3) )
+	{
+		level++;
+	}
+
+	const auto& lv = levels[level];
+	float farthest = 0.0f;
+	for( unsigned int y = y0 >> level; y <= (y1 >> level); y++ )
+	{
+		for( unsigned int x = x0 >> level; x <= (x1 >> level); x++ )
+		{
+			farthest = std::max( farthest,lv.texels[size_t( y ) * lv.width + x] );
+		}
+	}
+	return rect.minDepth > farthest + depthBias;
+}
+
+unsigned int HiZPyramid::GetLevelCount() const noexcept
+{
+	return (unsigned int)levels.size();
+}
+
+unsigned int HiZPyramid::GetWidth( unsigned int level ) const noexcept
+{
+	return levels[level].width;
+}
+
+unsigned int HiZPyramid::GetHeight( unsigned int level ) const noexcept
+{
+	return levels[level].height;
+}
+
+float HiZPyramid::Fetch( unsigned int level,unsigned int x,unsigned int y ) const noexcept
+{
+	const auto& lv = levels[level];
+	assert( x < lv.width && y < lv.height );
+	return lv.texels[size_t( y ) * lv.width + x];
+}
+
+
+// HiZOcclusion
+HiZOcclusion::HiZOcclusion( Graphics& gfx,unsigned int baseWidth,unsigned int baseHeight )
+	:
+	baseWidth( baseWidth ),
+	baseHeight( baseHeight )
+{
+	dx::XMStoreFloat4x4( &pyramidViewProj,dx::XMMatrixIdentity() );
+}
+
+void HiZOcclusion::Capture( Graphics& gfx,const Bind::DepthStencil& depth,DirectX::FXMMATRIX viewProj )
+{
+	if( !enabled )
+	{
+		return;
+	}
+	auto& slot = ring[writeIndex];
+	if( slot.pending )
+	{
+		// reader fell behind the whole ring, drop the oldest capture
+		readIndex = (writeIndex + 1) % ringSize;
+	}
+	depth.CopyToStaging( gfx,slot.pStaging );
+	dx::XMStoreFloat4x4( &slot.viewProj,viewProj );
+	slot.pending = true;
+	writeIndex = (writeIndex + 1) % ringSize;
+}
+
+void HiZOcclusion::Update( Graphics& gfx,DirectX::FXMMATRIX viewProj )
+{
+	INFOMAN( gfx );
+
+	lastStats = stats;
+	stats = {};
+
+	if( !enabled )
+	{
+		active = false;
+		pyramid.Clear();
+		for( auto& r : ring )
+		{
+			r.pending = false;
+		}
+		readIndex = writeIndex;
+		return;
+	}
+
+	// consume every capture that the gpu has finished with, never waiting on one that hasn't
+	while( ring[readIndex].pending )
+	{
+		auto& slot = ring[readIndex];
+		D3D11_MAPPED_SUBRESOURCE msr = {};
+		hr = GetContext( gfx )->Map( slot.pStaging.Get(),0,D3D11_MAP_READ,D3D11_MAP_FLAG_DO_NOT_WAIT,&msr );
+		if( hr == DXGI_ERROR_WAS_STILL_DRAWING )
+		{
+			break;
+		}
+		if( FAILED( hr ) )
+		{
+			throw GFX_EXCEPT( hr );
+		}
+
+		D3D11_TEXTURE2D_DESC desc;
+		slot.pStaging->GetDesc( &desc );
+		depthScratch.resize( size_t( desc.Width ) * desc.Height );
+		const auto pSrcBytes = static_cast<const char*>(msr.pData);
+		for( unsigned int y = 0; y < desc.Height; y++ )
+		{
+			const auto pSrcRow = pSrcBytes + msr.RowPitch * size_t( y );
+			auto pDstRow = depthScratch.data() + size_t( y ) * desc.Width;
+			if( desc.Format == DXGI_FORMAT_R24G8_TYPELESS )
+			{
+				const auto pRaw = reinterpret_cast<const unsigned int*>(pSrcRow);
+				for( unsigned int x = 0; x < desc.Width; x++ )
+				{
+					pDstRow[x] = float( pRaw[x] & 0xFFFFFF ) / float( 0xFFFFFF );
+				}
+			}
+			else
+			{
+				std::copy_n( reinterpret_cast<const float*>(pSrcRow),desc.Width,pDstRow );
+			}
+		}
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->Unmap( slot.pStaging.Get(),0 ) );
+
+		pyramid.Build( depthScratch.data(),desc.Width,desc.Height,baseWidth,baseHeight );
+		pyramidViewProj = slot.viewProj;
+		ExtractView( dx::XMLoadFloat4x4( &pyramidViewProj ),pyramidEye,pyramidForward );
+		slot.pending = false;
+		readIndex = (readIndex + 1) % ringSize;
+	}
+
+	if( pyramid.IsEmpty() )
+	{
+		active = false;
+		return;
+	}
+
+	// disocclusion fallback: geometry hidden in the captured frame may be exposed
+	// once the view has moved far enough, so stop culling until a fresh capture arrives
+	dx::XMFLOAT3 eye;
+	dx::XMFLOAT3 forward;
+	ExtractView( viewProj,eye,forward );
+	const auto moved = dx::XMVectorGetX( dx::XMVector3Length(
+		dx::XMVectorSubtract( dx::XMLoadFloat3( &eye ),dx::XMLoadFloat3( &pyramidEye ) )
+	) );
+	const auto turned = dx::XMVectorGetX( dx::XMVector3Dot(
+		dx::XMLoadFloat3( &forward ),dx::XMLoadFloat3( &pyramidForward )
+	) );
+	active = moved <= maxTranslation && turned >= maxRotationCos;
+}
+
+bool HiZOcclusion::IsVisible( const DirectX::BoundingBox& worldBounds ) const noexcept
+{
+	if( !active )
+	{
+		return true;
+	}
+	stats.tested++;
+	HiZPyramid::ScreenRect rect;
+	if( !ProjectBounds( worldBounds,dx::XMLoadFloat4x4( &pyramidViewProj ),rect ) )
+	{
+		return true;
+	}
+	if( pyramid.IsOccluded( rect,depthBias ) )
+	{
+		stats.culled++;
+		return false;
+	}
+	return true;
+}
+
+bool HiZOcclusion::ProjectBounds( const DirectX::BoundingBox& worldBounds,DirectX::FXMMATRIX viewProj,HiZPyramid::ScreenRect& rect ) noexcept
+{
+	dx::XMFLOAT3 corners[dx::BoundingBox::CORNER_COUNT];
+	worldBounds.GetCorners( corners );
+	rect = { FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,FLT_MAX };
+	for( const auto& c : corners )
+	{
+		dx::XMFLOAT4 clip;
+		dx::XMStoreFloat4( &clip,dx::XMVector3Transform( dx::XMLoadFloat3( &c ),viewProj ) );
+		// a corner at or behind the eye plane makes the projected rect unbounded
+		if( clip.w <= 1e-5f )
+		{
+			return false;
+		}
+		const auto invW = 1.0f / clip.w;
+		rect.minX = std::min( rect.minX,clip.x * invW );
+		rect.maxX = std::max( rect.maxX,clip.x * invW );
+		rect.minY = std::min( rect.minY,clip.y * invW );
+		rect.maxY = std::max( rect.maxY,clip.y * invW );
+		rect.minDepth = std::min( rect.minDepth,clip.z * invW );
+	}
+	rect.minDepth = std::max( rect.minDepth,0.0f );
+	return true;
+}
+
+void HiZOcclusion::ExtractView( DirectX::FXMMATRIX viewProj,DirectX::XMFLOAT3& pos,DirectX::XMFLOAT3& forward ) noexcept
+{
+	// center of the near plane and the direction to the center of the far plane
+	const auto inv = dx::XMMatrixInverse( nullptr,viewProj );
+	const auto nearPoint = dx::XMVector3TransformCoord( dx::XMVectorSet( 0.0f,0.0f,0.0f,1.0f ),inv );
+	const auto farPoint = dx::XMVector3TransformCoord( dx::XMVectorSet( 0.0f,0.0f,1.0f,1.0f ),inv );
+	dx::XMStoreFloat3( &pos,nearPoint );
+	dx::XMStoreFloat3( &forward,dx::XMVector3Normalize( dx::XMVectorSubtract( farPoint,nearPoint ) ) );
+}
+
+const HiZPyramid& HiZOcclusion::GetPyramid() const noexcept
+{
+	return pyramid;
+}
+
+const HiZOcclusion::Stats& HiZOcclusion::GetStats() const noexcept
+{
+	return lastStats;
+}
+
+bool HiZOcclusion::IsActive() const noexcept
+{
+	return active;
+}
+
+void HiZOcclusion::SpawnControlWindow() noexcept
+{
+	if( ImGui::Begin( "Occlusion" ) )
+	{
+		ImGui::Checkbox( "Hi-Z Culling",&enabled );
+		ImGui::SliderFloat( "Max Translation",&maxTranslation,0.0f,5.0f,"%.2f" );
+		ImGui::SliderFloat( "Depth Bias",&depthBias,0.0f,0.01f,"%.4f" );
+		ImGui::Text( "Active: %s",active ? "yes" : "no (fallback)" );
+		ImGui::Text( "Tested: %u  Culled: %u",lastStats.tested,lastStats.culled );
+	}
+	ImGui::End();
+}
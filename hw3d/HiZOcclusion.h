@@ -0,0 +1,104 @@
+#pragma once
+#include "Graphics.h"
+#include "GraphicsResource.h"
+#include <DirectXCollision.h>
+#include <vector>
+#include <array>
+
+namespace Bind
+{
+	class DepthStencil;
+}
+
+// CPU reference hierarchical-z pyramid
+// every texel stores the farthest depth of the base texels it covers, so a screen
+// rect whose nearest depth lies behind all texels it touches is guaranteed hidden
+class HiZPyramid
+{
+public:
+	// rect in ndc space (y up) of the capture frame, depth in [0,1] with 0 at the near plane
+	struct ScreenRect
+	{
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+		float minDepth;
+	};
+public:
+	// pDepth is width * height depth values, row major with row 0 at the top
+	void Build( const float* pDepth,unsigned int width,unsigned int height,unsigned int baseWidth,unsigned int baseHeight );
+	void Clear() noexcept;
+	bool IsEmpty() const noexcept;
+	// conservative: anything that cannot be proven hidden is reported as not occluded
+	bool IsOccluded( const ScreenRect& rect,float depthBias = 0.0f ) const noexcept;
+	unsigned int GetLevelCount() const noexcept;
+	unsigned int GetWidth( unsigned int level ) const noexcept;
+	unsigned int GetHeight( unsigned int level ) const noexcept;
+	float Fetch( unsigned int level,unsigned int x,unsigned int y ) const noexcept;
+private:
+	struct Level
+	{
+		unsigned int width;
+		unsigned int height;
+		std::vector<float> texels;
+	};
+	std::vector<Level> levels;
+};
+
+// occlusion culling against the depth of a previous frame
+// masterDepth is copied into a ring of staging textures after the graph executes,
+// and read back a couple of frames later (without stalling) to build the pyramid;
+// mesh bounds are projected with the view-projection of the frame that produced
+// the depth, so the test stays valid while the camera moves a little
+class HiZOcclusion : public GraphicsResource
+{
+public:
+	struct Stats
+	{
+		unsigned int tested = 0u;
+		unsigned int culled = 0u;
+	};
+public:
+	HiZOcclusion( Graphics& gfx,unsigned int baseWidth = 320u,unsigned int baseHeight = 180u );
+	// call after the render graph has executed, viewProj is the matrix the depth was rendered with
+	void Capture( Graphics& gfx,const Bind::DepthStencil& depth,DirectX::FXMMATRIX viewProj );
+	// call before submission, picks up any finished readback and decides whether culling is safe this frame
+	void Update( Graphics& gfx,DirectX::FXMMATRIX viewProj );
+	bool IsVisible( const DirectX::BoundingBox& worldBounds ) const noexcept;
+	// projects a world space box with viewProj, returns false when the box cannot be reduced to a rect
+	static bool ProjectBounds( const DirectX::BoundingBox& worldBounds,DirectX::FXMMATRIX viewProj,HiZPyramid::ScreenRect& rect ) noexcept;
+	const HiZPyramid& GetPyramid() const noexcept;
+	const Stats& GetStats() const noexcept;
+	bool IsActive() const noexcept;
+	void SpawnControlWindow() noexcept;
+private:
+	static void ExtractView( DirectX::FXMMATRIX viewProj,DirectX::XMFLOAT3& pos,DirectX::XMFLOAT3& forward ) noexcept;
+public:
+	bool enabled = true;
+	// disocclusion fallback: culling is skipped when the camera moved further than this since the capture
+	float maxTranslation = 0.5f;
+	float maxRotationCos = 0.995f;
+	float depthBias = 0.0005f;
+private:
+	static constexpr size_t ringSize = 3u;
+	struct Readback
+	{
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> pStaging;
+		DirectX::XMFLOAT4X4 viewProj;
+		bool pending = false;
+	};
+	std::array<Readback,ringSize> ring;
+	size_t writeIndex = 0u;
+	size_t readIndex = 0u;
+	unsigned int baseWidth;
+	unsigned int baseHeight;
+	HiZPyramid pyramid;
+	std::vector<float> depthScratch;
+	DirectX::XMFLOAT4X4 pyramidViewProj;
+	DirectX::XMFLOAT3 pyramidEye = { 0.0f,0.0f,0.0f };
+	DirectX::XMFLOAT3 pyramidForward = { 0.0f,0.0f,1.0f };
+	bool active = false;
+	mutable Stats stats;
+	Stats lastStats;
+};
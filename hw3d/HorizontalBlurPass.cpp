@@ -32,9 +32,7 @@ namespace Rgph
 	// the container of bindables (mainly because vector growth buggers references)
 	void HorizontalBlurPass::Execute( Graphics& gfx ) const noxnd
 	{
-		auto buf = direction->GetBuffer();
-		buf["isHorizontal"] = true;
-		direction->SetBuffer( buf );
+		direction->EditBuffer()["isHorizontal"] = true;
 
 		direction->Bind( gfx );
 		FullscreenPass::Execute( gfx );
@@ -1,6 +1,7 @@
 #include "IndexBuffer.h"
 #include "GraphicsThrowMacros.h"
 #include "BindableCodex.h"
+#include <algorithm>
 
 namespace Bind
 {
@@ -9,9 +10,47 @@ namespace Bind
 		IndexBuffer( gfx,"?",indices )
 	{}
 	IndexBuffer::IndexBuffer( Graphics& gfx,std::string tag,const std::vector<unsigned short>& indices )
+		:
+		tag( tag ),
+		count( (UINT)indices.size() ),
+		format( DXGI_FORMAT_R16_UINT )
+	{
+		Create( gfx,indices.data(),sizeof( unsigned short ) );
+	}
+	IndexBuffer::IndexBuffer( Graphics& gfx,const std::vector<unsigned int>& indices )
+		:
+		IndexBuffer( gfx,"?",indices )
+	{}
+	IndexBuffer::IndexBuffer( Graphics& gfx,std::string tag,const std::vector<unsigned int>& indices )
 		:
 		tag( tag ),
 		count( (UINT)indices.size() )
+	{
+		// half the memory and bandwidth whenever the mesh is small enough
+		if( indices.empty() || *std::max_element( indices.begin(),indices.end() ) <= 0xFFFF )
+		{
+			format = DXGI_FORMAT_R16_UINT;
+			const std::vector<unsigned short> narrow( indices.begin(),indices.end() );
+			Create( gfx,narrow.data(),sizeof( unsigned short ) );
+		}
+		else
+		{
+			format = DXGI_FORMAT_R32_UINT;
+			Create( gfx,indices.data(),sizeof( unsigned int ) );
+		}
+	}
+
+	IndexBuffer::IndexBuffer( Graphics& gfx,std::string tag,DXGI_FORMAT format,const void* pIndices,UINT count )
+		:
+		tag( tag ),
+		count( count ),
+		format( format )
+	{
+		assert( format == DXGI_FORMAT_R16_UINT || format == DXGI_FORMAT_R32_UINT );
+		Create( gfx,pIndices,format == DXGI_FORMAT_R16_UINT ? sizeof( unsigned short ) : sizeof( unsigned int ) );
+	}
+
+	void IndexBuffer::Create( Graphics& gfx,const void* pIndices,UINT stride )
 	{
 		INFOMAN( gfx );
 
@@ -20,36 +59,69 @@ namespace Bind
 		ibd.Usage = D3D11_USAGE_DEFAULT;
 		ibd.CPUAccessFlags = 0u;
 		ibd.MiscFlags = 0u;
-		ibd.ByteWidth = UINT( count * sizeof( unsigned short ) );
-		ibd.StructureByteStride = sizeof( unsigned short );
+		ibd.ByteWidth = UINT( count * stride );
+		ibd.StructureByteStride = stride;
 		D3D11_SUBRESOURCE_DATA isd = {};
-		isd.pSysMem = indices.data();
+		isd.pSysMem = pIndices;
 		GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &ibd,&isd,&pIndexBuffer ) );
 	}
 
 	void IndexBuffer::Bind( Graphics& gfx ) noxnd
 	{
 		INFOMAN_NOHR( gfx );
-		GFX_THROW_INFO_ONLY( GetContext( gfx )->IASetIndexBuffer( pIndexBuffer.Get(),DXGI_FORMAT_R16_UINT,0u ) );
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->IASetIndexBuffer( pIndexBuffer.Get(),format,0u ) );
 	}
 
 	UINT IndexBuffer::GetCount() const noexcept
 	{
 		return count;
 	}
+	DXGI_FORMAT IndexBuffer::GetFormat() const noexcept
+	{
+		return format;
+	}
 	std::shared_ptr<IndexBuffer> IndexBuffer::Resolve( Graphics& gfx,const std::string& tag,
 			const std::vector<unsigned short>& indices )
 	{
 		assert( tag != "?" );
 		return Codex::Resolve<IndexBuffer>( gfx,tag,indices );
 	}
+	std::shared_ptr<IndexBuffer> IndexBuffer::Resolve( Graphics& gfx,const std::string& tag,
+			const std::vector<unsigned int>& indices )
+	{
+		assert( tag != "?" );
+		return Codex::Resolve<IndexBuffer>( gfx,tag,indices );
+	}
+	std::shared_ptr<IndexBuffer> IndexBuffer::Resolve( Graphics& gfx,const std::string& tag,
+			DXGI_FORMAT format,const void* pIndices,UINT count )
+	{
+		assert( tag != "?" );
+		return Codex::Resolve<IndexBuffer>( gfx,tag,format,pIndices,count );
+	}
+	std::shared_ptr<IndexBuffer> IndexBuffer::ResolveDeferred( Graphics& gfx,const std::string& tag,
+			const std::function<std::vector<unsigned int>()>& produce )
+	{
+		assert( tag != "?" );
+		return Codex::ResolveDeferred<IndexBuffer>( [&]()
+		{
+			return std::make_shared<IndexBuffer>( gfx,tag,produce() );
+		},tag );
+	}
 	std::string IndexBuffer::GenerateUID_( const std::string& tag )
 	{
 		using namespace std::string_literals;
 		return typeid(IndexBuffer).name() + "#"s + tag;
 	}
+	std::uint64_t IndexBuffer::GenerateKey_( const std::string& tag ) noexcept
+	{
+		return Codex::Hasher{ Codex::TypeKey<IndexBuffer>() }.Add( tag ).Get();
+	}
 	std::string IndexBuffer::GetUID() const noexcept
 	{
 		return GenerateUID_( tag );
 	}
+	size_t IndexBuffer::GetSizeBytes() const noexcept
+	{
+		return size_t( count ) * (format == DXGI_FORMAT_R16_UINT ? sizeof( unsigned short ) : sizeof( unsigned int ));
+	}
 }
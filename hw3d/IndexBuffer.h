@@ -1,5 +1,6 @@
 #pragma once
 #include "Bindable.h"
+#include <functional>
 
 namespace Bind
 {
@@ -8,21 +9,43 @@ namespace Bind
 	public:
 		IndexBuffer( Graphics& gfx,const std::vector<unsigned short>& indices );
 		IndexBuffer( Graphics& gfx,std::string tag,const std::vector<unsigned short>& indices );
+		// stored as 16-bit when every index fits, 32-bit otherwise
+		IndexBuffer( Graphics& gfx,const std::vector<unsigned int>& indices );
+		IndexBuffer( Graphics& gfx,std::string tag,const std::vector<unsigned int>& indices );
+		// raw indices of the given format (R16_UINT / R32_UINT), e.g. from a cooked model
+		IndexBuffer( Graphics& gfx,std::string tag,DXGI_FORMAT format,const void* pIndices,UINT count );
 		void Bind( Graphics& gfx ) noxnd override;
 		UINT GetCount() const noexcept;
+		DXGI_FORMAT GetFormat() const noexcept;
 		static std::shared_ptr<IndexBuffer> Resolve( Graphics& gfx,const std::string& tag,
 			const std::vector<unsigned short>& indices );
+		static std::shared_ptr<IndexBuffer> Resolve( Graphics& gfx,const std::string& tag,
+			const std::vector<unsigned int>& indices );
+		static std::shared_ptr<IndexBuffer> Resolve( Graphics& gfx,const std::string& tag,
+			DXGI_FORMAT format,const void* pIndices,UINT count );
+		// produce is only called when nothing is cached under tag yet
+		static std::shared_ptr<IndexBuffer> ResolveDeferred( Graphics& gfx,const std::string& tag,
+			const std::function<std::vector<unsigned int>()>& produce );
 		template<typename...Ignore>
 		static std::string GenerateUID( const std::string& tag,Ignore&&...ignore )
 		{
 			return GenerateUID_( tag );
 		}
+		template<typename...Ignore>
+		static std::uint64_t GenerateKey( const std::string& tag,Ignore&&...ignore ) noexcept
+		{
+			return GenerateKey_( tag );
+		}
 		std::string GetUID() const noexcept override;
+		size_t GetSizeBytes() const noexcept override;
 	private:
 		static std::string GenerateUID_( const std::string& tag );
+		static std::uint64_t GenerateKey_( const std::string& tag ) noexcept;
+		void Create( Graphics& gfx,const void* pIndices,UINT stride );
 	protected:
 		std::string tag;
 		UINT count;
+		DXGI_FORMAT format;
 		Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer;
 	};
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ class IndexedTriangleList
 {
 public:
 	IndexedTriangleList() = default;
-	IndexedTriangleList( Dvtx::VertexBuffer verts_in,std::vector<unsigned short> indices_in )
+	IndexedTriangleList( Dvtx::VertexBuffer verts_in,std::vector<unsigned int> indices_in )
 		:
 		vertices( std::move( verts_in ) ),
 		indices( std::move( indices_in ) )
@@ -18,9 +18,10 @@ public:
 	void Transform( DirectX::FXMMATRIX matrix )
 	{
 		using Elements = Dvtx::VertexLayout::ElementType;
-		for( int i = 0; i < vertices.Size(); i++ )
+		const auto positions = vertices.Stream<Elements::Position3D>();
+		for( size_t i = 0; i < positions.Size(); i++ )
 		{
-			auto& pos = vertices[i].Attr<Elements::Position3D>();
+			auto& pos = positions[i];
 			DirectX::XMStoreFloat3(
 				&pos,
 				DirectX::XMVector3Transform( DirectX::XMLoadFloat3( &pos ),matrix )
@@ -31,20 +32,22 @@ public:
 	{
 		using namespace DirectX;
 		using Type = Dvtx::VertexLayout::ElementType;
+		const auto positions = vertices.Stream<Type::Position3D>();
+		const auto normals = vertices.Stream<Type::Normal>();
 		for( size_t i = 0; i < indices.size(); i += 3 )
 		{
-			auto v0 = vertices[indices[i]];
-			auto v1 = vertices[indices[i + 1]];
-			auto v2 = vertices[indices[i + 2]];
-			const auto p0 = XMLoadFloat3( &v0.Attr<Type::Position3D>() );
-			const auto p1 = XMLoadFloat3( &v1.Attr<Type::Position3D>() );
-			const auto p2 = XMLoadFloat3( &v2.Attr<Type::Position3D>() );
+			const auto i0 = indices[i];
+			const auto i1 = indices[i + 1];
+			const auto i2 = indices[i + 2];
+			const auto p0 = XMLoadFloat3( &positions[i0] );
+			const auto p1 = XMLoadFloat3( &positions[i1] );
+			const auto p2 = XMLoadFloat3( &positions[i2] );
 
 			const auto n = XMVector3Normalize( XMVector3Cross( (p1 - p0),(p2 - p0) ) );
 			
-			XMStoreFloat3( &v0.Attr<Type::Normal>(),n );
-			XMStoreFloat3( &v1.Attr<Type::Normal>(),n );
-			XMStoreFloat3( &v2.Attr<Type::Normal>(),n );
+			XMStoreFloat3( &normals[i0],n );
+			XMStoreFloat3( &normals[i1],n );
+			XMStoreFloat3( &normals[i2],n );
 		}
 	}
 
@@ -52,18 +55,23 @@ public:
 	{
 		using namespace DirectX;
 		using Type = Dvtx::VertexLayout::ElementType;
+		const auto positions = vertices.Stream<Type::Position3D>();
+		const auto texcoords = vertices.Stream<Type::Texture2D>();
+		const auto tangents = vertices.Stream<Type::Tangent>();
+		const auto binormals = vertices.Stream<Type::Binormal>();
+		const auto normals = vertices.Stream<Type::Normal>();
 		for (size_t i = 0; i < indices.size(); i += 3)
 		{
-			auto v0 = vertices[indices[i]];
-			auto v1 = vertices[indices[i + 1]];
-			auto v2 = vertices[indices[i + 2]];
-			const auto p0 = XMLoadFloat3(&v0.Attr<Type::Position3D>());
-			const auto p1 = XMLoadFloat3(&v1.Attr<Type::Position3D>());
-			const auto p2 = XMLoadFloat3(&v2.Attr<Type::Position3D>());
+			const auto i0 = indices[i];
+			const auto i1 = indices[i + 1];
+			const auto i2 = indices[i + 2];
+			const auto p0 = XMLoadFloat3(&positions[i0]);
+			const auto p1 = XMLoadFloat3(&positions[i1]);
+			const auto p2 = XMLoadFloat3(&positions[i2]);
 
-			const auto t0 = XMLoadFloat2(&v0.Attr<Type::Texture2D>());
-			const auto t1 = XMLoadFloat2(&v1.Attr<Type::Texture2D>());
-			const auto t2 = XMLoadFloat2(&v2.Attr<Type::Texture2D>());
+			const auto t0 = XMLoadFloat2(&texcoords[i0]);
+			const auto t1 = XMLoadFloat2(&texcoords[i1]);
+			const auto t2 = XMLoadFloat2(&texcoords[i2]);
 
 			// Calculate the two vectors for this face.
 			XMFLOAT3 p01, p02;
@@ -90,23 +98,23 @@ public:
 			binormal.z = (t01.x * p02.z - t02.x * p01.z) * den;
 
 			const auto t = XMVector3Normalize(XMLoadFloat3(&tangent));
-			XMStoreFloat3(&v0.Attr<Type::Tangent>(), t);
-			XMStoreFloat3(&v1.Attr<Type::Tangent>(), t);
-			XMStoreFloat3(&v2.Attr<Type::Tangent>(), t);
+			XMStoreFloat3(&tangents[i0], t);
+			XMStoreFloat3(&tangents[i1], t);
+			XMStoreFloat3(&tangents[i2], t);
 
 			const auto b = XMVector3Normalize(XMLoadFloat3(&binormal));
-			XMStoreFloat3(&v0.Attr<Type::Binormal>(), b);
-			XMStoreFloat3(&v1.Attr<Type::Binormal>(), b);
-			XMStoreFloat3(&v2.Attr<Type::Binormal>(), b);
+			XMStoreFloat3(&binormals[i0], b);
+			XMStoreFloat3(&binormals[i1], b);
+			XMStoreFloat3(&binormals[i2], b);
 
 			const auto n = XMVector3Normalize(XMVector3Cross((p1 - p0), (p2 - p0)));
-			XMStoreFloat3(&v0.Attr<Type::Normal>(), n);
-			XMStoreFloat3(&v1.Attr<Type::Normal>(), n);
-			XMStoreFloat3(&v2.Attr<Type::Normal>(), n);
+			XMStoreFloat3(&normals[i0], n);
+			XMStoreFloat3(&normals[i1], n);
+			XMStoreFloat3(&normals[i2], n);
 		}
 	}
 
 public:
 	Dvtx::VertexBuffer vertices;
-	std::vector<unsigned short> indices;
+	std::vector<unsigned int> indices;
 };
\ No newline at end of file
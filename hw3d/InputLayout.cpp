@@ -44,6 +44,17 @@ namespace Bind
 		using namespace std::string_literals;
 		return typeid(InputLayout).name() + "#"s + layout.GetCode() + "#"s + vs.GetUID();
 	}
+	std::uint64_t InputLayout::GenerateKey( const Dvtx::VertexLayout& layout,const VertexShader& vs )
+	{
+		// element types and the shader path hashed as they are, no code / uid strings built per lookup
+		Codex::Hasher hasher{ Codex::TypeKey<InputLayout>() };
+		hasher.Add( layout.GetElementCount() );
+		for( size_t i = 0; i < layout.GetElementCount(); i++ )
+		{
+			hasher.Add( layout.ResolveByIndex( i ).GetType() );
+		}
+		return hasher.Add( vs.GetPath() ).Get();
+	}
 	std::string InputLayout::GetUID() const noexcept
 	{
 		using namespace std::string_literals;
@@ -17,6 +17,7 @@ namespace Bind
 		static std::shared_ptr<InputLayout> Resolve( Graphics& gfx,
 			const Dvtx::VertexLayout& layout,const VertexShader& vs );
 		static std::string GenerateUID( const Dvtx::VertexLayout& layout,const VertexShader& vs );
+		static std::uint64_t GenerateKey( const Dvtx::VertexLayout& layout,const VertexShader& vs );
 		std::string GetUID() const noexcept override;
 	protected:
 		std::string vertexShaderUID;
@@ -1,20 +1,37 @@
 #include "Job.h"
 #include "Step.h"
 #include "Drawable.h"
+#include "IndexBuffer.h"
 
 
 namespace Rgph
 {
-	Job::Job( const Step* pStep,const Drawable* pDrawable )
+	Job::Job( const Step* pStep,const Drawable* pDrawable,const DrawOverride& draw )
 		:
 		pDrawable{ pDrawable },
-		pStep{ pStep }
+		pStep{ pStep },
+		draw{ draw }
 	{}
 
-	void Job::Execute( Graphics& gfx ) const noxnd
+	bool Job::Execute( Graphics& gfx,BoundInputs& bound ) const noxnd
 	{
-		pDrawable->Bind( gfx );
+		if( draw.pRanges && draw.pRanges->empty() )
+		{
+			return false;
+		}
+		pDrawable->Bind( gfx,bound,draw.pIndices );
 		pStep->Bind( gfx );
-		gfx.DrawIndexed( pDrawable->GetIndexCount() );
+		if( draw.pRanges )
+		{
+			for( const auto& r : *draw.pRanges )
+			{
+				gfx.DrawIndexed( r.indexCount,r.startIndex,r.baseVertex );
+			}
+		}
+		else
+		{
+			gfx.DrawIndexed( draw.pIndices ? draw.pIndices->GetCount() : pDrawable->GetIndexCount() );
+		}
+		return true;
 	}
 }
\ No newline at end of file
@@ -1,19 +1,55 @@
 #pragma once
 #include "ConditionalNoexcept.h"
+#include <memory>
+#include <vector>
 
 class Drawable;
 class Graphics;
 class Step;
 
+namespace Bind
+{
+	class Bindable;
+	class IndexBuffer;
+}
+
 namespace Rgph
 {
+	struct DrawRange
+	{
+		unsigned int startIndex;
+		unsigned int indexCount;
+		// added to every index of the range (e.g. a sub-mesh of a static batch)
+		int baseVertex = 0;
+	};
+	// per-submission changes to how a drawable is drawn
+	struct DrawOverride
+	{
+		// replaces the drawable's own index buffer (e.g. a level of detail)
+		Bind::IndexBuffer* pIndices = nullptr;
+		// when set, only these slices of the index buffer are drawn (e.g. visible clusters)
+		// shared by the jobs of one submission, so submitting the drawable again cannot change them
+		std::shared_ptr<const std::vector<DrawRange>> pRanges;
+	};
+
+	// input assembler bindables the previous job of a pass left bound
+	// jobs in a row sharing buffers (sub-meshes of a batch, the codex's topology) skip rebinding them
+	struct BoundInputs
+	{
+		const Bind::Bindable* pTopology = nullptr;
+		const Bind::Bindable* pIndices = nullptr;
+		const Bind::Bindable* pVertices = nullptr;
+	};
+
 	class Job
 	{
 	public:
-		Job( const Step* pStep,const Drawable* pDrawable );
-		void Execute( Graphics& gfx ) const noxnd;
+		Job( const Step* pStep,const Drawable* pDrawable,const DrawOverride& draw = {} );
+		// false if the job had nothing to draw and was skipped
+		bool Execute( Graphics& gfx,BoundInputs& bound ) const noxnd;
 	private:
 		const class Drawable* pDrawable;
 		const class Step* pStep;
+		DrawOverride draw;
 	};
 }
\ No newline at end of file
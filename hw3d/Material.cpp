@@ -6,8 +6,95 @@
 #include "Stencil.h"
 #include <filesystem>
 #include "Channels.h"
+#include "TextureAtlas.h"
+#include "TextureArray.h"
+#include "MaterialTable.h"
+#include "VertexConverter.h"
+#include <optional>
+#include <array>
+
+namespace
+{
+	using AtlasEntries = std::array<const TextureAtlas::Entry*,TextureAtlas::slotCount>;
+	// the atlas entries of a material's albedo / mra / normal maps (null where it has none),
+	// only when every map it does have made it into an array
+	std::optional<AtlasEntries> FindAtlasEntries( const TextureAtlas* pAtlas,const aiMaterial& material,const std::string& rootPath )
+	{
+		if( !pAtlas )
+		{
+			return std::nullopt;
+		}
+		AtlasEntries entries = {};
+		bool any = false;
+		const aiTextureType types[] = { aiTextureType_DIFFUSE,aiTextureType_SPECULAR,aiTextureType_NORMALS };
+		for( unsigned int slot = 0; slot < TextureAtlas::slotCount; slot++ )
+		{
+			aiString texFileName;
+			if( material.GetTexture( types[slot],0,&texFileName ) == aiReturn_SUCCESS )
+			{
+				entries[slot] = pAtlas->Find( slot,rootPath + texFileName.C_Str() );
+				if( !entries[slot] )
+				{
+					return std::nullopt;
+				}
+				any = true;
+			}
+		}
+		if( !any )
+		{
+			return std::nullopt;
+		}
+		return entries;
+	}
+	void AddAtlasFields( Dcb::RawLayout& layout )
+	{
+		layout.Add<Dcb::Float4>( "abedoRect" );
+		layout.Add<Dcb::Float4>( "mraRect" );
+		layout.Add<Dcb::Float4>( "normalRect" );
+		layout.Add<Dcb::Float>( "abedoSlice" );
+		layout.Add<Dcb::Float>( "mraSlice" );
+		layout.Add<Dcb::Float>( "normalSlice" );
+	}
+	void SetAtlasFields( Dcb::Buffer& buf,const AtlasEntries& entries )
+	{
+		const char* rects[] = { "abedoRect","mraRect","normalRect" };
+		const char* slices[] = { "abedoSlice","mraSlice","normalSlice" };
+		for( unsigned int slot = 0; slot < TextureAtlas::slotCount; slot++ )
+		{
+			if( entries[slot] )
+			{
+				buf[rects[slot]] = entries[slot]->rect;
+				buf[slices[slot]] = entries[slot]->slice;
+			}
+			else
+			{
+				buf[rects[slot]] = DirectX::XMFLOAT4{ 0.0f,0.0f,1.0f,1.0f };
+				buf[slices[slot]] = 0.0f;
+			}
+		}
+	}
+	void AppendPBRElements( Dvtx::VertexLayout& layout,const ModelOptions& options )
+	{
+		if( options.quantizeVertices )
+		{
+			layout.Append( options.quantizePositions ? Dvtx::VertexLayout::QuantizedPosition3D : Dvtx::VertexLayout::Position3D );
+			layout.Append( Dvtx::VertexLayout::OctNormal );
+			layout.Append( Dvtx::VertexLayout::HalfTexture2D );
+			layout.Append( Dvtx::VertexLayout::OctTangent );
+		}
+		else
+		{
+			layout.Append( Dvtx::VertexLayout::Position3D );
+			layout.Append( Dvtx::VertexLayout::Normal );
+			layout.Append( Dvtx::VertexLayout::Texture2D );
+			layout.Append( Dvtx::VertexLayout::Tangent );
+			layout.Append( Dvtx::VertexLayout::Binormal );
+		}
+	}
+}
 
-Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesystem::path& path, bool IsPBR) noxnd
+Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesystem::path& path, bool IsPBR,
+	const TextureAtlas* pAtlas, const ModelOptions& options) noxnd
 	:
 	modelPath( path.string() )
 {
@@ -54,6 +141,7 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 				pscLayout.Add<Dcb::Float3>( "materialColor" );
 			}
 			step.AddBindable( Rasterizer::Resolve( gfx,hasAlpha ) );
+			twoSided = twoSided || hasAlpha;
 		}
 		// specular
 		{
@@ -135,13 +223,12 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 			Step step( "lambertian" );
 			std::string shaderCode = "PBR";
 			aiString texFileName;
+			const auto atlasEntries = FindAtlasEntries( pAtlas,material,rootPath );
 
 			// common (pre)
-			vtxLayout.Append( Dvtx::VertexLayout::Position3D );
-			vtxLayout.Append( Dvtx::VertexLayout::Normal );
-			vtxLayout.Append(Dvtx::VertexLayout::Texture2D);
-			vtxLayout.Append(Dvtx::VertexLayout::Tangent);
-			vtxLayout.Append(Dvtx::VertexLayout::Binormal);
+			AppendPBRElements( vtxLayout,options );
+			// quantized elements are decoded by their own vertex shader variants
+			const std::string vsCode = options.quantizeVertices ? "Q" : "";
 			Dcb::RawLayout pscLayout;
 
 			pscLayout.Add<Dcb::Bool>("enableAbedoMap");
@@ -156,26 +243,42 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 				if( material.GetTexture( aiTextureType_DIFFUSE,0,&texFileName ) == aiReturn_SUCCESS )
 				{
 					enableAbedoMap = true;
-					auto tex = Texture::Resolve( gfx,rootPath + texFileName.C_Str() );
-					if( tex->HasAlpha() )
+					if( atlasEntries )
+					{
+						hasAlpha = (*atlasEntries)[0]->hasAlpha;
+						step.AddBindable( (*atlasEntries)[0]->pArray );
+					}
+					else
+					{
+						auto tex = Texture::Resolve( gfx,rootPath + texFileName.C_Str() );
+						hasAlpha = tex->HasAlpha();
+						step.AddBindable( std::move( tex ) );
+					}
+					if( hasAlpha )
 					{
-						hasAlpha = true;
 						shaderCode += "Msk";
 					}
-					step.AddBindable( std::move( tex ) );
 				}
 				pscLayout.Add<Dcb::Bool>("useAbedoMap");
 				pscLayout.Add<Dcb::Float3>( "materialColor" );
 				step.AddBindable( Rasterizer::Resolve( gfx,hasAlpha ) );
+				twoSided = twoSided || hasAlpha;
 			}
 			// specular
 			{
 				if( material.GetTexture( aiTextureType_SPECULAR,0,&texFileName ) == aiReturn_SUCCESS )
 				{
 					enableMRAMap = true;
-					auto tex = Texture::Resolve( gfx,rootPath + texFileName.C_Str(),1 );
-					//hasGlossAlpha = tex->HasAlpha();
-					step.AddBindable( std::move( tex ) );
+					if( atlasEntries )
+					{
+						step.AddBindable( (*atlasEntries)[1]->pArray );
+					}
+					else
+					{
+						auto tex = Texture::Resolve( gfx,rootPath + texFileName.C_Str(),1 );
+						//hasGlossAlpha = tex->HasAlpha();
+						step.AddBindable( std::move( tex ) );
+					}
 				}
 				pscLayout.Add<Dcb::Bool>("useMetallicMap");
 				pscLayout.Add<Dcb::Bool>("useRoughnessMap");
@@ -187,21 +290,32 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 				if( material.GetTexture( aiTextureType_NORMALS,0,&texFileName ) == aiReturn_SUCCESS )
 				{
 					enableNormalMap = true;
-					step.AddBindable( Texture::Resolve( gfx,rootPath + texFileName.C_Str(),2 ) );
+					if( atlasEntries )
+					{
+						step.AddBindable( (*atlasEntries)[2]->pArray );
+					}
+					else
+					{
+						step.AddBindable( Texture::Resolve( gfx,rootPath + texFileName.C_Str(),2 ) );
+					}
 				}
 				pscLayout.Add<Dcb::Bool>("useNormalMap");
 				pscLayout.Add<Dcb::Float>("normalMapWeight");
+				if( atlasEntries )
+				{
+					AddAtlasFields( pscLayout );
+				}
 			}
 			// common (post)
 			{
 				step.AddBindable( std::make_shared<TransformCbuf>( gfx,0u ) );
-				auto pvs = VertexShader::Resolve( gfx,shaderCode + "_VS.cso" );
+				auto pvs = VertexShader::Resolve( gfx,shaderCode + vsCode + "_VS.cso" );
 				step.AddBindable( InputLayout::Resolve( gfx,vtxLayout,*pvs ) );
 				step.AddBindable( std::move( pvs ) );
-				step.AddBindable( PixelShader::Resolve( gfx,shaderCode + "_PS.cso" ) );
+				step.AddBindable( PixelShader::Resolve( gfx,shaderCode + (atlasEntries ? "Arr" : "") + "_PS.cso" ) );
 				step.AddBindable( Bind::Sampler::Resolve( gfx ) );
 				step.AddBindable(Sampler::Resolve(gfx, Sampler::Filter::Bilinear, Sampler::Address::Clamp, 1u));
-				// PS material params (cbuf)
+				// PS material params (element of the layout's material table)
 				Dcb::Buffer buf{ std::move( pscLayout ) };
 
 				buf["enableAbedoMap"] = enableAbedoMap;
@@ -219,8 +333,12 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 
 				buf["useNormalMap"] = enableNormalMap;
 				buf["normalMapWeight"] = 1.0f;
+				if( atlasEntries )
+				{
+					SetAtlasFields( buf,*atlasEntries );
+				}
 
-				step.AddBindable( std::make_unique<Bind::CachingPixelConstantBufferEx>( gfx,std::move( buf ),10u ) );
+				step.AddBindable( std::make_shared<Bind::MaterialEntry>( buf ) );
 			}
 			pbr.AddStep( std::move( step ) );
 			techniques.push_back( std::move(pbr) );
@@ -231,13 +349,11 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 			Step step("gbuffer");
 			std::string shaderCode = "PBR";
 			aiString texFileName;
+			const auto atlasEntries = FindAtlasEntries(pAtlas, material, rootPath);
 
 			// common (pre)
-			vtxLayout.Append(Dvtx::VertexLayout::Position3D);
-			vtxLayout.Append(Dvtx::VertexLayout::Normal);
-			vtxLayout.Append(Dvtx::VertexLayout::Texture2D);
-			vtxLayout.Append(Dvtx::VertexLayout::Tangent);
-			vtxLayout.Append(Dvtx::VertexLayout::Binormal);
+			AppendPBRElements(vtxLayout, options);
+			const std::string vsCode = options.quantizeVertices ? "Q" : "";
 			Dcb::RawLayout pscLayout;
 
 			pscLayout.Add<Dcb::Bool>("enableAbedoMap");
@@ -252,26 +368,42 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 				if (material.GetTexture(aiTextureType_DIFFUSE, 0, &texFileName) == aiReturn_SUCCESS)
 				{
 					enableAbedoMap = true;
-					auto tex = Texture::Resolve(gfx, rootPath + texFileName.C_Str());
-					if (tex->HasAlpha())
+					if (atlasEntries)
+					{
+						hasAlpha = (*atlasEntries)[0]->hasAlpha;
+						step.AddBindable((*atlasEntries)[0]->pArray);
+					}
+					else
+					{
+						auto tex = Texture::Resolve(gfx, rootPath + texFileName.C_Str());
+						hasAlpha = tex->HasAlpha();
+						step.AddBindable(std::move(tex));
+					}
+					if (hasAlpha)
 					{
-						hasAlpha = true;
 						shaderCode += "Msk";
 					}
-					step.AddBindable(std::move(tex));
 				}
 				pscLayout.Add<Dcb::Bool>("useAbedoMap");
 				pscLayout.Add<Dcb::Float3>("materialColor");
 				step.AddBindable(Rasterizer::Resolve(gfx, hasAlpha));
+				twoSided = twoSided || hasAlpha;
 			}
 			// specular
 			{
 				if (material.GetTexture(aiTextureType_SPECULAR, 0, &texFileName) == aiReturn_SUCCESS)
 				{
 					enableMRAMap = true;
-					auto tex = Texture::Resolve(gfx, rootPath + texFileName.C_Str(), 1);
-					//hasGlossAlpha = tex->HasAlpha();
-					step.AddBindable(std::move(tex));
+					if (atlasEntries)
+					{
+						step.AddBindable((*atlasEntries)[1]->pArray);
+					}
+					else
+					{
+						auto tex = Texture::Resolve(gfx, rootPath + texFileName.C_Str(), 1);
+						//hasGlossAlpha = tex->HasAlpha();
+						step.AddBindable(std::move(tex));
+					}
 				}
 				pscLayout.Add<Dcb::Bool>("useMetallicMap");
 				pscLayout.Add<Dcb::Bool>("useRoughnessMap");
@@ -283,21 +415,32 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 				if (material.GetTexture(aiTextureType_NORMALS, 0, &texFileName) == aiReturn_SUCCESS)
 				{
 					enableNormalMap = true;
-					step.AddBindable(Texture::Resolve(gfx, rootPath + texFileName.C_Str(), 2));
+					if (atlasEntries)
+					{
+						step.AddBindable((*atlasEntries)[2]->pArray);
+					}
+					else
+					{
+						step.AddBindable(Texture::Resolve(gfx, rootPath + texFileName.C_Str(), 2));
+					}
 				}
 				pscLayout.Add<Dcb::Bool>("useNormalMap");
 				pscLayout.Add<Dcb::Float>("normalMapWeight");
+				if (atlasEntries)
+				{
+					AddAtlasFields(pscLayout);
+				}
 			}
 			// common (post)
 			{
 				step.AddBindable(std::make_shared<TransformCbuf>(gfx, 0u));
-				auto pvs = VertexShader::Resolve(gfx, shaderCode + "NoShadow_VS.cso");
+				auto pvs = VertexShader::Resolve(gfx, shaderCode + vsCode + "NoShadow_VS.cso");
 				step.AddBindable(InputLayout::Resolve(gfx, vtxLayout, *pvs));
 				step.AddBindable(std::move(pvs));
-				step.AddBindable(PixelShader::Resolve(gfx, shaderCode + "EncodeToGbuffer.cso"));
+				step.AddBindable(PixelShader::Resolve(gfx, shaderCode + (atlasEntries ? "Arr" : "") + "EncodeToGbuffer.cso"));
 				step.AddBindable(Bind::Sampler::Resolve(gfx));
 				step.AddBindable(Sampler::Resolve(gfx, Sampler::Filter::Bilinear, Sampler::Address::Clamp, 1u));
-				// PS material params (cbuf)
+				// PS material params (dedups to the same table element as the forward technique's block)
 				Dcb::Buffer buf{ std::move(pscLayout) };
 
 				buf["enableAbedoMap"] = enableAbedoMap;
@@ -315,8 +458,12 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 
 				buf["useNormalMap"] = enableNormalMap;
 				buf["normalMapWeight"] = 1.0f;
+				if (atlasEntries)
+				{
+					SetAtlasFields(buf, *atlasEntries);
+				}
 
-				step.AddBindable(std::make_unique<Bind::CachingPixelConstantBufferEx>(gfx, std::move(buf), 10u));
+				step.AddBindable(std::make_shared<Bind::MaterialEntry>(buf));
 			}
 			pbr.AddStep(std::move(step));
 			techniques.push_back(std::move(pbr));	
@@ -377,15 +524,50 @@ Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesys
 		}
 		techniques.push_back( std::move( map ) );
 	}
+	// cooking relies on knowing the layout without building the material
+	assert( vtxLayout.GetCode() == DeriveVertexLayout( material,IsPBR,options ).GetCode() );
+}
+Dvtx::VertexLayout Material::DeriveVertexLayout( const aiMaterial& material,bool IsPBR,const ModelOptions& options ) noexcept
+{
+	Dvtx::VertexLayout layout;
+	if( IsPBR )
+	{
+		AppendPBRElements( layout,options );
+		return layout;
+	}
+	layout.Append( Dvtx::VertexLayout::Position3D );
+	layout.Append( Dvtx::VertexLayout::Normal );
+	aiString texFileName;
+	const bool hasNormalMap = material.GetTexture( aiTextureType_NORMALS,0,&texFileName ) == aiReturn_SUCCESS;
+	if( hasNormalMap ||
+		material.GetTexture( aiTextureType_DIFFUSE,0,&texFileName ) == aiReturn_SUCCESS ||
+		material.GetTexture( aiTextureType_SPECULAR,0,&texFileName ) == aiReturn_SUCCESS )
+	{
+		layout.Append( Dvtx::VertexLayout::Texture2D );
+	}
+	if( hasNormalMap )
+	{
+		layout.Append( Dvtx::VertexLayout::Tangent );
+		layout.Append( Dvtx::VertexLayout::Binormal );
+	}
+	return layout;
+}
+bool Material::IsTwoSided() const noexcept
+{
+	return twoSided;
+}
+const Dvtx::VertexLayout& Material::GetVertexLayout() const noexcept
+{
+	return vtxLayout;
 }
 Dvtx::VertexBuffer Material::ExtractVertices( const aiMesh& mesh ) const noexcept
 {
 	return { vtxLayout,mesh };
 }
-std::vector<unsigned short> Material::ExtractIndices( const aiMesh& mesh ) const noexcept
+std::vector<unsigned int> Material::ExtractIndices( const aiMesh& mesh ) const noexcept
 {
-	std::vector<unsigned short> indices;
-	indices.reserve( mesh.mNumFaces * 3 );
+	std::vector<unsigned int> indices;
+	indices.reserve( size_t( mesh.mNumFaces ) * 3 );
 	for( unsigned int i = 0; i < mesh.mNumFaces; i++ )
 	{
 		const auto& face = mesh.mFaces[i];
@@ -398,26 +580,41 @@ std::vector<unsigned short> Material::ExtractIndices( const aiMesh& mesh ) const
 }
 std::shared_ptr<Bind::VertexBuffer> Material::MakeVertexBindable( Graphics& gfx,const aiMesh& mesh,float scale ) const noxnd
 {
-	auto vtc = ExtractVertices( mesh );
-	if( scale != 1.0f )
+	// only cooked meshes (see Mesh) carry the dequantization quantized positions need
+	assert( !vtxLayout.Has( Dvtx::VertexLayout::QuantizedPosition3D ) );
+	// another instance of the model has usually built this already, only extract on a miss
+	return Bind::VertexBuffer::ResolveDeferred( gfx,MakeMeshTag( mesh ),[&]()
 	{
-		for( auto i = 0u; i < vtc.Size(); i++ )
-		{
-			DirectX::XMFLOAT3& pos = vtc[i].Attr<Dvtx::VertexLayout::ElementType::Position3D>();
-			pos.x *= scale;
-			pos.y *= scale;
-			pos.z *= scale;
-		}
-	}
-	return Bind::VertexBuffer::Resolve( gfx,MakeMeshTag( mesh ),std::move( vtc ) );
+		VertexConverter::Options conversion;
+		conversion.scale = scale;
+		return VertexConverter::Convert( vtxLayout,mesh,conversion ).vertices;
+	} );
 }
 std::shared_ptr<Bind::IndexBuffer> Material::MakeIndexBindable( Graphics& gfx,const aiMesh& mesh ) const noxnd
 {
-	return Bind::IndexBuffer::Resolve( gfx,MakeMeshTag( mesh ),ExtractIndices( mesh ) );
+	return Bind::IndexBuffer::ResolveDeferred( gfx,MakeMeshTag( mesh ),[&]()
+	{
+		return ExtractIndices( mesh );
+	} );
+}
+std::shared_ptr<Bind::VertexBuffer> Material::MakeVertexBindable( Graphics& gfx,const std::string& meshName,const char* pVertices,size_t sizeBytes ) const noxnd
+{
+	return Bind::VertexBuffer::Resolve( gfx,MakeMeshTag( meshName ),vtxLayout,pVertices,sizeBytes );
+}
+std::shared_ptr<Bind::IndexBuffer> Material::MakeIndexBindable( Graphics& gfx,const std::string& meshName,const std::string& variant,
+	const void* pIndices,UINT count,bool wide ) const noxnd
+{
+	return Bind::IndexBuffer::Resolve( gfx,MakeMeshTag( meshName ) + variant,
+		wide ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT,pIndices,count
+	);
 }
 std::string Material::MakeMeshTag( const aiMesh& mesh ) const noexcept
 {
-	return modelPath + "%" + mesh.mName.C_Str();
+	return MakeMeshTag( std::string( mesh.mName.C_Str() ) );
+}
+std::string Material::MakeMeshTag( const std::string& meshName ) const noexcept
+{
+	return modelPath + "%" + meshName;
 }
 std::vector<Technique> Material::GetTechniques() const noexcept
 {
@@ -4,9 +4,11 @@
 #include "Technique.h"
 #include "Vertex.h"
 #include <filesystem>
+#include "ModelOptions.h"
 
 struct aiMaterial;
 struct aiMesh;
+class TextureAtlas;
 
 namespace Bind
 {
@@ -17,17 +19,32 @@ namespace Bind
 class Material
 {
 public:
-	Material(Graphics& gfx, const aiMaterial& material, const std::filesystem::path& path, bool IsPBR = false) noxnd;
+	// with an atlas holding every texture of a pbr material, it samples the shared arrays instead of binding its own
+	// options.quantizeVertices / quantizePositions pick the compact vertex elements (pbr only)
+	Material(Graphics& gfx, const aiMaterial& material, const std::filesystem::path& path, bool IsPBR = false,
+		const TextureAtlas* pAtlas = nullptr, const ModelOptions& options = {}) noxnd;
 	Dvtx::VertexBuffer ExtractVertices( const aiMesh& mesh ) const noexcept;
-	std::vector<unsigned short> ExtractIndices( const aiMesh& mesh ) const noexcept;
+	std::vector<unsigned int> ExtractIndices( const aiMesh& mesh ) const noexcept;
 	std::shared_ptr<Bind::VertexBuffer> MakeVertexBindable( Graphics& gfx,const aiMesh& mesh,float scale = 1.0f ) const noxnd;
 	std::shared_ptr<Bind::IndexBuffer> MakeIndexBindable( Graphics& gfx,const aiMesh& mesh ) const noxnd;
+	// from cooked data (see CookedModel), the bytes must already be in this material's layout
+	std::shared_ptr<Bind::VertexBuffer> MakeVertexBindable( Graphics& gfx,const std::string& meshName,const char* pVertices,size_t sizeBytes ) const noxnd;
+	// variant keeps the tags of alternative index buffers (lods) apart, empty for the main one
+	std::shared_ptr<Bind::IndexBuffer> MakeIndexBindable( Graphics& gfx,const std::string& meshName,const std::string& variant,
+		const void* pIndices,UINT count,bool wide ) const noxnd;
 	std::vector<Technique> GetTechniques() const noexcept;
+	const Dvtx::VertexLayout& GetVertexLayout() const noexcept;
+	// backface culling is off (alpha tested), so both sides of its triangles are seen
+	bool IsTwoSided() const noexcept;
+	// the layout the constructor will settle on, without creating any resources
+	static Dvtx::VertexLayout DeriveVertexLayout( const aiMaterial& material,bool IsPBR,const ModelOptions& options = {} ) noexcept;
 private:
 	std::string MakeMeshTag( const aiMesh& mesh ) const noexcept;
+	std::string MakeMeshTag( const std::string& meshName ) const noexcept;
 private:
 	Dvtx::VertexLayout vtxLayout;
 	std::vector<Technique> techniques;
 	std::string modelPath;
 	std::string name;
+	bool twoSided = false;
 };
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "MaterialTable.h"
+#include "BindableCodex.h"
+#include "TechniqueProbe.h"
+#include "GraphicsThrowMacros.h"
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+
+namespace Bind
+{
+	std::shared_ptr<MaterialTable> MaterialTable::Resolve( const Dcb::LayoutElement& root )
+	{
+		auto& tables = GetTables();
+		auto& slot = tables[root.GetSignature()];
+		if( auto pTable = slot.lock() )
+		{
+			return pTable;
+		}
+		auto pTable = std::make_shared<MaterialTable>( root );
+		slot = pTable;
+		return pTable;
+	}
+
+	MaterialTable::MaterialTable( const Dcb::LayoutElement& root )
+		:
+		stride( (UINT)root.GetSizeInBytes() )
+	{
+		assert( stride % 16u == 0u );
+	}
+
+	UINT MaterialTable::Acquire( const Dcb::Buffer& buf )
+	{
+		assert( buf.GetSizeInBytes() == stride );
+		const auto hash = Hash( buf.GetData() );
+		const auto [first,last] = lookup.equal_range( hash );
+		for( auto i = first; i != last; ++i )
+		{
+			if( std::memcmp( &data[size_t( i->second ) * stride],buf.GetData(),stride ) == 0 )
+			{
+				refCounts[i->second]++;
+				return i->second;
+			}
+		}
+		UINT index;
+		if( !freeSlots.empty() )
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			index = (UINT)refCounts.size();
+			refCounts.push_back( 0u );
+			data.resize( data.size() + stride );
+		}
+		std::memcpy( &data[size_t( index ) * stride],buf.GetData(),stride );
+		refCounts[index] = 1u;
+		lookup.emplace( hash,index );
+		MarkDirty( index );
+		return index;
+	}
+
+	void MaterialTable::Release( UINT index ) noexcept
+	{
+		assert( refCounts[index] > 0u );
+		if( --refCounts[index] == 0u )
+		{
+			const auto [first,last] = lookup.equal_range( Hash( &data[size_t( index ) * stride] ) );
+			for( auto i = first; i != last; ++i )
+			{
+				if( i->second == index )
+				{
+					lookup.erase( i );
+					break;
+				}
+			}
+			// stale bytes stay on the gpu until the slot is reused, nothing reads them
+			freeSlots.push_back( index );
+		}
+	}
+
+	bool MaterialTable::Write( UINT index,const Dcb::Buffer& buf )
+	{
+		assert( buf.GetSizeInBytes() == stride );
+		if( refCounts[index] != 1u )
+		{
+			return false;
+		}
+		char* pElement = &data[size_t( index ) * stride];
+		if( std::memcmp( pElement,buf.GetData(),stride ) == 0 )
+		{
+			return true;
+		}
+		// rehash under the new contents; an edit that happens to match another element is not merged
+		const auto [first,last] = lookup.equal_range( Hash( pElement ) );
+		for( auto i = first; i != last; ++i )
+		{
+			if( i->second == index )
+			{
+				lookup.erase( i );
+				break;
+			}
+		}
+		std::memcpy( pElement,buf.GetData(),stride );
+		lookup.emplace( Hash( pElement ),index );
+		MarkDirty( index );
+		return true;
+	}
+
+	void MaterialTable::Bind( Graphics& gfx,UINT index ) noxnd
+	{
+		INFOMAN( gfx );
+		if( dirty.first != dirty.last || gpuCapacity < refCounts.size() )
+		{
+			Upload( gfx );
+		}
+		if( indexBuffers.size() < refCounts.size() )
+		{
+			indexBuffers.resize( refCounts.size() );
+		}
+		if( !indexBuffers[index] )
+		{
+			const UINT element[4] = { index,0u,0u,0u };
+			D3D11_BUFFER_DESC cbd = {};
+			cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+			cbd.Usage = D3D11_USAGE_IMMUTABLE;
+			cbd.CPUAccessFlags = 0u;
+			cbd.MiscFlags = 0u;
+			cbd.ByteWidth = sizeof( element );
+			cbd.StructureByteStride = 0u;
+			D3D11_SUBRESOURCE_DATA csd = {};
+			csd.pSysMem = element;
+			GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &cbd,&csd,&indexBuffers[index] ) );
+		}
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->PSSetShaderResources( tableSlot,1u,pView.GetAddressOf() ) );
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->PSSetConstantBuffers( indexSlot,1u,indexBuffers[index].GetAddressOf() ) );
+	}
+
+	void MaterialTable::Upload( Graphics& gfx )
+	{
+		INFOMAN( gfx );
+		const UINT count = (UINT)refCounts.size();
+		if( gpuCapacity < count )
+		{
+			// doubling keeps regrowth rare while a scene's materials stream in
+			gpuCapacity = std::max( count,gpuCapacity * 2u );
+			D3D11_BUFFER_DESC bd = {};
+			bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			bd.Usage = D3D11_USAGE_DEFAULT;
+			bd.CPUAccessFlags = 0u;
+			bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+			bd.ByteWidth = gpuCapacity * stride;
+			bd.StructureByteStride = stride;
+			pBuffer.Reset();
+			pView.Reset();
+			GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &bd,nullptr,&pBuffer ) );
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			srvDesc.Buffer.FirstElement = 0u;
+			srvDesc.Buffer.NumElements = gpuCapacity;
+			GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView( pBuffer.Get(),&srvDesc,&pView ) );
+			dirty = { 0u,count };
+		}
+		const D3D11_BOX box = { dirty.first * stride,0u,0u,dirty.last * stride,1u,1u };
+		GetContext( gfx )->UpdateSubresource( pBuffer.Get(),0u,&box,&data[size_t( dirty.first ) * stride],0u,0u );
+		stats.uploads++;
+		stats.bytesUploaded += size_t( dirty.last - dirty.first ) * stride;
+		dirty = {};
+	}
+
+	UINT MaterialTable::GetStride() const noexcept
+	{
+		return stride;
+	}
+
+	UINT MaterialTable::GetReferenceCount( UINT index ) const noexcept
+	{
+		return refCounts[index];
+	}
+
+	MaterialTable::Range MaterialTable::GetDirtyRange() const noexcept
+	{
+		return dirty;
+	}
+
+	MaterialTable::Stats MaterialTable::GetStats() const noexcept
+	{
+		auto s = stats;
+		s.entries = refCounts.size() - freeSlots.size();
+		for( auto n : refCounts )
+		{
+			s.references += n;
+		}
+		return s;
+	}
+
+	std::string MaterialTable::GetStatsReport()
+	{
+		Stats total;
+		size_t tableCount = 0u;
+		for( auto& [signature,wpTable] : GetTables() )
+		{
+			if( auto pTable = wpTable.lock() )
+			{
+				const auto s = pTable->GetStats();
+				total.entries += s.entries;
+				total.references += s.references;
+				total.uploads += s.uploads;
+				total.bytesUploaded += s.bytesUploaded;
+				tableCount++;
+			}
+		}
+		std::ostringstream oss;
+		oss << "Material tables: " << tableCount << " layouts, " << total.references << " material blocks in "
+			<< total.entries << " elements, " << total.uploads << " uploads (" << total.bytesUploaded << " bytes)\n";
+		return oss.str();
+	}
+
+	std::uint64_t MaterialTable::Hash( const char* pData ) const noexcept
+	{
+		return Codex::Hasher{}.Add( pData,stride ).Get();
+	}
+
+	void MaterialTable::MarkDirty( UINT index ) noexcept
+	{
+		if( dirty.first == dirty.last )
+		{
+			dirty = { index,index + 1u };
+		}
+		else
+		{
+			dirty.first = std::min( dirty.first,index );
+			dirty.last = std::max( dirty.last,index + 1u );
+		}
+	}
+
+	std::unordered_map<std::string,std::weak_ptr<MaterialTable>>& MaterialTable::GetTables() noexcept
+	{
+		// only touched on the render thread, where materials are built
+		static std::unordered_map<std::string,std::weak_ptr<MaterialTable>> tables;
+		return tables;
+	}
+
+
+	MaterialEntry::MaterialEntry( const Dcb::Buffer& buf )
+		:
+		pTable( MaterialTable::Resolve( buf.GetRootLayoutElement() ) ),
+		buf( buf ),
+		index( pTable->Acquire( buf ) )
+	{}
+
+	MaterialEntry::~MaterialEntry()
+	{
+		pTable->Release( index );
+	}
+
+	void MaterialEntry::Bind( Graphics& gfx ) noxnd
+	{
+		pTable->Bind( gfx,index );
+	}
+
+	void MaterialEntry::Accept( TechniqueProbe& probe )
+	{
+		if( probe.VisitBuffer( buf ) )
+		{
+			SetBuffer( buf );
+		}
+	}
+
+	const Dcb::Buffer& MaterialEntry::GetBuffer() const noexcept
+	{
+		return buf;
+	}
+
+	void MaterialEntry::SetBuffer( const Dcb::Buffer& buf_in )
+	{
+		if( &buf_in != &buf )
+		{
+			buf.CopyFrom( buf_in );
+		}
+		if( !pTable->Write( index,buf ) )
+		{
+			// copy on write, the other materials keep the old element
+			const auto old = index;
+			index = pTable->Acquire( buf );
+			pTable->Release( old );
+		}
+	}
+
+	UINT MaterialEntry::GetIndex() const noexcept
+	{
+		return index;
+	}
+}
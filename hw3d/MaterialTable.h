@@ -0,0 +1,93 @@
+#pragma once
+#include "Bindable.h"
+#include "DynamicConstant.h"
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <cstdint>
+
+namespace Bind
+{
+	// the parameter blocks of every material built with one Dcb layout, packed into a single structured buffer
+	// blocks with identical bytes share one element (found by content hash), so a draw only carries its
+	// element index (a 16 byte cbuffer per element, shared by every draw that selects it)
+	// elements are written into a cpu mirror and the dirty element range is uploaded before the next bind
+	// acquiring / writing is cpu only; the gpu buffer is created and grown on bind (render thread)
+	class MaterialTable : public GraphicsResource
+	{
+	public:
+		struct Stats
+		{
+			// live elements, and how many material blocks they stand for
+			size_t entries = 0;
+			size_t references = 0;
+			size_t uploads = 0;
+			size_t bytesUploaded = 0;
+		};
+		// half-open element range waiting for upload, empty when first == last
+		struct Range
+		{
+			UINT first = 0u;
+			UINT last = 0u;
+		};
+	public:
+		// one table per layout, alive for as long as a material uses it
+		static std::shared_ptr<MaterialTable> Resolve( const Dcb::LayoutElement& root );
+		MaterialTable( const Dcb::LayoutElement& root );
+		// element holding exactly buf's bytes, added when no element matches
+		UINT Acquire( const Dcb::Buffer& buf );
+		void Release( UINT index ) noexcept;
+		// overwrites the element in place, unless it is shared with other materials (returns false, nothing written)
+		bool Write( UINT index,const Dcb::Buffer& buf );
+		// uploads the dirty range, then binds the table and the element's index cbuffer
+		void Bind( Graphics& gfx,UINT index ) noxnd;
+		UINT GetStride() const noexcept;
+		UINT GetReferenceCount( UINT index ) const noexcept;
+		Range GetDirtyRange() const noexcept;
+		Stats GetStats() const noexcept;
+		// one line summary over every live table, for logs
+		static std::string GetStatsReport();
+	public:
+		// pixel shader slots the table and the per-draw index occupy (see PBRMaterial.hlsli)
+		static constexpr UINT tableSlot = 3u;
+		static constexpr UINT indexSlot = 10u;
+	private:
+		std::uint64_t Hash( const char* pData ) const noexcept;
+		void MarkDirty( UINT index ) noexcept;
+		void Upload( Graphics& gfx );
+		static std::unordered_map<std::string,std::weak_ptr<MaterialTable>>& GetTables() noexcept;
+	private:
+		UINT stride;
+		std::vector<char> data;
+		std::vector<UINT> refCounts;
+		std::vector<UINT> freeSlots;
+		std::unordered_multimap<std::uint64_t,UINT> lookup;
+		Range dirty;
+		Stats stats;
+		// capacity of the gpu buffer in elements, regrown (and fully reuploaded) when data outgrows it
+		UINT gpuCapacity = 0u;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pView;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> indexBuffers;
+	};
+
+	// a material's parameter block as an element of its layout's MaterialTable
+	// keeps a cpu copy for the technique probe; edits go to the element in place, or to a fresh
+	// element when other materials still share the old one
+	class MaterialEntry : public Bindable
+	{
+	public:
+		MaterialEntry( const Dcb::Buffer& buf );
+		~MaterialEntry();
+		void Bind( Graphics& gfx ) noxnd override;
+		void Accept( TechniqueProbe& probe ) override;
+		const Dcb::Buffer& GetBuffer() const noexcept;
+		void SetBuffer( const Dcb::Buffer& buf_in );
+		UINT GetIndex() const noexcept;
+	private:
+		std::shared_ptr<MaterialTable> pTable;
+		Dcb::Buffer buf;
+		UINT index;
+	};
+}
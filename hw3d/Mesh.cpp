@@ -9,23 +9,120 @@
 #include "ConstantBuffersEx.h"
 #include "LayoutCodex.h"
 #include "Stencil.h"
+#include "HiZOcclusion.h"
+#include "SubmitView.h"
+#include "Material.h"
+#include "IndexBuffer.h"
+#include "Topology.h"
 
 namespace dx = DirectX;
 
 
 // Mesh
-Mesh::Mesh( Graphics& gfx,const Material& mat,const aiMesh& mesh,float scale ) noxnd
+Mesh::Mesh( Graphics& gfx,const Material& mat,const CookedModel::MeshView& mesh ) noxnd
 	:
-	Drawable( gfx,mat,mesh,scale )
-{}
+	bounds( mesh.bounds ),
+	clusters( mesh.clusters ),
+	twoSided( mesh.twoSided || mat.IsTwoSided() )
+{
+	assert( mat.GetVertexLayout().GetCode() == mesh.layoutCode );
+	dx::XMStoreFloat4x4( &dequantize,mesh.positionQuantization ?
+		mesh.positionQuantization->GetDequantizeXM() : dx::XMMatrixIdentity()
+	);
+	pVertices = mat.MakeVertexBindable( gfx,mesh.name,mesh.pVertices,mesh.vertexBytes );
+	pIndices = mat.MakeIndexBindable( gfx,mesh.name,"",mesh.indices.pData,mesh.indices.count,mesh.indices.wide );
+	pTopology = Bind::Topology::Resolve( gfx );
+	for( auto& t : mat.GetTechniques() )
+	{
+		AddTechnique( std::move( t ) );
+	}
+
+	for( size_t i = 0; i < mesh.lods.size(); i++ )
+	{
+		const auto& lod = mesh.lods[i];
+		lods.push_back( {
+			mat.MakeIndexBindable( gfx,mesh.name,"$lod" + std::to_string( i + 1 ),lod.indices.pData,lod.indices.count,lod.indices.wide ),
+			lod.screenSize
+		} );
+	}
+}
 
-void Mesh::Submit( size_t channels,dx::FXMMATRIX accumulatedTranform ) const noxnd
+void Mesh::Submit( size_t channels,dx::FXMMATRIX accumulatedTranform,const SubmitView* pView ) const noxnd
 {
+	Bind::IndexBuffer* pLodIndices = nullptr;
+	if( pView )
+	{
+		dx::BoundingBox worldBounds;
+		bounds.Transform( worldBounds,accumulatedTranform );
+		if( pView->pOcclusion && !pView->pOcclusion->IsVisible( worldBounds ) )
+		{
+			return;
+		}
+		if( !lods.empty() )
+		{
+			const auto size = pView->ProjectedSize( worldBounds ) * pView->lodBias;
+			for( const auto& lod : lods )
+			{
+				if( size < lod.screenSize )
+				{
+					pLodIndices = lod.pIndices.get();
+				}
+			}
+		}
+	}
+	Rgph::DrawOverride draw;
+	draw.pIndices = pLodIndices;
+	// clusters only partition the full-detail level
+	if( pView && pView->cullClusters && !pLodIndices && !clusters.IsEmpty() )
+	{
+		// cull in object space: planes from world * viewProj, eye brought into the mesh's frame
+		dx::XMFLOAT4X4 objectToClip;
+		dx::XMStoreFloat4x4( &objectToClip,accumulatedTranform * dx::XMLoadFloat4x4( &pView->viewProj ) );
+		float planes[6][4];
+		MeshClusters::ExtractFrustumPlanes( objectToClip.m,planes );
+		// cones hold the object space winding, which a mirroring transform turns inside out
+		dx::XMVECTOR determinant;
+		const auto toObject = dx::XMMatrixInverse( &determinant,accumulatedTranform );
+		const bool coneCull = !twoSided && dx::XMVectorGetX( determinant ) > 0.0f;
+		dx::XMFLOAT3 eye;
+		dx::XMStoreFloat3( &eye,dx::XMVector3TransformCoord( dx::XMLoadFloat3( &pView->eyePos ),toObject ) );
+		clusters.Cull( planes,coneCull ? &eye.x : nullptr,visibleClusters );
+		if( visibleClusters.empty() )
+		{
+			return;
+		}
+		// a single range covering everything is just the normal draw
+		if( !(visibleClusters.size() == 1 && visibleClusters[0].indexCount == GetIndexCount()) )
+		{
+			auto pRanges = std::make_shared<std::vector<Rgph::DrawRange>>();
+			pRanges->reserve( visibleClusters.size() );
+			for( const auto& r : visibleClusters )
+			{
+				pRanges->push_back( { r.startIndex,r.indexCount } );
+			}
+			draw.pRanges = std::move( pRanges );
+		}
+	}
 	dx::XMStoreFloat4x4( &transform,accumulatedTranform );
-	Drawable::Submit( channels );
+	Drawable::Submit( channels,draw );
+}
+
+size_t Mesh::GetLodCount() const noexcept
+{
+	return lods.size() + 1;
+}
+
+const MeshClusters& Mesh::GetClusters() const noexcept
+{
+	return clusters;
+}
+
+const DirectX::BoundingBox& Mesh::GetBounds() const noexcept
+{
+	return bounds;
 }
 
 DirectX::XMMATRIX Mesh::GetTransformXM() const noexcept
 {
-	return DirectX::XMLoadFloat4x4( &transform );
+	return DirectX::XMLoadFloat4x4( &dequantize ) * DirectX::XMLoadFloat4x4( &transform );
 }
@@ -2,18 +2,44 @@
 #include "Graphics.h"
 #include "Drawable.h"
 #include "ConditionalNoexcept.h"
+#include <DirectXCollision.h>
+#include "MeshClusters.h"
+#include "CookedModel.h"
 
 class Material;
 class FrameCommander;
-struct aiMesh;
+struct SubmitView;
 
 
 class Mesh : public Drawable
 {
 public:
-	Mesh( Graphics& gfx,const Material& mat,const aiMesh& mesh,float scale = 1.0f ) noxnd;
+	// buffers are created straight from the cooked data, all import-time processing has already happened
+	Mesh( Graphics& gfx,const Material& mat,const CookedModel::MeshView& mesh ) noxnd;
 	DirectX::XMMATRIX GetTransformXM() const noexcept override;
-	void Submit( size_t channels,DirectX::FXMMATRIX accumulatedTranform ) const noxnd;
+	// with a view, meshes can be occlusion culled and drawn at a coarser level of detail
+	void Submit( size_t channels,DirectX::FXMMATRIX accumulatedTranform,const SubmitView* pView = nullptr ) const noxnd;
+	// object space bounds, already scaled
+	const DirectX::BoundingBox& GetBounds() const noexcept;
+	size_t GetLodCount() const noexcept;
+	const MeshClusters& GetClusters() const noexcept;
 private:
+	struct Lod
+	{
+		std::shared_ptr<Bind::IndexBuffer> pIndices;
+		// used while the projected size is below this
+		float screenSize;
+	};
 	mutable DirectX::XMFLOAT4X4 transform;
+	// identity unless the vertices hold quantized positions, applied ahead of transform when drawing only
+	DirectX::XMFLOAT4X4 dequantize;
+	DirectX::BoundingBox bounds;
+	// coarser levels sharing the vertex buffer, ordered from finest to coarsest
+	std::vector<Lod> lods;
+	// full-detail index buffer is reordered by cluster when clusters are enabled
+	MeshClusters clusters;
+	// no cone culling for these, their back faces are drawn
+	bool twoSided;
+	// scratch for culling, the ranges handed to the jobs are copied out of it
+	mutable std::vector<MeshClusters::Range> visibleClusters;
 };
\ No newline at end of file
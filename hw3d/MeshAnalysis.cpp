@@ -0,0 +1,681 @@
+#include "MeshAnalysis.h"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include "ModelException.h"
+#include "MeshSimplifier.h"
+#include "MeshClusters.h"
+#include "MeshOptimizer.h"
+#include "CookedModel.h"
+#include "Material.h"
+#include "StaticBatch.h"
+#include "VertexConverter.h"
+#include "ChiliTimer.h"
+#include <DirectXMath.h>
+
+namespace
+{
+	// same post processing as Model so the numbers match what the renderer gets
+	constexpr unsigned int importFlags =
+		aiProcess_Triangulate |
+		aiProcess_JoinIdenticalVertices |
+		aiProcess_ConvertToLeftHanded |
+		aiProcess_GenNormals |
+		aiProcess_CalcTangentSpace;
+
+	const aiScene* LoadScene( Assimp::Importer& imp,const std::string& modelPath )
+	{
+		const auto pScene = imp.ReadFile( modelPath.c_str(),importFlags );
+		if( pScene == nullptr )
+		{
+			throw ModelException( __LINE__,__FILE__,imp.GetErrorString() );
+		}
+		return pScene;
+	}
+
+	std::vector<unsigned int> ExtractIndices( const aiMesh& mesh )
+	{
+		std::vector<unsigned int> indices;
+		indices.reserve( size_t( mesh.mNumFaces ) * 3 );
+		for( unsigned int i = 0; i < mesh.mNumFaces; i++ )
+		{
+			const auto& face = mesh.mFaces[i];
+			indices.insert( indices.end(),face.mIndices,face.mIndices + face.mNumIndices );
+		}
+		return indices;
+	}
+
+	// min and median of a set of timings
+	std::pair<float,float> Summarize( std::vector<float> seconds )
+	{
+		std::sort( seconds.begin(),seconds.end() );
+		return { seconds.front(),seconds[seconds.size() / 2] };
+	}
+}
+
+void MeshAnalysis::ReportLods( const std::string& modelPath,const std::string& reportPath,unsigned int lodCount,float reduction,float maxError )
+{
+	Assimp::Importer imp;
+	const auto pScene = LoadScene( imp,modelPath );
+
+	std::ofstream report( reportPath );
+	report << "lod report: " << modelPath << std::endl
+		<< "levels " << lodCount << "  reduction " << reduction << "  max error " << maxError << std::endl << std::endl
+		<< std::left << std::setw( 32 ) << "mesh" << std::right
+		<< std::setw( 5 ) << "lod" << std::setw( 10 ) << "tris" << std::setw( 9 ) << "ratio"
+		<< std::setw( 12 ) << "error" << std::setw( 11 ) << "ms" << std::endl;
+
+	size_t totalSource = 0;
+	std::vector<size_t> totalPerLevel( lodCount,0 );
+	float totalSeconds = 0.0f;
+	for( unsigned int m = 0; m < pScene->mNumMeshes; m++ )
+	{
+		const auto& mesh = *pScene->mMeshes[m];
+		const auto indices = ExtractIndices( mesh );
+		ChiliTimer timer;
+		const auto chain = MeshSimplifier::BuildLodChain(
+			&mesh.mVertices[0].x,mesh.mNumVertices,sizeof( aiVector3D ),indices,lodCount,reduction,maxError
+		);
+		const auto seconds = timer.Peek();
+		totalSeconds += seconds;
+
+		const auto sourceTris = indices.size() / 3;
+		totalSource += sourceTris;
+		totalPerLevel[0] += sourceTris;
+		report << std::left << std::setw( 32 ) << mesh.mName.C_Str() << std::right
+			<< std::setw( 5 ) << 0 << std::setw( 10 ) << sourceTris << std::setw( 9 ) << "1.000"
+			<< std::setw( 12 ) << "0" << std::setw( 11 ) << std::fixed << std::setprecision( 2 ) << seconds * 1000.0f << std::endl;
+		for( size_t l = 1; l < lodCount; l++ )
+		{
+			if( l > chain.size() )
+			{
+				// the chain stopped early, the renderer keeps drawing its coarsest level
+				totalPerLevel[l] += chain.empty() ? sourceTris : chain.back().indices.size() / 3;
+				continue;
+			}
+			const auto& level = chain[l - 1];
+			const auto tris = level.indices.size() / 3;
+			totalPerLevel[l] += tris;
+			report << std::left << std::setw( 32 ) << "" << std::right
+				<< std::setw( 5 ) << l << std::setw( 10 ) << tris
+				<< std::setw( 9 ) << std::setprecision( 3 ) << float( tris ) / float( sourceTris )
+				<< std::setw( 12 ) << std::setprecision( 5 ) << level.error << std::endl;
+		}
+	}
+
+	report << std::endl << "totals" << std::endl;
+	for( size_t l = 0; l < lodCount; l++ )
+	{
+		report << "  lod " << l << ": " << totalPerLevel[l] << " tris ("
+			<< std::setprecision( 3 ) << float( totalPerLevel[l] ) / float( std::max( totalSource,size_t( 1 ) ) ) << ")" << std::endl;
+	}
+	report << "  simplification time: " << std::setprecision( 1 ) << totalSeconds * 1000.0f << " ms, "
+		<< std::setprecision( 0 ) << float( totalSource ) / std::max( totalSeconds,1e-6f ) << " source tris/s" << std::endl;
+}
+
+void MeshAnalysis::ReportVertexCache( const std::string& modelPath,const std::string& reportPath,unsigned int cacheSize,
+	unsigned int vertexSize,float overdrawThreshold )
+{
+	Assimp::Importer imp;
+	const auto pScene = LoadScene( imp,modelPath );
+
+	std::ofstream report( reportPath );
+	report << "vertex cache report: " << modelPath << std::endl
+		<< "fifo " << cacheSize << "  vertex size " << vertexSize << " bytes  overdraw threshold " << overdrawThreshold << std::endl << std::endl
+		<< std::left << std::setw( 32 ) << "mesh" << std::right
+		<< std::setw( 10 ) << "tris" << std::setw( 16 ) << "acmr" << std::setw( 16 ) << "atvr"
+		<< std::setw( 18 ) << "overfetch" << std::setw( 10 ) << "ms" << std::endl;
+
+	struct Totals
+	{
+		float misses = 0.0f;
+		float fetched = 0.0f;
+	};
+	Totals before;
+	Totals after;
+	size_t totalTris = 0;
+	size_t totalVerts = 0;
+	float totalSeconds = 0.0f;
+	for( unsigned int m = 0; m < pScene->mNumMeshes; m++ )
+	{
+		auto& mesh = *pScene->mMeshes[m];
+		const auto original = ExtractIndices( mesh );
+		const auto cacheBefore = MeshOptimizer::AnalyzeVertexCache( original,mesh.mNumVertices,cacheSize );
+		const auto fetchBefore = MeshOptimizer::AnalyzeVertexFetch( original,mesh.mNumVertices,vertexSize );
+
+		ChiliTimer timer;
+		if( !MeshOptimizer::Optimize( mesh,overdrawThreshold ) )
+		{
+			report << std::left << std::setw( 32 ) << mesh.mName.C_Str() << std::right << "  skipped, not a plain triangle list" << std::endl;
+			continue;
+		}
+		const auto seconds = timer.Peek();
+		const auto optimized = ExtractIndices( mesh );
+		const auto cacheAfter = MeshOptimizer::AnalyzeVertexCache( optimized,mesh.mNumVertices,cacheSize );
+		const auto fetchAfter = MeshOptimizer::AnalyzeVertexFetch( optimized,mesh.mNumVertices,vertexSize );
+
+		const auto tris = original.size() / 3;
+		totalTris += tris;
+		totalVerts += mesh.mNumVertices;
+		totalSeconds += seconds;
+		before.misses += cacheBefore.acmr * tris;
+		after.misses += cacheAfter.acmr * tris;
+		before.fetched += fetchBefore.overfetch * mesh.mNumVertices;
+		after.fetched += fetchAfter.overfetch * mesh.mNumVertices;
+		report << std::left << std::setw( 32 ) << mesh.mName.C_Str() << std::right
+			<< std::setw( 10 ) << tris << std::fixed << std::setprecision( 3 )
+			<< std::setw( 8 ) << cacheBefore.acmr << std::setw( 8 ) << cacheAfter.acmr
+			<< std::setw( 8 ) << cacheBefore.atvr << std::setw( 8 ) << cacheAfter.atvr
+			<< std::setw( 9 ) << fetchBefore.overfetch << std::setw( 9 ) << fetchAfter.overfetch
+			<< std::setw( 10 ) << std::setprecision( 2 ) << seconds * 1000.0f << std::endl;
+	}
+
+	// acmr weighted by triangles, atvr and overfetch by vertices (near enough to referenced vertices after import)
+	const auto tris = float( std::max( totalTris,size_t( 1 ) ) );
+	const auto verts = float( std::max( totalVerts,size_t( 1 ) ) );
+	report << std::endl << "totals: " << totalTris << " tris, " << totalVerts << " verts" << std::endl << std::setprecision( 3 )
+		<< "  acmr      " << before.misses / tris << " -> " << after.misses / tris << std::endl
+		<< "  atvr      " << before.misses / verts << " -> " << after.misses / verts << std::endl
+		<< "  overfetch " << before.fetched / verts << " -> " << after.fetched / verts << std::endl
+		<< "  optimization time: " << std::setprecision( 1 ) << totalSeconds * 1000.0f << " ms" << std::endl;
+}
+
+void MeshAnalysis::ReportClusters( const std::string& modelPath,const std::string& reportPath,unsigned int maxVertices,unsigned int maxTriangles,
+	unsigned int views,float distance )
+{
+	namespace dx = DirectX;
+	Assimp::Importer imp;
+	const auto pScene = LoadScene( imp,modelPath );
+
+	struct Entry
+	{
+		MeshClusters clusters;
+		float center[3];
+		float radius;
+		size_t triangles;
+	};
+	std::vector<Entry> entries;
+	float lo[3] = { FLT_MAX,FLT_MAX,FLT_MAX };
+	float hi[3] = { -FLT_MAX,-FLT_MAX,-FLT_MAX };
+	size_t totalTris = 0;
+	size_t totalClusters = 0;
+	ChiliTimer buildTimer;
+	for( unsigned int m = 0; m < pScene->mNumMeshes; m++ )
+	{
+		const auto& mesh = *pScene->mMeshes[m];
+		auto indices = ExtractIndices( mesh );
+		Entry e;
+		e.clusters = MeshClusters::Build( &mesh.mVertices[0].x,mesh.mNumVertices,sizeof( aiVector3D ),indices,maxVertices,maxTriangles );
+		e.triangles = indices.size() / 3;
+		float mlo[3] = { FLT_MAX,FLT_MAX,FLT_MAX };
+		float mhi[3] = { -FLT_MAX,-FLT_MAX,-FLT_MAX };
+		for( unsigned int v = 0; v < mesh.mNumVertices; v++ )
+		{
+			const float* p = &mesh.mVertices[v].x;
+			for( int k = 0; k < 3; k++ )
+			{
+				mlo[k] = std::min( mlo[k],p[k] );
+				mhi[k] = std::max( mhi[k],p[k] );
+			}
+		}
+		float r2 = 0.0f;
+		for( int k = 0; k < 3; k++ )
+		{
+			e.center[k] = (mlo[k] + mhi[k]) * 0.5f;
+			r2 += (mhi[k] - e.center[k]) * (mhi[k] - e.center[k]);
+			lo[k] = std::min( lo[k],mlo[k] );
+			hi[k] = std::max( hi[k],mhi[k] );
+		}
+		e.radius = std::sqrt( r2 );
+		totalTris += e.triangles;
+		totalClusters += e.clusters.GetClusters().size();
+		entries.push_back( std::move( e ) );
+	}
+	const auto buildSeconds = buildTimer.Peek();
+
+	const auto center = dx::XMVectorSet( (lo[0] + hi[0]) * 0.5f,(lo[1] + hi[1]) * 0.5f,(lo[2] + hi[2]) * 0.5f,1.0f );
+	const auto sceneRadius = dx::XMVectorGetX( dx::XMVector3Length( dx::XMVectorSubtract( dx::XMVectorSet( hi[0],hi[1],hi[2],1.0f ),center ) ) );
+	const auto proj = dx::XMMatrixPerspectiveFovLH( dx::XM_PI / 3.0f,16.0f / 9.0f,sceneRadius * 0.005f,sceneRadius * 4.0f );
+
+	std::ofstream report( reportPath );
+	report << "cluster report: " << modelPath << std::endl
+		<< "max vertices " << maxVertices << "  max triangles " << maxTriangles << "  views " << views << "  distance " << distance << std::endl
+		<< pScene->mNumMeshes << " meshes, " << totalTris << " tris, " << totalClusters << " clusters ("
+		<< std::fixed << std::setprecision( 1 ) << float( totalTris ) / float( std::max( totalClusters,size_t( 1 ) ) ) << " tris/cluster), built in "
+		<< std::setprecision( 2 ) << buildSeconds * 1000.0f << " ms" << std::endl << std::endl
+		<< std::setw( 5 ) << "view" << std::setw( 12 ) << "mesh cull" << std::setw( 14 ) << "frustum clus" << std::setw( 12 ) << "cone clus"
+		<< std::setw( 12 ) << "drawn" << std::setw( 10 ) << "saved" << std::setw( 11 ) << "mesh us" << std::setw( 12 ) << "cluster us" << std::endl;
+
+	size_t sumMeshDrawn = 0;
+	size_t sumClusterDrawn = 0;
+	float sumMeshSeconds = 0.0f;
+	float sumClusterSeconds = 0.0f;
+	std::vector<MeshClusters::Range> ranges;
+	std::vector<const Entry*> meshVisible;
+	for( unsigned int v = 0; v < views; v++ )
+	{
+		const auto yaw = dx::XM_2PI * float( v ) / float( views );
+		const auto eye = dx::XMVectorAdd( center,dx::XMVectorScale(
+			dx::XMVectorSet( std::cos( yaw ),0.25f,std::sin( yaw ),0.0f ),sceneRadius * distance
+		) );
+		// looking across the middle rather than at it so part of the scene is always out of view
+		const auto target = dx::XMVectorAdd( center,dx::XMVectorScale( dx::XMVectorSet( -std::sin( yaw ),0.0f,std::cos( yaw ),0.0f ),sceneRadius * 0.25f ) );
+		dx::XMFLOAT4X4 viewProj;
+		dx::XMStoreFloat4x4( &viewProj,dx::XMMatrixLookAtLH( eye,target,dx::XMVectorSet( 0.0f,1.0f,0.0f,0.0f ) ) * proj );
+		float planes[6][4];
+		MeshClusters::ExtractFrustumPlanes( viewProj.m,planes );
+		dx::XMFLOAT3 eyePos;
+		dx::XMStoreFloat3( &eyePos,eye );
+
+		// whole-mesh bounding sphere culling, what the renderer does without clusters
+		ChiliTimer timer;
+		meshVisible.clear();
+		size_t meshDrawn = 0;
+		for( const auto& e : entries )
+		{
+			bool outside = false;
+			for( int p = 0; p < 6 && !outside; p++ )
+			{
+				outside = planes[p][0] * e.center[0] + planes[p][1] * e.center[1] + planes[p][2] * e.center[2] + planes[p][3] < -e.radius;
+			}
+			if( !outside )
+			{
+				meshVisible.push_back( &e );
+				meshDrawn += e.triangles;
+			}
+		}
+		const auto meshSeconds = timer.Mark();
+
+		MeshClusters::CullStats stats;
+		for( const auto pEntry : meshVisible )
+		{
+			pEntry->clusters.Cull( planes,&eyePos.x,ranges,&stats );
+		}
+		const auto clusterSeconds = timer.Peek();
+
+		sumMeshDrawn += meshDrawn;
+		sumClusterDrawn += stats.trianglesDrawn;
+		sumMeshSeconds += meshSeconds;
+		sumClusterSeconds += clusterSeconds;
+		report << std::setw( 5 ) << v
+			<< std::setw( 12 ) << totalTris - meshDrawn
+			<< std::setw( 14 ) << stats.frustumCulled << std::setw( 12 ) << stats.coneCulled
+			<< std::setw( 12 ) << stats.trianglesDrawn
+			<< std::setw( 9 ) << std::setprecision( 1 ) << 100.0f * float( meshDrawn - stats.trianglesDrawn ) / float( std::max( meshDrawn,size_t( 1 ) ) ) << "%"
+			<< std::setw( 11 ) << std::setprecision( 1 ) << meshSeconds * 1e6f
+			<< std::setw( 12 ) << clusterSeconds * 1e6f << std::endl;
+	}
+
+	const auto n = float( std::max( views,1u ) );
+	report << std::endl << "averages per view" << std::endl
+		<< "  whole-mesh culling: " << std::setprecision( 0 ) << float( sumMeshDrawn ) / n << " tris drawn, "
+		<< std::setprecision( 1 ) << sumMeshSeconds * 1e6f / n << " us" << std::endl
+		<< "  cluster culling:    " << std::setprecision( 0 ) << float( sumClusterDrawn ) / n << " tris drawn, "
+		<< std::setprecision( 1 ) << sumClusterSeconds * 1e6f / n << " us on top" << std::endl
+		<< "  extra triangles culled by clusters: " << std::setprecision( 0 ) << float( sumMeshDrawn - sumClusterDrawn ) / n
+		<< " (" << std::setprecision( 1 ) << 100.0f * float( sumMeshDrawn - sumClusterDrawn ) / float( std::max( sumMeshDrawn,size_t( 1 ) ) ) << "%), "
+		<< std::setprecision( 0 ) << float( sumMeshDrawn - sumClusterDrawn ) / std::max( sumClusterSeconds,1e-9f ) << " tris removed per cpu second" << std::endl;
+}
+
+void MeshAnalysis::BenchmarkCookedLoad( const std::string& modelPath,const std::string& reportPath,unsigned int iterations,
+	float scale,bool isPBR )
+{
+	iterations = std::max( iterations,1u );
+	const ModelOptions options;
+	const auto cachePath = CookedModel::MakeCachePath( modelPath );
+
+	std::vector<float> coldImport;
+	std::vector<float> coldCook;
+	std::vector<float> coldSave;
+	size_t cookedBytes = 0;
+	size_t meshCount = 0;
+	size_t vertexCount = 0;
+	for( unsigned int i = 0; i < iterations; i++ )
+	{
+		ChiliTimer timer;
+		const auto key = CookedModel::MakeKey( modelPath,importFlags,scale,isPBR,options );
+		Assimp::Importer imp;
+		const auto pScene = LoadScene( imp,modelPath );
+		coldImport.push_back( timer.Mark() );
+
+		std::vector<Dvtx::VertexLayout> layouts;
+		for( unsigned int m = 0; m < pScene->mNumMaterials; m++ )
+		{
+			layouts.push_back( Material::DeriveVertexLayout( *pScene->mMaterials[m],isPBR ) );
+		}
+		const auto pCooked = CookedModel::Cook( *pScene,layouts,scale,options,key );
+		coldCook.push_back( timer.Mark() );
+
+		pCooked->Save( cachePath );
+		coldSave.push_back( timer.Mark() );
+
+		cookedBytes = pCooked->GetSizeBytes();
+		meshCount = pCooked->GetMeshes().size();
+		vertexCount = 0;
+		for( const auto& mesh : pCooked->GetMeshes() )
+		{
+			vertexCount += mesh.vertexCount;
+		}
+	}
+
+	std::vector<float> warmKey;
+	std::vector<float> warmLoad;
+	unsigned int checksum = 0u;
+	for( unsigned int i = 0; i < iterations; i++ )
+	{
+		ChiliTimer timer;
+		const auto key = CookedModel::MakeKey( modelPath,importFlags,scale,isPBR,options );
+		warmKey.push_back( timer.Mark() );
+
+		const auto pCooked = CookedModel::Load( cachePath,key );
+		if( !pCooked )
+		{
+			throw ModelException( __LINE__,__FILE__,"Freshly written cooked model failed to load: " + cachePath );
+		}
+		// a page at a time is enough to fault in what the gpu upload would read
+		for( const auto& mesh : pCooked->GetMeshes() )
+		{
+			for( size_t b = 0; b < mesh.vertexBytes; b += 4096 )
+			{
+				checksum += (unsigned char)mesh.pVertices[b];
+			}
+		}
+		warmLoad.push_back( timer.Mark() );
+	}
+
+	const auto import = Summarize( coldImport );
+	const auto cook = Summarize( coldCook );
+	const auto save = Summarize( coldSave );
+	const auto hash = Summarize( warmKey );
+	const auto load = Summarize( warmLoad );
+	const auto coldTotal = import.second + cook.second + save.second;
+	const auto warmTotal = hash.second + load.second;
+
+	std::ofstream report( reportPath );
+	report << "cooked load benchmark: " << modelPath << std::endl
+		<< "iterations " << iterations << "  scale " << scale << "  pbr " << isPBR << std::endl
+		<< "source " << std::filesystem::file_size( modelPath ) << " bytes, cooked " << cookedBytes << " bytes, "
+		<< meshCount << " meshes, " << vertexCount << " vertices (checksum " << checksum << ")" << std::endl << std::endl
+		<< std::left << std::setw( 24 ) << "stage" << std::right << std::setw( 12 ) << "min ms" << std::setw( 12 ) << "median ms" << std::endl
+		<< std::fixed << std::setprecision( 2 );
+	const auto row = [&report]( const char* name,std::pair<float,float> t )
+	{
+		report << std::left << std::setw( 24 ) << name << std::right
+			<< std::setw( 12 ) << t.first * 1000.0f << std::setw( 12 ) << t.second * 1000.0f << std::endl;
+	};
+	row( "cold: assimp import",import );
+	row( "cold: cook",cook );
+	row( "cold: write cache",save );
+	row( "warm: hash source",hash );
+	row( "warm: map + touch",load );
+	report << std::endl << "median cold " << coldTotal * 1000.0f << " ms, warm " << warmTotal * 1000.0f << " ms, "
+		<< std::setprecision( 1 ) << coldTotal / std::max( warmTotal,1e-6f ) << "x" << std::endl;
+}
+
+void MeshAnalysis::ReportStaticBatching( const std::string& modelPath,const std::string& reportPath,unsigned int maxVertices,
+	float scale,bool isPBR )
+{
+	const ModelOptions options;
+	Assimp::Importer imp;
+	const auto pScene = LoadScene( imp,modelPath );
+	std::vector<Dvtx::VertexLayout> layouts;
+	for( unsigned int m = 0; m < pScene->mNumMaterials; m++ )
+	{
+		layouts.push_back( Material::DeriveVertexLayout( *pScene->mMaterials[m],isPBR ) );
+	}
+	const auto pCooked = CookedModel::Cook( *pScene,layouts,scale,options,0u );
+
+	ChiliTimer timer;
+	const auto batches = StaticBatch::Build( *pCooked,maxVertices );
+	const auto buildSeconds = timer.Mark();
+	const auto stats = StaticBatch::Analyze( batches,pCooked->GetMeshes().size() );
+
+	std::ofstream report( reportPath );
+	report << "static batching report: " << modelPath << std::endl
+		<< "max vertices per mesh " << maxVertices << std::endl << std::endl
+		<< std::setw( 9 ) << "material" << std::setw( 8 ) << "meshes" << std::setw( 10 ) << "vertices"
+		<< std::setw( 10 ) << "indices" << std::setw( 10 ) << "segments" << std::endl;
+	for( const auto& b : batches )
+	{
+		size_t segments = 0;
+		int lastBase = -1;
+		for( const auto& sub : b.subMeshes )
+		{
+			if( sub.baseVertex != lastBase )
+			{
+				segments++;
+				lastBase = sub.baseVertex;
+			}
+		}
+		report << std::setw( 9 ) << b.materialIndex << std::setw( 8 ) << b.subMeshes.size() << std::setw( 10 ) << b.vertexCount
+			<< std::setw( 10 ) << b.indices.size() << std::setw( 10 ) << segments << std::endl;
+	}
+	report << std::endl << StaticBatch::Report( stats )
+		<< "built in " << buildSeconds * 1000.0f << " ms" << std::endl;
+}
+
+void MeshAnalysis::ReportVertexQuantization( const std::string& modelPath,const std::string& reportPath,unsigned int iterations )
+{
+	namespace dx = DirectX;
+	using Dvtx::VertexLayout;
+	iterations = std::max( iterations,1u );
+	Assimp::Importer imp;
+	const auto pScene = LoadScene( imp,modelPath );
+	const aiMaterial dummy;
+
+	struct Config
+	{
+		const char* name;
+		ModelOptions options;
+	};
+	ModelOptions attributes;
+	attributes.quantizeVertices = true;
+	ModelOptions positions = attributes;
+	positions.quantizePositions = true;
+	const Config configs[] = { { "float",{} },{ "quantized",attributes },{ "quantized + positions",positions } };
+	// meshes without uvs get no tangent frame, every pbr layout needs one
+	const auto complete = []( const aiMesh& mesh )
+	{
+		return mesh.HasNormals() && mesh.HasTangentsAndBitangents() && mesh.HasTextureCoords( 0 );
+	};
+
+	std::ofstream report( reportPath );
+	report << "vertex quantization report: " << modelPath << std::endl
+		<< pScene->mNumMeshes << " meshes, iterations " << iterations << std::endl << std::endl
+		<< std::left << std::setw( 24 ) << "layout" << std::right << std::setw( 8 ) << "bytes" << std::setw( 14 ) << "total KB"
+		<< std::setw( 10 ) << "saved" << std::setw( 14 ) << "encode ms" << std::endl
+		<< std::fixed << std::setprecision( 2 );
+	size_t floatBytes = 0;
+	for( const auto& config : configs )
+	{
+		// only the layout matters here, pbr layouts do not depend on the material
+		const auto layout = Material::DeriveVertexLayout( dummy,true,config.options );
+		size_t bytes = 0;
+		std::vector<float> times;
+		for( unsigned int i = 0; i < iterations; i++ )
+		{
+			bytes = 0;
+			ChiliTimer timer;
+			for( unsigned int m = 0; m < pScene->mNumMeshes; m++ )
+			{
+				if( complete( *pScene->mMeshes[m] ) )
+				{
+					bytes += Dvtx::VertexBuffer{ layout,*pScene->mMeshes[m] }.SizeBytes();
+				}
+			}
+			times.push_back( timer.Mark() );
+		}
+		if( floatBytes == 0 )
+		{
+			floatBytes = bytes;
+		}
+		report << std::left << std::setw( 24 ) << config.name << std::right << std::setw( 8 ) << layout.Size()
+			<< std::setw( 14 ) << bytes / 1024.0f << std::setw( 9 ) << 100.0f * (1.0f - float( bytes ) / float( floatBytes )) << "%"
+			<< std::setw( 14 ) << Summarize( times ).second * 1000.0f << std::endl;
+	}
+
+	// worst case over the whole model, decoded the same way QuantizedVertex.hlsli does
+	const auto layout = Material::DeriveVertexLayout( dummy,true,positions );
+	const auto angle = []( const aiVector3D& a,const dx::XMFLOAT3& b )
+	{
+		const float la = a.Length();
+		return la == 0.0f ? 0.0f : std::acos( std::clamp( (a.x * b.x + a.y * b.y + a.z * b.z) / la,-1.0f,1.0f ) ) * 57.2957795f;
+	};
+	float normalError = 0.0f;
+	float tangentError = 0.0f;
+	float uvError = 0.0f;
+	float uvMagnitude = 0.0f;
+	float positionError = 0.0f;
+	float positionRange = 0.0f;
+	size_t signFlips = 0;
+	for( unsigned int m = 0; m < pScene->mNumMeshes; m++ )
+	{
+		const auto& mesh = *pScene->mMeshes[m];
+		if( !complete( mesh ) )
+		{
+			continue;
+		}
+		const Dvtx::VertexBuffer vertices{ layout,mesh };
+		const auto quantization = Dvtx::PositionQuantization::FromMesh( mesh );
+		positionRange = std::max( positionRange,quantization.range );
+		for( unsigned int i = 0; i < mesh.mNumVertices; i++ )
+		{
+			const auto v = vertices[i];
+			normalError = std::max( normalError,angle( mesh.mNormals[i],Dvtx::UnpackOctNormal( v.Attr<VertexLayout::OctNormal>() ) ) );
+			float sign;
+			tangentError = std::max( tangentError,angle( mesh.mTangents[i],Dvtx::UnpackOctTangent( v.Attr<VertexLayout::OctTangent>(),sign ) ) );
+			if( sign < 0.0f )
+			{
+				signFlips++;
+			}
+			dx::XMFLOAT2 uv;
+			dx::XMStoreFloat2( &uv,dx::PackedVector::XMLoadHalf2( &v.Attr<VertexLayout::HalfTexture2D>() ) );
+			const auto& srcUv = mesh.mTextureCoords[0][i];
+			uvError = std::max( { uvError,std::abs( uv.x - srcUv.x ),std::abs( uv.y - srcUv.y ) } );
+			uvMagnitude = std::max( { uvMagnitude,std::abs( srcUv.x ),std::abs( srcUv.y ) } );
+			const auto p = quantization.Dequantize( v.Attr<VertexLayout::QuantizedPosition3D>() );
+			const auto& src = mesh.mVertices[i];
+			positionError = std::max( { positionError,std::abs( p.x - src.x ),std::abs( p.y - src.y ),std::abs( p.z - src.z ) } );
+		}
+	}
+	report << std::endl << std::setprecision( 5 )
+		<< "normal error        " << normalError << " deg" << std::endl
+		<< "tangent error       " << tangentError << " deg (" << signFlips << " mirrored frames)" << std::endl
+		// half precision falls off with magnitude, tiling uvs far outside [0,1] lose texels
+		<< "uv error            " << uvError << " (largest |uv| " << uvMagnitude << ")" << std::endl
+		<< "position error      " << positionError << " model units (largest mesh " << positionRange << ")" << std::endl;
+}
+
+void MeshAnalysis::BenchmarkVertexConversion( const std::string& modelPath,const std::string& reportPath,unsigned int iterations,
+	float scale,unsigned int threads )
+{
+	using Dvtx::VertexLayout;
+	iterations = std::max( iterations,1u );
+	Assimp::Importer imp;
+	const auto pScene = LoadScene( imp,modelPath );
+	const aiMaterial dummy;
+	std::vector<const aiMesh*> meshes;
+	size_t vertexCount = 0;
+	for( unsigned int m = 0; m < pScene->mNumMeshes; m++ )
+	{
+		const auto& mesh = *pScene->mMeshes[m];
+		// meshes without uvs get no tangent frame, every pbr layout needs one
+		if( mesh.HasNormals() && mesh.HasTangentsAndBitangents() && mesh.HasTextureCoords( 0 ) )
+		{
+			meshes.push_back( &mesh );
+			vertexCount += mesh.mNumVertices;
+		}
+	}
+
+	struct Config
+	{
+		const char* name;
+		ModelOptions options;
+	};
+	ModelOptions quantized;
+	quantized.quantizeVertices = true;
+	quantized.quantizePositions = true;
+	const Config configs[] = { { "float",{} },{ "quantized",quantized } };
+
+	std::ofstream report( reportPath );
+	report << "vertex conversion benchmark: " << modelPath << std::endl
+		<< meshes.size() << " meshes, " << vertexCount << " vertices, scale " << scale
+		<< ", iterations " << iterations << " (median)" << std::endl << std::endl
+		<< std::left << std::setw( 12 ) << "layout" << std::setw( 20 ) << "path" << std::right
+		<< std::setw( 12 ) << "ms" << std::setw( 12 ) << "ns/vertex" << std::setw( 10 ) << "speedup" << std::setw( 8 ) << "match" << std::endl
+		<< std::fixed;
+	for( const auto& config : configs )
+	{
+		const auto layout = Material::DeriveVertexLayout( dummy,true,config.options );
+		const bool quantizedPositions = layout.Has( VertexLayout::QuantizedPosition3D );
+
+		std::vector<Dvtx::VertexBuffer> reference;
+		std::vector<float> times;
+		for( unsigned int i = 0; i < iterations; i++ )
+		{
+			reference.clear();
+			ChiliTimer timer;
+			for( const auto pMesh : meshes )
+			{
+				auto& vertices = reference.emplace_back( layout,*pMesh );
+				if( !quantizedPositions && scale != 1.0f )
+				{
+					const auto positions = vertices.Stream<VertexLayout::Position3D>();
+					for( size_t v = 0; v < positions.Size(); v++ )
+					{
+						positions[v].x *= scale;
+						positions[v].y *= scale;
+						positions[v].z *= scale;
+					}
+				}
+			}
+			times.push_back( timer.Mark() );
+		}
+		const float baseline = Summarize( times ).second;
+		const auto row = [&]( const char* path,float seconds,bool match )
+		{
+			report << std::left << std::setw( 12 ) << config.name << std::setw( 20 ) << path << std::right
+				<< std::setw( 12 ) << std::setprecision( 3 ) << seconds * 1000.0f
+				<< std::setw( 12 ) << std::setprecision( 2 ) << seconds * 1.0e9f / float( std::max( vertexCount,size_t( 1 ) ) )
+				<< std::setw( 9 ) << std::setprecision( 1 ) << baseline / std::max( seconds,1.0e-9f ) << "x"
+				<< std::setw( 8 ) << (match ? "yes" : "NO") << std::endl;
+		};
+		row( "per vertex",baseline,true );
+
+		for( const auto converterThreads : { 1u,threads } )
+		{
+			VertexConverter::Options options;
+			options.scale = scale;
+			options.threads = converterThreads;
+			std::vector<Dvtx::VertexBuffer> converted;
+			times.clear();
+			for( unsigned int i = 0; i < iterations; i++ )
+			{
+				converted.clear();
+				ChiliTimer timer;
+				for( const auto pMesh : meshes )
+				{
+					converted.push_back( VertexConverter::Convert( layout,*pMesh,options ).vertices );
+				}
+				times.push_back( timer.Mark() );
+			}
+			bool match = true;
+			for( size_t m = 0; m < meshes.size(); m++ )
+			{
+				match = match && converted[m].SizeBytes() == reference[m].SizeBytes() &&
+					std::memcmp( converted[m].GetData(),reference[m].GetData(),reference[m].SizeBytes() ) == 0;
+			}
+			const auto path = converterThreads == 1u ? std::string( "converter" ) :
+				"converter x" + (converterThreads == 0u ? std::string( "all" ) : std::to_string( converterThreads ));
+			row( path.c_str(),Summarize( times ).second,match );
+		}
+	}
+}
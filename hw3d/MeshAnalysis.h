@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+
+// headless reports on the import-time mesh processing, driven from ScriptCommander
+class MeshAnalysis
+{
+public:
+	// simplifies every mesh of a model into a lod chain, writes triangle counts, error and time per level
+	static void ReportLods( const std::string& modelPath,const std::string& reportPath,unsigned int lodCount,float reduction,float maxError );
+	// clusters every mesh, then orbits a camera around the scene (distance relative to its bounding radius) and compares
+	// triangles removed by per-cluster frustum/cone culling against whole-mesh frustum culling, with the cpu time spent culling
+	static void ReportClusters( const std::string& modelPath,const std::string& reportPath,unsigned int maxVertices,unsigned int maxTriangles,
+		unsigned int views,float distance );
+	// runs the import-time reordering on every mesh and writes vertex cache (acmr / atvr) and vertex fetch
+	// statistics before and after; vertexSize is the stride used for the fetch simulation
+	static void ReportVertexCache( const std::string& modelPath,const std::string& reportPath,unsigned int cacheSize,
+		unsigned int vertexSize,float overdrawThreshold );
+	// times the cpu side of a model load with default ModelOptions: cold (assimp import + cook + write cache)
+	// against warm (hash source + map cache + touch every byte), texture loading and gpu buffer creation excluded
+	static void BenchmarkCookedLoad( const std::string& modelPath,const std::string& reportPath,unsigned int iterations,
+		float scale,bool isPBR );
+	// merges the model's small meshes by material like ModelOptions::staticBatching does and writes every batch
+	// with the jobs, drawable binds and draw calls saved per step
+	static void ReportStaticBatching( const std::string& modelPath,const std::string& reportPath,unsigned int maxVertices,
+		float scale,bool isPBR );
+	// encodes every mesh with the full-float pbr vertex layout and the quantized ones (ModelOptions::quantizeVertices,
+	// with and without quantizePositions), writes bytes per vertex, encode time and the worst decode error per element
+	static void ReportVertexQuantization( const std::string& modelPath,const std::string& reportPath,unsigned int iterations );
+	// converts every mesh into the float and the fully quantized pbr vertex layouts per vertex (VertexBuffer( layout,mesh )
+	// then scaling the positions, the old import path) and through VertexConverter on one and on threads threads,
+	// writes time per vertex for each and whether the outputs match
+	static void BenchmarkVertexConversion( const std::string& modelPath,const std::string& reportPath,unsigned int iterations,
+		float scale,unsigned int threads );
+};
@@ -0,0 +1,284 @@
+#include "MeshClusters.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+namespace
+{
+	struct Float3
+	{
+		float x,y,z;
+	};
+	Float3 operator-( const Float3& a,const Float3& b ) noexcept
+	{
+		return { a.x - b.x,a.y - b.y,a.z - b.z };
+	}
+	float Dot( const Float3& a,const Float3& b ) noexcept
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+	Float3 Cross( const Float3& a,const Float3& b ) noexcept
+	{
+		return { a.y * b.z - a.z * b.y,a.z * b.x - a.x * b.z,a.x * b.y - a.y * b.x };
+	}
+}
+
+MeshClusters::MeshClusters( std::vector<Cluster> clusters ) noexcept
+	:
+	clusters( std::move( clusters ) )
+{}
+
+MeshClusters MeshClusters::Build( const float* pPositions,size_t vertexCount,size_t strideBytes,std::vector<unsigned int>& indices,
+	unsigned int maxVertices,unsigned int maxTriangles )
+{
+	assert( indices.size() % 3 == 0 && maxVertices >= 3 && maxTriangles >= 1 );
+	const auto pBytes = reinterpret_cast<const char*>(pPositions);
+	const auto position = [&]( unsigned int v )
+	{
+		Float3 p;
+		std::memcpy( &p,pBytes + size_t( v ) * strideBytes,sizeof( p ) );
+		return p;
+	};
+	const auto triCount = indices.size() / 3;
+
+	// vertex -> triangle adjacency
+	std::vector<unsigned int> triOffsets( vertexCount + 1,0u );
+	for( auto v : indices )
+	{
+		triOffsets[v + 1]++;
+	}
+	for( size_t v = 0; v < vertexCount; v++ )
+	{
+		triOffsets[v + 1] += triOffsets[v];
+	}
+	std::vector<unsigned int> triList( indices.size() );
+	{
+		auto fill = triOffsets;
+		for( size_t i = 0; i < indices.size(); i++ )
+		{
+			triList[fill[indices[i]]++] = (unsigned int)( i / 3 );
+		}
+	}
+
+	MeshClusters mc;
+	std::vector<unsigned int> reordered;
+	reordered.reserve( indices.size() );
+	std::vector<unsigned char> assigned( triCount,0 );
+	// stamp of the cluster that last used each vertex, avoids clearing a set per cluster
+	std::vector<unsigned int> vertexStamp( vertexCount,~0u );
+	std::vector<unsigned int> frontier;
+	std::vector<unsigned int> clusterVertices;
+
+	for( size_t seed = 0; seed < triCount; seed++ )
+	{
+		if( assigned[seed] )
+		{
+			continue;
+		}
+		const auto clusterId = (unsigned int)mc.clusters.size();
+		const auto startIndex = (unsigned int)reordered.size();
+		unsigned int triangles = 0;
+		clusterVertices.clear();
+		frontier.clear();
+		frontier.push_back( (unsigned int)seed );
+
+		// grow through shared vertices while the vertex and triangle budgets allow
+		for( size_t f = 0; f < frontier.size() && triangles < maxTriangles; f++ )
+		{
+			const auto t = frontier[f];
+			if( assigned[t] )
+			{
+				continue;
+			}
+			const unsigned int* tri = &indices[size_t( t ) * 3];
+			unsigned int newVertices = 0;
+			for( int k = 0; k < 3; k++ )
+			{
+				newVertices += vertexStamp[tri[k]] != clusterId ? 1 : 0;
+			}
+			if( clusterVertices.size() + newVertices > maxVertices )
+			{
+				continue;
+			}
+			assigned[t] = 1;
+			triangles++;
+			for( int k = 0; k < 3; k++ )
+			{
+				const auto v = tri[k];
+				reordered.push_back( v );
+				if( vertexStamp[v] != clusterId )
+				{
+					vertexStamp[v] = clusterId;
+					clusterVertices.push_back( v );
+				}
+				for( auto a = triOffsets[v]; a < triOffsets[v + 1]; a++ )
+				{
+					if( !assigned[triList[a]] )
+					{
+						frontier.push_back( triList[a] );
+					}
+				}
+			}
+		}
+
+		Cluster c{};
+		c.startIndex = startIndex;
+		c.indexCount = triangles * 3;
+
+		// sphere around the center of the cluster's box
+		Float3 lo = position( clusterVertices[0] );
+		Float3 hi = lo;
+		for( auto v : clusterVertices )
+		{
+			const auto p = position( v );
+			lo = { std::min( lo.x,p.x ),std::min( lo.y,p.y ),std::min( lo.z,p.z ) };
+			hi = { std::max( hi.x,p.x ),std::max( hi.y,p.y ),std::max( hi.z,p.z ) };
+		}
+		const Float3 center = { (lo.x + hi.x) * 0.5f,(lo.y + hi.y) * 0.5f,(lo.z + hi.z) * 0.5f };
+		float radius2 = 0.0f;
+		for( auto v : clusterVertices )
+		{
+			const auto d = position( v ) - center;
+			radius2 = std::max( radius2,Dot( d,d ) );
+		}
+		c.center[0] = center.x;
+		c.center[1] = center.y;
+		c.center[2] = center.z;
+		c.radius = std::sqrt( radius2 );
+
+		// normal cone from the front-face normals (clockwise winding)
+		std::vector<Float3> normals;
+		normals.reserve( triangles );
+		Float3 axis = { 0.0f,0.0f,0.0f };
+		for( auto i = startIndex; i < startIndex + c.indexCount; i += 3 )
+		{
+			const auto p0 = position( reordered[i] );
+			auto n = Cross( position( reordered[i + 1] ) - p0,position( reordered[i + 2] ) - p0 );
+			const auto len = std::sqrt( Dot( n,n ) );
+			if( len > 0.0f )
+			{
+				n = { n.x / len,n.y / len,n.z / len };
+				normals.push_back( n );
+				axis = { axis.x + n.x,axis.y + n.y,axis.z + n.z };
+			}
+		}
+		const auto axisLen = std::sqrt( Dot( axis,axis ) );
+		c.coneCutoff = 1.0f;
+		if( axisLen > 0.0f )
+		{
+			axis = { axis.x / axisLen,axis.y / axisLen,axis.z / axisLen };
+			float minDot = 1.0f;
+			for( const auto& n : normals )
+			{
+				minDot = std::min( minDot,Dot( n,axis ) );
+			}
+			// spread past ~85 degrees can never be fully backfacing
+			if( minDot > 0.1f )
+			{
+				c.coneCutoff = std::sqrt( 1.0f - minDot * minDot );
+			}
+		}
+		c.coneAxis[0] = axis.x;
+		c.coneAxis[1] = axis.y;
+		c.coneAxis[2] = axis.z;
+		mc.clusters.push_back( c );
+	}
+
+	indices = std::move( reordered );
+	return mc;
+}
+
+size_t MeshClusters::Cull( const float planes[6][4],const float eyePos[3],std::vector<Range>& ranges,CullStats* pStats ) const
+{
+	ranges.clear();
+	size_t drawn = 0;
+	size_t frustumCulled = 0;
+	size_t coneCulled = 0;
+	for( const auto& c : clusters )
+	{
+		bool outside = false;
+		for( int p = 0; p < 6 && !outside; p++ )
+		{
+			outside = planes[p][0] * c.center[0] + planes[p][1] * c.center[1] + planes[p][2] * c.center[2] + planes[p][3] < -c.radius;
+		}
+		if( outside )
+		{
+			frustumCulled++;
+			continue;
+		}
+		// every normal in the cone faces away from every point of the sphere
+		if( eyePos )
+		{
+			const Float3 toCluster = { c.center[0] - eyePos[0],c.center[1] - eyePos[1],c.center[2] - eyePos[2] };
+			const Float3 axis = { c.coneAxis[0],c.coneAxis[1],c.coneAxis[2] };
+			if( Dot( toCluster,axis ) >= c.coneCutoff * std::sqrt( Dot( toCluster,toCluster ) ) + c.radius )
+			{
+				coneCulled++;
+				continue;
+			}
+		}
+		if( !ranges.empty() && ranges.back().startIndex + ranges.back().indexCount == c.startIndex )
+		{
+			ranges.back().indexCount += c.indexCount;
+		}
+		else
+		{
+			ranges.push_back( { c.startIndex,c.indexCount } );
+		}
+		drawn += c.indexCount / 3;
+	}
+	if( pStats )
+	{
+		size_t total = 0;
+		for( const auto& c : clusters )
+		{
+			total += c.indexCount / 3;
+		}
+		pStats->clusters += clusters.size();
+		pStats->frustumCulled += frustumCulled;
+		pStats->coneCulled += coneCulled;
+		pStats->trianglesDrawn += drawn;
+		pStats->trianglesCulled += total - drawn;
+	}
+	return drawn;
+}
+
+const std::vector<MeshClusters::Cluster>& MeshClusters::GetClusters() const noexcept
+{
+	return clusters;
+}
+
+bool MeshClusters::IsEmpty() const noexcept
+{
+	return clusters.empty();
+}
+
+void MeshClusters::ExtractFrustumPlanes( const float m[4][4],float planes[6][4] ) noexcept
+{
+	// clip = v * m, so plane coefficients come from the columns of m
+	for( int i = 0; i < 4; i++ )
+	{
+		const float c0 = m[i][0];
+		const float c1 = m[i][1];
+		const float c2 = m[i][2];
+		const float c3 = m[i][3];
+		planes[0][i] = c3 + c0; // left
+		planes[1][i] = c3 - c0; // right
+		planes[2][i] = c3 + c1; // bottom
+		planes[3][i] = c3 - c1; // top
+		planes[4][i] = c2;      // near, d3d depth starts at 0
+		planes[5][i] = c3 - c2; // far
+	}
+	for( int p = 0; p < 6; p++ )
+	{
+		const auto len = std::sqrt( planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2] );
+		if( len > 0.0f )
+		{
+			for( int i = 0; i < 4; i++ )
+			{
+				planes[p][i] /= len;
+			}
+		}
+	}
+}
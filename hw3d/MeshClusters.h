@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// splits a mesh into small clusters (meshlets) of adjacent triangles, each with a
+// bounding sphere and a normal cone, so parts of a mesh can be culled on the cpu
+// all culling inputs are in the mesh's object space
+class MeshClusters
+{
+public:
+	struct Cluster
+	{
+		float center[3];
+		float radius;
+		float coneAxis[3];
+		// sine of the cone spread, 1 when the normals are too spread for backface culling
+		float coneCutoff;
+		unsigned int startIndex;
+		unsigned int indexCount;
+	};
+	// contiguous slice of the reordered index buffer
+	struct Range
+	{
+		unsigned int startIndex;
+		unsigned int indexCount;
+	};
+	struct CullStats
+	{
+		size_t clusters = 0;
+		size_t frustumCulled = 0;
+		size_t coneCulled = 0;
+		size_t trianglesDrawn = 0;
+		size_t trianglesCulled = 0;
+	};
+public:
+	MeshClusters() = default;
+	// clusters built earlier (e.g. loaded from a cooked model) over indices already in cluster order
+	explicit MeshClusters( std::vector<Cluster> clusters ) noexcept;
+	// reorders indices in place so every cluster's triangles are contiguous
+	static MeshClusters Build( const float* pPositions,size_t vertexCount,size_t strideBytes,std::vector<unsigned int>& indices,
+		unsigned int maxVertices = 64u,unsigned int maxTriangles = 124u );
+	// planes are ax + by + cz + d >= 0 inside and normalized; fills ranges with the surviving clusters,
+	// merging neighbours, and returns how many triangles survived
+	// a null eyePos culls against the frustum only (two-sided or mirrored meshes, whose cones don't hold)
+	size_t Cull( const float planes[6][4],const float eyePos[3],std::vector<Range>& ranges,CullStats* pStats = nullptr ) const;
+	const std::vector<Cluster>& GetClusters() const noexcept;
+	bool IsEmpty() const noexcept;
+	// row-vector (d3d) view-projection, depth range [0,1]
+	static void ExtractFrustumPlanes( const float viewProj[4][4],float planes[6][4] ) noexcept;
+private:
+	std::vector<Cluster> clusters;
+};
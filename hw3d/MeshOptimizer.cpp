@@ -0,0 +1,487 @@
+#include "MeshOptimizer.h"
+#include <assimp/scene.h>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+namespace
+{
+	// cache modelled by the triangle scoring, larger than real hardware on purpose
+	constexpr int scoreCacheSize = 32;
+	// fifo used to find where the cache goes cold when splitting for overdraw
+	constexpr unsigned int clusterCacheSize = 16;
+
+	float VertexScore( int cachePosition,unsigned int remainingTriangles ) noexcept
+	{
+		if( remainingTriangles == 0 )
+		{
+			return -1.0f;
+		}
+		float score = 0.0f;
+		if( cachePosition >= 0 )
+		{
+			// the last triangle's vertices get a fixed score so the strip doesn't just turn back on itself
+			if( cachePosition < 3 )
+			{
+				score = 0.75f;
+			}
+			else
+			{
+				score = std::pow( 1.0f - float( cachePosition - 3 ) / float( scoreCacheSize - 3 ),1.5f );
+			}
+		}
+		// vertices with few triangles left are finished off first, so they can leave the cache for good
+		return score + 2.0f / std::sqrt( float( remainingTriangles ) );
+	}
+
+	// fifo membership by timestamp: a vertex is cached if it missed less than cacheSize misses ago
+	class FifoCache
+	{
+	public:
+		FifoCache( size_t vertexCount,unsigned int cacheSize )
+			:
+			stamps( vertexCount,0u ),
+			cacheSize( cacheSize )
+		{}
+		// returns true on a miss
+		bool Access( unsigned int v ) noexcept
+		{
+			if( time - stamps[v] < cacheSize && stamps[v] != 0 )
+			{
+				return false;
+			}
+			stamps[v] = ++time;
+			return true;
+		}
+		void Flush() noexcept
+		{
+			time += cacheSize;
+		}
+	private:
+		std::vector<unsigned int> stamps;
+		unsigned int cacheSize;
+		unsigned int time = 0;
+	};
+
+	struct Float3
+	{
+		float x,y,z;
+	};
+	Float3 Load( const char* pBytes,size_t stride,unsigned int v ) noexcept
+	{
+		Float3 p;
+		std::memcpy( &p,pBytes + size_t( v ) * stride,sizeof( p ) );
+		return p;
+	}
+}
+
+std::vector<unsigned int> MeshOptimizer::OptimizeVertexCache( const std::vector<unsigned int>& indices,size_t vertexCount )
+{
+	assert( indices.size() % 3 == 0 );
+	const auto triCount = indices.size() / 3;
+	if( triCount == 0 )
+	{
+		return {};
+	}
+
+	// vertex -> live triangles, the first remaining[v] entries of each range are the unemitted ones
+	std::vector<unsigned int> remaining( vertexCount,0u );
+	for( auto v : indices )
+	{
+		remaining[v]++;
+	}
+	std::vector<unsigned int> offsets( vertexCount + 1,0u );
+	for( size_t v = 0; v < vertexCount; v++ )
+	{
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+	std::vector<unsigned int> adjacency( indices.size() );
+	{
+		auto fill = offsets;
+		for( size_t i = 0; i < indices.size(); i++ )
+		{
+			adjacency[fill[indices[i]]++] = (unsigned int)( i / 3 );
+		}
+	}
+
+	std::vector<int> cachePosition( vertexCount,-1 );
+	std::vector<float> vertexScore( vertexCount );
+	for( size_t v = 0; v < vertexCount; v++ )
+	{
+		vertexScore[v] = VertexScore( -1,remaining[v] );
+	}
+	std::vector<float> triScore( triCount );
+	std::vector<unsigned char> emitted( triCount,0 );
+	size_t best = 0;
+	for( size_t t = 0; t < triCount; t++ )
+	{
+		triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if( triScore[t] > triScore[best] )
+		{
+			best = t;
+		}
+	}
+
+	std::vector<unsigned int> result;
+	result.reserve( indices.size() );
+	std::vector<unsigned int> cache;
+	std::vector<unsigned int> nextCache;
+	cache.reserve( scoreCacheSize + 3 );
+	nextCache.reserve( scoreCacheSize + 3 );
+	size_t scanCursor = 0;
+
+	for( size_t emittedCount = 0; emittedCount < triCount; emittedCount++ )
+	{
+		const unsigned int* tri = &indices[best * 3];
+		result.insert( result.end(),tri,tri + 3 );
+		emitted[best] = 1;
+
+		// take the triangle out of its vertices' live lists
+		for( int k = 0; k < 3; k++ )
+		{
+			const auto v = tri[k];
+			const auto begin = adjacency.begin() + offsets[v];
+			const auto end = begin + remaining[v];
+			const auto it = std::find( begin,end,(unsigned int)best );
+			assert( it != end );
+			std::iter_swap( it,end - 1 );
+			remaining[v]--;
+		}
+
+		// new vertices go to the front, the rest keep their order behind them
+		nextCache.assign( tri,tri + 3 );
+		for( auto v : cache )
+		{
+			if( v != tri[0] && v != tri[1] && v != tri[2] )
+			{
+				nextCache.push_back( v );
+			}
+		}
+		for( size_t i = 0; i < nextCache.size(); i++ )
+		{
+			const auto v = nextCache[i];
+			cachePosition[v] = i < scoreCacheSize ? int( i ) : -1;
+			vertexScore[v] = VertexScore( cachePosition[v],remaining[v] );
+		}
+		if( nextCache.size() > scoreCacheSize )
+		{
+			nextCache.resize( scoreCacheSize );
+		}
+		std::swap( cache,nextCache );
+
+		// the next triangle is the best one touching the cache
+		float bestScore = -1.0f;
+		for( auto v : cache )
+		{
+			for( auto a = offsets[v]; a < offsets[v] + remaining[v]; a++ )
+			{
+				const auto t = adjacency[a];
+				triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if( triScore[t] > bestScore )
+				{
+					bestScore = triScore[t];
+					best = t;
+				}
+			}
+		}
+		if( bestScore < 0.0f )
+		{
+			// nothing left around the cache, continue with the next triangle in input order
+			while( scanCursor < triCount && emitted[scanCursor] )
+			{
+				scanCursor++;
+			}
+			best = scanCursor;
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned int> MeshOptimizer::OptimizeOverdraw( const std::vector<unsigned int>& indices,
+	const float* pPositions,size_t vertexCount,size_t strideBytes,float threshold )
+{
+	assert( indices.size() % 3 == 0 );
+	const auto triCount = indices.size() / 3;
+	if( triCount == 0 )
+	{
+		return {};
+	}
+
+	// hard boundaries where all three vertices miss, the cache is effectively cold there anyway
+	std::vector<size_t> hard;
+	{
+		FifoCache cache( vertexCount,clusterCacheSize );
+		for( size_t t = 0; t < triCount; t++ )
+		{
+			int misses = 0;
+			for( int k = 0; k < 3; k++ )
+			{
+				misses += cache.Access( indices[t * 3 + k] ) ? 1 : 0;
+			}
+			if( misses == 3 )
+			{
+				hard.push_back( t );
+			}
+		}
+		hard.push_back( triCount );
+	}
+
+	// soft boundaries inside each: restart wherever the running acmr is already within threshold of the
+	// cluster's own, so splitting costs at most that much cache efficiency
+	std::vector<size_t> starts;
+	FifoCache cache( vertexCount,clusterCacheSize );
+	FifoCache running( vertexCount,clusterCacheSize );
+	for( size_t h = 0; h + 1 < hard.size(); h++ )
+	{
+		const auto begin = hard[h];
+		const auto end = hard[h + 1];
+		cache.Flush();
+		size_t clusterMisses = 0;
+		for( auto t = begin; t < end; t++ )
+		{
+			for( int k = 0; k < 3; k++ )
+			{
+				clusterMisses += cache.Access( indices[t * 3 + k] ) ? 1 : 0;
+			}
+		}
+		const auto limit = float( clusterMisses ) / float( end - begin ) * threshold;
+
+		running.Flush();
+		size_t start = begin;
+		size_t misses = 0;
+		starts.push_back( begin );
+		for( auto t = begin; t < end; t++ )
+		{
+			for( int k = 0; k < 3; k++ )
+			{
+				misses += running.Access( indices[t * 3 + k] ) ? 1 : 0;
+			}
+			if( t + 1 < end && float( misses ) / float( t + 1 - start ) <= limit )
+			{
+				start = t + 1;
+				misses = 0;
+				running.Flush();
+				starts.push_back( start );
+			}
+		}
+	}
+	starts.push_back( triCount );
+
+	// area weighted centroids and normals (clockwise front faces)
+	const auto pBytes = reinterpret_cast<const char*>(pPositions);
+	struct Cluster
+	{
+		size_t begin;
+		size_t end;
+		float sortKey;
+	};
+	std::vector<Cluster> clusters;
+	std::vector<Float3> centroids;
+	std::vector<Float3> normals;
+	Float3 meshCentroid = { 0.0f,0.0f,0.0f };
+	float meshArea = 0.0f;
+	for( size_t c = 0; c + 1 < starts.size(); c++ )
+	{
+		Float3 centroid = { 0.0f,0.0f,0.0f };
+		Float3 normal = { 0.0f,0.0f,0.0f };
+		float area = 0.0f;
+		for( auto t = starts[c]; t < starts[c + 1]; t++ )
+		{
+			const auto p0 = Load( pBytes,strideBytes,indices[t * 3] );
+			const auto p1 = Load( pBytes,strideBytes,indices[t * 3 + 1] );
+			const auto p2 = Load( pBytes,strideBytes,indices[t * 3 + 2] );
+			const Float3 e1 = { p1.x - p0.x,p1.y - p0.y,p1.z - p0.z };
+			const Float3 e2 = { p2.x - p0.x,p2.y - p0.y,p2.z - p0.z };
+			const Float3 n = { e1.y * e2.z - e1.z * e2.y,e1.z * e2.x - e1.x * e2.z,e1.x * e2.y - e1.y * e2.x };
+			const auto a = std::sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+			centroid = { centroid.x + (p0.x + p1.x + p2.x) * a,centroid.y + (p0.y + p1.y + p2.y) * a,centroid.z + (p0.z + p1.z + p2.z) * a };
+			normal = { normal.x + n.x,normal.y + n.y,normal.z + n.z };
+			area += a;
+		}
+		meshCentroid = { meshCentroid.x + centroid.x,meshCentroid.y + centroid.y,meshCentroid.z + centroid.z };
+		meshArea += area;
+		const auto inv = area > 0.0f ? 1.0f / (area * 3.0f) : 0.0f;
+		centroids.push_back( { centroid.x * inv,centroid.y * inv,centroid.z * inv } );
+		normals.push_back( normal );
+		clusters.push_back( { starts[c],starts[c + 1],0.0f } );
+	}
+	const auto inv = meshArea > 0.0f ? 1.0f / (meshArea * 3.0f) : 0.0f;
+	meshCentroid = { meshCentroid.x * inv,meshCentroid.y * inv,meshCentroid.z * inv };
+	for( size_t c = 0; c < clusters.size(); c++ )
+	{
+		const auto& n = normals[c];
+		const auto len = std::sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+		if( len > 0.0f )
+		{
+			clusters[c].sortKey = ((centroids[c].x - meshCentroid.x) * n.x + (centroids[c].y - meshCentroid.y) * n.y +
+				(centroids[c].z - meshCentroid.z) * n.z) / len;
+		}
+	}
+	// clusters far out along their own normal tend to occlude the rest, so they go first
+	std::stable_sort( clusters.begin(),clusters.end(),[]( const Cluster& a,const Cluster& b )
+	{
+		return a.sortKey > b.sortKey;
+	} );
+
+	std::vector<unsigned int> result;
+	result.reserve( indices.size() );
+	for( const auto& c : clusters )
+	{
+		result.insert( result.end(),indices.begin() + c.begin * 3,indices.begin() + c.end * 3 );
+	}
+	return result;
+}
+
+std::vector<unsigned int> MeshOptimizer::OptimizeVertexFetch( std::vector<unsigned int>& indices,size_t vertexCount )
+{
+	constexpr auto unused = ~0u;
+	std::vector<unsigned int> remap( vertexCount,unused );
+	unsigned int next = 0;
+	for( auto& i : indices )
+	{
+		if( remap[i] == unused )
+		{
+			remap[i] = next++;
+		}
+		i = remap[i];
+	}
+	for( auto& r : remap )
+	{
+		if( r == unused )
+		{
+			r = next++;
+		}
+	}
+	return remap;
+}
+
+bool MeshOptimizer::Optimize( aiMesh& mesh,float overdrawThreshold )
+{
+	if( mesh.mNumAnimMeshes != 0 || mesh.mNumFaces == 0 )
+	{
+		return false;
+	}
+	std::vector<unsigned int> indices;
+	indices.reserve( size_t( mesh.mNumFaces ) * 3 );
+	for( unsigned int i = 0; i < mesh.mNumFaces; i++ )
+	{
+		const auto& face = mesh.mFaces[i];
+		if( face.mNumIndices != 3 )
+		{
+			return false;
+		}
+		indices.insert( indices.end(),face.mIndices,face.mIndices + 3 );
+	}
+
+	indices = OptimizeVertexCache( indices,mesh.mNumVertices );
+	indices = OptimizeOverdraw( indices,&mesh.mVertices[0].x,mesh.mNumVertices,sizeof( aiVector3D ),overdrawThreshold );
+	const auto remap = OptimizeVertexFetch( indices,mesh.mNumVertices );
+
+	for( unsigned int i = 0; i < mesh.mNumFaces; i++ )
+	{
+		std::copy( indices.begin() + size_t( i ) * 3,indices.begin() + size_t( i ) * 3 + 3,mesh.mFaces[i].mIndices );
+	}
+	const auto permute = [&]( auto* pAttribute )
+	{
+		if( pAttribute )
+		{
+			const std::vector<std::remove_pointer_t<decltype(pAttribute)>> original( pAttribute,pAttribute + mesh.mNumVertices );
+			for( unsigned int v = 0; v < mesh.mNumVertices; v++ )
+			{
+				pAttribute[remap[v]] = original[v];
+			}
+		}
+	};
+	permute( mesh.mVertices );
+	permute( mesh.mNormals );
+	permute( mesh.mTangents );
+	permute( mesh.mBitangents );
+	for( auto pColors : mesh.mColors )
+	{
+		permute( pColors );
+	}
+	for( auto pCoords : mesh.mTextureCoords )
+	{
+		permute( pCoords );
+	}
+	for( unsigned int b = 0; b < mesh.mNumBones; b++ )
+	{
+		auto& bone = *mesh.mBones[b];
+		for( unsigned int w = 0; w < bone.mNumWeights; w++ )
+		{
+			bone.mWeights[w].mVertexId = remap[bone.mWeights[w].mVertexId];
+		}
+	}
+	return true;
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache( const std::vector<unsigned int>& indices,size_t vertexCount,unsigned int cacheSize )
+{
+	FifoCache cache( vertexCount,cacheSize );
+	std::vector<unsigned char> referenced( vertexCount,0 );
+	size_t misses = 0;
+	size_t unique = 0;
+	for( auto v : indices )
+	{
+		misses += cache.Access( v ) ? 1 : 0;
+		if( !referenced[v] )
+		{
+			referenced[v] = 1;
+			unique++;
+		}
+	}
+	CacheStats stats;
+	if( !indices.empty() )
+	{
+		stats.acmr = float( misses ) / float( indices.size() / 3 );
+		stats.atvr = float( misses ) / float( unique );
+	}
+	return stats;
+}
+
+MeshOptimizer::FetchStats MeshOptimizer::AnalyzeVertexFetch( const std::vector<unsigned int>& indices,size_t vertexCount,size_t vertexSize,size_t cacheBytes )
+{
+	constexpr size_t lineSize = 64;
+	const auto lineCount = std::max( cacheBytes / lineSize,size_t( 1 ) );
+	// most recently used at the back
+	std::vector<size_t> lines;
+	lines.reserve( lineCount );
+	std::vector<unsigned char> referenced( vertexCount,0 );
+	size_t unique = 0;
+	size_t fetched = 0;
+	for( auto v : indices )
+	{
+		if( !referenced[v] )
+		{
+			referenced[v] = 1;
+			unique++;
+		}
+		const auto first = size_t( v ) * vertexSize / lineSize;
+		const auto last = (size_t( v ) * vertexSize + vertexSize - 1) / lineSize;
+		for( auto l = first; l <= last; l++ )
+		{
+			const auto it = std::find( lines.begin(),lines.end(),l );
+			if( it != lines.end() )
+			{
+				lines.erase( it );
+			}
+			else
+			{
+				fetched += lineSize;
+				if( lines.size() == lineCount )
+				{
+					lines.erase( lines.begin() );
+				}
+			}
+			lines.push_back( l );
+		}
+	}
+	FetchStats stats;
+	if( unique > 0 )
+	{
+		stats.overfetch = float( fetched ) / float( unique * vertexSize );
+	}
+	return stats;
+}
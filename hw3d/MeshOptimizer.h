@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+struct aiMesh;
+
+// import-time reordering of triangle lists for the gpu:
+// triangles for post-transform vertex cache hits, then groups of them for less overdraw,
+// then vertices in first-use order for vertex fetch locality
+class MeshOptimizer
+{
+public:
+	struct CacheStats
+	{
+		// transformed vertices per triangle, 0.5 is the ideal for large regular meshes, 3 the worst
+		float acmr = 0.0f;
+		// transformed vertices per referenced vertex, 1 is ideal
+		float atvr = 0.0f;
+	};
+	struct FetchStats
+	{
+		// bytes pulled through the fetch cache per byte of referenced vertex data, 1 is ideal
+		float overfetch = 0.0f;
+	};
+public:
+	// greedy cache-aware triangle ordering (Forsyth's linear-speed scoring)
+	static std::vector<unsigned int> OptimizeVertexCache( const std::vector<unsigned int>& indices,size_t vertexCount );
+	// splits a cache-optimized list where the cache is cold (or nearly so, within threshold of its acmr)
+	// and sorts those clusters so outward facing ones on the rim of the mesh are drawn first
+	static std::vector<unsigned int> OptimizeOverdraw( const std::vector<unsigned int>& indices,
+		const float* pPositions,size_t vertexCount,size_t strideBytes,float threshold = 1.05f );
+	// old vertex index -> new, in order of first use, unreferenced vertices go to the end
+	// indices are rewritten in place
+	static std::vector<unsigned int> OptimizeVertexFetch( std::vector<unsigned int>& indices,size_t vertexCount );
+	// runs all three on an imported mesh in place, permuting every vertex attribute and bone weight
+	// returns false and leaves the mesh untouched when it is not a plain triangle list
+	static bool Optimize( aiMesh& mesh,float overdrawThreshold = 1.05f );
+
+	// fifo cache simulation of the given size
+	static CacheStats AnalyzeVertexCache( const std::vector<unsigned int>& indices,size_t vertexCount,unsigned int cacheSize = 16u );
+	// lru cache of 64 byte lines, cacheBytes large, over vertices vertexSize bytes apart
+	static FetchStats AnalyzeVertexFetch( const std::vector<unsigned int>& indices,size_t vertexCount,size_t vertexSize,size_t cacheBytes = 4096u );
+};
@@ -0,0 +1,399 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+namespace
+{
+	struct Vec3
+	{
+		double x,y,z;
+		Vec3 operator-( const Vec3& rhs ) const noexcept
+		{
+			return { x - rhs.x,y - rhs.y,z - rhs.z };
+		}
+		Vec3 operator*( double s ) const noexcept
+		{
+			return { x * s,y * s,z * s };
+		}
+	};
+	double Dot( const Vec3& a,const Vec3& b ) noexcept
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+	Vec3 Cross( const Vec3& a,const Vec3& b ) noexcept
+	{
+		return { a.y * b.z - a.z * b.y,a.z * b.x - a.x * b.z,a.x * b.y - a.y * b.x };
+	}
+
+	// symmetric 4x4 error quadric
+	struct Quadric
+	{
+		double a00 = 0.0,a01 = 0.0,a02 = 0.0,a03 = 0.0;
+		double a11 = 0.0,a12 = 0.0,a13 = 0.0;
+		double a22 = 0.0,a23 = 0.0;
+		double a33 = 0.0;
+		double weight = 0.0;
+		static Quadric FromPlane( const Vec3& n,double d,double weight ) noexcept
+		{
+			Quadric q;
+			q.weight = weight;
+			q.a00 = weight * n.x * n.x; q.a01 = weight * n.x * n.y; q.a02 = weight * n.x * n.z; q.a03 = weight * n.x * d;
+			q.a11 = weight * n.y * n.y; q.a12 = weight * n.y * n.z; q.a13 = weight * n.y * d;
+			q.a22 = weight * n.z * n.z; q.a23 = weight * n.z * d;
+			q.a33 = weight * d * d;
+			return q;
+		}
+		Quadric& operator+=( const Quadric& rhs ) noexcept
+		{
+			a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02; a03 += rhs.a03;
+			a11 += rhs.a11; a12 += rhs.a12; a13 += rhs.a13;
+			a22 += rhs.a22; a23 += rhs.a23;
+			a33 += rhs.a33;
+			weight += rhs.weight;
+			return *this;
+		}
+		double Evaluate( const Vec3& v ) const noexcept
+		{
+			const double r =
+				a00 * v.x * v.x + 2.0 * a01 * v.x * v.y + 2.0 * a02 * v.x * v.z + 2.0 * a03 * v.x +
+				a11 * v.y * v.y + 2.0 * a12 * v.y * v.z + 2.0 * a13 * v.y +
+				a22 * v.z * v.z + 2.0 * a23 * v.z +
+				a33;
+			return std::max( r,0.0 );
+		}
+		// squared distance, averaged over the accumulated plane weights
+		double Error( const Vec3& v ) const noexcept
+		{
+			return weight > 0.0 ? Evaluate( v ) / weight : 0.0;
+		}
+	};
+
+	enum class Kind : unsigned char
+	{
+		Manifold,
+		Border,
+		Locked,
+	};
+
+	struct Collapse
+	{
+		unsigned int from;
+		unsigned int to;
+		double cost;
+	};
+
+	unsigned long long EdgeKey( unsigned int a,unsigned int b ) noexcept
+	{
+		return (unsigned long long)a << 32 | b;
+	}
+}
+
+MeshSimplifier::Result MeshSimplifier::Simplify( const float* pPositions,size_t vertexCount,size_t strideBytes,
+	const std::vector<unsigned int>& indices,size_t targetIndexCount,float maxError )
+{
+	assert( indices.size() % 3 == 0 );
+	Result result{ indices,0.0f };
+	if( indices.size() <= targetIndexCount || vertexCount == 0 )
+	{
+		return result;
+	}
+
+	// load positions normalized to the unit cube so errors are scale independent
+	std::vector<Vec3> pos( vertexCount );
+	Vec3 lo{ 1e30,1e30,1e30 };
+	Vec3 hi{ -1e30,-1e30,-1e30 };
+	const auto pBytes = reinterpret_cast<const char*>(pPositions);
+	for( size_t i = 0; i < vertexCount; i++ )
+	{
+		float f[3];
+		std::memcpy( f,pBytes + i * strideBytes,sizeof( f ) );
+		pos[i] = { f[0],f[1],f[2] };
+		lo = { std::min( lo.x,pos[i].x ),std::min( lo.y,pos[i].y ),std::min( lo.z,pos[i].z ) };
+		hi = { std::max( hi.x,pos[i].x ),std::max( hi.y,pos[i].y ),std::max( hi.z,pos[i].z ) };
+	}
+	const double extent = std::max( std::sqrt( Dot( hi - lo,hi - lo ) ),1e-12 );
+	for( auto& p : pos )
+	{
+		p = (p - lo) * (1.0 / extent);
+	}
+
+	// classify vertices: shared positions mark attribute seams, unmatched half-edges mark borders
+	std::vector<Kind> kinds( vertexCount,Kind::Manifold );
+	{
+		std::unordered_map<unsigned long long,unsigned int> firstAtPosition;
+		firstAtPosition.reserve( vertexCount );
+		for( unsigned int i = 0; i < vertexCount; i++ )
+		{
+			float f[3];
+			std::memcpy( f,pBytes + i * strideBytes,sizeof( f ) );
+			unsigned int bits[3];
+			std::memcpy( bits,f,sizeof( bits ) );
+			const auto key = (unsigned long long)bits[0] * 0x9E3779B97F4A7C15ull ^
+				(unsigned long long)bits[1] * 0xC2B2AE3D27D4EB4Full ^ bits[2];
+			const auto [it,inserted] = firstAtPosition.try_emplace( key,i );
+			if( !inserted && std::memcmp( pBytes + it->second * strideBytes,f,sizeof( f ) ) == 0 )
+			{
+				kinds[i] = Kind::Locked;
+				kinds[it->second] = Kind::Locked;
+			}
+		}
+	}
+
+	std::vector<Quadric> quadrics( vertexCount );
+	{
+		std::unordered_map<unsigned long long,unsigned int> halfEdges;
+		halfEdges.reserve( indices.size() );
+		for( size_t i = 0; i < indices.size(); i += 3 )
+		{
+			for( int e = 0; e < 3; e++ )
+			{
+				halfEdges[EdgeKey( indices[i + e],indices[i + (e + 1) % 3] )]++;
+			}
+		}
+		for( size_t i = 0; i < indices.size(); i += 3 )
+		{
+			const unsigned int tri[3] = { indices[i],indices[i + 1],indices[i + 2] };
+			const auto normal = Cross( pos[tri[1]] - pos[tri[0]],pos[tri[2]] - pos[tri[0]] );
+			const auto len = std::sqrt( Dot( normal,normal ) );
+			if( len <= 0.0 )
+			{
+				continue;
+			}
+			const auto n = normal * (1.0 / len);
+			// area weighted face plane
+			const auto face = Quadric::FromPlane( n,-Dot( n,pos[tri[0]] ),len * 0.5 );
+			for( auto v : tri )
+			{
+				quadrics[v] += face;
+			}
+			// borders get a perpendicular plane so they keep their outline
+			for( int e = 0; e < 3; e++ )
+			{
+				const auto a = tri[e];
+				const auto b = tri[(e + 1) % 3];
+				if( halfEdges.count( EdgeKey( b,a ) ) == 0 )
+				{
+					const auto edge = pos[b] - pos[a];
+					const auto edgeLen2 = Dot( edge,edge );
+					auto perp = Cross( edge,n );
+					const auto perpLen = std::sqrt( Dot( perp,perp ) );
+					if( perpLen > 0.0 )
+					{
+						perp = perp * (1.0 / perpLen);
+						const auto border = Quadric::FromPlane( perp,-Dot( perp,pos[a] ),edgeLen2 * 10.0 );
+						quadrics[a] += border;
+						quadrics[b] += border;
+					}
+					for( auto v : { a,b } )
+					{
+						if( kinds[v] == Kind::Manifold )
+						{
+							kinds[v] = Kind::Border;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	auto& current = result.indices;
+	const double maxCost = double( maxError ) * double( maxError );
+	double worstCost = 0.0;
+	std::vector<unsigned int> remap( vertexCount );
+	std::vector<unsigned char> touched( vertexCount );
+	std::vector<unsigned int> triOffsets( vertexCount + 1 );
+	std::vector<unsigned int> triList;
+	std::vector<Collapse> candidates;
+
+	while( current.size() > targetIndexCount )
+	{
+		// vertex -> triangle adjacency for this pass
+		std::fill( triOffsets.begin(),triOffsets.end(),0u );
+		for( auto v : current )
+		{
+			triOffsets[v + 1]++;
+		}
+		for( size_t v = 0; v < vertexCount; v++ )
+		{
+			triOffsets[v + 1] += triOffsets[v];
+		}
+		triList.resize( current.size() );
+		{
+			auto fill = triOffsets;
+			for( size_t i = 0; i < current.size(); i++ )
+			{
+				triList[fill[current[i]]++] = (unsigned int)( i / 3 );
+			}
+		}
+		// border edges of the current mesh, collapses of border vertices must follow them
+		std::unordered_map<unsigned long long,unsigned int> halfEdges;
+		halfEdges.reserve( current.size() );
+		for( size_t i = 0; i < current.size(); i += 3 )
+		{
+			for( int e = 0; e < 3; e++ )
+			{
+				halfEdges[EdgeKey( current[i + e],current[i + (e + 1) % 3] )]++;
+			}
+		}
+		const auto isBorderEdge = [&]( unsigned int a,unsigned int b )
+		{
+			return halfEdges.count( EdgeKey( a,b ) ) == 0 || halfEdges.count( EdgeKey( b,a ) ) == 0;
+		};
+		const auto canCollapse = [&]( unsigned int from,unsigned int to )
+		{
+			switch( kinds[from] )
+			{
+			case Kind::Manifold:
+				return true;
+			case Kind::Border:
+				return kinds[to] != Kind::Manifold && isBorderEdge( from,to );
+			default:
+				return false;
+			}
+		};
+
+		// gather the cheapest valid direction of every edge
+		candidates.clear();
+		for( size_t i = 0; i < current.size(); i += 3 )
+		{
+			for( int e = 0; e < 3; e++ )
+			{
+				const auto a = current[i + e];
+				const auto b = current[i + (e + 1) % 3];
+				// visit each undirected edge once, borders only have the one half-edge
+				if( a > b && halfEdges.count( EdgeKey( b,a ) ) != 0 )
+				{
+					continue;
+				}
+				auto q = quadrics[a];
+				q += quadrics[b];
+				Collapse best{ 0,0,-1.0 };
+				if( canCollapse( a,b ) )
+				{
+					best = { a,b,q.Error( pos[b] ) };
+				}
+				if( canCollapse( b,a ) )
+				{
+					const auto cost = q.Error( pos[a] );
+					if( best.cost < 0.0 || cost < best.cost )
+					{
+						best = { b,a,cost };
+					}
+				}
+				if( best.cost >= 0.0 && best.cost <= maxCost )
+				{
+					candidates.push_back( best );
+				}
+			}
+		}
+		if( candidates.empty() )
+		{
+			break;
+		}
+		std::sort( candidates.begin(),candidates.end(),[]( const Collapse& l,const Collapse& r )
+		{
+			return l.cost < r.cost;
+		} );
+
+		for( unsigned int v = 0; v < vertexCount; v++ )
+		{
+			remap[v] = v;
+		}
+		std::fill( touched.begin(),touched.end(),(unsigned char)0 );
+
+		// each collapse removes about two triangles, stop once the target would be crossed
+		const size_t collapseBudget = (current.size() - targetIndexCount) / 6 + 1;
+		size_t collapses = 0;
+		for( const auto& c : candidates )
+		{
+			if( collapses >= collapseBudget )
+			{
+				break;
+			}
+			if( touched[c.from] || touched[c.to] )
+			{
+				continue;
+			}
+			// reject collapses that flip or degenerate a surviving triangle
+			bool flips = false;
+			for( auto t = triOffsets[c.from]; t < triOffsets[c.from + 1] && !flips; t++ )
+			{
+				const auto* tri = &current[size_t( triList[t] ) * 3];
+				if( tri[0] == c.to || tri[1] == c.to || tri[2] == c.to )
+				{
+					continue;
+				}
+				const Vec3 p0 = pos[tri[0]],p1 = pos[tri[1]],p2 = pos[tri[2]];
+				const auto before = Cross( p1 - p0,p2 - p0 );
+				const Vec3 q0 = pos[tri[0] == c.from ? c.to : tri[0]];
+				const Vec3 q1 = pos[tri[1] == c.from ? c.to : tri[1]];
+				const Vec3 q2 = pos[tri[2] == c.from ? c.to : tri[2]];
+				const auto after = Cross( q1 - q0,q2 - q0 );
+				const auto afterLen2 = Dot( after,after );
+				flips = Dot( before,after ) <= 0.25 * std::sqrt( Dot( before,before ) * afterLen2 ) || afterLen2 <= 1e-24;
+			}
+			if( flips )
+			{
+				continue;
+			}
+
+			remap[c.from] = c.to;
+			quadrics[c.to] += quadrics[c.from];
+			worstCost = std::max( worstCost,c.cost );
+			// freeze the whole neighbourhood so this pass's adjacency stays valid
+			for( auto t = triOffsets[c.from]; t < triOffsets[c.from + 1]; t++ )
+			{
+				const auto* tri = &current[size_t( triList[t] ) * 3];
+				touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+			}
+			touched[c.to] = 1;
+			collapses++;
+		}
+		if( collapses == 0 )
+		{
+			break;
+		}
+
+		// apply and drop triangles that became degenerate
+		size_t write = 0;
+		for( size_t i = 0; i < current.size(); i += 3 )
+		{
+			const auto a = remap[current[i]];
+			const auto b = remap[current[i + 1]];
+			const auto c = remap[current[i + 2]];
+			if( a != b && b != c && a != c )
+			{
+				current[write++] = a;
+				current[write++] = b;
+				current[write++] = c;
+			}
+		}
+		current.resize( write );
+	}
+
+	result.error = float( std::sqrt( worstCost ) );
+	return result;
+}
+
+std::vector<MeshSimplifier::Result> MeshSimplifier::BuildLodChain( const float* pPositions,size_t vertexCount,size_t strideBytes,
+	const std::vector<unsigned int>& indices,unsigned int lodCount,float reduction,float maxError )
+{
+	std::vector<Result> chain;
+	size_t previousCount = indices.size();
+	for( unsigned int lod = 1; lod < lodCount; lod++ )
+	{
+		const auto target = size_t( double( previousCount ) * reduction ) / 3 * 3;
+		auto level = Simplify( pPositions,vertexCount,strideBytes,indices,target,maxError );
+		// not worth another index buffer if the error limit stopped it early
+		if( level.indices.empty() || level.indices.size() > previousCount * 9 / 10 )
+		{
+			break;
+		}
+		previousCount = level.indices.size();
+		chain.push_back( std::move( level ) );
+	}
+	return chain;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// quadric error metric edge-collapse simplifier used to build mesh lod chains at import
+// vertices are never moved or created, a collapse snaps one vertex onto a neighbour,
+// so every lod can index the full-detail vertex buffer unchanged
+// vertices that share a position with another vertex (uv/normal seams) are locked,
+// and open borders may only slide along themselves
+class MeshSimplifier
+{
+public:
+	struct Result
+	{
+		std::vector<unsigned int> indices;
+		// largest collapse error, as a distance relative to the mesh bounding box diagonal
+		float error = 0.0f;
+	};
+public:
+	// pPositions points at the first float3, strideBytes apart
+	// stops at targetIndexCount or when the next collapse would exceed maxError (relative)
+	static Result Simplify( const float* pPositions,size_t vertexCount,size_t strideBytes,
+		const std::vector<unsigned int>& indices,size_t targetIndexCount,float maxError );
+	// levels 1..lodCount-1, each targeting reduction times the triangles of the previous one
+	// (always simplified from the full mesh); the chain ends early once a level stops shrinking
+	static std::vector<Result> BuildLodChain( const float* pPositions,size_t vertexCount,size_t strideBytes,
+		const std::vector<unsigned int>& indices,unsigned int lodCount,float reduction,float maxError );
+};
@@ -6,89 +6,349 @@
 #include "Node.h"
 #include "Mesh.h"
 #include "Material.h"
+#include "CookedModel.h"
 #include "ChiliXM.h"
+#include "AssetStreamer.h"
+#include "TextureResource.h"
+#include "StaticBatch.h"
+#include "TextureAtlas.h"
+#include "Trace.h"
+
+#include <unordered_set>
+#include <array>
 
 namespace dx = DirectX;
 
-Model::Model(Graphics& gfx, const std::string& pathString, const float scale, bool IsPBR)
+namespace
 {
-	Assimp::Importer imp;
-	const auto pScene = imp.ReadFile( pathString.c_str(),
+	constexpr unsigned int importFlags =
 		aiProcess_Triangulate |
 		aiProcess_JoinIdenticalVertices |
 		aiProcess_ConvertToLeftHanded |
 		aiProcess_GenNormals |
-		aiProcess_CalcTangentSpace
-	);
+		aiProcess_CalcTangentSpace;
+}
+
+struct Model::Asset
+{
+	std::unique_ptr<CookedModel> pCooked;
+	// material textures packed into arrays, null when off
+	std::unique_ptr<TextureAtlas> pAtlas;
+	std::vector<Material> materials;
+	std::vector<StaticBatch::Data> batches;
+	// meshes drawn through one of the batches
+	std::vector<bool> batched;
+};
 
-	if( pScene == nullptr )
+Model::Model(Graphics& gfx, const std::string& pathString, const float scale, bool IsPBR, const ModelOptions& options)
+	:
+	pathString( pathString ),
+	scale( scale ),
+	IsPBR( IsPBR ),
+	options( options ),
+	assetKey( pathString + "#" + std::to_string( CookedModel::MakeSettingsKey( importFlags,scale,IsPBR,options ) ) ),
+	batchMaxVertices( options.staticBatching ? options.staticBatchMaxVertices : 0u ),
+	// only the pbr shaders have texture array variants
+	textureArrays( options.textureArrays && IsPBR )
+{
+	if( batchMaxVertices )
+	{
+		assetKey += "#batch" + std::to_string( batchMaxVertices );
+	}
+	if( textureArrays )
 	{
-		throw ModelException( __LINE__,__FILE__,imp.GetErrorString() );
+		assetKey += "#arrays";
 	}
+	if( auto pShared = GetAssetCache()[assetKey].lock() )
+	{
+		pAsset = std::move( pShared );
+		Instantiate( gfx );
+	}
+	else if( options.async && AssetStreamer::IsActive() )
+	{
+		// the worker only sees copies, the finalizer checks the model is still around before building
+		AssetStreamer::Enqueue( [pathString,scale,IsPBR,options,pToken = std::weak_ptr<Model*>( pAliveToken )]() -> AssetStreamer::Finalizer
+		{
+			auto pLoad = std::make_shared<Loaded>( Load( pathString,scale,IsPBR,options ) );
+			for( auto& [path,pDecoded] : pLoad->textures )
+			{
+				pDecoded->background = true;
+			}
+			return [pLoad,pToken]( Graphics& gfx )
+			{
+				if( const auto pAlive = pToken.lock() )
+				{
+					(*pAlive)->Build( gfx,*pLoad );
+				}
+			};
+		} );
+	}
+	else
+	{
+		auto load = Load( pathString,scale,IsPBR,options );
+		Build( gfx,load );
+	}
+}
 
-	// parse materials
-	std::vector<Material> materials;
-	materials.reserve( pScene->mNumMaterials );
-	for( size_t i = 0; i < pScene->mNumMaterials; i++ )
+Model::Loaded Model::Load( const std::string& pathString,float scale,bool IsPBR,const ModelOptions& options )
+{
+	// everything up to gpu buffer creation comes out of the cooked model, either mapped from the cache
+	// or cooked now from a fresh import (and cached for next time)
+	TRACE_ZONE( "Model::Load" );
+	Loaded load;
+	const auto key = CookedModel::MakeKey( pathString,importFlags,scale,IsPBR,options );
+	const auto cachePath = CookedModel::MakeCachePath( pathString );
+	if( options.useCache )
+	{
+		load.pCooked = CookedModel::Load( cachePath,key );
+	}
+	if( !load.pCooked )
 	{
-		materials.emplace_back(gfx, *pScene->mMaterials[i], pathString, IsPBR);
+		TRACE_ZONE( "Model::Import" );
+		Assimp::Importer imp;
+		const auto pScene = imp.ReadFile( pathString.c_str(),importFlags );
+
+		if( pScene == nullptr )
+		{
+			throw ModelException( __LINE__,__FILE__,imp.GetErrorString() );
+		}
+
+		std::vector<Dvtx::VertexLayout> layouts;
+		for( size_t i = 0; i < pScene->mNumMaterials; i++ )
+		{
+			layouts.push_back( Material::DeriveVertexLayout( *pScene->mMaterials[i],IsPBR,options ) );
+		}
+
+		load.pCooked = CookedModel::Cook( *pScene,layouts,scale,options,key );
+		if( options.useCache )
+		{
+			try
+			{
+				load.pCooked->Save( cachePath );
+			}
+			catch( const ModelException& )
+			{
+				// read-only asset directory, just import again next time
+			}
+		}
 	}
 
-	for( size_t i = 0; i < pScene->mNumMeshes; i++ )
+	// decoded ahead of the materials so building them only uploads (see TextureResource::Prefetch)
+	const auto rootPath = std::filesystem::path{ pathString }.parent_path().string() + "\\";
+	for( size_t i = 0; i < load.pCooked->GetMaterialCount(); i++ )
 	{
-		const auto& mesh = *pScene->mMeshes[i];
-		meshPtrs.push_back( std::make_unique<Mesh>( gfx,materials[mesh.mMaterialIndex],mesh,scale ) );
+		const auto& material = load.pCooked->GetMaterial( i );
+		for( const auto type : { aiTextureType_DIFFUSE,aiTextureType_SPECULAR,aiTextureType_NORMALS } )
+		{
+			aiString texFileName;
+			if( material.GetTexture( type,0,&texFileName ) == aiReturn_SUCCESS )
+			{
+				const auto path = rootPath + texFileName.C_Str();
+				if( !load.textures.count( path ) )
+				{
+					load.textures[path] = Bind::TextureResource::Prefetch( path );
+				}
+			}
+		}
+	}
+	return load;
+}
+
+void Model::Build( Graphics& gfx,Loaded& load )
+{
+	TRACE_ZONE( "Model::Build" );
+	auto& pCached = GetAssetCache()[assetKey];
+	// an instance streamed in at the same time may have finished first
+	if( auto pShared = pCached.lock() )
+	{
+		pAsset = std::move( pShared );
+	}
+	else
+	{
+		auto pNew = std::make_shared<Asset>();
+		pNew->pCooked = std::move( load.pCooked );
+		const auto& cooked = *pNew->pCooked;
+		if( textureArrays )
+		{
+			pNew->pAtlas = MakeAtlas( gfx,cooked,load );
+			if( options.logLoadReports )
+			{
+				OutputDebugStringA( (pathString + ": " + pNew->pAtlas->GetReport()).c_str() );
+			}
+		}
+		pNew->materials.reserve( cooked.GetMaterialCount() );
+		for( size_t i = 0; i < cooked.GetMaterialCount(); i++ )
+		{
+			pNew->materials.emplace_back( gfx,cooked.GetMaterial( i ),pathString,IsPBR,pNew->pAtlas.get(),options );
+		}
+		pNew->batched.assign( cooked.GetMeshes().size(),false );
+		if( batchMaxVertices )
+		{
+			pNew->batches = StaticBatch::Build( cooked,batchMaxVertices );
+			for( const auto& b : pNew->batches )
+			{
+				for( const auto& sub : b.subMeshes )
+				{
+					pNew->batched[sub.meshIndex] = true;
+				}
+			}
+			if( options.logLoadReports )
+			{
+				OutputDebugStringA( (pathString + ": " + StaticBatch::Report( StaticBatch::Analyze( pNew->batches,cooked.GetMeshes().size() ) )).c_str() );
+			}
+		}
+		pCached = pNew;
+		pAsset = std::move( pNew );
+	}
+	Instantiate( gfx );
+}
+
+std::unique_ptr<TextureAtlas> Model::MakeAtlas( Graphics& gfx,const CookedModel& cooked,const Loaded& load ) const
+{
+	// only decoded images can be packed, cooked (block compressed) ones keep their own textures
+	const auto rootPath = std::filesystem::path{ pathString }.parent_path().string() + "\\";
+	const aiTextureType types[] = { aiTextureType_DIFFUSE,aiTextureType_SPECULAR,aiTextureType_NORMALS };
+	std::array<std::vector<TextureAtlas::Image>,TextureAtlas::slotCount> images;
+	for( unsigned int slot = 0; slot < TextureAtlas::slotCount; slot++ )
+	{
+		std::unordered_set<std::string> seen;
+		for( size_t i = 0; i < cooked.GetMaterialCount(); i++ )
+		{
+			aiString texFileName;
+			if( cooked.GetMaterial( i ).GetTexture( types[slot],0,&texFileName ) != aiReturn_SUCCESS )
+			{
+				continue;
+			}
+			const auto path = rootPath + texFileName.C_Str();
+			const auto pDecoded = load.textures.find( path );
+			if( seen.insert( path ).second && pDecoded != load.textures.end() && pDecoded->second->surface )
+			{
+				images[slot].push_back( { path,&*pDecoded->second->surface } );
+			}
+		}
+	}
+	return std::make_unique<TextureAtlas>( gfx,images );
+}
+
+void Model::Instantiate( Graphics& gfx )
+{
+	TRACE_ZONE( "Model::Instantiate" );
+	const auto& cooked = *pAsset->pCooked;
+	const auto& meshes = cooked.GetMeshes();
+	for( size_t i = 0; i < meshes.size(); i++ )
+	{
+		meshPtrs.push_back( pAsset->batched[i] ? nullptr :
+			std::make_unique<Mesh>( gfx,pAsset->materials[meshes[i].materialIndex],meshes[i] )
+		);
+	}
+	for( size_t i = 0; i < pAsset->batches.size(); i++ )
+	{
+		const auto& b = pAsset->batches[i];
+		batchPtrs.push_back( std::make_unique<StaticBatch>( gfx,pAsset->materials[b.materialIndex],b,i ) );
 	}
 
 	int nextId = 0;
-	pRoot = ParseNode( nextId,*pScene->mRootNode,scale );
+	pRoot = ParseNode( nextId,cooked.GetRoot(),scale );
+	// calls that came in while loading
+	if( pendingRootTransform )
+	{
+		pRoot->SetAppliedTransform( dx::XMLoadFloat4x4( &*pendingRootTransform ) );
+	}
+	if( pLinkedGraph )
+	{
+		LinkTechniques( *pLinkedGraph );
+	}
+}
+
+std::unordered_map<std::string,std::weak_ptr<Model::Asset>>& Model::GetAssetCache() noexcept
+{
+	static std::unordered_map<std::string,std::weak_ptr<Asset>> cache;
+	return cache;
 }
 
-void Model::Submit( size_t channels ) const noxnd
+bool Model::IsLoaded() const noexcept
 {
-	pRoot->Submit( channels,dx::XMMatrixIdentity() );
+	return pRoot != nullptr;
+}
+
+void Model::Submit( size_t channels,const SubmitView* pView ) const noxnd
+{
+	if( !pRoot )
+	{
+		return;
+	}
+	pRoot->Submit( channels,dx::XMMatrixIdentity(),pView );
+	if( !batchPtrs.empty() )
+	{
+		// batched meshes only ever sit under identity nodes, so the root's frame is theirs
+		const auto rootFrame = dx::XMLoadFloat4x4( &pRoot->appliedTransform ) * dx::XMLoadFloat4x4( &pRoot->transform );
+		for( const auto& pb : batchPtrs )
+		{
+			pb->Submit( channels,rootFrame,pView );
+		}
+	}
 }
 
 void Model::SetRootTransform( DirectX::FXMMATRIX tf ) noexcept
 {
+	if( !pRoot )
+	{
+		pendingRootTransform.emplace();
+		dx::XMStoreFloat4x4( &*pendingRootTransform,tf );
+		return;
+	}
 	pRoot->SetAppliedTransform( tf );
 }
 
 void Model::Accept( ModelProbe & probe )
 {
+	if( !pRoot )
+	{
+		return;
+	}
 	pRoot->Accept( probe );
 }
 
 void Model::LinkTechniques( Rgph::RenderGraph& rg )
 {
+	pLinkedGraph = &rg;
 	for( auto& pMesh : meshPtrs )
 	{
-		pMesh->LinkTechniques( rg );
+		if( pMesh )
+		{
+			pMesh->LinkTechniques( rg );
+		}
+	}
+	for( auto& pb : batchPtrs )
+	{
+		pb->LinkTechniques( rg );
 	}
 }
 
 Model::~Model() noexcept
 {}
 
-std::unique_ptr<Node> Model::ParseNode( int& nextId,const aiNode& node,float scale ) noexcept
+std::unique_ptr<Node> Model::ParseNode( int& nextId,const CookedModel::NodeView& node,float scale ) noexcept
 {
 	namespace dx = DirectX;
 	const auto transform = ScaleTranslation( dx::XMMatrixTranspose( dx::XMLoadFloat4x4(
-		reinterpret_cast<const dx::XMFLOAT4X4*>(&node.mTransformation)
+		reinterpret_cast<const dx::XMFLOAT4X4*>(node.transform)
 	) ),scale );
 
 	std::vector<Mesh*> curMeshPtrs;
-	curMeshPtrs.reserve( node.mNumMeshes );
-	for( size_t i = 0; i < node.mNumMeshes; i++ )
+	curMeshPtrs.reserve( node.meshes.size() );
+	for( const auto meshIdx : node.meshes )
 	{
-		const auto meshIdx = node.mMeshes[i];
-		curMeshPtrs.push_back( meshPtrs.at( meshIdx ).get() );
+		if( const auto pMesh = meshPtrs.at( meshIdx ).get() )
+		{
+			curMeshPtrs.push_back( pMesh );
+		}
 	}
 
-	auto pNode = std::make_unique<Node>( nextId++,node.mName.C_Str(),std::move( curMeshPtrs ),transform );
-	for( size_t i = 0; i < node.mNumChildren; i++ )
+	auto pNode = std::make_unique<Node>( nextId++,node.name,std::move( curMeshPtrs ),transform );
+	for( const auto& child : node.children )
 	{
-		pNode->AddChild( ParseNode( nextId,*node.mChildren[i],scale ) );
+		pNode->AddChild( ParseNode( nextId,child,scale ) );
 	}
 
 	return pNode;
@@ -3,13 +3,18 @@
 #include <string>
 #include <memory>
 #include <filesystem>
+#include "ModelOptions.h"
+#include "CookedModel.h"
+#include "TextureResource.h"
+#include <optional>
+#include <unordered_map>
 
 class Node;
 class Mesh;
+class StaticBatch;
+class TextureAtlas;
 class ModelWindow;
-struct aiMesh;
-struct aiMaterial;
-struct aiNode;
+struct SubmitView;
 
 namespace Rgph
 {
@@ -19,17 +24,56 @@ namespace Rgph
 class Model
 {
 public:
-	Model(Graphics& gfx, const std::string& pathString, float scale = 1.0f, bool IsPBR = false);
-	void Submit( size_t channels ) const noxnd;
+	// with options.async and an AssetStreamer running this returns at once, and the model
+	// draws nothing until its data has been loaded on a worker and built on the render thread
+	// instances of a file that is already loaded (with the same scale and options) share its cooked
+	// data and materials and are built right away
+	Model(Graphics& gfx, const std::string& pathString, float scale = 1.0f, bool IsPBR = false, const ModelOptions& options = {});
+	bool IsLoaded() const noexcept;
+	// pView enables per-mesh occlusion culling and lod selection, see SubmitView
+	void Submit( size_t channels,const SubmitView* pView = nullptr ) const noxnd;
 	void SetRootTransform( DirectX::FXMMATRIX tf ) noexcept;
 	void Accept( class ModelProbe& probe );
 	void LinkTechniques( Rgph::RenderGraph& );
 	~Model() noexcept;
 private:
-	static std::unique_ptr<Mesh> ParseMesh( Graphics& gfx,const aiMesh& mesh,const aiMaterial* const* pMaterials,const std::filesystem::path& path,float scale );
-	std::unique_ptr<Node> ParseNode( int& nextId,const aiNode& node,float scale ) noexcept;
+	// everything that can be done off the render thread
+	struct Loaded
+	{
+		std::unique_ptr<CookedModel> pCooked;
+		// by path, kept alive until the materials (or the texture atlas) have picked them up
+		std::unordered_map<std::string,std::shared_ptr<Bind::TextureResource::Decoded>> textures;
+	};
+	// the cooked data and materials every instance of one file shares
+	struct Asset;
+	static Loaded Load( const std::string& pathString,float scale,bool IsPBR,const ModelOptions& options );
+	// makes the shared asset from a load, unless another instance got there first
+	void Build( Graphics& gfx,Loaded& load );
+	std::unique_ptr<TextureAtlas> MakeAtlas( Graphics& gfx,const CookedModel& cooked,const Loaded& load ) const;
+	// per-instance meshes and nodes over the shared asset
+	void Instantiate( Graphics& gfx );
+	// only touched on the render thread
+	static std::unordered_map<std::string,std::weak_ptr<Asset>>& GetAssetCache() noexcept;
+	std::unique_ptr<Node> ParseNode( int& nextId,const CookedModel::NodeView& node,float scale ) noexcept;
 private:
+	std::string pathString;
+	float scale;
+	bool IsPBR;
+	// kept for Build, its materials must pick the vertex elements the mesh data was cooked with
+	ModelOptions options;
+	std::string assetKey;
+	// 0 when static batching is off
+	unsigned int batchMaxVertices;
+	bool textureArrays;
+	std::shared_ptr<const Asset> pAsset;
+	// lets a streaming finalizer find out whether the model is still alive
+	std::shared_ptr<Model*> pAliveToken = std::make_shared<Model*>( this );
+	std::optional<DirectX::XMFLOAT4X4> pendingRootTransform;
+	Rgph::RenderGraph* pLinkedGraph = nullptr;
 	std::unique_ptr<Node> pRoot;
-	// sharing meshes here perhaps dangerous?
+	// meshes carry per-instance transforms and cluster / lod state, so only their buffers are shared
+	// null for the meshes merged into a batch
 	std::vector<std::unique_ptr<Mesh>> meshPtrs;
+	// drawn in the root node's frame
+	std::vector<std::unique_ptr<StaticBatch>> batchPtrs;
 };
\ No newline at end of file
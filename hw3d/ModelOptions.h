@@ -0,0 +1,38 @@
+#pragma once
+
+// import-time processing applied by Model to every mesh
+struct ModelOptions
+{
+	// levels including the full-detail mesh, 1 disables lod generation
+	unsigned int lodCount = 1u;
+	// target triangle ratio between neighbouring levels
+	float lodReduction = 0.5f;
+	// largest simplification error allowed, relative to the mesh bounding box diagonal
+	float lodMaxError = 0.02f;
+	// projected size (see SubmitView) below which lod 1 is used, halves for every further level
+	float lodScreenSize = 0.25f;
+	// split the full-detail mesh into clusters that are frustum / backface culled per view
+	bool clusters = false;
+	unsigned int clusterMaxVertices = 64u;
+	unsigned int clusterMaxTriangles = 124u;
+	// reorder triangles and vertices for the vertex cache, overdraw and vertex fetch (see MeshOptimizer)
+	bool optimizeMeshes = true;
+	// acmr that may be given up to sort triangle clusters for overdraw, 1 keeps pure cache order
+	float overdrawThreshold = 1.05f;
+	// merge small meshes sharing a material into one buffer per material at load (see StaticBatch)
+	bool staticBatching = false;
+	// meshes with more vertices are left alone
+	unsigned int staticBatchMaxVertices = 4096u;
+	// write what load-time packing did (batches, texture arrays) to the debug output, see also batch-report
+	bool logLoadReports = false;
+	// pbr vertices with octahedral normal / tangent (binormal sign bit instead of a binormal) and half uvs
+	bool quantizeVertices = false;
+	// with quantizeVertices, also 16-bit positions dequantized by the mesh transform
+	bool quantizePositions = false;
+	// pack the material textures of pbr models into one texture array per slot (see TextureAtlas)
+	bool textureArrays = false;
+	// map the cooked result from <model>.cooked when it matches, write it after an import otherwise
+	bool useCache = true;
+	// with an AssetStreamer running, import / decode on a worker and build once the data is there
+	bool async = false;
+};
@@ -15,7 +15,7 @@ Node::Node( int id,const std::string& name,std::vector<Mesh*> meshPtrs,const Dir
 	dx::XMStoreFloat4x4( &appliedTransform,dx::XMMatrixIdentity() );
 }
 
-void Node::Submit( size_t channels,DirectX::FXMMATRIX accumulatedTransform ) const noxnd
+void Node::Submit( size_t channels,DirectX::FXMMATRIX accumulatedTransform,const SubmitView* pView ) const noxnd
 {
 	const auto built =
 		dx::XMLoadFloat4x4( &appliedTransform ) *
@@ -23,11 +23,11 @@ void Node::Submit( size_t channels,DirectX::FXMMATRIX accumulatedTransform ) con
 		accumulatedTransform;
 	for( const auto pm : meshPtrs )
 	{
-		pm->Submit( channels,built );
+		pm->Submit( channels,built,pView );
 	}
 	for( const auto& pc : childPtrs )
 	{
-		pc->Submit( channels,built );
+		pc->Submit( channels,built,pView );
 	}
 }
 
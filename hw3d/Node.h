@@ -2,16 +2,20 @@
 #include "Graphics.h"
 
 class Model;
+class Benchmark;
 class Mesh;
 class TechniqueProbe;
 class ModelProbe;
+struct SubmitView;
 
 class Node
 {
 	friend Model;
+	// builds synthetic hierarchies
+	friend Benchmark;
 public:
 	Node( int id,const std::string& name,std::vector<Mesh*> meshPtrs,const DirectX::XMMATRIX& transform ) noxnd;
-	void Submit( size_t channels,DirectX::FXMMATRIX accumulatedTransform ) const noxnd;
+	void Submit( size_t channels,DirectX::FXMMATRIX accumulatedTransform,const SubmitView* pView = nullptr ) const noxnd;
 	void SetAppliedTransform( DirectX::FXMMATRIX transform ) noexcept;
 	const DirectX::XMFLOAT4X4& GetAppliedTransform() const noexcept;
 	int GetId() const noexcept;
@@ -0,0 +1,2 @@
+#define TextureArrays
+#include "PBREncodeToGbuffer.hlsl"
\ No newline at end of file
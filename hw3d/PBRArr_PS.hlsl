@@ -0,0 +1,2 @@
+#define TextureArrays
+#include "PBR_PS.hlsl"
\ No newline at end of file
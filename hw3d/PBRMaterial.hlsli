@@ -0,0 +1,35 @@
+// parameters of every pbr material of one layout in a single structured buffer (see Bind::MaterialTable),
+// each draw only selects its element
+// elements are the Dcb layout Material builds, which packs like a cbuffer, so the padding
+// cbuffer rules would insert is spelled out here
+struct PBRMaterial
+{
+	bool enableAbedoMap;
+	bool enableMRAMap;
+	bool enableNormalMap;
+	bool useAbedoMap;
+	float3 materialColor;
+	bool useMetallicMap;
+	bool useRoughnessMap;
+	float metallic;
+	float roughness;
+	bool useNormalMap;
+	float normalMapWeight;
+	float3 pad0;
+#ifdef TextureArrays
+	float4 abedoRect;
+	float4 mraRect;
+	float4 normalRect;
+	float abedoSlice;
+	float mraSlice;
+	float normalSlice;
+	float pad1;
+#endif
+};
+
+StructuredBuffer<PBRMaterial> materials : register(t3);
+
+cbuffer MaterialIndex : register(b10)
+{
+	uint materialIndex;
+};
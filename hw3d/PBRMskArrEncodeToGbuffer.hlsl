@@ -0,0 +1,3 @@
+#define AlphaTest
+#define TextureArrays
+#include "PBREncodeToGbuffer.hlsl"
\ No newline at end of file
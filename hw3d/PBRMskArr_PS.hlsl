@@ -0,0 +1,3 @@
+#define AlphaTest
+#define TextureArrays
+#include "PBR_PS.hlsl"
\ No newline at end of file
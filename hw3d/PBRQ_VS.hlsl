@@ -0,0 +1,2 @@
+#define QuantizedVertices
+#include "PBR_VS.hlsl"
\ No newline at end of file
@@ -4,24 +4,18 @@
 
 #define IsPBR
 
+#ifdef TextureArrays
+// shared by many materials, each picking its image by slice / rect (see TextureAtlas)
+Texture2DArray tex;
+Texture2DArray mramap : register(t1);
+Texture2DArray nmap : register(t2);
+#else
 Texture2D tex;
 Texture2D mramap : register(t1);
 Texture2D nmap : register(t2);
+#endif
 
-cbuffer ObjectCBuf : register(b10)
-{
-	bool enableAbedoMap;
-	bool enableMRAMap;
-	bool enableNormalMap;
-	bool useAbedoMap;
-	float3 materialColor;
-	bool useMetallicMap;
-	bool useRoughnessMap;
-	float metallic;
-	float roughness;
-	bool useNormalMap;
-	float normalMapWeight;
-};
+#include "PBRMaterial.hlsli"
 
 struct PSIn {
 	float3 worldPos : Position;
@@ -50,13 +44,18 @@ struct MaterialShadingParameters
 void GetMaterialParameters(out MaterialShadingParameters matParams, PSIn IN)
 {
 	matParams.shadingModelID = ShadingModel_PBR;
+	const PBRMaterial mat = materials[materialIndex];
 	matParams.worldPos = IN.worldPos;
-	float3 abedo = materialColor;
-	if (enableAbedoMap)
+	float3 abedo = mat.materialColor;
+	if (mat.enableAbedoMap)
 	{
-		if (useAbedoMap)
+		if (mat.useAbedoMap)
 		{
+			#ifdef TextureArrays
+			float4 basecolor = SampleAtlas(tex, splr, IN.uv, mat.abedoRect, mat.abedoSlice);
+#else
 			float4 basecolor = tex.Sample(splr, IN.uv);
+#endif
 		#ifdef AlphaTest
 			// bail if highly translucent
 			clip(basecolor.a < 0.1f ? -1 : 1);
@@ -66,17 +65,21 @@ void GetMaterialParameters(out MaterialShadingParameters matParams, PSIn IN)
 	}
 	matParams.baseColor = abedo;
 
-	float fmetallic = metallic;
-	float froughness = roughness;
+	float fmetallic = mat.metallic;
+	float froughness = mat.roughness;
 	float AO = 1.0f;
-	if (enableMRAMap)
+	if (mat.enableMRAMap)
 	{
+#ifdef TextureArrays
+		float3 MRA = SampleAtlas(mramap, splr, IN.uv, mat.mraRect, mat.mraSlice).rgb;
+#else
 		float3 MRA = mramap.Sample(splr, IN.uv).rgb;
-		if (useMetallicMap)
+#endif
+		if (mat.useMetallicMap)
 		{
 			fmetallic *= MRA.x;
 		}
-		if (useRoughnessMap)
+		if (mat.useRoughnessMap)
 		{
 			froughness *= MRA.y;
 		}
@@ -88,12 +91,17 @@ void GetMaterialParameters(out MaterialShadingParameters matParams, PSIn IN)
 	matParams.specular = 0.5f;
 
 	float3 normal = normalize(IN.normal);
-	if (enableNormalMap)
+	if (mat.enableNormalMap)
 	{
-		if (useNormalMap)
+		if (mat.useNormalMap)
 		{
+#ifdef TextureArrays
+			const float3 mappedNormal = UnpackTangentNormal(normalize(IN.tangent), normalize(IN.binormal), normal,
+				SampleAtlas(nmap, splr, IN.uv, mat.normalRect, mat.normalSlice).xyz);
+#else
 			const float3 mappedNormal = MapNormal(normalize(IN.tangent), normalize(IN.binormal), normal, IN.uv, nmap, splr);
-			normal = lerp(normal, mappedNormal, normalMapWeight);
+#endif
+			normal = lerp(normal, mappedNormal, mat.normalMapWeight);
 			normal = normalize(normal);
 		}
 	}
@@ -0,0 +1,47 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+// calls func( i ) for every i in [0,count), each index taken in turn by the next free thread
+// threads counts the calling thread, which always works too (0 means one per hardware thread),
+// and is never more than count; returns how many threads ran
+// enterThread() runs first on every thread and what it returns lives until the thread is done
+// (per-thread setup like com initialization)
+template<typename F,typename Enter>
+unsigned int ParallelFor( size_t count,unsigned int threads,F&& func,Enter&& enterThread )
+{
+	if( threads == 0u )
+	{
+		threads = std::max( std::thread::hardware_concurrency(),1u );
+	}
+	threads = (unsigned int)std::min( size_t( threads ),std::max( count,size_t( 1 ) ) );
+
+	std::atomic<size_t> next{ 0u };
+	const auto Work = [&]()
+	{
+		[[maybe_unused]] const auto scope = enterThread();
+		for( size_t i = next++; i < count; i = next++ )
+		{
+			func( i );
+		}
+	};
+	std::vector<std::thread> workers;
+	for( unsigned int i = 1; i < threads; i++ )
+	{
+		workers.emplace_back( Work );
+	}
+	Work();
+	for( auto& w : workers )
+	{
+		w.join();
+	}
+	return threads;
+}
+
+template<typename F>
+unsigned int ParallelFor( size_t count,unsigned int threads,F&& func )
+{
+	return ParallelFor( count,threads,std::forward<F>( func ),[]() { return 0; } );
+}
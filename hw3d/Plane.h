@@ -2,6 +2,7 @@
 
 #include <optional>
 #include "Vertex.h"
+#include "VertexFormat.h"
 #include "IndexedTriangleList.h"
 #include <DirectXMath.h>
 #include "ChiliMath.h"
@@ -29,83 +30,76 @@ public:
 		constexpr float height = 2.0f;
 		const int nVertices_x = divisions_x + 1;
 		const int nVertices_y = divisions_y + 1;
-		Dvtx::VertexBuffer vb{ std::move( layout ) };
-
+		// the grid is written through the vertex format matching the requested elements, no per-element dispatch
+		const auto makeGrid = [&]<typename Format>( const Format*,auto&& makeVertex )
 		{
 			const float side_x = width / 2.0f;
 			const float side_y = height / 2.0f;
 			const float divisionSize_x = width / float( divisions_x );
 			const float divisionSize_y = height / float( divisions_y );
-			float divisionSize_x_tc;
-			float divisionSize_y_tc;
-			if (withTexture)
-			{
-				divisionSize_x_tc = 1.0f / float(divisions_x);
-				divisionSize_y_tc = 1.0f / float(divisions_y);
-			}
-			for( int y = 0,i = 0; y < nVertices_y; y++ )
+			const float divisionSize_x_tc = 1.0f / float( divisions_x );
+			const float divisionSize_y_tc = 1.0f / float( divisions_y );
+			std::vector<typename Format::Vertex> vertices;
+			vertices.reserve( size_t( nVertices_x ) * nVertices_y );
+			for( int y = 0; y < nVertices_y; y++ )
 			{
 				const float y_pos = float( y ) * divisionSize_y - side_y;
-				float y_pos_tc;
-				if (withTexture)
-					y_pos_tc = 1.0f - float(y) * divisionSize_y_tc;
-				for( int x = 0; x < nVertices_x; x++,i++ )
+				const float y_pos_tc = 1.0f - float( y ) * divisionSize_y_tc;
+				for( int x = 0; x < nVertices_x; x++ )
 				{
-					const float x_pos = float( x ) * divisionSize_x - side_x;	
-					if (withTexture)
-					{
-						float x_pos_tc = float(x) * divisionSize_x_tc;
-						if (withNormal)
-						{
-							if (withTangent)
-							{
-								vb.EmplaceBack(
-									dx::XMFLOAT3{ x_pos,y_pos,0.0f },
-									dx::XMFLOAT3{ 1.0f,0.0f,0.0f },
-									dx::XMFLOAT3{ 0.0f,-1.0f,0.0f },
-									dx::XMFLOAT3{ 0.0f,0.0f,-1.0f },
-									dx::XMFLOAT2{ x_pos_tc,y_pos_tc }
-								);
-							}
-							else
-							{
-								vb.EmplaceBack(
-									dx::XMFLOAT3{ x_pos,y_pos,0.0f },
-									dx::XMFLOAT3{ 0.0f,0.0f,-1.0f },
-									dx::XMFLOAT2{ x_pos_tc,y_pos_tc }
-								);
-							}
-						}
-						else
-						{
-							vb.EmplaceBack(
-								dx::XMFLOAT3{ x_pos,y_pos,0.0f },
-								dx::XMFLOAT2{ x_pos_tc,y_pos_tc }
-							);
-						}
-					}
-					else
-					{
-						vb.EmplaceBack(
-							dx::XMFLOAT3{ x_pos,y_pos,0.0f }
-						);
-					}
+					const float x_pos = float( x ) * divisionSize_x - side_x;
+					const float x_pos_tc = float( x ) * divisionSize_x_tc;
+					vertices.push_back( makeVertex( dx::XMFLOAT3{ x_pos,y_pos,0.0f },dx::XMFLOAT2{ x_pos_tc,y_pos_tc } ) );
 				}
 			}
-		}
+			return Format::MakeBuffer( std::move( layout ),vertices );
+		};
+		using Element = Dvtx::VertexLayout::ElementType;
+		using Pos = Dvtx::VertexFormat<Element::Position3D>;
+		using PosTex = Dvtx::VertexFormat<Element::Position3D,Element::Texture2D>;
+		using PosNormalTex = Dvtx::VertexFormat<Element::Position3D,Element::Normal,Element::Texture2D>;
+		using PosTBNTex = Dvtx::VertexFormat<Element::Position3D,Element::Tangent,Element::Binormal,Element::Normal,Element::Texture2D>;
+		Dvtx::VertexBuffer vb = [&]()
+		{
+			if( !withTexture )
+			{
+				return makeGrid( (const Pos*)nullptr,[]( const dx::XMFLOAT3& pos,const dx::XMFLOAT2& )
+				{
+					return Pos::Make( pos );
+				} );
+			}
+			if( !withNormal )
+			{
+				return makeGrid( (const PosTex*)nullptr,[]( const dx::XMFLOAT3& pos,const dx::XMFLOAT2& tc )
+				{
+					return PosTex::Make( pos,tc );
+				} );
+			}
+			if( !withTangent )
+			{
+				return makeGrid( (const PosNormalTex*)nullptr,[]( const dx::XMFLOAT3& pos,const dx::XMFLOAT2& tc )
+				{
+					return PosNormalTex::Make( pos,{ 0.0f,0.0f,-1.0f },tc );
+				} );
+			}
+			return makeGrid( (const PosTBNTex*)nullptr,[]( const dx::XMFLOAT3& pos,const dx::XMFLOAT2& tc )
+			{
+				return PosTBNTex::Make( pos,{ 1.0f,0.0f,0.0f },{ 0.0f,-1.0f,0.0f },{ 0.0f,0.0f,-1.0f },tc );
+			} );
+		}();
 
-		std::vector<unsigned short> indices;
-		indices.reserve( sq( divisions_x * divisions_y ) * 6 );
+		std::vector<unsigned int> indices;
+		indices.reserve( size_t( divisions_x ) * divisions_y * 6 );
 		{
 			const auto vxy2i = [nVertices_x]( size_t x,size_t y )
 			{
-				return (unsigned short)(y * nVertices_x + x);
+				return (unsigned int)(y * nVertices_x + x);
 			};
 			for( size_t y = 0; y < divisions_y; y++ )
 			{
 				for( size_t x = 0; x < divisions_x; x++ )
 				{
-					const std::array<unsigned short,4> indexArray =
+					const std::array<unsigned int,4> indexArray =
 					{ vxy2i( x,y ),vxy2i( x + 1,y ),vxy2i( x,y + 1 ),vxy2i( x + 1,y + 1 ) };
 					indices.push_back( indexArray[0] );
 					indices.push_back( indexArray[2] );
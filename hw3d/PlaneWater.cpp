@@ -199,14 +199,9 @@ void PlaneWater::SubmitEX(size_t channels1, size_t channels2) const
 {
 	Submit(channels1);
 
-	auto buf = waterCaustics.dmc->GetBuffer();
-	auto buf2 = vmc->GetBuffer();
-	float f = buf2["depth"];
-	buf["depth"] = f;
-	waterCaustics.dmc->SetBuffer(buf);
-	auto buf3 = pmc->GetBuffer();
-	buf3["_depth"] = f;
-	pmc->SetBuffer(buf3);
+	const float f = vmc->GetBuffer()["depth"];
+	waterCaustics.dmc->EditBuffer()["depth"] = f;
+	pmc->EditBuffer()["_depth"] = f;
 
 	waterCaustics.Submit(channels2);
 	Submit(channels2);
@@ -66,13 +66,11 @@ void PointLight::SpawnControlWindow(const char* name) noexcept
 void PointLight::Reset() noexcept
 {
 	cbData = home;
-	auto buf = mesh.cbuf->GetBuffer();
-	buf["color"] = DirectX::XMFLOAT3{
+	mesh.cbuf->EditBuffer()["color"] = DirectX::XMFLOAT3{
 		cbData.diffuseColor.x * cbData.diffuseIntensity,
 		cbData.diffuseColor.y * cbData.diffuseIntensity,
 		cbData.diffuseColor.z * cbData.diffuseIntensity
 	};
-	mesh.cbuf->SetBuffer(buf);
 }
 
 void PointLight::Submit( size_t channels ) const noxnd
@@ -110,6 +108,11 @@ DirectX::XMFLOAT3 PointLight::GetPos() noexcept
 	return cbData.pos;
 }
 
+void PointLight::SetPos(DirectX::XMFLOAT3 pos) noexcept
+{
+	cbData.pos = pos;
+}
+
 void PointLight::RotateAround(float dx, float dy, DirectX::XMFLOAT3 centralPoint, float speed) noexcept
 {
 	using namespace DirectX;
@@ -22,6 +22,7 @@ public:
 	void LinkTechniques( Rgph::RenderGraph& );
 	//std::shared_ptr<Camera> ShareCamera() const noexcept;
 	DirectX::XMFLOAT3 GetPos() noexcept;
+	void SetPos(DirectX::XMFLOAT3 pos) noexcept;
 	void RotateAround(float dx, float dy, DirectX::XMFLOAT3 centralPoint, float speed) noexcept;
 private:
 	struct PointLightCBuf
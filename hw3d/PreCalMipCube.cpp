@@ -38,9 +38,7 @@ namespace Rgph
 				pPreCalMipCube->ChangeMipSlice(gfx, i);
 			}
 			pPreCalMipCube->_width = pPreCalMipCube->_height = 256u * (float)pow(0.5, i);
-			auto k = roughness->GetBuffer();
-			k["roughness"] = i / 4.0f;
-			roughness->SetBuffer(k);
+			roughness->EditBuffer()["roughness"] = i / 4.0f;
 			for (unsigned char j = 0; j < 6; j++)
 			{
 				gfx.SetCamera(viewmatrix[j]);
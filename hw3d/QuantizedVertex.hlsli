@@ -0,0 +1,32 @@
+// compact vertex elements (see Dvtx::VertexLayout OctNormal / OctTangent / HalfTexture2D / QuantizedPosition3D)
+// decoded to the full VSIn before the trunk runs
+struct QuantizedVSIn
+{
+	// float3 or 16-bit unorm, the mesh transform carries the dequantization either way
+	float3 pos : Position;
+	// octahedral, 16-bit snorm
+	float2 n : Normal;
+	// octahedral 16 + 15 bits, binormal sign in the top bit of y
+	uint2 t : Tangent;
+	// half
+	float2 uv : Texcoord;
+};
+
+float3 DecodeOctahedral(float2 e)
+{
+	float3 v = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	const float t = saturate(-v.z);
+	v.xy += v.xy >= 0.0f ? -t : t;
+	return normalize(v);
+}
+
+VSIn DecodeVertex(QuantizedVSIn q)
+{
+	VSIn v;
+	v.pos = q.pos;
+	v.n = DecodeOctahedral(q.n);
+	v.t = DecodeOctahedral(float2(q.t.x / 65535.0f, (q.t.y & 0x7FFF) / 32767.0f) * 2.0f - 1.0f);
+	v.b = cross(v.n, v.t) * ((q.t.y & 0x8000) ? -1.0f : 1.0f);
+	v.uv = q.uv;
+	return v;
+}
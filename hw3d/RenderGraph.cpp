@@ -7,6 +7,9 @@
 #include "RenderQueuePass.h"
 #include "Sink.h"
 #include "Source.h"
+#include "Trace.h"
+#include "FrameProfiler.h"
+#include "imgui/imgui.h"
 #include <sstream>
 
 namespace Rgph
@@ -67,12 +70,93 @@ namespace Rgph
 	void RenderGraph::Execute( Graphics& gfx ) noxnd
 	{
 		assert( finalized );
-		for( auto& p : passes )
+		TRACE_ZONE( "RenderGraph::Execute" );
+		if( passStats.size() != passes.size() )
+		{
+			passStats.clear();
+			for( const auto& p : passes )
+			{
+				passStats.push_back( { p->GetName() } );
+			}
+		}
+		for( size_t i = 0; i < passes.size(); i++ )
 		{
+			const auto& p = passes[i];
+			TRACE_ZONE_DYNAMIC( p->GetName() );
+			const auto before = gfx.GetStatsCounters();
+			if( pProfiler )
+			{
+				pProfiler->BeginPass( gfx,p->GetName() );
+			}
 			p->Execute( gfx );
+			if( pProfiler )
+			{
+				pProfiler->EndPass( gfx );
+			}
+			passStats[i].stats = gfx.GetStatsCounters();
+			passStats[i].stats -= before;
 		}
 	}
 
+	void RenderGraph::SetProfiler( FrameProfiler* pProfiler_in ) noexcept
+	{
+		pProfiler = pProfiler_in;
+	}
+
+	const std::vector<RenderGraph::PassStats>& RenderGraph::GetPassStats() const noexcept
+	{
+		return passStats;
+	}
+
+	void RenderGraph::RenderStatsWindow( const Graphics& gfx ) const
+	{
+		if( ImGui::Begin( "Frame Stats" ) )
+		{
+			const auto& f = gfx.GetFrameStats();
+			ImGui::Text( "Draws: %zu (%zu indices, ~%zu tris)",f.draws,f.indices,f.GetTriangles() );
+			ImGui::Text( "Binds: %zu (%zu avoided)",f.binds,f.bindsAvoided );
+			ImGui::Text( "CB uploads: %zu (%zu bytes)",f.constantUploads,f.constantBytes );
+			ImGui::Text( "Jobs: %zu executed / %zu submitted",f.jobsExecuted,f.jobsSubmitted );
+			if( ImGui::CollapsingHeader( "Passes",ImGuiTreeNodeFlags_DefaultOpen ) )
+			{
+				const auto cell = []( const char* format,auto... args )
+				{
+					ImGui::Text( format,args... );
+					ImGui::NextColumn();
+				};
+				ImGui::Columns( 7,"passStats" );
+				for( const auto heading : { "Pass","Draws","Tris","Binds","Avoided","CB bytes","Jobs" } )
+				{
+					cell( "%s",heading );
+				}
+				ImGui::Separator();
+				for( const auto& p : passStats )
+				{
+					const auto& s = p.stats;
+					cell( "%s",p.name.c_str() );
+					cell( "%zu",s.draws );
+					cell( "%zu",s.GetTriangles() );
+					cell( "%zu",s.binds );
+					cell( "%zu",s.bindsAvoided );
+					cell( "%zu",s.constantBytes );
+					cell( "%zu/%zu",s.jobsExecuted,s.jobsSubmitted );
+				}
+				ImGui::Columns( 1 );
+			}
+			if( ImGui::CollapsingHeader( "Binds by type" ) )
+			{
+				for( size_t i = 0; i < FrameStats::GetBindTypeCount(); i++ )
+				{
+					if( f.bindsByType[i] != 0u )
+					{
+						ImGui::Text( "%s: %zu",FrameStats::GetBindTypeName( i ),f.bindsByType[i] );
+					}
+				}
+			}
+		}
+		ImGui::End();
+	}
+
 	void RenderGraph::Reset() noexcept
 	{
 		assert( finalized );
@@ -218,4 +302,9 @@ namespace Rgph
 	{
 		masterDepth->ToSurface( gfx ).Save( path );
 	}
+
+	const Bind::OutputOnlyDepthStencil& Rgph::RenderGraph::GetMasterDepth() const noexcept
+	{
+		return *masterDepth;
+	}
 }
\ No newline at end of file
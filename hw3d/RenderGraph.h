@@ -4,8 +4,10 @@
 #include <memory>
 #include <filesystem>
 #include "ConditionalNoexcept.h"
+#include "FrameStats.h"
 
 class Graphics;
+class FrameProfiler;
 
 namespace Bind
 {
@@ -36,6 +38,18 @@ namespace Rgph
 		void Reset() noexcept;
 		RenderQueuePass& GetRenderQueue( const std::string& passName );
 		void StoreDepth( Graphics& gfx,const std::string& path );
+		const Bind::OutputOnlyDepthStencil& GetMasterDepth() const noexcept;
+		// times every pass into the profiler's current frame, null to stop
+		void SetProfiler( FrameProfiler* pProfiler ) noexcept;
+		struct PassStats
+		{
+			std::string name;
+			FrameStats stats;
+		};
+		// what each pass issued the last time the graph was executed, in execution order
+		const std::vector<PassStats>& GetPassStats() const noexcept;
+		// per frame and per pass counters, next to the graph's other windows
+		void RenderStatsWindow( const Graphics& gfx ) const;
 	protected:
 		void SetSinkTarget( const std::string& sinkName,const std::string& target );
 		void AddGlobalSource( std::unique_ptr<Source> );
@@ -53,5 +67,7 @@ namespace Rgph
 		std::vector<std::unique_ptr<Source>> globalSources;
 		std::vector<std::unique_ptr<Sink>> globalSinks;
 		bool finalized = false;
+		FrameProfiler* pProfiler = nullptr;
+		std::vector<PassStats> passStats;
 	};
 }
\ No newline at end of file
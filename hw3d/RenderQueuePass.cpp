@@ -11,9 +11,16 @@ namespace Rgph
 	{
 		BindAll( gfx );
 
+		auto& stats = gfx.GetStatsCounters();
+		stats.jobsSubmitted += jobs.size();
+		// starts empty every pass, other passes change the input assembler state in between
+		BoundInputs bound;
 		for( const auto& j : jobs )
 		{
-			j.Execute( gfx );
+			if( j.Execute( gfx,bound ) )
+			{
+				stats.jobsExecuted++;
+			}
 		}
 	}
 
@@ -86,6 +86,10 @@ namespace Bind
 		return typeid(Sampler).name() + "#"s + std::to_string( (int)filter) + std::to_string((int)address) + "@"s + std::to_string((int)slot) +
 			std::to_string(shaderIndex) + std::to_string(LODRange);
 	}
+	std::uint64_t Sampler::GenerateKey(Filter filter, Address address, UINT slot, UINT shaderIndex, float LODRange) noexcept
+	{
+		return Codex::Hasher{ Codex::TypeKey<Sampler>() }.Add( filter ).Add( address ).Add( slot ).Add( shaderIndex ).Add( LODRange ).Get();
+	}
 	std::string Sampler::GetUID() const noexcept
 	{
 		return GenerateUID(filter, address, slot, shaderIndex, LODRange);
@@ -24,6 +24,7 @@ namespace Bind
 		static std::shared_ptr<Sampler> Resolve(Graphics& gfx, Filter filter = Filter::Anisotropic, Address address = Address::Wrap,
 			UINT slot = 0u, UINT shaderIndex = 0b1u, float LODRange = 3.402823466e+38F);
 		static std::string GenerateUID(Filter filter, Address address, UINT slot, UINT shaderIndex, float LODRange);
+		static std::uint64_t GenerateKey(Filter filter, Address address, UINT slot, UINT shaderIndex, float LODRange) noexcept;
 		std::string GetUID() const noexcept override;
 	protected:
 		Microsoft::WRL::ComPtr<ID3D11SamplerState> pSampler;
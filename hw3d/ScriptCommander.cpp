@@ -5,6 +5,11 @@
 #include "json.hpp"
 #include "TexturePreprocessor.h"
 #include "Testing.h"
+#include "MeshAnalysis.h"
+#include "Benchmark.h"
+#include "Trace.h"
+#include "BindableCodex.h"
+#include "FlythroughBenchmark.h"
 
 namespace jso = nlohmann;
 using namespace std::string_literals;
@@ -47,11 +52,157 @@ ScriptCommander::ScriptCommander( const std::vector<std::string>& args )
 					TexturePreprocessor::ValidateNormalMap( params.at( "source" ),params.at( "min" ),params.at( "max" ) );
 					abort = true;
 				}
+				else if( commandName == "cook-texture" )
+				{
+					const auto kind = params.value( "kind","color"s );
+					const auto source = params.at( "source" ).get<std::string>();
+					TexturePreprocessor::CookTexture( source,params.value( "dest",TexturePreprocessor::GetCookedPath( source ) ),
+						kind == "normal" ? TexturePreprocessor::CookKind::Normal :
+						kind == "scalar" ? TexturePreprocessor::CookKind::Scalar :
+						TexturePreprocessor::CookKind::Color,
+						params.value( "flipY",false ),params.value( "fast",false ) );
+					abort = true;
+				}
+				else if( commandName == "cook-textures" )
+				{
+					TexturePreprocessor::CookModelTextures( params.at( "source" ),params.value( "dest","texture_cook.txt"s ),
+						params.value( "flipY",false ),params.value( "threads",0u ),params.value( "force",false ),params.value( "fast",false ) );
+					abort = true;
+				}
 				else if( commandName == "make-stripes" )
 				{
 					TexturePreprocessor::MakeStripes( params.at( "dest" ),params.at( "size" ),params.at( "stripeWidth" ) );
 					abort = true;
 				}
+				else if( commandName == "lod-report" )
+				{
+					MeshAnalysis::ReportLods( params.at( "source" ),params.value( "dest","lod_report.txt"s ),
+						params.value( "lods",4u ),params.value( "reduction",0.5f ),params.value( "maxError",0.02f ) );
+					abort = true;
+				}
+				else if( commandName == "vertex-cache-report" )
+				{
+					MeshAnalysis::ReportVertexCache( params.at( "source" ),params.value( "dest","vertex_cache_report.txt"s ),
+						params.value( "cacheSize",16u ),params.value( "vertexSize",56u ),params.value( "overdrawThreshold",1.05f ) );
+					abort = true;
+				}
+				else if( commandName == "cluster-report" )
+				{
+					MeshAnalysis::ReportClusters( params.at( "source" ),params.value( "dest","cluster_report.txt"s ),
+						params.value( "maxVertices",64u ),params.value( "maxTriangles",124u ),
+						params.value( "views",16u ),params.value( "distance",0.5f ) );
+					abort = true;
+				}
+				else if( commandName == "cook-benchmark" )
+				{
+					MeshAnalysis::BenchmarkCookedLoad( params.at( "source" ),params.value( "dest","cook_benchmark.txt"s ),
+						params.value( "iterations",5u ),params.value( "scale",1.0f ),params.value( "pbr",false ) );
+					abort = true;
+				}
+				else if( commandName == "batch-report" )
+				{
+					MeshAnalysis::ReportStaticBatching( params.at( "source" ),params.value( "dest","batch_report.txt"s ),
+						params.value( "maxVertices",4096u ),params.value( "scale",1.0f ),params.value( "pbr",false ) );
+					abort = true;
+				}
+				else if( commandName == "quantize-report" )
+				{
+					MeshAnalysis::ReportVertexQuantization( params.at( "source" ),params.value( "dest","quantize_report.txt"s ),
+						params.value( "iterations",5u ) );
+					abort = true;
+				}
+				else if( commandName == "vertex-convert-benchmark" )
+				{
+					MeshAnalysis::BenchmarkVertexConversion( params.at( "source" ),params.value( "dest","vertex_convert_benchmark.txt"s ),
+						params.value( "iterations",5u ),params.value( "scale",1.0f ),params.value( "threads",0u ) );
+					abort = true;
+				}
+				else if( commandName == "dcb-benchmark" )
+				{
+					Benchmark::DcbAccess( params.value( "dest","dcb_benchmark.txt"s ),
+						params.value( "iterations",9u ),params.value( "passes",100000u ) );
+					abort = true;
+				}
+				else if( commandName == "vertex-benchmark" )
+				{
+					Benchmark::VertexFormats( params.value( "dest","vertex_benchmark.txt"s ),
+						params.value( "iterations",9u ),params.value( "vertices",262144u ) );
+					abort = true;
+				}
+				else if( commandName == "cbring-benchmark" )
+				{
+					Benchmark::ConstantRing( params.value( "dest","cbring_benchmark.txt"s ),
+						params.value( "frames",240u ),params.value( "draws",2000u ) );
+					abort = true;
+				}
+				else if( commandName == "texture-benchmark" )
+				{
+					Benchmark::TexturePreprocess( params.value( "dest","texture_benchmark.txt"s ),
+						params.value( "iterations",9u ),params.value( "size",2048u ),params.value( "threads",0u ) );
+					abort = true;
+				}
+				else if( commandName == "benchmark-suite" )
+				{
+					Benchmark::SuiteOptions options;
+					options.reportPath = params.value( "dest",options.reportPath );
+					options.baselinePath = params.value( "baseline",""s );
+					options.filter = params.value( "filter",""s );
+					options.label = params.value( "label",""s );
+					options.samples = params.value( "samples",options.samples );
+					options.sampleSeconds = params.value( "sampleMs",options.sampleSeconds * 1000.0f ) / 1000.0f;
+					options.tolerance = params.value( "tolerance",options.tolerance );
+					// fails the run so scripted comparisons across commits notice
+					if( const auto regressions = Benchmark::Suite( options ) )
+					{
+						throw SCRIPT_ERROR( std::to_string( regressions ) + " benchmark regression(s), see "s + options.reportPath );
+					}
+					abort = true;
+				}
+				else if( commandName == "codex-budget" )
+				{
+					// runs the app as usual, with unreferenced bindables evicted once the codex holds more than this
+					Bind::Codex::SetBudget( size_t( params.value( "megabytes",512u ) ) * 1024u * 1024u );
+				}
+				else if( commandName == "trace" )
+				{
+					// runs the app as usual, recording from startup (scene loading included) for the first frames
+					Trace::Capture( params.value( "dest","trace.json"s ),params.value( "frames",120u ) );
+				}
+				else if( commandName == "benchmark" )
+				{
+					// scene settings come from a scene description file, params given inline override it
+					auto scene = jso::json::object();
+					if( params.contains( "scene" ) )
+					{
+						const auto scenePath = params.at( "scene" ).get<std::string>();
+						std::ifstream sceneFile( scenePath );
+						if( !sceneFile.is_open() )
+						{
+							throw SCRIPT_ERROR( "Unable to open scene description: "s + scenePath );
+						}
+						sceneFile >> scene;
+					}
+					scene.update( params );
+					FlythroughBenchmark::Settings settings;
+					settings.pathFile = scene.value( "path",settings.pathFile );
+					settings.dest = scene.value( "dest",settings.dest );
+					settings.timestep = 1.0f / scene.value( "fps",1.0f / settings.timestep );
+					settings.warmupFrames = scene.value( "warmup",settings.warmupFrames );
+					const auto optional = [&scene]( const char* key,auto& setting )
+					{
+						if( scene.contains( key ) )
+						{
+							setting = scene.at( key ).get<typename std::decay_t<decltype( setting )>::value_type>();
+						}
+					};
+					optional( "taa",settings.TAA );
+					optional( "hbao",settings.HBAO );
+					optional( "lodBias",settings.lodBias );
+					optional( "shadowLodBias",settings.shadowLodBias );
+					optional( "camera",settings.activeCamera );
+					// the app plays the path once loaded, writes the reports and quits
+					FlythroughBenchmark::Request( std::move( settings ) );
+				}
 				else if( commandName == "publish" )
 				{
 					Publish( params.at( "dest" ) );
@@ -63,6 +214,25 @@ ScriptCommander::ScriptCommander( const std::vector<std::string>& args )
 					TestDynamicMeshLoading();
 					TestScaleMatrixTranslation();
 					TestNumpy();
+					TestHiZOcclusion();
+					TestMeshSimplifier();
+					TestMeshClusters();
+					TestMeshOptimizer();
+					TestDenseGrid();
+					TestCookedModel();
+					TestCodexBudget();
+					TestStaticBatch();
+					TestTextureAtlasPlan();
+					TestMaterialTable();
+					TestVertexQuantization();
+					TestVertexFormat();
+					TestVertexConverter();
+					TestDcbAccessors();
+					TestDcbDirtyRanges();
+					TestConstantRing();
+					TestTrace();
+					TestFrameStats();
+					TestTexturePreprocessor();
 					abort = true;
 				}
 				else
@@ -8,7 +8,8 @@ namespace Bind
 {
 	ShadowCameraCBuf::ShadowCameraCBuf(Graphics& gfx, UINT slot, UINT shaderIndex)
 		:
-		shaderIndex(shaderIndex)
+		shaderIndex(shaderIndex),
+		slot(slot)
 	{
 		assert(shaderIndex & 0b00001111);
 		if (shaderIndex & 0b00001000)
@@ -30,6 +31,26 @@ namespace Bind
 	}
 	void ShadowCameraCBuf::Bind( Graphics& gfx ) noxnd
 	{
+		if (ringRange.pBuffer != nullptr)
+		{
+			if (shaderIndex & 0b00001000)
+			{
+				ConstantRingBuffer::BindVS(gfx, slot, ringRange);
+			}
+			if (shaderIndex & 0b00000100)
+			{
+				ConstantRingBuffer::BindHS(gfx, slot, ringRange);
+			}
+			if (shaderIndex & 0b00000010)
+			{
+				ConstantRingBuffer::BindDS(gfx, slot, ringRange);
+			}
+			if (shaderIndex & 0b00000001)
+			{
+				ConstantRingBuffer::BindPS(gfx, slot, ringRange);
+			}
+			return;
+		}
 		if (shaderIndex & 0b00001000)
 		{
 			pVcbuf->Bind(gfx);
@@ -54,6 +75,10 @@ namespace Bind
 				pCamera->GetMatrix() * pCamera->GetProjection()
 			)
 		};
+		if (WriteRing(gfx, t))
+		{
+			return;
+		}
 		if (shaderIndex & 0b00001000)
 		{
 			pVcbuf->Update(gfx, t);
@@ -87,6 +112,10 @@ namespace Bind
 				dx::XMMatrixTranslation(-pos.x,-pos.y,-pos.z)
 			)
 		};
+		if (WriteRing(gfx, t))
+		{
+			return;
+		}
 		if (shaderIndex & 0b00001000)
 		{
 			pVcbuf->Update(gfx, t);
@@ -104,4 +133,13 @@ namespace Bind
 			pPcbuf->Update(gfx, t);
 		}
 	}
+	bool ShadowCameraCBuf::WriteRing(Graphics& gfx, const Transform& t)
+	{
+		if (auto pRing = ConstantRingBuffer::Get(gfx))
+		{
+			ringRange = pRing->Write(gfx, &t, sizeof(t));
+			return true;
+		}
+		return false;
+	}
 }
@@ -2,6 +2,7 @@
 #include "Bindable.h"
 #include "ConstantBuffers.h"
 #include "PointLight.h"
+#include "ConstantRingBuffer.h"
 
 class Camera;
 
@@ -22,6 +23,8 @@ namespace Bind
 		void SetPointLight(std::shared_ptr<PointLight> light) noexcept;
 		void UpdatePointLight(Graphics& gfx);
 	private:
+		// writes t to the constant ring when there is one (bound by Bind until the next update)
+		bool WriteRing(Graphics& gfx, const Transform& t);
 		std::unique_ptr<VertexConstantBuffer<Transform>> pVcbuf;
 		std::unique_ptr<HullConstantBuffer<Transform>> pHcbuf;
 		std::unique_ptr<DomainConstantBuffer<Transform>> pDcbuf;
@@ -29,5 +32,7 @@ namespace Bind
 		const Camera* pCamera = nullptr;
 		std::shared_ptr<PointLight> light;
 		UINT shaderIndex;
+		UINT slot;
+		ConstantRingBuffer::Range ringRange;
 	};
 }
\ No newline at end of file
@@ -57,8 +57,8 @@ void SolidArrow::SetTransform(DirectX::XMFLOAT3 pos, float pitch, float yaw) noe
 
 DirectX::XMMATRIX SolidArrow::GetTransformXM() const noexcept
 {
-	auto buf = cbuf->GetBuffer();
-	return DirectX::XMMatrixScaling(1.0f, 1.0f, buf["length"]) *
+	const float length = cbuf->GetBuffer()["length"];
+	return DirectX::XMMatrixScaling(1.0f, 1.0f, length) *
 		DirectX::XMMatrixRotationRollPitchYaw(pitch, yaw, 0.0f) *
 		DirectX::XMMatrixTranslation(pos.x, pos.y, pos.z);
 }
@@ -103,7 +103,5 @@ void SolidArrow::ChangeArrowColor() noexcept
 
 void SolidArrow::SetColor(DirectX::XMFLOAT3 diffuseColor) noexcept
 {
-	auto buf = cbuf->GetBuffer();
-	buf["color"] = diffuseColor;
-	cbuf->SetBuffer(buf);
+	cbuf->EditBuffer()["color"] = diffuseColor;
 }
\ No newline at end of file
@@ -48,7 +48,7 @@ public:
 		}
 
 		// add the cap vertices
-		const auto iNorthPole = (unsigned short)vb.Size();
+		const auto iNorthPole = (unsigned int)vb.Size();
 		{
 			dx::XMFLOAT3 northPos;
 			dx::XMStoreFloat3(&northPos, base);
@@ -63,7 +63,7 @@ public:
 				vb.EmplaceBack(northPos);
 			}
 		}
-		const auto iSouthPole = (unsigned short)vb.Size();
+		const auto iSouthPole = (unsigned int)vb.Size();
 		{
 			dx::XMFLOAT3 southPos;
 			dx::XMStoreFloat3(&southPos, dx::XMVectorNegate(base));
@@ -79,12 +79,12 @@ public:
 			}
 		}
 
-		const auto calcIdx = [latDiv, longDiv](unsigned short iLat, unsigned short iLong)
+		const auto calcIdx = [latDiv, longDiv](unsigned int iLat, unsigned int iLong)
 		{ return iLat * longDiv + iLong; };
-		std::vector<unsigned short> indices;
-		for (unsigned short iLat = 0; iLat < latDiv - 2; iLat++)
+		std::vector<unsigned int> indices;
+		for (unsigned int iLat = 0; iLat < (unsigned int)(latDiv - 2); iLat++)
 		{
-			for (unsigned short iLong = 0; iLong < longDiv - 1; iLong++)
+			for (unsigned int iLong = 0; iLong < (unsigned int)(longDiv - 1); iLong++)
 			{
 				indices.push_back(calcIdx(iLat, iLong));
 				indices.push_back(calcIdx(iLat + 1, iLong));
@@ -103,7 +103,7 @@ public:
 		}
 
 		// cap fans
-		for (unsigned short iLong = 0; iLong < longDiv - 1; iLong++)
+		for (unsigned int iLong = 0; iLong < (unsigned int)(longDiv - 1); iLong++)
 		{
 			// north
 			indices.push_back(iNorthPole);
@@ -235,7 +235,7 @@ public:
 		}
 
 		// add the cap vertices
-		const auto iNorthPole = (unsigned short)vb.Size();
+		const auto iNorthPole = (unsigned int)vb.Size();
 		{
 			dx::XMFLOAT3 northPos;
 			dx::XMStoreFloat3(&northPos, base);
@@ -268,7 +268,7 @@ public:
 				}
 			}
 		}
-		const auto iSouthPole = (unsigned short)vb.Size();
+		const auto iSouthPole = (unsigned int)vb.Size();
 		{
 			dx::XMFLOAT3 southPos;
 			dx::XMStoreFloat3(&southPos, dx::XMVectorNegate(base));
@@ -302,12 +302,12 @@ public:
 			}
 		}
 
-		const auto calcIdx = [latDiv, longDiv](unsigned short iLat, unsigned short iLong)
+		const auto calcIdx = [latDiv, longDiv](unsigned int iLat, unsigned int iLong)
 		{ return iLat * (longDiv + 1) + iLong; };
-		std::vector<unsigned short> indices;
-		for (unsigned short iLat = 0; iLat < latDiv - 2; iLat++)
+		std::vector<unsigned int> indices;
+		for (unsigned int iLat = 0; iLat < (unsigned int)(latDiv - 2); iLat++)
 		{
-			for (unsigned short iLong = 0; iLong < longDiv; iLong++)
+			for (unsigned int iLong = 0; iLong < (unsigned int)longDiv; iLong++)
 			{
 				indices.push_back(calcIdx(iLat, iLong));
 				indices.push_back(calcIdx(iLat + 1, iLong));
@@ -319,7 +319,7 @@ public:
 		}
 
 		// cap fans
-		for (unsigned short iLong = 0; iLong < longDiv; iLong++)
+		for (unsigned int iLong = 0; iLong < (unsigned int)longDiv; iLong++)
 		{
 			// north
 			indices.push_back(iNorthPole + iLong);
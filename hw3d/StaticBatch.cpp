@@ -0,0 +1,234 @@
+#include "StaticBatch.h"
+#include "Material.h"
+#include "MeshClusters.h"
+#include "HiZOcclusion.h"
+#include "SubmitView.h"
+#include "Topology.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace dx = DirectX;
+
+namespace
+{
+	bool IsIdentity( const float m[16] ) noexcept
+	{
+		for( int i = 0; i < 16; i++ )
+		{
+			if( std::abs( m[i] - ((i % 5 == 0) ? 1.0f : 0.0f) ) > 1e-6f )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// counts the nodes drawing each mesh and flags those whose path from the root is all identity
+	void MarkRootFrame( const CookedModel::NodeView& node,bool inRootFrame,std::vector<unsigned int>& refs,std::vector<bool>& rootFrame )
+	{
+		for( const auto m : node.meshes )
+		{
+			refs[m]++;
+			rootFrame[m] = rootFrame[m] || inRootFrame;
+		}
+		for( const auto& child : node.children )
+		{
+			MarkRootFrame( child,inRootFrame && IsIdentity( child.transform ),refs,rootFrame );
+		}
+	}
+
+	bool OutsideFrustum( const float planes[6][4],const dx::BoundingBox& box ) noexcept
+	{
+		for( int p = 0; p < 6; p++ )
+		{
+			const auto d = planes[p][0] * box.Center.x + planes[p][1] * box.Center.y + planes[p][2] * box.Center.z + planes[p][3];
+			const auto r = std::abs( planes[p][0] ) * box.Extents.x + std::abs( planes[p][1] ) * box.Extents.y + std::abs( planes[p][2] ) * box.Extents.z;
+			if( d < -r )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+std::vector<StaticBatch::Data> StaticBatch::Build( const CookedModel& cooked,unsigned int maxVertices )
+{
+	maxVertices = std::min( maxVertices,0x10000u );
+	const auto& meshes = cooked.GetMeshes();
+	std::vector<unsigned int> refs( meshes.size(),0u );
+	std::vector<bool> rootFrame( meshes.size(),false );
+	// the root's own transform is applied to the batches as a whole
+	MarkRootFrame( cooked.GetRoot(),true,refs,rootFrame );
+
+	std::vector<std::vector<unsigned int>> groups( cooked.GetMaterialCount() );
+	for( unsigned int i = 0; i < (unsigned int)meshes.size(); i++ )
+	{
+		const auto& mesh = meshes[i];
+		// quantized positions are relative to each mesh's own bounds, they cannot share a buffer
+		if( refs[i] == 1u && rootFrame[i] && mesh.vertexCount <= maxVertices && mesh.indices.count > 0u &&
+			!mesh.positionQuantization )
+		{
+			groups[mesh.materialIndex].push_back( i );
+		}
+	}
+
+	std::vector<Data> batches;
+	for( unsigned int mat = 0; mat < (unsigned int)groups.size(); mat++ )
+	{
+		const auto& group = groups[mat];
+		if( group.size() < 2 )
+		{
+			continue;
+		}
+		Data data;
+		data.materialIndex = mat;
+		unsigned int segmentStart = 0u;
+		for( const auto i : group )
+		{
+			const auto& mesh = meshes[i];
+			if( data.vertexCount - segmentStart + mesh.vertexCount > 0x10000u )
+			{
+				segmentStart = data.vertexCount;
+			}
+			const auto offset = data.vertexCount - segmentStart;
+			data.subMeshes.push_back( {
+				i,(unsigned int)data.indices.size(),mesh.indices.count,int( segmentStart ),mesh.bounds
+			} );
+			// lods and clusters are dropped, the full-detail level is a plain triangle list either way
+			for( unsigned int n = 0; n < mesh.indices.count; n++ )
+			{
+				const auto index = mesh.indices.wide ?
+					static_cast<const unsigned int*>( mesh.indices.pData )[n] :
+					static_cast<const unsigned short*>( mesh.indices.pData )[n];
+				data.indices.push_back( (unsigned short)(index + offset) );
+			}
+			data.vertices.insert( data.vertices.end(),mesh.pVertices,mesh.pVertices + mesh.vertexBytes );
+			data.vertexCount += mesh.vertexCount;
+		}
+		batches.push_back( std::move( data ) );
+	}
+	return batches;
+}
+
+StaticBatch::Stats StaticBatch::Analyze( const std::vector<Data>& batches,size_t meshCount ) noexcept
+{
+	Stats stats;
+	stats.meshes = meshCount;
+	stats.batches = batches.size();
+	size_t runs = 0;
+	for( const auto& b : batches )
+	{
+		stats.batchedMeshes += b.subMeshes.size();
+		std::vector<Rgph::DrawRange> ranges;
+		for( const auto& sub : b.subMeshes )
+		{
+			AppendRange( ranges,sub );
+		}
+		runs += ranges.size();
+	}
+	stats.submissionsBefore = meshCount;
+	stats.submissionsAfter = meshCount - stats.batchedMeshes + stats.batches;
+	stats.drawableBindsBefore = stats.submissionsBefore * 3;
+	stats.drawableBindsAfter = stats.submissionsAfter * 3;
+	stats.drawCallsBefore = meshCount;
+	stats.drawCallsAfter = meshCount - stats.batchedMeshes + runs;
+	return stats;
+}
+
+std::string StaticBatch::Report( const Stats& stats )
+{
+	std::ostringstream oss;
+	oss << "Static batching: " << stats.batchedMeshes << " of " << stats.meshes << " meshes merged into "
+		<< stats.batches << " batches, per step " << stats.submissionsBefore << " -> " << stats.submissionsAfter << " jobs, "
+		<< stats.drawableBindsBefore << " -> " << stats.drawableBindsAfter << " drawable binds, "
+		<< stats.drawCallsBefore << " -> " << stats.drawCallsAfter << " draw calls\n";
+	return oss.str();
+}
+
+StaticBatch::StaticBatch( Graphics& gfx,const Material& mat,const Data& data,size_t batchIndex ) noxnd
+	:
+	subMeshes( data.subMeshes )
+{
+	const auto tag = "$batch" + std::to_string( batchIndex );
+	pVertices = mat.MakeVertexBindable( gfx,tag,data.vertices.data(),data.vertices.size() );
+	pIndices = mat.MakeIndexBindable( gfx,tag,"",data.indices.data(),(UINT)data.indices.size(),false );
+	pTopology = Bind::Topology::Resolve( gfx );
+	for( auto& t : mat.GetTechniques() )
+	{
+		AddTechnique( std::move( t ) );
+	}
+	auto pRanges = std::make_shared<std::vector<Rgph::DrawRange>>();
+	for( const auto& sub : subMeshes )
+	{
+		AppendRange( *pRanges,sub );
+	}
+	pAllRanges = std::move( pRanges );
+}
+
+void StaticBatch::AppendRange( std::vector<Rgph::DrawRange>& ranges,const SubMesh& sub )
+{
+	// neighbours in the index buffer with the same base vertex draw as one
+	if( !ranges.empty() && ranges.back().baseVertex == sub.baseVertex &&
+		ranges.back().startIndex + ranges.back().indexCount == sub.startIndex )
+	{
+		ranges.back().indexCount += sub.indexCount;
+	}
+	else
+	{
+		ranges.push_back( { sub.startIndex,sub.indexCount,sub.baseVertex } );
+	}
+}
+
+void StaticBatch::Submit( size_t channels,dx::FXMMATRIX accumulatedTransform,const SubmitView* pView ) const noxnd
+{
+	Rgph::DrawOverride draw;
+	draw.pRanges = pAllRanges;
+	// same rule as cluster culling, only the view the jobs are rendered from may cull
+	if( pView && (pView->cullClusters || pView->pOcclusion) )
+	{
+		float planes[6][4] = {};
+		if( pView->cullClusters )
+		{
+			dx::XMFLOAT4X4 objectToClip;
+			dx::XMStoreFloat4x4( &objectToClip,accumulatedTransform * dx::XMLoadFloat4x4( &pView->viewProj ) );
+			MeshClusters::ExtractFrustumPlanes( objectToClip.m,planes );
+		}
+		auto pVisible = std::make_shared<std::vector<Rgph::DrawRange>>();
+		for( const auto& sub : subMeshes )
+		{
+			if( pView->cullClusters && OutsideFrustum( planes,sub.bounds ) )
+			{
+				continue;
+			}
+			if( pView->pOcclusion )
+			{
+				dx::BoundingBox worldBounds;
+				sub.bounds.Transform( worldBounds,accumulatedTransform );
+				if( !pView->pOcclusion->IsVisible( worldBounds ) )
+				{
+					continue;
+				}
+			}
+			AppendRange( *pVisible,sub );
+		}
+		if( pVisible->empty() )
+		{
+			return;
+		}
+		draw.pRanges = std::move( pVisible );
+	}
+	dx::XMStoreFloat4x4( &transform,accumulatedTransform );
+	Drawable::Submit( channels,draw );
+}
+
+size_t StaticBatch::GetSubMeshCount() const noexcept
+{
+	return subMeshes.size();
+}
+
+DirectX::XMMATRIX StaticBatch::GetTransformXM() const noexcept
+{
+	return dx::XMLoadFloat4x4( &transform );
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Graphics.h"
+#include "Drawable.h"
+#include "ConditionalNoexcept.h"
+#include <DirectXCollision.h>
+#include <vector>
+#include <string>
+#include "CookedModel.h"
+
+class Material;
+struct SubmitView;
+
+// small static meshes of one material merged at load into one vertex / index buffer (see ModelOptions::staticBatching)
+// the batch binds once per step and draws each surviving run of sub-meshes with start index / base vertex offsets
+// only meshes drawn exactly once, in the model root's frame (every node between them and the root has an
+// identity transform) are merged, so no vertex has to be transformed
+class StaticBatch : public Drawable
+{
+public:
+	struct SubMesh
+	{
+		// into CookedModel::GetMeshes()
+		unsigned int meshIndex;
+		unsigned int startIndex;
+		unsigned int indexCount;
+		int baseVertex;
+		// object space, scaled
+		DirectX::BoundingBox bounds;
+	};
+	// cpu side of a batch, shared by every instance of the model
+	struct Data
+	{
+		unsigned int materialIndex;
+		// interleaved in the material's layout, sub-meshes back to back
+		std::vector<char> vertices;
+		unsigned int vertexCount = 0u;
+		// relative to the base vertex of their sub-mesh, which is moved on whenever the next sub-mesh would
+		// no longer fit 16 bits, so the index buffer always stays narrow
+		std::vector<unsigned short> indices;
+		std::vector<SubMesh> subMeshes;
+	};
+	struct Stats
+	{
+		size_t meshes = 0;
+		size_t batchedMeshes = 0;
+		size_t batches = 0;
+		// one job per mesh (or batch) per step
+		size_t submissionsBefore = 0;
+		size_t submissionsAfter = 0;
+		// vertex buffer, index buffer and topology per submission
+		size_t drawableBindsBefore = 0;
+		size_t drawableBindsAfter = 0;
+		// with nothing culled, batches draw one call per run of sub-meshes sharing a base vertex
+		size_t drawCallsBefore = 0;
+		size_t drawCallsAfter = 0;
+	};
+public:
+	// groups of at least two meshes with at most maxVertices vertices each (capped at 65536)
+	static std::vector<Data> Build( const CookedModel& cooked,unsigned int maxVertices );
+	static Stats Analyze( const std::vector<Data>& batches,size_t meshCount ) noexcept;
+	// one line summary for logs
+	static std::string Report( const Stats& stats );
+	// buffers are tagged by batch index, so every instance of the model shares them
+	StaticBatch( Graphics& gfx,const Material& mat,const Data& data,size_t batchIndex ) noxnd;
+	DirectX::XMMATRIX GetTransformXM() const noexcept override;
+	// sub-meshes outside the view frustum or occluded are skipped when there is a view
+	void Submit( size_t channels,DirectX::FXMMATRIX accumulatedTransform,const SubmitView* pView = nullptr ) const noxnd;
+	size_t GetSubMeshCount() const noexcept;
+private:
+	static void AppendRange( std::vector<Rgph::DrawRange>& ranges,const SubMesh& sub );
+private:
+	mutable DirectX::XMFLOAT4X4 transform;
+	std::vector<SubMesh> subMeshes;
+	// every sub-mesh, shared by the jobs of every unculled submission
+	std::shared_ptr<const std::vector<Rgph::DrawRange>> pAllRanges;
+};
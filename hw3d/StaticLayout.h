@@ -0,0 +1,138 @@
+#pragma once
+#include "DynamicConstant.h"
+#include "LayoutCodex.h"
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <string>
+#include <string_view>
+
+namespace Dcb
+{
+	// string literal usable as a template argument, names the members of a StaticLayout
+	template<size_t N>
+	struct FixedString
+	{
+		constexpr FixedString( const char (&s)[N] ) noexcept
+		{
+			std::copy_n( s,N,str );
+		}
+		constexpr std::string_view View() const noexcept
+		{
+			return { str,N - 1u };
+		}
+		char str[N];
+	};
+
+	// one leaf member of a StaticLayout
+	template<Type typeIn,FixedString nameIn>
+	struct Member
+	{
+		static_assert(Map<typeIn>::valid,"StaticLayout members must be leaf types");
+		static constexpr Type type = typeIn;
+		static constexpr auto name = nameIn;
+	};
+
+	// a flat struct layout whose members are fixed at compile time, e.g.
+	//   using Light = StaticLayout<Member<Float3,"pos">,Member<Float,"range">>;
+	// offsets are packed with the same rules as LayoutElement::Finalize, so they are constants that can be
+	// static_asserted against the offsetof of a C++ struct mirroring the cbuffer
+	// Make() registers the equivalent runtime layout, so its Buffers work everywhere (string keys, Accessors,
+	// the technique probe), while Get<"name">( buf ) touches the bytes at a constant offset
+	template<typename... Members>
+	class StaticLayout
+	{
+		static constexpr size_t count = sizeof...(Members);
+		static_assert(count != 0u,"StaticLayout needs at least one member");
+		// constexpr twins of the LayoutElement boundary helpers
+		static constexpr size_t AdvanceToBoundary( size_t offset ) noexcept
+		{
+			return offset + (16u - offset % 16u) % 16u;
+		}
+		static constexpr size_t AdvanceIfCrossesBoundary( size_t offset,size_t size ) noexcept
+		{
+			const auto end = offset + size;
+			const bool crosses = (offset / 16u != end / 16u && end % 16u != 0u) || size > 16u;
+			return crosses ? AdvanceToBoundary( offset ) : offset;
+		}
+		// member offsets followed by the size of the whole (root struct rounded up to a register)
+		static constexpr std::array<size_t,count + 1u> Pack() noexcept
+		{
+			constexpr size_t sizes[] = { Map<Members::type>::hlslSize... };
+			std::array<size_t,count + 1u> offsets{};
+			size_t offset = 0u;
+			for( size_t i = 0u; i < count; i++ )
+			{
+				offsets[i] = AdvanceIfCrossesBoundary( offset,sizes[i] );
+				offset = offsets[i] + sizes[i];
+			}
+			offsets[count] = AdvanceToBoundary( offset );
+			return offsets;
+		}
+		static constexpr std::array<size_t,count + 1u> offsets = Pack();
+		template<FixedString name>
+		static constexpr size_t IndexOf() noexcept
+		{
+			constexpr std::string_view names[] = { Members::name.View()... };
+			size_t i = 0u;
+			while( i < count && names[i] != name.View() )
+			{
+				i++;
+			}
+			return i;
+		}
+		template<FixedString name>
+		using MemberOf = std::tuple_element_t<IndexOf<name>(),std::tuple<Members...>>;
+	public:
+		template<FixedString name>
+		using SysType = typename Map<MemberOf<name>::type>::SysType;
+		static constexpr size_t sizeInBytes = offsets[count];
+		template<FixedString name>
+		static constexpr size_t OffsetOf() noexcept
+		{
+			constexpr auto i = IndexOf<name>();
+			static_assert(i < count,"No member of that name in StaticLayout");
+			return offsets[i];
+		}
+		// the runtime layout with the same members, shared through the codex like any other
+		static CookedLayout Make() noxnd
+		{
+			RawLayout lay;
+			(lay.Add<Members::type>( std::string( Members::name.View() ) ),...);
+			auto cooked = LayoutCodex::Resolve( std::move( lay ) );
+			assert( "StaticLayout packing disagrees with LayoutElement" && Describes( *cooked.ShareRoot() ) );
+			return cooked;
+		}
+		// true when the root has exactly these members at exactly these offsets
+		static bool Describes( const LayoutElement& root ) noxnd
+		{
+			if( root.GetType() != Struct || root.GetSizeInBytes() != sizeInBytes )
+			{
+				return false;
+			}
+			size_t i = 0u;
+			const auto matches = [&]( std::string_view name,Type type ) {
+				const auto& el = root[std::string( name )];
+				return el.Exists() && el.GetType() == type && el.GetOffsetBegin() == offsets[i++];
+			};
+			return (matches( Members::name.View(),Members::type ) && ...);
+		}
+		// buf must be made from Make() (or any layout Describes() accepts)
+		// the mutable version counts as a write of the member
+		template<FixedString name>
+		static SysType<name>& Get( Buffer& buf ) noxnd
+		{
+			constexpr auto offset = OffsetOf<name>();
+			assert( Describes( *buf.pLayoutRoot ) );
+			buf.MarkDirty( offset,sizeof( SysType<name> ) );
+			return *reinterpret_cast<SysType<name>*>(buf.bytes.data() + offset);
+		}
+		template<FixedString name>
+		static const SysType<name>& Get( const Buffer& buf ) noxnd
+		{
+			constexpr auto offset = OffsetOf<name>();
+			assert( Describes( *buf.pLayoutRoot ) );
+			return *reinterpret_cast<const SysType<name>*>(buf.bytes.data() + offset);
+		}
+	};
+}
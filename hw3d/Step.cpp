@@ -4,9 +4,9 @@
 #include "TechniqueProbe.h"
 #include "RenderQueuePass.h"
 
-void Step::Submit( const Drawable& drawable ) const
+void Step::Submit( const Drawable& drawable,const Rgph::DrawOverride& draw ) const
 {
-	pTargetPass->Accept( Rgph::Job{ this,&drawable } );
+	pTargetPass->Accept( Rgph::Job{ this,&drawable,draw } );
 }
 
 void Step::InitializeParentReferences( const Drawable& parent ) noexcept
@@ -50,6 +50,7 @@ void Step::Bind( Graphics& gfx ) const noxnd
 	for( const auto& b : bindables )
 	{
 		b->Bind( gfx );
+		gfx.CountBind( *b );
 	}
 }
 
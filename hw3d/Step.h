@@ -3,6 +3,7 @@
 #include <memory>
 #include "Bindable.h"
 #include "Graphics.h"
+#include "Job.h"
 
 class TechniqueProbe;
 class Drawable;
@@ -22,7 +23,7 @@ public:
 	Step& operator=( const Step& ) = delete;
 	Step& operator=( Step&& ) = delete;
 	void AddBindable( std::shared_ptr<Bind::Bindable> bind_in ) noexcept;
-	void Submit( const Drawable& drawable ) const;
+	void Submit( const Drawable& drawable,const Rgph::DrawOverride& draw = {} ) const;
 	void Bind( Graphics& gfx ) const noxnd;
 	void InitializeParentReferences( const Drawable& parent ) noexcept;
 	void Accept( TechniqueProbe& probe );
@@ -0,0 +1,51 @@
+#pragma once
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cfloat>
+
+class HiZOcclusion;
+
+// the viewpoint a model is being submitted for, lets meshes make per-view decisions
+// (occlusion, level of detail) before any jobs are generated
+struct SubmitView
+{
+	DirectX::XMFLOAT3 eyePos = { 0.0f,0.0f,0.0f };
+	// proj._22, a sphere of radius r at distance d covers about projScale * r / d of the half screen height
+	float projScale = 1.0f;
+	// scales the projected size used for lod selection, < 1 picks coarser levels
+	float lodBias = 1.0f;
+	// null disables occlusion culling (always for shadow passes)
+	const HiZOcclusion* pOcclusion = nullptr;
+	// world to clip, for per-cluster frustum culling
+	DirectX::XMFLOAT4X4 viewProj = {};
+	// cluster culling is only valid for the view the jobs are rendered from
+	bool cullClusters = true;
+
+	static SubmitView Make( DirectX::FXMMATRIX view,DirectX::CXMMATRIX proj,float lodBias = 1.0f,const HiZOcclusion* pOcclusion = nullptr ) noexcept
+	{
+		namespace dx = DirectX;
+		SubmitView sv;
+		dx::XMFLOAT4X4 p;
+		dx::XMStoreFloat4x4( &p,proj );
+		dx::XMStoreFloat3( &sv.eyePos,dx::XMMatrixInverse( nullptr,view ).r[3] );
+		sv.projScale = p._22;
+		sv.lodBias = lodBias;
+		sv.pOcclusion = pOcclusion;
+		dx::XMStoreFloat4x4( &sv.viewProj,view * proj );
+		return sv;
+	}
+	float ProjectedSize( const DirectX::BoundingBox& worldBounds ) const noexcept
+	{
+		namespace dx = DirectX;
+		const auto radius = dx::XMVectorGetX( dx::XMVector3Length( dx::XMLoadFloat3( &worldBounds.Extents ) ) );
+		const auto distance = dx::XMVectorGetX( dx::XMVector3Length(
+			dx::XMVectorSubtract( dx::XMLoadFloat3( &worldBounds.Center ),dx::XMLoadFloat3( &eyePos ) )
+		) );
+		// inside the bounds, always the finest level
+		if( distance <= radius )
+		{
+			return FLT_MAX;
+		}
+		return projScale * radius / distance;
+	}
+};
@@ -71,6 +71,18 @@ Surface::Color Surface::GetPixel( unsigned int x,unsigned int y ) const noxnd
 	return reinterpret_cast<Color*>(&imgData.pixels[y * imgData.rowPitch])[x];
 }
 
+std::span<Surface::Color> Surface::GetRow( unsigned int y ) noxnd
+{
+	assert( y < GetHeight() );
+	auto& imgData = *scratch.GetImage( 0,0,0 );
+	return { reinterpret_cast<Color*>(&imgData.pixels[y * imgData.rowPitch]),imgData.width };
+}
+
+std::span<const Surface::Color> Surface::GetRow( unsigned int y ) const noxnd
+{
+	return const_cast<Surface*>(this)->GetRow( y );
+}
+
 unsigned int Surface::GetWidth() const noexcept
 {
 	return (unsigned int)scratch.GetMetadata().width;
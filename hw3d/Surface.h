@@ -23,6 +23,7 @@
 #include "ChiliException.h"
 #include <string>
 #include <optional>
+#include <span>
 #include "ConditionalNoexcept.h"
 #include <dxtex/DirectXTex.h>
 
@@ -126,6 +127,10 @@ public:
 	void Clear( Color fillValue ) noexcept;
 	void PutPixel( unsigned int x,unsigned int y,Color c ) noxnd;
 	Color GetPixel( unsigned int x,unsigned int y ) const noxnd;
+	// the texels of one row, for kernels working on whole rows instead of Get / PutPixel per texel
+	// rows are GetBytePitch() apart, don't step from one into the next
+	std::span<Color> GetRow( unsigned int y ) noxnd;
+	std::span<const Color> GetRow( unsigned int y ) const noxnd;
 	unsigned int GetWidth() const noexcept;
 	unsigned int GetHeight() const noexcept;
 	unsigned int GetBytePitch() const noexcept;
@@ -2,13 +2,13 @@
 #include "Drawable.h"
 #include "TechniqueProbe.h"
 
-void Technique::Submit( const Drawable& drawable,size_t channelFilter ) const noexcept
+void Technique::Submit( const Drawable& drawable,size_t channelFilter,const Rgph::DrawOverride& draw ) const noexcept
 {
 	if( active && ((channels & channelFilter) != 0) )
 	{
 		for( const auto& step : steps )
 		{
-			step.Submit( drawable );
+			step.Submit( drawable,draw );
 		}
 	}
 }
@@ -1,6 +1,8 @@
 #include "DynamicConstant.h"
 #include "LayoutCodex.h"
 #include "Vertex.h"
+#include "VertexFormat.h"
+#include "VertexConverter.h"
 #include "Graphics.h"
 #include "Window.h"
 #include <cstring>
@@ -14,18 +16,1062 @@
 #include <algorithm>
 #include <array>
 #include "BindableCommon.h"
+#include "BindableCodex.h"
 #include "RenderTarget.h"
 #include "Surface.h"
 #include "cnpy.h"
+#include "HiZOcclusion.h"
+#include "MeshSimplifier.h"
+#include "MeshClusters.h"
+#include "MeshOptimizer.h"
+#include "CookedModel.h"
+#include "StaticBatch.h"
+#include "TextureAtlas.h"
+#include "MaterialTable.h"
+#include "StaticLayout.h"
+#include "ConstantRing.h"
+#include "Trace.h"
+#include "FrameStats.h"
+#include "TexturePreprocessor.h"
+#include "json.hpp"
+#include "Plane.h"
+#include "ChiliMath.h"
+#include <random>
+#include <numeric>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <map>
+#include <cstddef>
 
 namespace dx = DirectX;
 
+namespace
+{
+	// one vertex of a synthetic import, the frame only goes into meshes that have one
+	struct TestVertex
+	{
+		aiVector3D pos;
+		aiVector3D uv;
+		aiVector3D normal = {};
+		aiVector3D tangent = {};
+		aiVector3D bitangent = {};
+	};
+
+	// allocates the vertex streams of mesh (aiMesh frees its own arrays) and fills them from vertex( i ), in order
+	template<typename F>
+	void FillTestMesh( aiMesh& mesh,unsigned int vertexCount,bool withFrame,F&& vertex )
+	{
+		mesh.mNumVertices = vertexCount;
+		mesh.mVertices = new aiVector3D[vertexCount];
+		mesh.mTextureCoords[0] = new aiVector3D[vertexCount];
+		if( withFrame )
+		{
+			mesh.mNormals = new aiVector3D[vertexCount];
+			mesh.mTangents = new aiVector3D[vertexCount];
+			mesh.mBitangents = new aiVector3D[vertexCount];
+		}
+		for( unsigned int i = 0; i < vertexCount; i++ )
+		{
+			const TestVertex v = vertex( i );
+			mesh.mVertices[i] = v.pos;
+			mesh.mTextureCoords[0][i] = v.uv;
+			if( withFrame )
+			{
+				mesh.mNormals[i] = v.normal;
+				mesh.mTangents[i] = v.tangent;
+				mesh.mBitangents[i] = v.bitangent;
+			}
+		}
+	}
+}
+
 void TestNumpy()
 {
 	auto v = std::vector{ 0,1,2,4,5,6 };
 	cnpy::npy_save( "test.npy",v.data(),{ 3,2 } );
 }
 
+void TestHiZOcclusion()
+{
+	// synthetic depth: a wall at view z = 10 covering the middle of the screen, sky elsewhere
+	const auto viewProj = dx::XMMatrixLookToLH( dx::XMVectorZero(),dx::XMVectorSet( 0.0f,0.0f,1.0f,0.0f ),dx::XMVectorSet( 0.0f,1.0f,0.0f,0.0f ) ) *
+		dx::XMMatrixPerspectiveFovLH( PI / 2.0f,16.0f / 9.0f,0.5f,100.0f );
+	const auto wallDepth = dx::XMVectorGetZ( dx::XMVector3TransformCoord( dx::XMVectorSet( 0.0f,0.0f,10.0f,1.0f ),viewProj ) );
+	const unsigned int width = 320;
+	const unsigned int height = 180;
+	std::vector<float> depth( size_t( width ) * height,1.0f );
+	for( unsigned int y = height / 4; y < height * 3 / 4; y++ )
+	{
+		for( unsigned int x = width / 4; x < width * 3 / 4; x++ )
+		{
+			depth[size_t( y ) * width + x] = wallDepth;
+		}
+	}
+
+	HiZPyramid pyramid;
+	pyramid.Build( depth.data(),width,height,80,45 );
+	// every coarse texel is the max of the base texels it covers
+	for( unsigned int l = 1; l < pyramid.GetLevelCount(); l++ )
+	{
+		for( unsigned int y = 0; y < pyramid.GetHeight( l ); y++ )
+		{
+			for( unsigned int x = 0; x < pyramid.GetWidth( l ); x++ )
+			{
+				float farthest = 0.0f;
+				for( unsigned int by = y << l; by < std::min( (y + 1) << l,pyramid.GetHeight( 0 ) ); by++ )
+				{
+					for( unsigned int bx = x << l; bx < std::min( (x + 1) << l,pyramid.GetWidth( 0 ) ); bx++ )
+					{
+						farthest = std::max( farthest,pyramid.Fetch( 0,bx,by ) );
+					}
+				}
+				assert( pyramid.Fetch( l,x,y ) == farthest );
+			}
+		}
+	}
+
+	const auto test = [&]( const dx::BoundingBox& box )
+	{
+		HiZPyramid::ScreenRect rect;
+		return HiZOcclusion::ProjectBounds( box,viewProj,rect ) && pyramid.IsOccluded( rect );
+	};
+	// behind the wall
+	assert( test( dx::BoundingBox{ { 0.0f,0.0f,20.0f },{ 1.0f,1.0f,1.0f } } ) );
+	// in front of the wall
+	assert( !test( dx::BoundingBox{ { 0.0f,0.0f,5.0f },{ 1.0f,1.0f,1.0f } } ) );
+	// behind the wall but poking out past its edge
+	assert( !test( dx::BoundingBox{ { 0.0f,0.0f,20.0f },{ 15.0f,1.0f,1.0f } } ) );
+	// straddling the eye, can't be projected
+	assert( !test( dx::BoundingBox{ { 0.0f,0.0f,0.0f },{ 1.0f,1.0f,1.0f } } ) );
+	// partially off screen in the captured view
+	assert( !test( dx::BoundingBox{ { 40.0f,0.0f,20.0f },{ 1.0f,1.0f,1.0f } } ) );
+
+	// conservativeness against brute force over the full resolution depth
+	std::mt19937 rng( 69 );
+	std::uniform_real_distribution<float> ndc( -1.0f,1.0f );
+	std::uniform_real_distribution<float> z( 0.0f,1.0f );
+	for( int i = 0; i < 10000; i++ )
+	{
+		const auto a = ndc( rng ),b = ndc( rng ),c = ndc( rng ),d = ndc( rng );
+		const HiZPyramid::ScreenRect rect{ std::min( a,b ),std::min( c,d ),std::max( a,b ),std::max( c,d ),z( rng ) };
+		if( pyramid.IsOccluded( rect ) )
+		{
+			const auto x0 = (unsigned int)( (rect.minX * 0.5f + 0.5f) * width );
+			const auto x1 = std::min( width - 1,(unsigned int)( (rect.maxX * 0.5f + 0.5f) * width ) );
+			const auto y0 = (unsigned int)( (0.5f - rect.maxY * 0.5f) * height );
+			const auto y1 = std::min( height - 1,(unsigned int)( (0.5f - rect.minY * 0.5f) * height ) );
+			float farthest = 0.0f;
+			for( auto y = y0; y <= y1; y++ )
+			{
+				for( auto x = x0; x <= x1; x++ )
+				{
+					farthest = std::max( farthest,depth[size_t( y ) * width + x] );
+				}
+			}
+			assert( rect.minDepth > farthest );
+		}
+	}
+}
+
+void TestMeshSimplifier()
+{
+	// wavy grid split by a uv seam down the middle (duplicated column of vertices)
+	const unsigned int n = 64;
+	std::vector<dx::XMFLOAT3> positions;
+	for( unsigned int y = 0; y <= n; y++ )
+	{
+		for( unsigned int x = 0; x <= n; x++ )
+		{
+			positions.push_back( { float( x ) / n,float( y ) / n,0.05f * std::sin( x * 0.3f ) } );
+		}
+	}
+	const auto seamBase = (unsigned int)positions.size();
+	for( unsigned int y = 0; y <= n; y++ )
+	{
+		positions.push_back( positions[y * (n + 1) + n / 2] );
+	}
+	std::vector<unsigned int> indices;
+	for( unsigned int y = 0; y < n; y++ )
+	{
+		for( unsigned int x = 0; x < n; x++ )
+		{
+			const auto right = x >= n / 2;
+			const auto v = [&]( unsigned int vx,unsigned int vy )
+			{
+				return (right && vx == n / 2) ? seamBase + vy : vy * (n + 1) + vx;
+			};
+			indices.insert( indices.end(),{ v( x,y ),v( x,y + 1 ),v( x + 1,y ),v( x + 1,y ),v( x,y + 1 ),v( x + 1,y + 1 ) } );
+		}
+	}
+
+	const auto chain = MeshSimplifier::BuildLodChain( &positions[0].x,positions.size(),sizeof( dx::XMFLOAT3 ),indices,4,0.5f,0.05f );
+	assert( !chain.empty() );
+	size_t previous = indices.size();
+	for( const auto& level : chain )
+	{
+		// each level shrinks, stays within the error bound and only references existing vertices
+		assert( level.indices.size() < previous && level.indices.size() % 3 == 0 );
+		assert( level.error <= 0.05f );
+		assert( std::all_of( level.indices.begin(),level.indices.end(),[&]( unsigned int i ) { return i < positions.size(); } ) );
+		// seam vertices are locked, so both sides of the seam keep all of them
+		for( unsigned int y = 0; y <= n; y++ )
+		{
+			assert( std::find( level.indices.begin(),level.indices.end(),seamBase + y ) != level.indices.end() );
+			assert( std::find( level.indices.begin(),level.indices.end(),y * (n + 1) + n / 2 ) != level.indices.end() );
+		}
+		previous = level.indices.size();
+	}
+}
+
+void TestMeshClusters()
+{
+	// uv sphere, clockwise front faces pointing outwards
+	const unsigned int rings = 48;
+	const unsigned int segments = 96;
+	std::vector<dx::XMFLOAT3> positions;
+	for( unsigned int r = 0; r <= rings; r++ )
+	{
+		for( unsigned int s = 0; s <= segments; s++ )
+		{
+			const auto theta = PI * float( r ) / rings;
+			const auto phi = 2.0f * PI * float( s ) / segments;
+			positions.push_back( { std::sin( theta ) * std::cos( phi ),std::cos( theta ),std::sin( theta ) * std::sin( phi ) } );
+		}
+	}
+	std::vector<unsigned int> indices;
+	for( unsigned int r = 0; r < rings; r++ )
+	{
+		for( unsigned int s = 0; s < segments; s++ )
+		{
+			const auto a = r * (segments + 1) + s;
+			const auto b = a + segments + 1;
+			indices.insert( indices.end(),{ a,a + 1,b,a + 1,b + 1,b } );
+		}
+	}
+	const auto source = indices;
+	const auto clusters = MeshClusters::Build( &positions[0].x,positions.size(),sizeof( dx::XMFLOAT3 ),indices,64,124 );
+
+	// reordering keeps exactly the same triangles, clusters tile the buffer and respect the limits
+	const auto sortedTris = []( const std::vector<unsigned int>& ind )
+	{
+		std::vector<std::array<unsigned int,3>> tris;
+		for( size_t i = 0; i < ind.size(); i += 3 )
+		{
+			tris.push_back( { ind[i],ind[i + 1],ind[i + 2] } );
+		}
+		std::sort( tris.begin(),tris.end() );
+		return tris;
+	};
+	assert( sortedTris( source ) == sortedTris( indices ) );
+	unsigned int next = 0;
+	for( const auto& c : clusters.GetClusters() )
+	{
+		assert( c.startIndex == next && c.indexCount > 0 && c.indexCount <= 124 * 3 );
+		std::vector<unsigned int> verts( indices.begin() + c.startIndex,indices.begin() + c.startIndex + c.indexCount );
+		std::sort( verts.begin(),verts.end() );
+		assert( std::unique( verts.begin(),verts.end() ) - verts.begin() <= 64 );
+		next += c.indexCount;
+	}
+	assert( next == indices.size() );
+
+	// looking at the sphere from off to the side, half of it is out of view and the far side faces away
+	const auto eye = dx::XMVectorSet( 0.0f,0.0f,-3.0f,1.0f );
+	const auto viewProj = dx::XMMatrixLookAtLH( eye,dx::XMVectorSet( 1.0f,0.0f,0.0f,1.0f ),dx::XMVectorSet( 0.0f,1.0f,0.0f,0.0f ) ) *
+		dx::XMMatrixPerspectiveFovLH( PI / 4.0f,1.0f,0.1f,100.0f );
+	dx::XMFLOAT4X4 vp;
+	dx::XMStoreFloat4x4( &vp,viewProj );
+	float planes[6][4];
+	MeshClusters::ExtractFrustumPlanes( vp.m,planes );
+	dx::XMFLOAT3 eyePos;
+	dx::XMStoreFloat3( &eyePos,eye );
+	std::vector<MeshClusters::Range> ranges;
+	MeshClusters::CullStats stats;
+	const auto drawn = clusters.Cull( planes,&eyePos.x,ranges,&stats );
+	assert( drawn == stats.trianglesDrawn && drawn + stats.trianglesCulled == source.size() / 3 );
+	assert( stats.frustumCulled > 0 && stats.coneCulled > 0 );
+
+	// culling is conservative: every front facing triangle with a corner on screen is kept
+	std::vector<bool> kept( indices.size() / 3,false );
+	for( const auto& r : ranges )
+	{
+		for( auto i = r.startIndex; i < r.startIndex + r.indexCount; i += 3 )
+		{
+			kept[i / 3] = true;
+		}
+	}
+	for( size_t t = 0; t < kept.size(); t++ )
+	{
+		const auto p0 = dx::XMLoadFloat3( &positions[indices[t * 3]] );
+		const auto p1 = dx::XMLoadFloat3( &positions[indices[t * 3 + 1]] );
+		const auto p2 = dx::XMLoadFloat3( &positions[indices[t * 3 + 2]] );
+		const auto normal = dx::XMVector3Cross( dx::XMVectorSubtract( p1,p0 ),dx::XMVectorSubtract( p2,p0 ) );
+		const bool front = dx::XMVectorGetX( dx::XMVector3Dot( dx::XMVectorSubtract( p0,eye ),normal ) ) < 0.0f;
+		bool onScreen = false;
+		for( const auto& p : { p0,p1,p2 } )
+		{
+			dx::XMFLOAT4 clip;
+			dx::XMStoreFloat4( &clip,dx::XMVector4Transform( dx::XMVectorSetW( p,1.0f ),viewProj ) );
+			onScreen = onScreen || (std::abs( clip.x ) <= clip.w && std::abs( clip.y ) <= clip.w && clip.z >= 0.0f && clip.z <= clip.w);
+		}
+		assert( !(front && onScreen) || kept[t] );
+	}
+
+	// without an eye (two sided or mirrored meshes) only the frustum test runs
+	std::vector<MeshClusters::Range> frustumRanges;
+	MeshClusters::CullStats frustumStats;
+	const auto frustumDrawn = clusters.Cull( planes,nullptr,frustumRanges,&frustumStats );
+	assert( frustumStats.coneCulled == 0 && frustumStats.frustumCulled == stats.frustumCulled );
+	assert( frustumDrawn > drawn );
+}
+
+void TestMeshOptimizer()
+{
+	// grid with its vertices and triangles shuffled, about as bad as authored data gets
+	const unsigned int n = 64;
+	const unsigned int vertexCount = (n + 1) * (n + 1);
+	std::mt19937 rng( 7 );
+	std::vector<unsigned int> shuffle( vertexCount );
+	std::iota( shuffle.begin(),shuffle.end(),0u );
+	std::shuffle( shuffle.begin(),shuffle.end(),rng );
+	std::vector<std::array<unsigned int,3>> tris;
+	for( unsigned int y = 0; y < n; y++ )
+	{
+		for( unsigned int x = 0; x < n; x++ )
+		{
+			const auto a = y * (n + 1) + x;
+			const auto b = a + n + 1;
+			tris.push_back( { shuffle[a],shuffle[b],shuffle[a + 1] } );
+			tris.push_back( { shuffle[a + 1],shuffle[b],shuffle[b + 1] } );
+		}
+	}
+	std::shuffle( tris.begin(),tris.end(),rng );
+
+	aiMesh mesh;
+	FillTestMesh( mesh,vertexCount,false,[&]( unsigned int v )
+	{
+		const auto grid = (unsigned int)( std::find( shuffle.begin(),shuffle.end(),v ) - shuffle.begin() );
+		const aiVector3D pos( float( grid % (n + 1) ),float( grid / (n + 1) ),0.1f * std::sin( float( grid ) ) );
+		return TestVertex{ .pos = pos,.uv = { pos.x * 0.5f,pos.y * 0.25f,0.0f } };
+	} );
+	mesh.mNumFaces = (unsigned int)tris.size();
+	mesh.mFaces = new aiFace[tris.size()];
+	std::vector<unsigned int> before;
+	for( size_t i = 0; i < tris.size(); i++ )
+	{
+		mesh.mFaces[i].mNumIndices = 3;
+		mesh.mFaces[i].mIndices = new unsigned int[3];
+		std::copy( tris[i].begin(),tris[i].end(),mesh.mFaces[i].mIndices );
+		before.insert( before.end(),tris[i].begin(),tris[i].end() );
+	}
+	const auto positionsOf = [&]( const std::vector<unsigned int>& ind,const aiVector3D* pPos )
+	{
+		std::vector<std::array<float,9>> result;
+		for( size_t i = 0; i < ind.size(); i += 3 )
+		{
+			std::array<float,9> t;
+			for( int k = 0; k < 3; k++ )
+			{
+				t[k * 3] = pPos[ind[i + k]].x;
+				t[k * 3 + 1] = pPos[ind[i + k]].y;
+				t[k * 3 + 2] = pPos[ind[i + k]].z;
+			}
+			result.push_back( t );
+		}
+		std::sort( result.begin(),result.end() );
+		return result;
+	};
+	const auto trianglesBefore = positionsOf( before,mesh.mVertices );
+	const auto cacheBefore = MeshOptimizer::AnalyzeVertexCache( before,vertexCount );
+	const auto fetchBefore = MeshOptimizer::AnalyzeVertexFetch( before,vertexCount,56 );
+
+	const bool optimized = MeshOptimizer::Optimize( mesh );
+	assert( optimized );
+	std::vector<unsigned int> after;
+	for( unsigned int i = 0; i < mesh.mNumFaces; i++ )
+	{
+		after.insert( after.end(),mesh.mFaces[i].mIndices,mesh.mFaces[i].mIndices + 3 );
+	}
+	// same triangles with the same winding, attributes moved together with their vertices
+	assert( positionsOf( after,mesh.mVertices ) == trianglesBefore );
+	for( unsigned int v = 0; v < vertexCount; v++ )
+	{
+		assert( mesh.mTextureCoords[0][v].x == mesh.mVertices[v].x * 0.5f && mesh.mTextureCoords[0][v].y == mesh.mVertices[v].y * 0.25f );
+	}
+	// vertices are in first-use order
+	unsigned int highest = 0;
+	for( auto i : after )
+	{
+		assert( i <= highest + 1 );
+		highest = std::max( highest,i );
+	}
+	const auto cacheAfter = MeshOptimizer::AnalyzeVertexCache( after,vertexCount );
+	const auto fetchAfter = MeshOptimizer::AnalyzeVertexFetch( after,vertexCount,56 );
+	assert( cacheBefore.acmr > 2.5f && cacheAfter.acmr < 0.8f && cacheAfter.atvr < 1.6f );
+	assert( fetchAfter.overfetch < fetchBefore.overfetch * 0.5f && fetchAfter.overfetch < 2.0f );
+}
+
+void TestDenseGrid()
+{
+	// 1024 x 1024 quads is well past what 16-bit indices can address
+	const unsigned int divisions = 1024;
+	const auto model = Plane::Make( Plane::Type::PlaneTextured,divisions );
+	const size_t vertexCount = size_t( divisions + 1 ) * (divisions + 1);
+	assert( model.vertices.Size() == vertexCount );
+	assert( model.indices.size() == size_t( divisions ) * divisions * 6 );
+	assert( *std::max_element( model.indices.begin(),model.indices.end() ) == vertexCount - 1 );
+	// the last quad still references the last row and column correctly
+	const auto last = model.indices.end() - 6;
+	const auto corner = (unsigned int)( vertexCount - 1 );
+	assert( std::count( last,model.indices.end(),corner ) == 1 );
+	assert( std::count( last,model.indices.end(),corner - 1 ) == 2 );
+	assert( std::count( last,model.indices.end(),corner - (divisions + 1) ) == 2 );
+}
+
+void TestCookedModel()
+{
+	const std::string path = "Models\\brick_wall\\brick_wall.obj";
+	const std::string cachePath = "brick_wall_test.cooked";
+	const unsigned int flags =
+		aiProcess_Triangulate |
+		aiProcess_JoinIdenticalVertices |
+		aiProcess_ConvertToLeftHanded |
+		aiProcess_GenNormals |
+		aiProcess_CalcTangentSpace;
+	ModelOptions options;
+	options.lodCount = 2u;
+	options.clusters = true;
+	const auto key = CookedModel::MakeKey( path,flags,2.0f,false,options );
+	// every input feeds the key
+	options.clusterMaxTriangles = 64u;
+	assert( CookedModel::MakeKey( path,flags,2.0f,false,options ) != key );
+	options.clusterMaxTriangles = 124u;
+	assert( CookedModel::MakeKey( path,flags,1.0f,false,options ) != key );
+	// so does the .mtl of an .obj
+	{
+		std::ofstream( "key_test.obj" ) << "mtllib key_test.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl a\nf 1 2 3\n";
+		std::ofstream( "key_test.mtl" ) << "newmtl a\nKd 1 0 0\n";
+		const auto objKey = CookedModel::MakeKey( "key_test.obj",flags,2.0f,false,options );
+		std::ofstream( "key_test.mtl" ) << "newmtl a\nKd 0 1 0\n";
+		assert( CookedModel::MakeKey( "key_test.obj",flags,2.0f,false,options ) != objKey );
+		std::filesystem::remove( "key_test.obj" );
+		std::filesystem::remove( "key_test.mtl" );
+	}
+
+	Assimp::Importer imp;
+	const auto pScene = imp.ReadFile( path.c_str(),flags );
+	std::vector<Dvtx::VertexLayout> layouts;
+	for( unsigned int i = 0; i < pScene->mNumMaterials; i++ )
+	{
+		layouts.push_back( Material::DeriveVertexLayout( *pScene->mMaterials[i],false ) );
+	}
+	const auto pCooked = CookedModel::Cook( *pScene,layouts,2.0f,options,key );
+	pCooked->Save( cachePath );
+
+	assert( !CookedModel::Load( cachePath,key + 1 ) );
+	assert( !CookedModel::Load( "missing.cooked",key ) );
+	auto pLoaded = CookedModel::Load( cachePath,key );
+	assert( pLoaded && pLoaded->GetSizeBytes() == pCooked->GetSizeBytes() );
+	assert( pLoaded->GetMaterialCount() == pScene->mNumMaterials );
+	aiString texFileName;
+	assert( pScene->mMaterials[0]->GetTexture( aiTextureType_DIFFUSE,0,&texFileName ) != aiReturn_SUCCESS ||
+		pLoaded->GetMaterial( 0 ).GetTexture( aiTextureType_DIFFUSE,0,&texFileName ) == aiReturn_SUCCESS );
+	const auto IndicesEqual = []( const CookedModel::Indices& a,const CookedModel::Indices& b )
+	{
+		return a.count == b.count && a.wide == b.wide &&
+			std::memcmp( a.pData,b.pData,a.count * (a.wide ? 4u : 2u) ) == 0;
+	};
+	assert( pLoaded->GetMeshes().size() == pCooked->GetMeshes().size() );
+	for( size_t m = 0; m < pCooked->GetMeshes().size(); m++ )
+	{
+		const auto& a = pCooked->GetMeshes()[m];
+		const auto& b = pLoaded->GetMeshes()[m];
+		assert( a.layoutCode == b.layoutCode && a.vertexBytes == b.vertexBytes );
+		assert( std::memcmp( a.pVertices,b.pVertices,a.vertexBytes ) == 0 );
+		assert( IndicesEqual( a.indices,b.indices ) );
+		assert( a.lods.size() == 1 && b.lods.size() == 1 && IndicesEqual( a.lods[0].indices,b.lods[0].indices ) );
+		assert( !b.clusters.empty() && b.clusters.size() == a.clusters.size() );
+		// positions were scaled on the way in
+		assert( b.bounds.Extents.x == a.bounds.Extents.x && b.bounds.Extents.x > 0.0f );
+	}
+	assert( pLoaded->GetRoot().name == pScene->mRootNode->mName.C_Str() );
+	// unmap before deleting
+	pLoaded.reset();
+	std::filesystem::remove( cachePath );
+}
+
+void TestCodexBudget()
+{
+	// stands in for a buffer, only its size matters to the codex
+	class Sized : public Bind::Bindable
+	{
+	public:
+		Sized( size_t bytes ) : bytes( bytes ) {}
+		void Bind( Graphics& ) noxnd override {}
+		size_t GetSizeBytes() const noexcept override
+		{
+			return bytes;
+		}
+		static std::string GenerateUID( int id )
+		{
+			return "test sized#" + std::to_string( id );
+		}
+	private:
+		size_t bytes;
+	};
+	const auto resolve = []( int id )
+	{
+		return Bind::Codex::ResolveDeferred<Sized>( []() { return std::make_shared<Sized>( 1000u ); },id );
+	};
+	// only what the rest of the program still holds is left, none of it can be evicted
+	const auto oldBudget = Bind::Codex::GetStats().budget;
+	Bind::Codex::Evict( true );
+	const auto before = Bind::Codex::GetStats();
+	Bind::Codex::SetBudget( before.bytes + 3000u );
+	resolve( 1 );
+	const auto pHeld = resolve( 2 );
+	resolve( 3 );
+	assert( Bind::Codex::GetStats().evictions == before.evictions );
+	// going over drops the least recently used entry nothing holds, the held one stays
+	resolve( 3 );
+	resolve( 4 );
+	auto stats = Bind::Codex::GetStats();
+	assert( stats.evictions == before.evictions + 1u && stats.bytes == before.bytes + 3000u );
+	const auto misses = stats.misses;
+	resolve( 2 );
+	resolve( 3 );
+	assert( Bind::Codex::GetStats().misses == misses );
+	resolve( 1 );
+	stats = Bind::Codex::GetStats();
+	assert( stats.misses == misses + 1u && stats.evictions == before.evictions + 2u );
+	Bind::Codex::SetBudget( oldBudget );
+	Bind::Codex::Evict( true );
+}
+
+void TestStaticBatch()
+{
+	// two objects sharing the default material, each under its own identity node, and a third one too big to batch
+	const std::string obj =
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\nv 1 1 1\n"
+		"o first\nf 1 2 3\n"
+		"o second\nf 1 2 4\nf 2 3 4\n"
+		"o third\nf 1 2 5\nf 2 3 5\nf 3 4 5\n";
+	const unsigned int flags =
+		aiProcess_Triangulate |
+		aiProcess_JoinIdenticalVertices |
+		aiProcess_ConvertToLeftHanded |
+		aiProcess_GenNormals |
+		aiProcess_CalcTangentSpace;
+	Assimp::Importer imp;
+	const auto pScene = imp.ReadFileFromMemory( obj.data(),obj.size(),flags,"obj" );
+	assert( pScene );
+	std::vector<Dvtx::VertexLayout> layouts;
+	for( unsigned int i = 0; i < pScene->mNumMaterials; i++ )
+	{
+		layouts.push_back( Material::DeriveVertexLayout( *pScene->mMaterials[i],false ) );
+	}
+	const auto pCooked = CookedModel::Cook( *pScene,layouts,1.0f,{},0u );
+	const auto& meshes = pCooked->GetMeshes();
+	assert( meshes.size() == 3 );
+
+	unsigned int maxVertices = 0u;
+	for( const auto& mesh : meshes )
+	{
+		maxVertices = std::max( maxVertices,mesh.vertexCount );
+	}
+	// nothing to merge a single small mesh with
+	assert( StaticBatch::Build( *pCooked,0u ).empty() );
+	const auto batches = StaticBatch::Build( *pCooked,maxVertices - 1u );
+	assert( batches.size() == 1 && batches[0].subMeshes.size() == 2 );
+	const auto& batch = batches[0];
+	for( const auto& sub : batch.subMeshes )
+	{
+		const auto& mesh = meshes[sub.meshIndex];
+		assert( mesh.vertexCount < maxVertices && sub.indexCount == mesh.indices.count );
+		const auto stride = mesh.vertexBytes / mesh.vertexCount;
+		// every batched vertex a sub-mesh index reaches is the vertex the original index reached
+		for( unsigned int n = 0; n < sub.indexCount; n++ )
+		{
+			const unsigned int original = mesh.indices.wide ?
+				static_cast<const unsigned int*>( mesh.indices.pData )[n] :
+				static_cast<const unsigned short*>( mesh.indices.pData )[n];
+			const unsigned int merged = batch.indices[sub.startIndex + n] + sub.baseVertex;
+			assert( merged < batch.vertexCount );
+			assert( std::memcmp( &batch.vertices[merged * stride],mesh.pVertices + original * stride,stride ) == 0 );
+		}
+	}
+	const auto stats = StaticBatch::Analyze( batches,meshes.size() );
+	assert( stats.submissionsBefore == 3 && stats.submissionsAfter == 2 );
+	// both sub-meshes share base vertex 0 and sit back to back, one draw
+	assert( stats.drawCallsAfter == 2 );
+}
+
+void TestTextureAtlasPlan()
+{
+	using Size = std::pair<unsigned int,unsigned int>;
+	// a lone image is not worth an array
+	assert( TextureAtlas::MakePlan( { { 512u,512u } },8u ).sliceCount == 0u );
+
+	const std::vector<Size> sizes = {
+		{ 1024u,1024u },{ 256u,256u },{ 1024u,1024u },{ 2048u,2048u },
+		{ 256u,128u },{ 1024u,1024u },{ 256u,256u },{ 1024u,1024u }
+	};
+	const unsigned int padding = 8u;
+	const auto plan = TextureAtlas::MakePlan( sizes,padding );
+	// most common size sets the slices, the larger image stays out, the small ones share one slice
+	assert( plan.width == 1024u && plan.height == 1024u );
+	assert( plan.sliceCount == 5u );
+	assert( plan.places.size() == sizes.size() - 1 );
+	for( const auto& a : plan.places )
+	{
+		const auto [w,h] = sizes[a.image];
+		assert( a.image != 3 );
+		assert( a.slice < plan.sliceCount );
+		assert( a.x + w <= plan.width && a.y + h <= plan.height );
+		if( w != plan.width )
+		{
+			assert( a.slice == 4u && a.x >= padding && a.y >= padding );
+		}
+		// padded rects of images sharing a slice never overlap
+		for( const auto& b : plan.places )
+		{
+			if( &a == &b || a.slice != b.slice )
+			{
+				continue;
+			}
+			const auto [bw,bh] = sizes[b.image];
+			const bool apart =
+				a.x + w + padding <= b.x - padding || b.x + bw + padding <= a.x - padding ||
+				a.y + h + padding <= b.y - padding || b.y + bh + padding <= a.y - padding;
+			assert( apart );
+		}
+	}
+}
+
+void TestVertexQuantization()
+{
+	using Dvtx::VertexLayout;
+	// random tangent frames of both handednesses, positions in an off-center box, uvs in [0,1]
+	const unsigned int vertexCount = 4096;
+	std::mt19937 rng( 11 );
+	std::uniform_real_distribution<float> dist( -1.0f,1.0f );
+	const auto randomUnit = [&]()
+	{
+		aiVector3D v;
+		do
+		{
+			v = { dist( rng ),dist( rng ),dist( rng ) };
+		} while( v.SquareLength() < 0.01f || v.SquareLength() > 1.0f );
+		return v.Normalize();
+	};
+	aiMesh mesh;
+	FillTestMesh( mesh,vertexCount,true,[&]( unsigned int i )
+	{
+		const aiVector3D pos{ 100.0f + 20.0f * dist( rng ),-5.0f + 2.0f * dist( rng ),3.0f * dist( rng ) };
+		const auto n = randomUnit();
+		auto t = randomUnit();
+		t = (t - n * (t * n)).Normalize();
+		const aiVector3D uv{ dist( rng ) * 0.5f + 0.5f,dist( rng ) * 0.5f + 0.5f,0.0f };
+		return TestVertex{ .pos = pos,.uv = uv,.normal = n,.tangent = t,.bitangent = (n ^ t) * (i % 2 ? -1.0f : 1.0f) };
+	} );
+
+	auto fullLayout = VertexLayout{}
+		.Append( VertexLayout::Position3D )
+		.Append( VertexLayout::Normal )
+		.Append( VertexLayout::Texture2D )
+		.Append( VertexLayout::Tangent )
+		.Append( VertexLayout::Binormal );
+	auto compactLayout = VertexLayout{}
+		.Append( VertexLayout::QuantizedPosition3D )
+		.Append( VertexLayout::OctNormal )
+		.Append( VertexLayout::HalfTexture2D )
+		.Append( VertexLayout::OctTangent );
+	// bytes per vertex
+	assert( fullLayout.Size() == 56u );
+	assert( compactLayout.Size() == 20u );
+	assert( compactLayout.GetD3DLayout()[3].Format == DXGI_FORMAT_R16G16_UINT );
+
+	const Dvtx::VertexBuffer compact{ compactLayout,mesh };
+	const auto quantization = Dvtx::PositionQuantization::FromMesh( mesh );
+	assert( quantization.range > 39.0f && quantization.range <= 40.0f );
+	const auto dequantize = quantization.GetDequantizeXM();
+	const auto angle = []( const aiVector3D& a,const dx::XMFLOAT3& b )
+	{
+		return std::acos( std::clamp( a.x * b.x + a.y * b.y + a.z * b.z,-1.0f,1.0f ) );
+	};
+	float maxNormalError = 0.0f;
+	float maxTangentError = 0.0f;
+	float maxUvError = 0.0f;
+	float maxPositionError = 0.0f;
+	for( unsigned int i = 0; i < vertexCount; i++ )
+	{
+		const auto v = compact[i];
+		maxNormalError = std::max( maxNormalError,angle( mesh.mNormals[i],Dvtx::UnpackOctNormal( v.Attr<VertexLayout::OctNormal>() ) ) );
+		float sign;
+		const auto t = Dvtx::UnpackOctTangent( v.Attr<VertexLayout::OctTangent>(),sign );
+		maxTangentError = std::max( maxTangentError,angle( mesh.mTangents[i],t ) );
+		assert( sign == (i % 2 ? -1.0f : 1.0f) );
+		dx::XMFLOAT2 uv;
+		dx::XMStoreFloat2( &uv,dx::PackedVector::XMLoadHalf2( &v.Attr<VertexLayout::HalfTexture2D>() ) );
+		maxUvError = std::max( { maxUvError,std::abs( uv.x - mesh.mTextureCoords[0][i].x ),std::abs( uv.y - mesh.mTextureCoords[0][i].y ) } );
+		dx::XMFLOAT3 p;
+		dx::XMStoreFloat3( &p,dx::XMVector3Transform( dx::PackedVector::XMLoadUShortN4( &v.Attr<VertexLayout::QuantizedPosition3D>() ),dequantize ) );
+		const auto& src = mesh.mVertices[i];
+		maxPositionError = std::max( { maxPositionError,std::abs( p.x - src.x ),std::abs( p.y - src.y ),std::abs( p.z - src.z ) } );
+	}
+	// 16-bit octahedral is good to a few hundredths of a degree, the 15-bit tangent axis about twice that
+	assert( maxNormalError < 0.0005f );
+	assert( maxTangentError < 0.001f );
+	// half has 11 significant bits, half a step below 1 is 2^-12
+	assert( maxUvError <= 1.0f / 4096.0f );
+	// half a quantization step of the bounding cube, plus float slack
+	assert( maxPositionError <= quantization.range / 65535.0f * 0.5f + 1e-4f );
+
+	// the unpacked frame reproduces the binormal
+	const auto n = Dvtx::UnpackOctNormal( compact[1].Attr<VertexLayout::OctNormal>() );
+	float sign;
+	const auto t = Dvtx::UnpackOctTangent( compact[1].Attr<VertexLayout::OctTangent>(),sign );
+	dx::XMFLOAT3 b;
+	dx::XMStoreFloat3( &b,dx::XMVectorScale( dx::XMVector3Cross( dx::XMLoadFloat3( &n ),dx::XMLoadFloat3( &t ) ),sign ) );
+	assert( angle( mesh.mBitangents[1],b ) < 0.002f );
+}
+
+void TestVertexFormat()
+{
+	using Dvtx::VertexLayout;
+	using Full = Dvtx::VertexFormat<VertexLayout::Position3D,VertexLayout::Normal,VertexLayout::Texture2D,
+		VertexLayout::Tangent,VertexLayout::Binormal>;
+	using Compact = Dvtx::VertexFormat<VertexLayout::QuantizedPosition3D,VertexLayout::OctNormal,
+		VertexLayout::HalfTexture2D,VertexLayout::OctTangent>;
+	static_assert( Full::size == 56u && Compact::size == 20u );
+	static_assert( Full::OffsetOf<VertexLayout::Texture2D>() == 24u && Compact::OffsetOf<VertexLayout::OctTangent>() == 16u );
+
+	// same bytes as the dynamic layout of the same elements
+	const auto fullLayout = Full::MakeLayout();
+	assert( fullLayout.Size() == Full::size );
+	assert( fullLayout.GetCode() == "P3NT2TB" );
+	assert( fullLayout.Resolve<VertexLayout::Binormal>().GetOffset() == Full::OffsetOf<VertexLayout::Binormal>() );
+	assert( Full::Describes( fullLayout ) );
+	// element order matters, so does every element being there
+	assert( !Full::Describes( VertexLayout{}.Append( VertexLayout::Position3D ).Append( VertexLayout::Texture2D )
+		.Append( VertexLayout::Normal ).Append( VertexLayout::Tangent ).Append( VertexLayout::Binormal ) ) );
+	assert( !Full::Describes( VertexLayout{}.Append( VertexLayout::Position3D ).Append( VertexLayout::Normal ) ) );
+
+	// static vertices go into a VertexBuffer as they are and read back through the dynamic path
+	const std::vector<Full::Vertex> vertices = {
+		Full::Make( { 1.0f,2.0f,3.0f },{ 0.0f,0.0f,1.0f },{ 0.25f,0.75f },{ 1.0f,0.0f,0.0f },{ 0.0f,1.0f,0.0f } ),
+		Full::Make( { 4.0f,5.0f,6.0f },{ 0.0f,1.0f,0.0f },{ 0.5f,0.5f },{ 0.0f,0.0f,1.0f },{ 1.0f,0.0f,0.0f } ),
+	};
+	auto buf = Full::MakeBuffer( vertices );
+	assert( buf.Size() == 2u && buf.SizeBytes() == 2u * Full::size );
+	assert( buf[1].Attr<VertexLayout::Position3D>().y == 5.0f );
+	assert( buf[0].Attr<VertexLayout::Texture2D>().y == 0.75f );
+	assert( buf[1].Attr<VertexLayout::Binormal>().x == 1.0f );
+	// and the other way round, writes through a view land in the buffer
+	Full::View( buf )[0].Attr<VertexLayout::Normal>().x = 0.5f;
+	assert( buf.Stream<VertexLayout::Normal>()[0].x == 0.5f );
+	assert( std::as_const( buf ).Stream<VertexLayout::Texture2D>()[1].x == 0.5f );
+
+	// importing through a format gives exactly what the dynamic import gives
+	constexpr unsigned int vertexCount = 97u;
+	aiMesh mesh;
+	FillTestMesh( mesh,vertexCount,true,[]( unsigned int i )
+	{
+		const float a = float( i ) * 0.37f;
+		return TestVertex{
+			.pos = { std::cos( a ) * 10.0f,float( i ),std::sin( a ) * 4.0f },
+			.uv = { float( i ) / vertexCount,1.0f - float( i ) / vertexCount,0.0f },
+			.normal = { std::cos( a ),0.0f,std::sin( a ) },
+			.tangent = { -std::sin( a ),0.0f,std::cos( a ) },
+			.bitangent = { 0.0f,i % 3 ? 1.0f : -1.0f,0.0f }
+		};
+	} );
+	const Dvtx::VertexBuffer fullDynamic{ fullLayout,mesh };
+	const auto fullStatic = Full::Extract( mesh );
+	assert( fullStatic.size() == vertexCount );
+	assert( std::memcmp( fullStatic.data(),fullDynamic.GetData(),fullDynamic.SizeBytes() ) == 0 );
+	const Dvtx::VertexBuffer compactDynamic{ Compact::MakeLayout(),mesh };
+	const auto compactStatic = Compact::Extract( mesh );
+	assert( std::memcmp( compactStatic.data(),compactDynamic.GetData(),compactDynamic.SizeBytes() ) == 0 );
+
+	// procedural geometry built through formats keeps the layout it was asked for
+	const auto plane = Plane::Make( Plane::Type::PlaneTexturedTBN,2u );
+	assert( plane.vertices.GetLayout().GetCode() == "P3TBNT2" );
+	assert( plane.vertices.Size() == 9u );
+	const auto corner = plane.vertices[8];
+	assert( corner.Attr<VertexLayout::Position3D>().x == 1.0f && corner.Attr<VertexLayout::Position3D>().y == 1.0f );
+	assert( corner.Attr<VertexLayout::Binormal>().y == -1.0f );
+	assert( corner.Attr<VertexLayout::Texture2D>().x == 1.0f && corner.Attr<VertexLayout::Texture2D>().y == 0.0f );
+}
+
+void TestVertexConverter()
+{
+	namespace dx = DirectX;
+	using Dvtx::VertexLayout;
+	constexpr unsigned int vertexCount = 131u;
+	aiMesh mesh;
+	FillTestMesh( mesh,vertexCount,true,[]( unsigned int i )
+	{
+		const float a = float( i ) * 0.61f;
+		const aiVector3D n{ std::cos( a ),0.0f,std::sin( a ) };
+		const aiVector3D t{ -std::sin( a ),0.0f,std::cos( a ) };
+		return TestVertex{
+			.pos = { std::cos( a ) * 3.0f + 7.0f,float( i ) * 0.1f,std::sin( a ) * 2.0f },
+			.uv = { float( i ) / vertexCount,0.25f + float( i % 7 ) * 0.1f,0.0f },
+			.normal = n,
+			.tangent = t,
+			.bitangent = (n ^ t) * (i % 5 ? 1.0f : -1.0f)
+		};
+	} );
+	const auto fullLayout = VertexLayout{}
+		.Append( VertexLayout::Position3D )
+		.Append( VertexLayout::Normal )
+		.Append( VertexLayout::Texture2D )
+		.Append( VertexLayout::Tangent )
+		.Append( VertexLayout::Binormal );
+	const auto compactLayout = VertexLayout{}
+		.Append( VertexLayout::QuantizedPosition3D )
+		.Append( VertexLayout::OctNormal )
+		.Append( VertexLayout::HalfTexture2D )
+		.Append( VertexLayout::OctTangent );
+
+	// scale only: exactly the per-vertex extraction plus scaling the positions afterwards,
+	// on one thread and split into blocks that do not divide the mesh evenly
+	constexpr float scale = 2.5f;
+	Dvtx::VertexBuffer fullReference{ fullLayout,mesh };
+	const auto positions = fullReference.Stream<VertexLayout::Position3D>();
+	for( size_t i = 0; i < positions.Size(); i++ )
+	{
+		positions[i].x *= scale;
+		positions[i].y *= scale;
+		positions[i].z *= scale;
+	}
+	const Dvtx::VertexBuffer compactReference{ compactLayout,mesh };
+	for( const auto [threads,blockVertices] : { std::pair{ 1u,16384u },std::pair{ 4u,16u } } )
+	{
+		VertexConverter::Options options;
+		options.scale = scale;
+		options.threads = threads;
+		options.blockVertices = blockVertices;
+		const auto full = VertexConverter::Convert( fullLayout,mesh,options );
+		assert( !full.positionQuantization );
+		assert( full.vertices.SizeBytes() == fullReference.SizeBytes() );
+		assert( std::memcmp( full.vertices.GetData(),fullReference.GetData(),fullReference.SizeBytes() ) == 0 );
+		const auto compact = VertexConverter::Convert( compactLayout,mesh,options );
+		assert( std::memcmp( compact.vertices.GetData(),compactReference.GetData(),compactReference.SizeBytes() ) == 0 );
+		// the scale went into the dequantization
+		const auto q = Dvtx::PositionQuantization::FromMesh( mesh );
+		assert( compact.positionQuantization && compact.positionQuantization->range == q.range * scale );
+		assert( compact.positionQuantization->offset.x == q.offset.x * scale );
+	}
+
+	// full transform: positions move, the frame turns with them and keeps its handedness
+	const auto transform = dx::XMMatrixRotationY( PI / 2.0f ) * dx::XMMatrixTranslation( 0.0f,1.0f,0.0f );
+	VertexConverter::Options options;
+	options.scale = scale;
+	options.transform.emplace();
+	dx::XMStoreFloat4x4( &*options.transform,transform );
+	options.blockVertices = 32u;
+	const auto within = []( const dx::XMFLOAT3& a,dx::FXMVECTOR b,float tolerance )
+	{
+		dx::XMFLOAT3 v;
+		dx::XMStoreFloat3( &v,b );
+		return std::abs( a.x - v.x ) <= tolerance && std::abs( a.y - v.y ) <= tolerance && std::abs( a.z - v.z ) <= tolerance;
+	};
+	const auto load = []( const aiVector3D& v )
+	{
+		return dx::XMVectorSet( v.x,v.y,v.z,0.0f );
+	};
+	const auto full = VertexConverter::Convert( fullLayout,mesh,options );
+	const auto compact = VertexConverter::Convert( compactLayout,mesh,options );
+	assert( compact.positionQuantization );
+	const auto& q = *compact.positionQuantization;
+	for( unsigned int i = 0; i < vertexCount; i++ )
+	{
+		const auto p = dx::XMVector3TransformCoord( dx::XMVectorScale( load( mesh.mVertices[i] ),scale ),transform );
+		const auto n = dx::XMVector3TransformNormal( load( mesh.mNormals[i] ),transform );
+		const auto t = dx::XMVector3TransformNormal( load( mesh.mTangents[i] ),transform );
+		const auto v = full.vertices[i];
+		assert( within( v.Attr<VertexLayout::Position3D>(),p,1e-4f ) );
+		assert( within( v.Attr<VertexLayout::Normal>(),n,1e-5f ) );
+		assert( within( v.Attr<VertexLayout::Tangent>(),t,1e-5f ) );
+		assert( v.Attr<VertexLayout::Texture2D>().x == mesh.mTextureCoords[0][i].x );
+
+		const auto c = compact.vertices[i];
+		assert( within( q.Dequantize( c.Attr<VertexLayout::QuantizedPosition3D>() ),p,q.range / 65535.0f + 1e-4f ) );
+		assert( within( Dvtx::UnpackOctNormal( c.Attr<VertexLayout::OctNormal>() ),n,1e-3f ) );
+		float sign;
+		assert( within( Dvtx::UnpackOctTangent( c.Attr<VertexLayout::OctTangent>(),sign ),t,2e-3f ) );
+		assert( sign == (i % 5 ? 1.0f : -1.0f) );
+	}
+	// a mirroring transform swaps the handedness the tangent carries
+	dx::XMStoreFloat4x4( &*options.transform,dx::XMMatrixScaling( -1.0f,1.0f,1.0f ) );
+	const auto mirrored = VertexConverter::Convert( compactLayout,mesh,options );
+	float sign;
+	Dvtx::UnpackOctTangent( mirrored.vertices[1].Attr<VertexLayout::OctTangent>(),sign );
+	assert( sign == -1.0f );
+}
+
+void TestMaterialTable()
+{
+	Dcb::RawLayout lay;
+	lay.Add<Dcb::Float3>( "materialColor" );
+	lay.Add<Dcb::Float>( "metallic" );
+	Dcb::Buffer red{ std::move( lay ) };
+	red["materialColor"] = dx::XMFLOAT3{ 1.0f,0.0f,0.0f };
+	red["metallic"] = 0.5f;
+	auto blue = red;
+	blue["materialColor"] = dx::XMFLOAT3{ 0.0f,0.0f,1.0f };
+
+	Bind::MaterialTable table{ red.GetRootLayoutElement() };
+	assert( table.GetStride() == 16u );
+	// identical blocks share an element
+	const auto r0 = table.Acquire( red );
+	const auto r1 = table.Acquire( red );
+	const auto b = table.Acquire( blue );
+	assert( r0 == r1 && r0 != b );
+	assert( table.GetReferenceCount( r0 ) == 2u );
+	assert( table.GetStats().entries == 2u && table.GetStats().references == 3u );
+	assert( table.GetDirtyRange().first == 0u && table.GetDirtyRange().last == 2u );
+	// shared elements are not written in place
+	auto edited = red;
+	edited["metallic"] = 1.0f;
+	const bool wroteShared = table.Write( r0,edited );
+	assert( !wroteShared );
+	const bool wroteSole = table.Write( b,edited );
+	assert( wroteSole );
+	// released slots are reused, and content lookup follows in-place writes
+	table.Release( b );
+	const auto reacquired = table.Acquire( edited );
+	assert( reacquired == b );
+	table.Release( r0 );
+	const bool wroteReleased = table.Write( r0,blue );
+	assert( wroteReleased );
+	const auto blueIndex = table.Acquire( blue );
+	assert( blueIndex == r0 );
+
+	// entries of identical materials split on edit, the other keeps its element
+	Bind::MaterialEntry e0{ red };
+	Bind::MaterialEntry e1{ red };
+	assert( e0.GetIndex() == e1.GetIndex() );
+	e1.SetBuffer( edited );
+	assert( e0.GetIndex() != e1.GetIndex() );
+	assert( (float)e0.GetBuffer()["metallic"] == 0.5f );
+	// sole owner edits in place
+	const auto index = e1.GetIndex();
+	e1.SetBuffer( blue );
+	assert( e1.GetIndex() == index );
+}
+
+void TestDcbAccessors()
+{
+	Dcb::RawLayout s;
+	s.Add<Dcb::Float>( "woot" );
+	s.Add<Dcb::Array>( "arr" );
+	s["arr"].Set<Dcb::Struct>( 4 );
+	s["arr"].T().Add<Dcb::Float3>( "twerk" );
+	s["arr"].T().Add<Dcb::Array>( "werk" );
+	s["arr"].T()["werk"].Set<Dcb::Float>( 6 );
+	const auto lay = Dcb::LayoutCodex::Resolve( std::move( s ) );
+	Dcb::Buffer a{ lay };
+	Dcb::Buffer b{ lay };
+	// compiled once, lands on the same bytes as the string path in every buffer of the layout
+	const auto werk = lay.Compile<float>( "arr[2].werk[5]" );
+	const Dcb::Accessor<dx::XMFLOAT3> twerk{ b.GetRootLayoutElement(),"arr[3].twerk" };
+	assert( werk.Exists() && twerk.Exists() );
+	a[werk] = 111.0f;
+	b[werk] = 222.0f;
+	assert( (float)a["arr"][2]["werk"][5] == 111.0f );
+	assert( (float)b["arr"][2]["werk"][5] == 222.0f );
+	b["arr"][3]["twerk"] = dx::XMFLOAT3{ 1.0f,2.0f,3.0f };
+	assert( b[twerk].z == 3.0f );
+	// missing or malformed paths give empty accessors
+	assert( !lay.Compile<float>( "arr[4].werk[0]" ).Exists() );
+	assert( !lay.Compile<float>( "nope" ).Exists() );
+	assert( !lay.Compile<float>( "arr.werk[0]" ).Exists() );
+	assert( !lay.Compile<float>( "arr[2]werk[0]" ).Exists() );
+	assert( !lay.Compile<float>( "woot[0]" ).Exists() );
+	assert( !lay.Compile<float>( "arr[x].werk[0]" ).Exists() );
+
+	// static layout offsets agree with a mirroring c++ struct and with the runtime layout
+	struct Mirror
+	{
+		dx::XMFLOAT3 color;
+		float gloss;
+		dx::XMFLOAT2 uv;
+		float pad[2];
+		dx::XMFLOAT3 dir;
+		int enabled;
+	};
+	using MirrorLayout = Dcb::StaticLayout<
+		Dcb::Member<Dcb::Float3,"color">,
+		Dcb::Member<Dcb::Float,"gloss">,
+		Dcb::Member<Dcb::Float2,"uv">,
+		Dcb::Member<Dcb::Float3,"dir">,
+		Dcb::Member<Dcb::Integer,"enabled">
+	>;
+	static_assert(MirrorLayout::OffsetOf<"gloss">() == offsetof( Mirror,gloss ));
+	static_assert(MirrorLayout::OffsetOf<"uv">() == offsetof( Mirror,uv ));
+	static_assert(MirrorLayout::OffsetOf<"dir">() == offsetof( Mirror,dir ));
+	static_assert(MirrorLayout::OffsetOf<"enabled">() == offsetof( Mirror,enabled ));
+	static_assert(MirrorLayout::sizeInBytes == sizeof( Mirror ));
+	const auto mirrorLay = MirrorLayout::Make();
+	assert( MirrorLayout::Describes( *mirrorLay.ShareRoot() ) );
+	Dcb::Buffer m{ mirrorLay };
+	MirrorLayout::Get<"dir">( m ) = dx::XMFLOAT3{ 0.0f,-1.0f,0.0f };
+	MirrorLayout::Get<"enabled">( m ) = 7;
+	const dx::XMFLOAT3 dir = m["dir"];
+	assert( dir.y == -1.0f );
+	assert( (int)m["enabled"] == 7 );
+	// the codex shares the root, so accessors compiled on one Make() serve buffers from another
+	Dcb::Buffer m2{ MirrorLayout::Make() };
+	m2["enabled"] = 9;
+	assert( m2[mirrorLay.Compile<int>( "enabled" )] == 9 );
+}
+
+void TestDcbDirtyRanges()
+{
+	Dcb::RawLayout s;
+	s.Add<Dcb::Float3>( "color" );
+	s.Add<Dcb::Float>( "gloss" );
+	s.Add<Dcb::Array>( "weights" );
+	s["weights"].Set<Dcb::Float>( 4 );
+	s.Add<Dcb::Integer>( "count" );
+	Dcb::Buffer b{ std::move( s ) };
+	const auto range = [&b]() { return std::make_pair( b.GetDirtyRange().begin,b.GetDirtyRange().end ); };
+	// fresh buffers are clean, writing the value already there leaves them clean
+	assert( !b.IsDirty() );
+	b["gloss"] = 0.0f;
+	assert( !b.IsDirty() );
+	// writes grow one range over the leaves they touch (weights are padded to a row each)
+	b["gloss"] = 2.0f;
+	assert( range() == std::make_pair( size_t( 12 ),size_t( 16 ) ) );
+	b["weights"][1] = 0.5f;
+	assert( range() == std::make_pair( size_t( 12 ),size_t( 36 ) ) );
+	b.ClearDirty();
+	// mutable access through accessors, static layouts and pointers counts as a write
+	b[Dcb::Accessor<int>{ b.GetRootLayoutElement(),"count" }] = 3;
+	assert( range() == std::make_pair( size_t( 80 ),size_t( 84 ) ) );
+	b.ClearDirty();
+	float* pGloss = &b["gloss"];
+	*pGloss = 4.0f;
+	assert( range() == std::make_pair( size_t( 12 ),size_t( 16 ) ) );
+	// reads through a const buffer never mark
+	b.ClearDirty();
+	const auto& cb = b;
+	assert( static_cast<const float&>(cb["gloss"]) == 4.0f && !b.IsDirty() );
+	// copies start clean and CopyFrom marks only the bytes that differ (within weights[3] here)
+	auto c = b;
+	assert( !c.IsDirty() );
+	c["weights"][3] = 1.0f;
+	c.ClearDirty();
+	b.CopyFrom( c );
+	assert( b.IsDirty() && range().first >= 64u && range().second <= 68u );
+	b.ClearDirty();
+	b.CopyFrom( c );
+	assert( !b.IsDirty() );
+}
+
 void TestDynamicMeshLoading()
 {
 	using namespace Dvtx;
@@ -388,4 +1434,181 @@ void D3DTestScratchPad( Window& wnd )
 
 	RenderWithVS( "Test2_VS.cso" );
 	RenderWithVS( "Test1_VS.cso" );
-}
\ No newline at end of file
+}
+
+void TestConstantRing()
+{
+	ConstantRing ring{ 1024u,2u };
+	ring.BeginFrame( 0u );
+	// chunks are 256 byte aligned and packed into the first page
+	const auto a = ring.Allocate( 704u );
+	const auto b = ring.Allocate( 16u );
+	assert( a.page == 0u && a.offset == 0u && a.size == 768u );
+	assert( b.page == 0u && b.offset == 768u && b.size == 256u );
+	// a full page moves on to a new one while its frame is in flight
+	const auto c = ring.Allocate( 256u );
+	assert( c.page == 1u && c.offset == 0u );
+	ring.BeginFrame( 1u );
+	ring.Allocate( 1024u );
+	assert( ring.GetPageCount() == 3u );
+	ring.BeginFrame( 2u );
+	ring.Allocate( 1024u );
+	assert( ring.GetPageCount() == 4u );
+	// frame 0 is more than two frames behind, its page is reused in ring order
+	ring.BeginFrame( 3u );
+	const auto d = ring.Allocate( 512u );
+	assert( d.page == 0u && d.offset == 0u );
+	assert( ring.GetStats().recycles == 1u );
+	// page 1 was last used by frame 0 as well, the others are still in flight
+	ring.Allocate( 512u );
+	const auto e = ring.Allocate( 1024u );
+	assert( e.page == 1u );
+	const auto f = ring.Allocate( 256u );
+	assert( f.page == 4u );
+	assert( ring.GetStats().pages == 5u && ring.GetStats().allocations == 9u );
+}
+
+void TestTrace()
+{
+	namespace jso = nlohmann;
+	const std::string path = "trace_test.json";
+	const bool wasEnabled = Trace::IsEnabled();
+	// whatever was recorded before the test
+	Trace::Export( path );
+
+	Trace::SetEnabled( true );
+	constexpr size_t nThreads = 4u;
+	constexpr size_t nOuter = 100u;
+	std::vector<std::thread> threads;
+	for( size_t t = 0; t < nThreads; t++ )
+	{
+		threads.emplace_back( []()
+		{
+			for( size_t i = 0; i < nOuter; i++ )
+			{
+				TRACE_ZONE( "test outer" );
+				{
+					TRACE_ZONE( "test inner" );
+				}
+			}
+		} );
+	}
+	for( auto& t : threads )
+	{
+		t.join();
+	}
+	Trace::FrameMark();
+	// nothing is recorded while disabled
+	Trace::SetEnabled( false );
+	{
+		TRACE_ZONE( "test disabled" );
+	}
+	const auto exported = Trace::Export( path );
+	assert( exported == nThreads * nOuter * 2u + 1u );
+	{
+		std::ifstream file( path );
+		const auto trace = jso::json::parse( file );
+		std::map<unsigned int,std::vector<std::pair<double,double>>> outers;
+		std::map<unsigned int,std::vector<std::pair<double,double>>> inners;
+		size_t frames = 0u;
+		for( const auto& e : trace.at( "traceEvents" ) )
+		{
+			const auto ph = e.at( "ph" ).get<std::string>();
+			const auto name = e.at( "name" ).get<std::string>();
+			assert( name != "test disabled" );
+			if( ph == "X" )
+			{
+				const auto ts = e.at( "ts" ).get<double>();
+				auto& zones = name == "test outer" ? outers : inners;
+				zones[e.at( "tid" ).get<unsigned int>()].push_back( { ts,ts + e.at( "dur" ).get<double>() } );
+			}
+			else if( ph == "i" )
+			{
+				assert( name == "Frame" );
+				frames++;
+			}
+		}
+		assert( frames == 1u );
+		// one track per thread, every inner zone inside an outer one on the same track
+		assert( outers.size() == nThreads && inners.size() == nThreads );
+		for( const auto& [tid,zones] : inners )
+		{
+			const auto& parents = outers.at( tid );
+			assert( zones.size() == nOuter && parents.size() == nOuter );
+			for( size_t i = 0; i < nOuter; i++ )
+			{
+				assert( zones[i].first >= parents[i].first && zones[i].second <= parents[i].second );
+			}
+		}
+	}
+
+	// a full ring drops new events rather than overwriting ones not exported yet
+	Trace::SetEnabled( true );
+	const auto dropped = Trace::GetStats().dropped;
+	for( size_t i = 0; i < Trace::ringCapacity + 10u; i++ )
+	{
+		TRACE_ZONE( "test wrap" );
+	}
+	Trace::SetEnabled( false );
+	assert( Trace::GetStats().dropped - dropped == 10u );
+	const auto exportedFull = Trace::Export( path );
+	assert( exportedFull == Trace::ringCapacity );
+
+	Trace::SetEnabled( wasEnabled );
+	std::filesystem::remove( path );
+}
+
+void TestFrameStats()
+{
+	struct A {};
+	struct B {};
+	// slots stick to their type and are handed out in order of first sight
+	const auto a = FrameStats::GetBindType( typeid( A ) );
+	const auto b = FrameStats::GetBindType( typeid( B ) );
+	assert( a != b && FrameStats::GetBindType( typeid( A ) ) == a );
+	assert( FrameStats::GetBindTypeCount() > b && FrameStats::GetBindTypeName( b ) != nullptr );
+	// a pass's stats are the counters after it minus those before
+	FrameStats before;
+	before.draws = 4u;
+	before.bindsByType[a] = 2u;
+	FrameStats after = before;
+	after.draws += 3u;
+	after.indices += 36u;
+	after.bindsByType[a] += 5u;
+	after -= before;
+	assert( after.draws == 3u && after.GetTriangles() == 12u && after.bindsByType[a] == 5u );
+	before += after;
+	assert( before.draws == 7u && before.bindsByType[a] == 7u && before.bindsByType[b] == 0u );
+}
+
+void TestTexturePreprocessor()
+{
+	// odd width so rows end in a partial vector, tall enough to be split over several tiles
+	const unsigned int width = 67u;
+	const unsigned int height = 2000u;
+	Surface surf( width,height );
+	for( unsigned int y = 0; y < height; y++ )
+	{
+		for( unsigned int x = 0; x < width; x++ )
+		{
+			surf.PutPixel( x,y,{ 0x40u,(unsigned char)(x * 3u + y),(unsigned char)(y % 7u == 0u ? 0x20u : 0xF0u) } );
+		}
+	}
+	// the totals don't depend on how the rows were split
+	const auto one = TexturePreprocessor::ValidateNormalMap( surf,0.9f,1.1f,false,1u );
+	const auto many = TexturePreprocessor::ValidateNormalMap( surf,0.9f,1.1f,false,5u );
+	assert( one.texels == size_t( width ) * height );
+	assert( one.badLength == many.badLength && one.badZ == many.badZ && one.badZ > 0u );
+	assert( one.biasX == many.biasX && one.biasY == many.biasY );
+	// flip is green inverted, red and blue kept, alpha opaque, every texel including the tails
+	TexturePreprocessor::FlipYNormalMap( surf,3u );
+	for( unsigned int y = 0; y < height; y++ )
+	{
+		for( unsigned int x = 0; x < width; x++ )
+		{
+			const auto c = surf.GetPixel( x,y );
+			assert( c.GetR() == 0x40u && c.GetG() == (unsigned char)(255u - (unsigned char)(x * 3u + y)) );
+			assert( c.GetB() == (y % 7u == 0u ? 0x20u : 0xF0u) && c.GetA() == 255u );
+		}
+	}
+}
@@ -11,4 +11,42 @@ void TestScaleMatrixTranslation();
 
 void D3DTestScratchPad( class Window& wnd );
 
-void TestNumpy();
\ No newline at end of file
+void TestNumpy();
+
+void TestHiZOcclusion();
+
+void TestMeshSimplifier();
+
+void TestMeshClusters();
+
+void TestMeshOptimizer();
+
+void TestDenseGrid();
+
+void TestCookedModel();
+
+void TestCodexBudget();
+
+void TestStaticBatch();
+
+void TestTextureAtlasPlan();
+
+void TestMaterialTable();
+
+void TestDcbAccessors();
+
+void TestDcbDirtyRanges();
+
+void TestConstantRing();
+
+void TestTrace();
+
+void TestFrameStats();
+
+void TestTexturePreprocessor();
+
+void TestVertexQuantization();
+
+void TestVertexFormat();
+
+void TestVertexConverter();
\ No newline at end of file
@@ -9,52 +9,14 @@ namespace Bind
 
 	Texture::Texture(Graphics& gfx, const std::string& path, UINT slot, UINT shaderIndex)
 		:
-		path( path ),
 		slot( slot ),
-		shaderIndex(shaderIndex)
+		shaderIndex(shaderIndex),
+		pResource( TextureResource::Resolve( gfx,path ) ),
+		countsResource( pResource->ClaimSize() ),
+		path( path )
 	{
-		INFOMAN( gfx );
-
-		// load surface
-		const auto s = Surface::FromFile( path );
-		hasAlpha = s.AlphaLoaded();
-
-		// create texture resource
-		D3D11_TEXTURE2D_DESC textureDesc = {};
-		textureDesc.Width = s.GetWidth();
-		textureDesc.Height = s.GetHeight();
-		textureDesc.MipLevels
-			= 0;
-		textureDesc.ArraySize = 1;
-		textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-		textureDesc.SampleDesc.Count = 1;
-		textureDesc.SampleDesc.Quality = 0;
-		textureDesc.Usage = D3D11_USAGE_DEFAULT;
-		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-		textureDesc.CPUAccessFlags = 0;
-		textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
-		wrl::ComPtr<ID3D11Texture2D> pTexture;
-		GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D(
-			&textureDesc,nullptr,&pTexture
-		) );
-
-		// write image data into top mip level
-		GetContext( gfx )->UpdateSubresource(
-			pTexture.Get(),0u,nullptr,s.GetBufferPtrConst(),s.GetWidth() * sizeof( Surface::Color ),0u
-		);
-
-		// create the resource view on the texture
-		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Format = textureDesc.Format;
-		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = -1;
-		GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView(
-			pTexture.Get(),&srvDesc,&pTextureView
-		) );
-
-		// generate the mip chain using the gpu rendering pipeline
-		GetContext( gfx )->GenerateMips( pTextureView.Get() );
+		// the image itself is shared with every other slot / stage binding the same file
+		// and may still be streaming in, so its view is looked up on every bind
 	}
 
 	Texture::Texture(Graphics& gfx, const Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pTextureViewIn, UINT slot)
@@ -68,21 +30,22 @@ namespace Bind
 	{
 		INFOMAN_NOHR( gfx );
 		assert(shaderIndex & 0b00001111);
+		ID3D11ShaderResourceView* const pView = pResource ? pResource->GetView() : pTextureView.Get();
 		if (shaderIndex & 0b00001000)
 		{
-			GFX_THROW_INFO_ONLY(GetContext(gfx)->VSSetShaderResources(slot, 1, pTextureView.GetAddressOf()));
+			GFX_THROW_INFO_ONLY(GetContext(gfx)->VSSetShaderResources(slot, 1, &pView));
 		}
 		if (shaderIndex & 0b00000100)
 		{
-			GFX_THROW_INFO_ONLY(GetContext(gfx)->HSSetShaderResources(slot, 1, pTextureView.GetAddressOf()));
+			GFX_THROW_INFO_ONLY(GetContext(gfx)->HSSetShaderResources(slot, 1, &pView));
 		}
 		if (shaderIndex & 0b00000010)
 		{
-			GFX_THROW_INFO_ONLY(GetContext(gfx)->DSSetShaderResources(slot, 1, pTextureView.GetAddressOf()));
+			GFX_THROW_INFO_ONLY(GetContext(gfx)->DSSetShaderResources(slot, 1, &pView));
 		}
 		if (shaderIndex & 0b00000001)
 		{
-			GFX_THROW_INFO_ONLY(GetContext(gfx)->PSSetShaderResources(slot, 1, pTextureView.GetAddressOf()));
+			GFX_THROW_INFO_ONLY(GetContext(gfx)->PSSetShaderResources(slot, 1, &pView));
 		}
 	}
 	std::shared_ptr<Texture> Texture::Resolve(Graphics& gfx, const std::string& path, UINT slot, UINT shaderIndex)
@@ -94,13 +57,21 @@ namespace Bind
 		using namespace std::string_literals;
 		return typeid(Texture).name() + "#"s + path + "#" + std::to_string(slot) + std::to_string(shaderIndex);
 	}
+	std::uint64_t Texture::GenerateKey(const std::string& path, UINT slot, UINT shaderIndex) noexcept
+	{
+		return Codex::Hasher{ Codex::TypeKey<Texture>() }.Add( path ).Add( slot ).Add( shaderIndex ).Get();
+	}
 	std::string Texture::GetUID() const noexcept
 	{
 		return GenerateUID(path, slot, shaderIndex);
 	}
+	size_t Texture::GetSizeBytes() const noexcept
+	{
+		return countsResource ? pResource->GetSizeBytes() : 0u;
+	}
 	bool Texture::HasAlpha() const noexcept
 	{
-		return hasAlpha;
+		return pResource ? pResource->HasAlpha() : hasAlpha;
 	}
 	UINT Texture::CalculateNumberOfMipLevels( UINT width,UINT height ) noexcept
 	{
@@ -1,5 +1,6 @@
 #pragma once
 #include "Bindable.h"
+#include "TextureResource.h"
 
 class Surface;
 
@@ -13,13 +14,19 @@ namespace Bind
 		void Bind( Graphics& gfx ) noxnd override;
 		static std::shared_ptr<Texture> Resolve(Graphics& gfx, const std::string& path, UINT slot = 0, UINT shaderIndex = 0b1u);
 		static std::string GenerateUID(const std::string& path, UINT slot, UINT shaderIndex);
+		static std::uint64_t GenerateKey(const std::string& path, UINT slot, UINT shaderIndex) noexcept;
 		std::string GetUID() const noexcept override;
+		// the shared image is counted by the first slot binding that resolved it, the others own nothing
+		size_t GetSizeBytes() const noexcept override;
 		bool HasAlpha() const noexcept;
 	private:
 		static UINT CalculateNumberOfMipLevels( UINT width,UINT height ) noexcept;
 	private:
 		unsigned int slot;
 		UINT shaderIndex;
+		// null for views handed in directly
+		std::shared_ptr<TextureResource> pResource;
+		bool countsResource = false;
 	protected:
 		bool hasAlpha = false;
 		std::string path;
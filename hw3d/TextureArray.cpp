@@ -0,0 +1,90 @@
+#include "TextureArray.h"
+#include "Surface.h"
+#include "GraphicsThrowMacros.h"
+
+namespace Bind
+{
+	namespace wrl = Microsoft::WRL;
+
+	TextureArray::TextureArray( Graphics& gfx,UINT width,UINT height,UINT sliceCount,const std::vector<Placement>& placements,UINT slot )
+		:
+		slot( slot ),
+		sliceCount( sliceCount ),
+		sizeBytes( size_t( width ) * height * sliceCount * sizeof( Surface::Color ) * 4u / 3u )
+	{
+		INFOMAN( gfx );
+
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = width;
+		textureDesc.Height = height;
+		textureDesc.MipLevels = 0;
+		textureDesc.ArraySize = sliceCount;
+		textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		wrl::ComPtr<ID3D11Texture2D> pTexture;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D( &textureDesc,nullptr,&pTexture ) );
+		pTexture->GetDesc( &textureDesc );
+
+		// slices holding packed images are cleared first so the gaps between them filter to black, not garbage
+		std::vector<bool> packed( sliceCount,false );
+		for( const auto& p : placements )
+		{
+			if( p.pSurface->GetWidth() != width || p.pSurface->GetHeight() != height )
+			{
+				packed[p.slice] = true;
+			}
+		}
+		const std::vector<Surface::Color> black( size_t( width ) * height,Surface::Color{ 0u } );
+		for( UINT i = 0; i < sliceCount; i++ )
+		{
+			if( packed[i] )
+			{
+				GetContext( gfx )->UpdateSubresource(
+					pTexture.Get(),D3D11CalcSubresource( 0u,i,textureDesc.MipLevels ),nullptr,
+					black.data(),width * sizeof( Surface::Color ),0u
+				);
+			}
+		}
+		for( const auto& p : placements )
+		{
+			const auto& s = *p.pSurface;
+			const D3D11_BOX box = { p.x,p.y,0u,p.x + s.GetWidth(),p.y + s.GetHeight(),1u };
+			GetContext( gfx )->UpdateSubresource(
+				pTexture.Get(),D3D11CalcSubresource( 0u,p.slice,textureDesc.MipLevels ),&box,
+				s.GetBufferPtrConst(),s.GetWidth() * sizeof( Surface::Color ),0u
+			);
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = textureDesc.Format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MostDetailedMip = 0;
+		srvDesc.Texture2DArray.MipLevels = -1;
+		srvDesc.Texture2DArray.FirstArraySlice = 0;
+		srvDesc.Texture2DArray.ArraySize = sliceCount;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView( pTexture.Get(),&srvDesc,&pTextureView ) );
+
+		GetContext( gfx )->GenerateMips( pTextureView.Get() );
+	}
+
+	void TextureArray::Bind( Graphics& gfx ) noxnd
+	{
+		INFOMAN_NOHR( gfx );
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->PSSetShaderResources( slot,1u,pTextureView.GetAddressOf() ) );
+	}
+
+	size_t TextureArray::GetSizeBytes() const noexcept
+	{
+		return sizeBytes;
+	}
+
+	UINT TextureArray::GetSliceCount() const noexcept
+	{
+		return sliceCount;
+	}
+}
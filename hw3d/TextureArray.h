@@ -0,0 +1,33 @@
+#pragma once
+#include "Bindable.h"
+#include <vector>
+
+class Surface;
+
+namespace Bind
+{
+	// several images of one size and format in a single Texture2DArray (with a generated mip chain),
+	// bound to one pixel shader slot; shaders pick the image by slice index (see TextureAtlas)
+	class TextureArray : public Bindable
+	{
+	public:
+		struct Placement
+		{
+			const Surface* pSurface;
+			UINT slice;
+			// top left corner in texels, images smaller than a slice are packed several to one
+			UINT x;
+			UINT y;
+		};
+	public:
+		TextureArray( Graphics& gfx,UINT width,UINT height,UINT sliceCount,const std::vector<Placement>& placements,UINT slot );
+		void Bind( Graphics& gfx ) noxnd override;
+		size_t GetSizeBytes() const noexcept override;
+		UINT GetSliceCount() const noexcept;
+	private:
+		UINT slot;
+		UINT sliceCount;
+		size_t sizeBytes;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pTextureView;
+	};
+}
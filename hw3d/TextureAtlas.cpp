@@ -0,0 +1,148 @@
+#include "TextureAtlas.h"
+#include "TextureArray.h"
+#include "Surface.h"
+#include <map>
+#include <algorithm>
+#include <sstream>
+#define STB_RECT_PACK_IMPLEMENTATION
+#define STBRP_STATIC
+#include "imgui/imstb_rectpack.h"
+
+TextureAtlas::TextureAtlas( Graphics& gfx,const std::array<std::vector<Image>,slotCount>& images,unsigned int padding )
+{
+	for( unsigned int slot = 0; slot < slotCount; slot++ )
+	{
+		const auto& slotImages = images[slot];
+		stats.textures += slotImages.size();
+		std::vector<std::pair<unsigned int,unsigned int>> sizes;
+		for( const auto& image : slotImages )
+		{
+			sizes.emplace_back( image.pSurface->GetWidth(),image.pSurface->GetHeight() );
+		}
+		const auto plan = MakePlan( sizes,padding );
+		if( plan.sliceCount == 0u )
+		{
+			continue;
+		}
+		std::vector<Bind::TextureArray::Placement> placements;
+		for( const auto& place : plan.places )
+		{
+			placements.push_back( { slotImages[place.image].pSurface,place.slice,place.x,place.y } );
+		}
+		const auto pArray = std::make_shared<Bind::TextureArray>( gfx,plan.width,plan.height,plan.sliceCount,placements,slot );
+		for( const auto& place : plan.places )
+		{
+			const auto& image = slotImages[place.image];
+			const auto w = float( plan.width );
+			const auto h = float( plan.height );
+			entries[slot][image.path] = {
+				pArray,float( place.slice ),
+				{ place.x / w,place.y / h,image.pSurface->GetWidth() / w,image.pSurface->GetHeight() / h },
+				image.pSurface->AlphaLoaded()
+			};
+			if( sizes[place.image] != std::make_pair( plan.width,plan.height ) )
+			{
+				stats.packed++;
+			}
+		}
+		stats.atlased += plan.places.size();
+		stats.arrays++;
+		stats.slices += plan.sliceCount;
+	}
+}
+
+TextureAtlas::Plan TextureAtlas::MakePlan( const std::vector<std::pair<unsigned int,unsigned int>>& sizes,unsigned int padding )
+{
+	// slice size: the most common image size, the larger one on ties
+	std::map<std::pair<unsigned int,unsigned int>,size_t> histogram;
+	for( const auto& s : sizes )
+	{
+		histogram[s]++;
+	}
+	if( histogram.empty() )
+	{
+		return {};
+	}
+	const auto common = std::max_element( histogram.begin(),histogram.end(),[]( const auto& a,const auto& b )
+	{
+		if( a.second != b.second )
+		{
+			return a.second < b.second;
+		}
+		return size_t( a.first.first ) * a.first.second < size_t( b.first.first ) * b.first.second;
+	} )->first;
+
+	Plan plan;
+	plan.width = common.first;
+	plan.height = common.second;
+	std::vector<stbrp_rect> remaining;
+	for( size_t i = 0; i < sizes.size(); i++ )
+	{
+		const auto [w,h] = sizes[i];
+		if( sizes[i] == common )
+		{
+			plan.places.push_back( { i,plan.sliceCount++,0u,0u } );
+		}
+		else if( w + 2 * padding <= plan.width && h + 2 * padding <= plan.height )
+		{
+			stbrp_rect r = {};
+			r.id = int( i );
+			r.w = stbrp_coord( w + 2 * padding );
+			r.h = stbrp_coord( h + 2 * padding );
+			remaining.push_back( r );
+		}
+	}
+	// smaller images fill further slices, one pack per slice until nothing fits any more
+	std::vector<stbrp_node> nodes( plan.width );
+	while( !remaining.empty() )
+	{
+		stbrp_context context;
+		stbrp_init_target( &context,int( plan.width ),int( plan.height ),nodes.data(),int( nodes.size() ) );
+		stbrp_pack_rects( &context,remaining.data(),int( remaining.size() ) );
+		std::vector<stbrp_rect> left;
+		bool any = false;
+		for( const auto& r : remaining )
+		{
+			if( r.was_packed )
+			{
+				plan.places.push_back( { size_t( r.id ),plan.sliceCount,r.x + padding,r.y + padding } );
+				any = true;
+			}
+			else
+			{
+				left.push_back( r );
+			}
+		}
+		if( !any )
+		{
+			break;
+		}
+		plan.sliceCount++;
+		remaining = std::move( left );
+	}
+	if( plan.places.size() < 2 )
+	{
+		return {};
+	}
+	return plan;
+}
+
+const TextureAtlas::Entry* TextureAtlas::Find( unsigned int slot,const std::string& path ) const noexcept
+{
+	const auto i = entries[slot].find( path );
+	return i != entries[slot].end() ? &i->second : nullptr;
+}
+
+const TextureAtlas::Stats& TextureAtlas::GetStats() const noexcept
+{
+	return stats;
+}
+
+std::string TextureAtlas::GetReport() const
+{
+	std::ostringstream oss;
+	oss << "Texture arrays: " << stats.atlased << " of " << stats.textures << " textures in " << stats.arrays << " arrays ("
+		<< stats.slices << " slices, " << stats.packed << " rect packed), distinct shader resources "
+		<< stats.textures << " -> " << stats.textures - stats.atlased + stats.arrays << "\n";
+	return oss.str();
+}
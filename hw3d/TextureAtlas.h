@@ -0,0 +1,79 @@
+#pragma once
+#include "Graphics.h"
+#include <DirectXMath.h>
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+class Surface;
+
+namespace Bind
+{
+	class TextureArray;
+}
+
+// the material textures of a model packed at load into one Texture2DArray per slot (albedo, mra / specular,
+// normal), see ModelOptions::textureArrays; materials bind the shared arrays and pass slice and uv rect in
+// their constant buffer, so consecutive draws no longer change shader resources
+// slices take the most common image size of the slot; smaller images are rect packed several to a slice,
+// larger ones are left out (their materials keep separate textures)
+class TextureAtlas
+{
+public:
+	static constexpr unsigned int slotCount = 3u;
+	struct Entry
+	{
+		std::shared_ptr<Bind::TextureArray> pArray;
+		float slice;
+		// uv offset (xy) and scale (zw) of the image within its slice
+		DirectX::XMFLOAT4 rect;
+		bool hasAlpha;
+	};
+	struct Image
+	{
+		std::string path;
+		const Surface* pSurface;
+	};
+	// where every image goes, without touching the gpu
+	struct Plan
+	{
+		struct Place
+		{
+			// into the sizes planned for
+			size_t image;
+			unsigned int slice;
+			// of the image itself, padding already skipped
+			unsigned int x;
+			unsigned int y;
+		};
+		unsigned int width = 0u;
+		unsigned int height = 0u;
+		unsigned int sliceCount = 0u;
+		std::vector<Place> places;
+	};
+	struct Stats
+	{
+		// distinct files per slot, summed
+		size_t textures = 0;
+		size_t atlased = 0;
+		// of those, sharing a slice with others
+		size_t packed = 0;
+		size_t arrays = 0;
+		size_t slices = 0;
+	};
+public:
+	// images[slot] are the distinct files bound at that slot
+	TextureAtlas( Graphics& gfx,const std::array<std::vector<Image>,slotCount>& images,unsigned int padding = 8u );
+	// null when the image did not make it into an array
+	const Entry* Find( unsigned int slot,const std::string& path ) const noexcept;
+	const Stats& GetStats() const noexcept;
+	// one line summary for logs, with shader resource changes between materials before and after
+	std::string GetReport() const;
+	// empty (no slices) when fewer than two images would share the array
+	static Plan MakePlan( const std::vector<std::pair<unsigned int,unsigned int>>& sizes,unsigned int padding );
+private:
+	std::array<std::unordered_map<std::string,Entry>,slotCount> entries;
+	Stats stats;
+};
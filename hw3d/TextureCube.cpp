@@ -5,6 +5,7 @@
 #include <vector>
 #include "DepthStencil.h"
 #include "RenderTarget.h"
+#include "AssetStreamer.h"
 
 namespace Bind
 {
@@ -16,113 +17,94 @@ namespace Bind
 		slot( slot ),
 		manuallyGenerateMips(manuallyGenerateMips)
 	{
-		INFOMAN( gfx );
-
-		if (!manuallyGenerateMips)
+		if( AssetStreamer::IsActive() )
 		{
-			// load 6 surfaces for cube faces
-			std::vector<Surface> surfaces;
-			for( int i = 0; i < 6; i++ )
-			{
-				surfaces.push_back(Surface::FromFile(path + "#" + std::to_string(i) + ".jpg"));
-			}
-
-			// texture descriptor
-			D3D11_TEXTURE2D_DESC textureDesc = {};
-			textureDesc.Width = surfaces[0].GetWidth();
-			textureDesc.Height = surfaces[0].GetHeight();
-			textureDesc.MipLevels = 1;
-			textureDesc.ArraySize = 6;
-			textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-			textureDesc.SampleDesc.Count = 1;
-			textureDesc.SampleDesc.Quality = 0;
-			textureDesc.Usage = D3D11_USAGE_DEFAULT;
-			textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-			textureDesc.CPUAccessFlags = 0;
-			textureDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
-			// subresource data
-			D3D11_SUBRESOURCE_DATA data[6];
-			for( int i = 0; i < 6; i++ )
+			// the slot stays unbound (samples as zero) until the faces have been decoded
+			pStreamed = std::make_shared<wrl::ComPtr<ID3D11ShaderResourceView>>();
+			AssetStreamer::Enqueue( [path,manuallyGenerateMips,pStreamed = pStreamed]() -> AssetStreamer::Finalizer
 			{
-				data[i].pSysMem = surfaces[i].GetBufferPtrConst();
-				data[i].SysMemPitch = surfaces[i].GetBytePitch();
-				data[i].SysMemSlicePitch = 0;
-			}
-			// create the texture resource
-			wrl::ComPtr<ID3D11Texture2D> pTexture;
-			GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D(
-				&textureDesc,data,&pTexture
-			) );
-
-			// create the resource view on the texture
-			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-			srvDesc.Format = textureDesc.Format;
-			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
-			srvDesc.Texture2D.MostDetailedMip = 0;
-			srvDesc.Texture2D.MipLevels = 1;
-			GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView(
-				pTexture.Get(),&srvDesc,&pTextureView
-			) );
+				auto pSurfaces = std::make_shared<std::vector<Surface>>( LoadFaces( path,manuallyGenerateMips ) );
+				return [pSurfaces,manuallyGenerateMips,pStreamed]( Graphics& gfx )
+				{
+					*pStreamed = CreateView( gfx,*pSurfaces,manuallyGenerateMips );
+				};
+			} );
 		}
 		else
 		{
-			// load 6 surfaces for cube faces
-			std::vector<Surface> surfaces;
+			pTextureView = CreateView( gfx,LoadFaces( path,manuallyGenerateMips ),manuallyGenerateMips );
+		}
+	}
 
-			for (unsigned int i = 0; i < 6; i++)
+	std::vector<Surface> TextureCube::LoadFaces( const std::string& path,bool manuallyGenerateMips )
+	{
+		// 6 faces, each with its 5 mip levels as separate files when mips are provided
+		std::vector<Surface> surfaces;
+		for( unsigned int i = 0; i < 6; i++ )
+		{
+			if( !manuallyGenerateMips )
 			{
-				for (unsigned int j = 0; j < 5; j++)
-				{
-				surfaces.push_back(Surface::FromFile(path + "#" + std::to_string(i) + "#" + std::to_string(j) + ".jpg"));
-				}
+				surfaces.push_back( Surface::FromFile( path + "#" + std::to_string( i ) + ".jpg" ) );
+				continue;
 			}
-
-			// texture descriptor
-			D3D11_TEXTURE2D_DESC textureDesc = {};
-			textureDesc.Width = surfaces[0].GetWidth();
-			textureDesc.Height = surfaces[0].GetHeight();
-			textureDesc.MipLevels = 5;
-			textureDesc.ArraySize = 6;
-			textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-			textureDesc.SampleDesc.Count = 1;
-			textureDesc.SampleDesc.Quality = 0;
-			textureDesc.Usage = D3D11_USAGE_DEFAULT;
-			textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-			textureDesc.CPUAccessFlags = 0;
-			textureDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;;
-			// subresource data
-			D3D11_SUBRESOURCE_DATA data[30];
-			for (int i = 0; i < 6; i++)
+			for( unsigned int j = 0; j < 5; j++ )
 			{
-				for (unsigned int j = 0; j < 5; j++)
-				{
-					data[j + i * 5].pSysMem = surfaces[j + i * 5].GetBufferPtrConst();
-					data[j + i * 5].SysMemPitch = surfaces[j + i * 5].GetBytePitch();
-					data[j + i * 5].SysMemSlicePitch = 0;
-				}
+				surfaces.push_back( Surface::FromFile( path + "#" + std::to_string( i ) + "#" + std::to_string( j ) + ".jpg" ) );
 			}
-			// create the texture resource
-			wrl::ComPtr<ID3D11Texture2D> pTexture;
-			GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D(
-				&textureDesc,data,&pTexture
-			) );
-
-			// create the resource view on the texture
-			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-			srvDesc.Format = textureDesc.Format;
-			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
-			srvDesc.Texture2D.MostDetailedMip = 0;
-			srvDesc.Texture2D.MipLevels = 5;
-			GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView(
-				pTexture.Get(),&srvDesc,&pTextureView
-			) );
-		}		
+		}
+		return surfaces;
+	}
+
+	wrl::ComPtr<ID3D11ShaderResourceView> TextureCube::CreateView( Graphics& gfx,const std::vector<Surface>& surfaces,bool manuallyGenerateMips )
+	{
+		INFOMAN( gfx );
+
+		const UINT levels = manuallyGenerateMips ? 5 : 1;
+		// texture descriptor
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = surfaces[0].GetWidth();
+		textureDesc.Height = surfaces[0].GetHeight();
+		textureDesc.MipLevels = levels;
+		textureDesc.ArraySize = 6;
+		textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+		// subresource data, face-major like the surfaces
+		D3D11_SUBRESOURCE_DATA data[30];
+		for( size_t i = 0; i < surfaces.size(); i++ )
+		{
+			data[i].pSysMem = surfaces[i].GetBufferPtrConst();
+			data[i].SysMemPitch = surfaces[i].GetBytePitch();
+			data[i].SysMemSlicePitch = 0;
+		}
+		// create the texture resource
+		wrl::ComPtr<ID3D11Texture2D> pTexture;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D(
+			&textureDesc,data,&pTexture
+		) );
+
+		// create the resource view on the texture
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = textureDesc.Format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.Texture2D.MipLevels = levels;
+		wrl::ComPtr<ID3D11ShaderResourceView> pView;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView(
+			pTexture.Get(),&srvDesc,&pView
+		) );
+		return pView;
 	}
 
 	void TextureCube::Bind( Graphics& gfx ) noxnd
 	{
 		INFOMAN_NOHR( gfx );
-		GFX_THROW_INFO_ONLY( GetContext( gfx )->PSSetShaderResources( slot,1u,pTextureView.GetAddressOf() ) );
+		ID3D11ShaderResourceView* const pView = pStreamed ? pStreamed->Get() : pTextureView.Get();
+		GFX_THROW_INFO_ONLY( GetContext( gfx )->PSSetShaderResources( slot,1u,&pView ) );
 	}
 
 	std::shared_ptr<TextureCube> TextureCube::Resolve(Graphics& gfx, const std::string& path, UINT slot, bool manuallyGenerateMips)
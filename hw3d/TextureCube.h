@@ -16,8 +16,13 @@ namespace Bind
 		static std::shared_ptr<TextureCube> Resolve(Graphics& gfx, const std::string& path, UINT slot = 0, bool manuallyGenerateMips = false);
 		static std::string GenerateUID(const std::string& path, UINT slot, bool manuallyGenerateMips);
 		std::string GetUID() const noexcept override;
+	private:
+		static std::vector<Surface> LoadFaces( const std::string& path,bool manuallyGenerateMips );
+		static Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateView( Graphics& gfx,const std::vector<Surface>& surfaces,bool manuallyGenerateMips );
 	private:
 		unsigned int slot;
+		// filled in by the streaming worker's finalizer, see AssetStreamer
+		std::shared_ptr<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> pStreamed;
 	protected:
 		std::string path;
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pTextureView;
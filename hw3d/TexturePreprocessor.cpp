@@ -4,31 +4,184 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <objbase.h>
 #include "ChiliMath.h"
+#include "ChiliUtil.h"
+#include "ChiliTimer.h"
 #include "ModelException.h"
+#include "ParallelFor.h"
 
-
-template<typename F>
-inline void TexturePreprocessor::TransformSurface( Surface& surf,F&& func )
+namespace
 {
-	const auto width = surf.GetWidth();
-	const auto height = surf.GetHeight();
-	for( unsigned int y = 0; y < height; y++ )
+	static_assert( sizeof( Surface::Color ) == sizeof( uint32_t ),"Row kernels load texels as dwords" );
+
+	// bands of whole rows, about this many texels each
+	constexpr unsigned int tileTexels = 1u << 16;
+
+	struct RowTiles
+	{
+		unsigned int rows;
+		unsigned int count;
+	};
+
+	RowTiles MakeRowTiles( const Surface& surf ) noexcept
+	{
+		const auto rows = std::max( tileTexels / std::max( surf.GetWidth(),1u ),1u );
+		return { rows,(surf.GetHeight() + rows - 1u) / rows };
+	}
+
+	// calls func( tile,firstRow,endRow ) for every tile, taken in turn by up to threads threads
+	template<typename F>
+	void ForEachRowTile( const Surface& surf,const RowTiles& tiles,unsigned int threads,F&& func )
+	{
+		ParallelFor( tiles.count,threads,[&]( size_t tile )
+		{
+			const auto t = (unsigned int)tile;
+			const auto first = t * tiles.rows;
+			func( t,first,std::min( first + tiles.rows,surf.GetHeight() ) );
+		} );
+	}
+
+	// wic decoding needs com on every thread that uses it
+	class ComScope
+	{
+	public:
+		ComScope() noexcept
+			:
+			initialized( SUCCEEDED( CoInitializeEx( nullptr,COINIT_MULTITHREADED ) ) )
+		{}
+		ComScope( const ComScope& ) = delete;
+		ComScope& operator=( const ComScope& ) = delete;
+		~ComScope()
+		{
+			if( initialized )
+			{
+				CoUninitialize();
+			}
+		}
+	private:
+		bool initialized;
+	};
+
+	// g -> 255 - g, which is what decoding, negating y and encoding again comes to, and opaque alpha
+	void FlipYRow( std::span<Surface::Color> row ) noexcept
 	{
-		for( unsigned int x = 0; x < width; x++ )
+		using namespace DirectX;
+		const auto pTexels = reinterpret_cast<uint32_t*>(row.data());
+		const auto greenMask = XMVectorReplicateInt( 0x0000FF00u );
+		const auto alphaMask = XMVectorReplicateInt( 0xFF000000u );
+		size_t x = 0;
+		for( ; x + 4u <= row.size(); x += 4u )
 		{
-			const auto n = ColorToVector( surf.GetPixel( x,y ) );
-			surf.PutPixel( x,y,VectorToColor( func( n,x,y ) ) );
+			XMStoreInt4( pTexels + x,XMVectorOrInt( XMVectorXorInt( XMLoadInt4( pTexels + x ),greenMask ),alphaMask ) );
+		}
+		for( ; x < row.size(); x++ )
+		{
+			pTexels[x] = (pTexels[x] ^ 0x0000FF00u) | 0xFF000000u;
 		}
 	}
-}
 
-template<typename F>
-inline void TexturePreprocessor::TransformFile( const std::string& pathIn,const std::string& pathOut,F&& func )
-{
-	auto surf = Surface::FromFile( pathIn );
-	TransformSurface( surf,func );
-	surf.Save( pathOut );
+	struct NormalCheck
+	{
+		// squared, compared against squared lengths so the kernel needs no square roots
+		float minLengthSq;
+		float maxLengthSq;
+		bool logTexels;
+	};
+
+	struct NormalTotals
+	{
+		// raw channel values, exact
+		uint64_t sumR = 0u;
+		uint64_t sumG = 0u;
+		size_t badLength = 0u;
+		size_t badZ = 0u;
+		std::string log;
+	};
+
+	void CheckNormal( Surface::Color c,unsigned int x,unsigned int y,const NormalCheck& check,NormalTotals& totals )
+	{
+		const float nx = float( c.GetR() ) * (2.0f / 255.0f) - 1.0f;
+		const float ny = float( c.GetG() ) * (2.0f / 255.0f) - 1.0f;
+		const float nz = float( c.GetB() ) * (2.0f / 255.0f) - 1.0f;
+		const float lenSq = nx * nx + ny * ny + nz * nz;
+		const bool badLength = lenSq < check.minLengthSq || lenSq > check.maxLengthSq;
+		const bool badZ = nz < 0.0f;
+		totals.badLength += badLength ? 1u : 0u;
+		totals.badZ += badZ ? 1u : 0u;
+		if( check.logTexels && (badLength || badZ) )
+		{
+			std::ostringstream oss;
+			if( badLength )
+			{
+				oss << "Bad normal length: " << std::sqrt( lenSq ) << " at: (" << x << "," << y << ") normal: (" << nx << "," << ny << "," << nz << ")\n";
+			}
+			if( badZ )
+			{
+				oss << "Bad normal Z direction at: (" << x << "," << y << ") normal: (" << nx << "," << ny << "," << nz << ")\n";
+			}
+			totals.log += oss.str();
+		}
+	}
+
+	// 4 texels at a time split into channel vectors; only groups with a bad texel go through CheckNormal
+	void CheckNormalRow( std::span<const Surface::Color> row,unsigned int y,const NormalCheck& check,NormalTotals& totals )
+	{
+		using namespace DirectX;
+		const auto pTexels = reinterpret_cast<const uint32_t*>(row.data());
+		const auto redMask = XMVectorReplicateInt( 0x00FF0000u );
+		const auto greenMask = XMVectorReplicateInt( 0x0000FF00u );
+		const auto blueMask = XMVectorReplicateInt( 0x000000FFu );
+		const auto decodeScale = XMVectorReplicate( 2.0f / 255.0f );
+		const auto minLengthSq = XMVectorReplicate( check.minLengthSq );
+		const auto maxLengthSq = XMVectorReplicate( check.maxLengthSq );
+		// lanes stay below 2^24 for rows up to 64k texels, so the float sums are exact
+		auto sumR = XMVectorZero();
+		auto sumG = XMVectorZero();
+		size_t x = 0;
+		for( ; x + 4u <= row.size(); x += 4u )
+		{
+			const auto texels = XMLoadInt4( pTexels + x );
+			// the divide exponent shifts each channel down to 0..255
+			const auto r = XMConvertVectorUIntToFloat( XMVectorAndInt( texels,redMask ),16u );
+			const auto g = XMConvertVectorUIntToFloat( XMVectorAndInt( texels,greenMask ),8u );
+			const auto b = XMConvertVectorUIntToFloat( XMVectorAndInt( texels,blueMask ),0u );
+			sumR = XMVectorAdd( sumR,r );
+			sumG = XMVectorAdd( sumG,g );
+			const auto nx = XMVectorMultiplyAdd( r,decodeScale,g_XMNegativeOne );
+			const auto ny = XMVectorMultiplyAdd( g,decodeScale,g_XMNegativeOne );
+			const auto nz = XMVectorMultiplyAdd( b,decodeScale,g_XMNegativeOne );
+			const auto lenSq = XMVectorMultiplyAdd( nz,nz,XMVectorMultiplyAdd( ny,ny,XMVectorMultiply( nx,nx ) ) );
+			const auto bad = XMVectorOrInt(
+				XMVectorOrInt( XMVectorLess( lenSq,minLengthSq ),XMVectorGreater( lenSq,maxLengthSq ) ),
+				XMVectorLess( nz,XMVectorZero() )
+			);
+			if( XMVector4NotEqualInt( bad,XMVectorZero() ) )
+			{
+				for( size_t i = x; i < x + 4u; i++ )
+				{
+					CheckNormal( row[i],(unsigned int)i,y,check,totals );
+				}
+			}
+		}
+		XMFLOAT4 sums;
+		XMStoreFloat4( &sums,sumR );
+		totals.sumR += uint64_t( sums.x ) + uint64_t( sums.y ) + uint64_t( sums.z ) + uint64_t( sums.w );
+		XMStoreFloat4( &sums,sumG );
+		totals.sumG += uint64_t( sums.x ) + uint64_t( sums.y ) + uint64_t( sums.z ) + uint64_t( sums.w );
+		for( ; x < row.size(); x++ )
+		{
+			totals.sumR += row[x].GetR();
+			totals.sumG += row[x].GetG();
+			CheckNormal( row[x],(unsigned int)x,y,check,totals );
+		}
+	}
 }
 
 void TexturePreprocessor::FlipYAllNormalMapsInObj( const std::string & objPath )
@@ -58,57 +211,273 @@ void TexturePreprocessor::FlipYAllNormalMapsInObj( const std::string & objPath )
 
 void TexturePreprocessor::FlipYNormalMap( const std::string& pathIn,const std::string& pathOut )
 {
-	// function for processing each normal in texture
-	using namespace DirectX;
-	const auto flipY = XMVectorSet( 1.0f,-1.0f,1.0f,1.0f );
-	const auto ProcessNormal = [flipY]( FXMVECTOR n,int x,int y ) -> XMVECTOR
+	auto surf = Surface::FromFile( pathIn );
+	FlipYNormalMap( surf );
+	surf.Save( pathOut );
+}
+
+void TexturePreprocessor::FlipYNormalMap( Surface& surf,unsigned int threads )
+{
+	ForEachRowTile( surf,MakeRowTiles( surf ),threads,[&surf]( unsigned int,unsigned int first,unsigned int end )
 	{
-		return XMVectorMultiply( n,flipY );
+		for( unsigned int y = first; y < end; y++ )
+		{
+			FlipYRow( surf.GetRow( y ) );
+		}
+	} );
+}
+
+TexturePreprocessor::NormalMapReport TexturePreprocessor::ValidateNormalMap( const Surface& surf,float thresholdMin,float thresholdMax,
+	bool logTexels,unsigned int threads )
+{
+	const auto tiles = MakeRowTiles( surf );
+	const NormalCheck check = {
+		std::max( thresholdMin,0.0f ) * std::max( thresholdMin,0.0f ),
+		thresholdMax * thresholdMax,
+		logTexels
 	};
-	// execute processing over every texel in file
-	TransformFile( pathIn,pathOut,ProcessNormal );
+	// one set of totals per tile, combined in tile order afterwards so nothing is shared between threads
+	std::vector<NormalTotals> tileTotals( tiles.count );
+	ForEachRowTile( surf,tiles,threads,[&]( unsigned int tile,unsigned int first,unsigned int end )
+	{
+		for( unsigned int y = first; y < end; y++ )
+		{
+			CheckNormalRow( surf.GetRow( y ),y,check,tileTotals[tile] );
+		}
+	} );
+	NormalMapReport report;
+	report.texels = size_t( surf.GetWidth() ) * surf.GetHeight();
+	uint64_t sumR = 0u;
+	uint64_t sumG = 0u;
+	for( const auto& t : tileTotals )
+	{
+		sumR += t.sumR;
+		sumG += t.sumG;
+		report.badLength += t.badLength;
+		report.badZ += t.badZ;
+		if( !t.log.empty() )
+		{
+			OutputDebugStringA( t.log.c_str() );
+		}
+	}
+	// sum of (2c / 255 - 1) over every texel
+	report.biasX = (2.0 * double( sumR ) - 255.0 * double( report.texels )) / 255.0;
+	report.biasY = (2.0 * double( sumG ) - 255.0 * double( report.texels )) / 255.0;
+	return report;
 }
 
 void TexturePreprocessor::ValidateNormalMap( const std::string& pathIn,float thresholdMin,float thresholdMax )
 {
 	OutputDebugStringA( ("Validating normal map [" + pathIn + "]\n").c_str() );
-	// function for processing each normal in texture
+	const auto report = ValidateNormalMap( Surface::FromFile( pathIn ),thresholdMin,thresholdMax,true );
+	std::ostringstream oss;
+	oss << "Normal map biases: (" << report.biasX << "," << report.biasY << ")\n"
+		<< report.badLength << " bad lengths, " << report.badZ << " bad z directions in " << report.texels << " texels\n";
+	OutputDebugStringA( oss.str().c_str() );
+}
+
+std::string TexturePreprocessor::GetCookedPath( const std::string& sourcePath )
+{
+	return std::filesystem::path{ sourcePath }.replace_extension( ".dds" ).string();
+}
+
+bool TexturePreprocessor::IsCookedUpToDate( const std::string& sourcePath )
+{
+	std::error_code ec;
+	const auto cookedTime = std::filesystem::last_write_time( GetCookedPath( sourcePath ),ec );
+	if( ec )
+	{
+		return false;
+	}
+	const auto sourceTime = std::filesystem::last_write_time( sourcePath,ec );
+	return ec || cookedTime >= sourceTime;
+}
+
+void TexturePreprocessor::CookTexture( const std::string& pathIn,const std::string& pathOut,CookKind kind,bool flipY,bool fastBC7 )
+{
 	using namespace DirectX;
-	auto sum = XMVectorZero();
-	const auto ProcessNormal = [thresholdMin,thresholdMax,&sum]( FXMVECTOR n,int x,int y ) -> XMVECTOR
+	auto surf = Surface::FromFile( pathIn );
+	const bool hasAlpha = kind == CookKind::Color && surf.AlphaLoaded();
+	if( flipY )
+	{
+		FlipYNormalMap( surf );
+	}
+
+	Image base = {};
+	base.width = surf.GetWidth();
+	base.height = surf.GetHeight();
+	base.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	base.rowPitch = surf.GetBytePitch();
+	base.slicePitch = base.rowPitch * base.height;
+	base.pixels = reinterpret_cast<uint8_t*>(surf.GetBufferPtr());
+
+	ScratchImage mips;
+	HRESULT hr = GenerateMipMaps( base,TEX_FILTER_DEFAULT,0u,mips );
+	if( FAILED( hr ) )
 	{
-		const float len = XMVectorGetX( XMVector3Length( n ) );
-		const float z = XMVectorGetZ( n );
-		if( len < thresholdMin || len > thresholdMax )
+		throw Surface::Exception( __LINE__,__FILE__,pathIn,"Failed to generate mip chain",hr );
+	}
+	if( kind == CookKind::Normal )
+	{
+		// averaging shortens normals, bring every level back to unit length
+		ScratchImage renormalized;
+		hr = TransformImage( mips.GetImages(),mips.GetImageCount(),mips.GetMetadata(),
+			[]( XMVECTOR* pOut,const XMVECTOR* pIn,size_t width,size_t y )
+			{
+				for( size_t x = 0; x < width; x++ )
+				{
+					const auto n = XMVector3Normalize( XMVectorSubtract( XMVectorScale( pIn[x],2.0f ),g_XMOne ) );
+					pOut[x] = XMVectorSelect( g_XMOne,XMVectorMultiplyAdd( n,g_XMOneHalf,g_XMOneHalf ),g_XMSelect1110 );
+				}
+			},renormalized
+		);
+		if( FAILED( hr ) )
 		{
-			XMFLOAT3 vec;
-			XMStoreFloat3( &vec,n );
-			std::ostringstream oss;
-			oss << "Bad normal length: " << len << " at: (" << x << "," << y << ") normal: (" << vec.x << "," << vec.y << "," << vec.z << ")\n";
-			OutputDebugStringA( oss.str().c_str() );
+			throw Surface::Exception( __LINE__,__FILE__,pathIn,"Failed to renormalize mip chain",hr );
 		}
-		if( z < 0.0f )
+		mips = std::move( renormalized );
+	}
+
+	// d3d11 wants block compressed top levels in whole blocks
+	ScratchImage compressed;
+	const ScratchImage* pOut = &mips;
+	if( base.width % 4 == 0 && base.height % 4 == 0 )
+	{
+		const auto format =
+			kind == CookKind::Normal ? DXGI_FORMAT_BC5_UNORM :
+			kind == CookKind::Scalar ? DXGI_FORMAT_BC4_UNORM :
+			DXGI_FORMAT_BC7_UNORM;
+		hr = Compress( mips.GetImages(),mips.GetImageCount(),mips.GetMetadata(),format,
+			fastBC7 ? TEX_COMPRESS_BC7_QUICK : TEX_COMPRESS_DEFAULT,TEX_THRESHOLD_DEFAULT,compressed
+		);
+		if( FAILED( hr ) )
 		{
-			XMFLOAT3 vec;
-			XMStoreFloat3( &vec,n );
-			std::ostringstream oss;
-			oss << "Bad normal Z direction at: (" << x << "," << y << ") normal: (" << vec.x << "," << vec.y << "," << vec.z << ")\n";
-			OutputDebugStringA( oss.str().c_str() );
+			throw Surface::Exception( __LINE__,__FILE__,pathIn,"Failed to compress image",hr );
+		}
+		pOut = &compressed;
+	}
+
+	// alpha mode tells the loader whether to treat the texture as masked (see Texture::HasAlpha)
+	auto metadata = pOut->GetMetadata();
+	metadata.SetAlphaMode( hasAlpha ? TEX_ALPHA_MODE_STRAIGHT : TEX_ALPHA_MODE_OPAQUE );
+	// written to a temporary and renamed so an interrupted cook never looks up to date
+	const auto tempPath = pathOut + ".tmp";
+	hr = SaveToDDSFile( pOut->GetImages(),pOut->GetImageCount(),metadata,
+		DDS_FLAGS_FORCE_DX10_EXT | DDS_FLAGS_FORCE_DX10_EXT_MISC2,ToWide( tempPath ).c_str()
+	);
+	if( FAILED( hr ) )
+	{
+		throw Surface::Exception( __LINE__,__FILE__,pathOut,"Failed to save cooked texture",hr );
+	}
+	std::error_code ec;
+	std::filesystem::rename( tempPath,pathOut,ec );
+	if( ec )
+	{
+		std::filesystem::remove( tempPath,ec );
+		throw Surface::Exception( __LINE__,__FILE__,pathOut,"Failed to replace cooked texture" );
+	}
+}
+
+void TexturePreprocessor::CookModelTextures( const std::string& modelPath,const std::string& reportPath,bool flipYNormals,
+	unsigned int threads,bool force,bool fastBC7 )
+{
+	const auto rootPath = std::filesystem::path{ modelPath }.parent_path().string() + "\\";
+
+	Assimp::Importer imp;
+	const auto pScene = imp.ReadFile( modelPath.c_str(),0u );
+	if( pScene == nullptr )
+	{
+		throw ModelException( __LINE__,__FILE__,imp.GetErrorString() );
+	}
+
+	// every referenced texture once, a map used as normals anywhere is cooked as one
+	std::map<std::string,CookKind> textures;
+	for( auto i = 0u; i < pScene->mNumMaterials; i++ )
+	{
+		const auto& mat = *pScene->mMaterials[i];
+		aiString texFileName;
+		if( mat.GetTexture( aiTextureType_NORMALS,0,&texFileName ) == aiReturn_SUCCESS )
+		{
+			textures[rootPath + texFileName.C_Str()] = CookKind::Normal;
 		}
-		sum = XMVectorAdd( sum,n );
-		return n;
+		for( const auto type : { aiTextureType_DIFFUSE,aiTextureType_SPECULAR } )
+		{
+			if( mat.GetTexture( type,0,&texFileName ) == aiReturn_SUCCESS )
+			{
+				textures.emplace( rootPath + texFileName.C_Str(),CookKind::Color );
+			}
+		}
+	}
+
+	struct Job
+	{
+		std::string path;
+		CookKind kind;
+		std::string status;
+		float seconds = 0.0f;
+		uintmax_t sourceBytes = 0;
+		uintmax_t cookedBytes = 0;
 	};
-	// execute the validation for each texel
-	auto surf = Surface::FromFile( pathIn );
-	TransformSurface( surf,ProcessNormal );
-	// output bias
+	std::vector<Job> jobs;
+	for( const auto& [path,kind] : textures )
+	{
+		jobs.push_back( { path,kind } );
+	}
+
+	ChiliTimer total;
+	threads = ParallelFor( jobs.size(),threads,[&]( size_t i )
+	{
+		auto& job = jobs[i];
+		std::error_code ec;
+		job.sourceBytes = std::filesystem::file_size( job.path,ec );
+		if( ec )
+		{
+			job.status = "missing";
+			return;
+		}
+		const auto cookedPath = GetCookedPath( job.path );
+		if( !force && IsCookedUpToDate( job.path ) )
+		{
+			job.status = "up to date";
+		}
+		else
+		{
+			ChiliTimer timer;
+			try
+			{
+				CookTexture( job.path,cookedPath,job.kind,flipYNormals && job.kind == CookKind::Normal,fastBC7 );
+				job.status = "cooked";
+			}
+			catch( const std::exception& e )
+			{
+				job.status = std::string( "failed: " ) + e.what();
+			}
+			job.seconds = timer.Peek();
+		}
+		job.cookedBytes = std::filesystem::file_size( cookedPath,ec );
+	},[]() { return ComScope{}; } );
+	const auto totalSeconds = total.Peek();
+
+	std::ofstream report( reportPath );
+	report << "texture cook: " << modelPath << std::endl
+		<< "threads " << threads << "  flip y normals " << flipYNormals << "  force " << force << "  fast bc7 " << fastBC7 << std::endl << std::endl
+		<< std::left << std::setw( 56 ) << "texture" << std::setw( 8 ) << "kind" << std::right
+		<< std::setw( 12 ) << "source kb" << std::setw( 12 ) << "dds kb" << std::setw( 10 ) << "s" << "  status" << std::endl;
+	size_t cooked = 0;
+	uintmax_t sourceBytes = 0;
+	uintmax_t cookedBytes = 0;
+	for( const auto& job : jobs )
 	{
-		XMFLOAT2 sumv;
-		XMStoreFloat2( &sumv,sum );
-		std::ostringstream oss;
-		oss << "Normal map biases: (" << sumv.x << "," << sumv.y << ")\n";
-		OutputDebugStringA( oss.str().c_str() );		
+		cooked += job.status == "cooked" ? 1 : 0;
+		sourceBytes += job.sourceBytes;
+		cookedBytes += job.cookedBytes;
+		report << std::left << std::setw( 56 ) << job.path
+			<< std::setw( 8 ) << (job.kind == CookKind::Normal ? "bc5" : job.kind == CookKind::Scalar ? "bc4" : "bc7") << std::right
+			<< std::setw( 12 ) << job.sourceBytes / 1024 << std::setw( 12 ) << job.cookedBytes / 1024
+			<< std::setw( 10 ) << std::fixed << std::setprecision( 2 ) << job.seconds << "  " << job.status << std::endl;
 	}
+	report << std::endl << cooked << " of " << jobs.size() << " textures cooked in " << totalSeconds << " s, "
+		<< sourceBytes / 1024 << " kb of sources -> " << cookedBytes / 1024 << " kb of dds" << std::endl;
 }
 
 void TexturePreprocessor::MakeStripes( const std::string& pathOut,int size,int stripeWidth )
@@ -120,44 +489,15 @@ void TexturePreprocessor::MakeStripes( const std::string& pathOut,int size,int s
 	assert( stripeWidth < size / 2 );
 
 	Surface s( size,size );
-	for( int y = 0; y < size; y++ )
+	// every row is the same
+	const auto first = s.GetRow( 0u );
+	for( int x = 0; x < size; x++ )
 	{
-		for( int x = 0; x < size; x++ )
-		{
-			Surface::Color c = { 0,0,0 };
-			if( (x / stripeWidth) % 2 == 0 )
-			{
-				c = { 255,255,255 };
-			}
-			s.PutPixel( x,y,c );
-		}
+		first[x] = (x / stripeWidth) % 2 == 0 ? Surface::Color{ 255,255,255 } : Surface::Color{ 0,0,0 };
+	}
+	for( int y = 1; y < size; y++ )
+	{
+		std::ranges::copy( first,s.GetRow( y ).begin() );
 	}
 	s.Save( pathOut );
 }
-
-DirectX::XMVECTOR TexturePreprocessor::ColorToVector( Surface::Color c ) noexcept
-{
-	using namespace DirectX;
-	auto n = XMVectorSet( (float)c.GetR(),(float)c.GetG(),(float)c.GetB(),0.0f );
-	const auto all255 = XMVectorReplicate( 2.0f / 255.0f );
-	n = XMVectorMultiply( n,all255 );
-	const auto all1 = XMVectorReplicate( 1.0f );
-	n = XMVectorSubtract( n,all1 );
-	return n;
-}
-
-Surface::Color TexturePreprocessor::VectorToColor( DirectX::FXMVECTOR n ) noexcept
-{
-	using namespace DirectX;
-	const auto all1 = XMVectorReplicate( 1.0f );
-	XMVECTOR nOut = XMVectorAdd( n,all1 );
-	const auto all255 = XMVectorReplicate( 255.0f / 2.0f );
-	nOut = XMVectorMultiply( nOut,all255 );
-	XMFLOAT3 floats;
-	XMStoreFloat3( &floats,nOut );
-	return {
-		(unsigned char)round( floats.x ),
-		(unsigned char)round( floats.y ),
-		(unsigned char)round( floats.z ),
-	};
-}
@@ -8,15 +8,47 @@
 class TexturePreprocessor
 {
 public:
+	enum class CookKind
+	{
+		// albedo / specular / mra maps, BC7 keeping alpha
+		Color,
+		// tangent space normals, BC5 with z rebuilt in the shader (see MapNormal)
+		Normal,
+		// single channel data (masks, heights), BC4
+		Scalar,
+	};
+public:
+	// <source stem>.dds next to the source, loaded by Bind::Texture instead of the source when up to date
+	static std::string GetCookedPath( const std::string& sourcePath );
+	// cooked file exists and is not older than the source (or the source is gone)
+	static bool IsCookedUpToDate( const std::string& sourcePath );
+	// full mip chain filtered offline (normals renormalized per level), then block compressed
+	// flipY inverts green first like FlipYNormalMap; sizes that are not multiples of 4 stay uncompressed
+	static void CookTexture( const std::string& pathIn,const std::string& pathOut,CookKind kind,bool flipY = false,bool fastBC7 = false );
+	// cooks every texture the model's materials reference on worker threads, normal maps to BC5 and the rest to BC7,
+	// skipping the ones that are up to date unless forced; writes per-texture timings and sizes to reportPath
+	static void CookModelTextures( const std::string& modelPath,const std::string& reportPath,bool flipYNormals,
+		unsigned int threads,bool force,bool fastBC7 );
 	static void FlipYAllNormalMapsInObj( const std::string& objPath );
 	static void FlipYNormalMap( const std::string& pathIn,const std::string& pathOut );
+	// inverts green (tangent space y) in place and makes alpha opaque
+	// rows go through a kernel working on 4 texels at a time, in bands of rows spread over threads
+	// (0 uses every hardware thread, small surfaces stay on the calling thread)
+	static void FlipYNormalMap( Surface& surf,unsigned int threads = 0u );
+	struct NormalMapReport
+	{
+		size_t texels = 0u;
+		size_t badLength = 0u;
+		size_t badZ = 0u;
+		// sums of the decoded x and y over every texel, near 0 for a map without bias
+		// summed exactly as integers per band, so the result doesn't depend on the thread count
+		double biasX = 0.0;
+		double biasY = 0.0;
+	};
+	// checks the length of every normal against the thresholds and that it points out of the surface (z >= 0)
+	// logTexels writes each bad texel to the debug output, in row order
+	static NormalMapReport ValidateNormalMap( const Surface& surf,float thresholdMin,float thresholdMax,
+		bool logTexels = false,unsigned int threads = 0u );
 	static void ValidateNormalMap( const std::string& pathIn,float thresholdMin,float thresholdMax );
 	static void MakeStripes( const std::string& pathOut,int size,int stripeWidth );
-private:
-	template<typename F>
-	static void TransformFile( const std::string& pathIn,const std::string& pathOut,F&& func );
-	template<typename F>
-	static void TransformSurface( Surface& surf,F && func );
-	static DirectX::XMVECTOR ColorToVector( Surface::Color c ) noexcept;
-	static Surface::Color VectorToColor( DirectX::FXMVECTOR n ) noexcept;
 };
@@ -0,0 +1,329 @@
+#include "TextureResource.h"
+#include "Surface.h"
+#include "GraphicsThrowMacros.h"
+#include "TexturePreprocessor.h"
+#include "ChiliUtil.h"
+#include "AssetStreamer.h"
+#include <sstream>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
+namespace Bind
+{
+	namespace wrl = Microsoft::WRL;
+
+	namespace
+	{
+		// Resolve and the finalizers of streamed loads run on the render thread, but nothing stops a
+		// worker from resolving, so the cache and the stats are only touched under this
+		std::mutex stateMutex;
+		std::unordered_map<std::string,std::weak_ptr<TextureResource>> cache;
+		TextureResource::Stats stats;
+
+		template<typename F>
+		void UpdateStats( F&& f )
+		{
+			std::lock_guard lock{ stateMutex };
+			f( stats );
+		}
+
+		// what CreateTextureEx will allocate for the file, every mip of every slice
+		size_t GetCookedSizeBytes( const DirectX::TexMetadata& metadata ) noexcept
+		{
+			size_t bytes = 0u;
+			for( size_t mip = 0; mip < metadata.mipLevels; mip++ )
+			{
+				size_t rowPitch = 0u;
+				size_t slicePitch = 0u;
+				if( FAILED( DirectX::ComputePitch( metadata.format,
+					std::max<size_t>( metadata.width >> mip,1u ),std::max<size_t>( metadata.height >> mip,1u ),
+					rowPitch,slicePitch ) ) )
+				{
+					return 0u;
+				}
+				bytes += slicePitch;
+			}
+			return bytes * metadata.arraySize;
+		}
+	}
+
+	TextureResource::TextureResource( Graphics& gfx,const std::string& path,const Options& options,const Decoded* pDecoded )
+		:
+		path( path ),
+		options( options )
+	{
+		if( pDecoded )
+		{
+			Create( gfx,*pDecoded );
+		}
+		else
+		{
+			// only cooked files stream (see Resolve), their header already says whether the image has alpha,
+			// so materials pick their masked / opaque technique right even while the placeholder is bound
+			const auto cookedPath = TexturePreprocessor::GetCookedPath( path );
+			DirectX::TexMetadata metadata;
+			const auto hr = DirectX::GetMetadataFromDDSFile( ToWide( cookedPath ).c_str(),DirectX::DDS_FLAGS_NONE,metadata );
+			if( FAILED( hr ) )
+			{
+				throw Surface::Exception( __LINE__,__FILE__,cookedPath,"Failed to read cooked texture header",hr );
+			}
+			hasAlpha = metadata.GetAlphaMode() == DirectX::TEX_ALPHA_MODE_STRAIGHT;
+			// the codex records the size when the texture is inserted, long before the pixels arrive
+			sizeBytes = GetCookedSizeBytes( metadata );
+			pTextureView = GetPlaceholderView( gfx );
+		}
+	}
+
+	void TextureResource::Create( Graphics& gfx,const Decoded& decoded )
+	{
+		assert( pending );
+		if( decoded.surface )
+		{
+			CreateFromSurface( gfx,*decoded.surface );
+		}
+		else
+		{
+			CreateFromCooked( gfx,decoded.scratch,decoded.metadata );
+		}
+		pending = false;
+		UpdateStats( [&]( Stats& s )
+		{
+			s.loads++;
+			s.backgroundLoads += decoded.background ? 1 : 0;
+		} );
+	}
+
+	void TextureResource::CreateFromSurface( Graphics& gfx,const Surface& s )
+	{
+		INFOMAN( gfx );
+
+		hasAlpha = s.AlphaLoaded();
+
+		// create texture resource
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = s.GetWidth();
+		textureDesc.Height = s.GetHeight();
+		textureDesc.MipLevels = 0;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = options.srgb ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		wrl::ComPtr<ID3D11Texture2D> pTexture;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateTexture2D(
+			&textureDesc,nullptr,&pTexture
+		) );
+
+		// write image data into top mip level
+		GetContext( gfx )->UpdateSubresource(
+			pTexture.Get(),0u,nullptr,s.GetBufferPtrConst(),s.GetWidth() * sizeof( Surface::Color ),0u
+		);
+		UpdateStats( [&]( Stats& totals ) { totals.bytesUploaded += size_t( s.GetWidth() ) * s.GetHeight() * sizeof( Surface::Color ); } );
+		// the generated mip chain adds a third
+		sizeBytes = size_t( s.GetWidth() ) * s.GetHeight() * sizeof( Surface::Color ) * 4u / 3u;
+
+		// create the resource view on the texture
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = textureDesc.Format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.Texture2D.MipLevels = -1;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView(
+			pTexture.Get(),&srvDesc,&pTextureView
+		) );
+
+		// generate the mip chain using the gpu rendering pipeline
+		GetContext( gfx )->GenerateMips( pTextureView.Get() );
+	}
+
+	void TextureResource::CreateFromCooked( Graphics& gfx,const DirectX::ScratchImage& scratch,const DirectX::TexMetadata& metadata )
+	{
+		INFOMAN( gfx );
+
+		hasAlpha = metadata.GetAlphaMode() == DirectX::TEX_ALPHA_MODE_STRAIGHT;
+
+		// every level is already in the file, no render target binding or mip generation needed
+		wrl::ComPtr<ID3D11Resource> pTexture;
+		GFX_THROW_INFO( DirectX::CreateTextureEx( GetDevice( gfx ),
+			scratch.GetImages(),scratch.GetImageCount(),metadata,
+			D3D11_USAGE_DEFAULT,D3D11_BIND_SHADER_RESOURCE,0u,0u,options.srgb,&pTexture
+		) );
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = options.srgb ? DirectX::MakeSRGB( metadata.format ) : metadata.format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.Texture2D.MipLevels = (UINT)metadata.mipLevels;
+		GFX_THROW_INFO( GetDevice( gfx )->CreateShaderResourceView(
+			pTexture.Get(),&srvDesc,&pTextureView
+		) );
+		UpdateStats( [&]( Stats& s )
+		{
+			s.cookedLoads++;
+			s.bytesUploaded += scratch.GetPixelsSize();
+		} );
+		sizeBytes = scratch.GetPixelsSize();
+	}
+
+	std::shared_ptr<TextureResource> TextureResource::Resolve( Graphics& gfx,const std::string& path,const Options& options )
+	{
+		const auto key = GenerateUID( path,options );
+		auto pDecoded = TakePrefetched( path );
+		std::shared_ptr<TextureResource> pExisting;
+		{
+			std::lock_guard lock{ stateMutex };
+			stats.requests++;
+			pExisting = cache[key].lock();
+		}
+		if( pExisting )
+		{
+			// still streaming, but the data is right here
+			if( pExisting->IsPending() && pDecoded )
+			{
+				pExisting->Create( gfx,*pDecoded );
+			}
+			return pExisting;
+		}
+		// an image that isn't cooked has to be decoded to tell whether it has alpha, so it loads right away
+		if( !pDecoded && AssetStreamer::IsActive() && TexturePreprocessor::IsCookedUpToDate( path ) )
+		{
+			auto pResource = std::make_shared<TextureResource>( gfx,path,options,nullptr );
+			{
+				std::lock_guard lock{ stateMutex };
+				cache[key] = pResource;
+			}
+			AssetStreamer::Enqueue( [path,pWeak = std::weak_ptr<TextureResource>( pResource )]() -> AssetStreamer::Finalizer
+			{
+				auto pDecoded = Decode( path );
+				pDecoded->background = true;
+				return [pWeak,pDecoded]( Graphics& gfx )
+				{
+					const auto pResource = pWeak.lock();
+					if( pResource && pResource->IsPending() )
+					{
+						pResource->Create( gfx,*pDecoded );
+					}
+				};
+			} );
+			return pResource;
+		}
+		if( !pDecoded )
+		{
+			pDecoded = Decode( path );
+		}
+		auto pResource = std::make_shared<TextureResource>( gfx,path,options,pDecoded.get() );
+		{
+			std::lock_guard lock{ stateMutex };
+			cache[key] = pResource;
+		}
+		return pResource;
+	}
+
+	std::shared_ptr<TextureResource::Decoded> TextureResource::Decode( const std::string& path )
+	{
+		auto pDecoded = std::make_shared<Decoded>();
+		if( TexturePreprocessor::IsCookedUpToDate( path ) )
+		{
+			const auto cookedPath = TexturePreprocessor::GetCookedPath( path );
+			const auto hr = DirectX::LoadFromDDSFile( ToWide( cookedPath ).c_str(),DirectX::DDS_FLAGS_NONE,
+				&pDecoded->metadata,pDecoded->scratch
+			);
+			if( FAILED( hr ) )
+			{
+				throw Surface::Exception( __LINE__,__FILE__,cookedPath,"Failed to load cooked texture",hr );
+			}
+		}
+		else
+		{
+			pDecoded->surface = Surface::FromFile( path );
+		}
+		return pDecoded;
+	}
+
+	namespace
+	{
+		std::mutex prefetchMutex;
+		std::unordered_map<std::string,std::weak_ptr<TextureResource::Decoded>> prefetched;
+	}
+
+	std::shared_ptr<TextureResource::Decoded> TextureResource::Prefetch( const std::string& path )
+	{
+		auto pDecoded = Decode( path );
+		std::lock_guard lock{ prefetchMutex };
+		prefetched[path] = pDecoded;
+		return pDecoded;
+	}
+
+	std::shared_ptr<TextureResource::Decoded> TextureResource::TakePrefetched( const std::string& path )
+	{
+		std::lock_guard lock{ prefetchMutex };
+		const auto i = prefetched.find( path );
+		if( i == prefetched.end() )
+		{
+			return nullptr;
+		}
+		auto pDecoded = i->second.lock();
+		prefetched.erase( i );
+		return pDecoded;
+	}
+
+	ID3D11ShaderResourceView* TextureResource::GetPlaceholderView( Graphics& gfx ) noexcept
+	{
+		// owned by the device it was created on, like the constant ring
+		return gfx.GetPlaceholderView();
+	}
+
+	std::string TextureResource::GenerateUID( const std::string& path,const Options& options )
+	{
+		return path + (options.srgb ? "#srgb" : "#linear");
+	}
+
+	TextureResource::Stats TextureResource::GetStats()
+	{
+		std::lock_guard lock{ stateMutex };
+		return stats;
+	}
+
+	std::string TextureResource::GetStatsReport()
+	{
+		const auto stats = GetStats();
+		std::ostringstream oss;
+		oss << "Textures: " << stats.requests << " bound, " << stats.loads << " decoded (" << stats.cookedLoads << " cooked), "
+			<< stats.requests - stats.loads << " redundant decodes / uploads avoided, " << stats.backgroundLoads << " decoded in the background, "
+			<< stats.bytesUploaded / (1024 * 1024) << " MB uploaded\n";
+		return oss.str();
+	}
+
+	ID3D11ShaderResourceView* TextureResource::GetView() const noexcept
+	{
+		return pTextureView.Get();
+	}
+
+	bool TextureResource::HasAlpha() const noexcept
+	{
+		return hasAlpha;
+	}
+
+	bool TextureResource::IsPending() const noexcept
+	{
+		return pending;
+	}
+	size_t TextureResource::GetSizeBytes() const noexcept
+	{
+		return sizeBytes;
+	}
+
+	bool TextureResource::ClaimSize() noexcept
+	{
+		return !std::exchange( sizeClaimed,true );
+	}
+
+	const std::string& TextureResource::GetPath() const noexcept
+	{
+		return path;
+	}
+
+}
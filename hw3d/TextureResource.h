@@ -0,0 +1,79 @@
+#pragma once
+#include "GraphicsResource.h"
+#include "Surface.h"
+#include <memory>
+#include <string>
+#include <optional>
+#include <unordered_map>
+
+namespace Bind
+{
+	// the gpu copy of an image file, decoded and uploaded once no matter how many slots / stages bind it
+	// Texture bindables are thin per-slot views over one of these
+	class TextureResource : public GraphicsResource
+	{
+	public:
+		struct Options
+		{
+			// view the data as sRGB so sampling linearizes in hardware (shaders here decode gamma themselves)
+			bool srgb = false;
+		};
+		struct Stats
+		{
+			// Resolve calls, i.e. texture bindables created
+			size_t requests = 0;
+			// images actually decoded and uploaded
+			size_t loads = 0;
+			// of those, read from cooked dds files
+			size_t cookedLoads = 0;
+			// of those, decoded on a streaming worker (prefetched or streamed)
+			size_t backgroundLoads = 0;
+			size_t bytesUploaded = 0;
+		};
+		// cpu side of a load, can be produced on any thread
+		struct Decoded
+		{
+			std::optional<Surface> surface;
+			// cooked dds with all its levels, used when there is no surface
+			DirectX::ScratchImage scratch;
+			DirectX::TexMetadata metadata = {};
+			bool background = false;
+		};
+	public:
+		// pDecoded null makes a placeholder that is filled in once the streamed data arrives
+		TextureResource( Graphics& gfx,const std::string& path,const Options& options,const Decoded* pDecoded );
+		// shared while anything still holds it; with an AssetStreamer running, cooked files that were not
+		// prefetched come back as placeholders (with HasAlpha already right) and load in the background
+		static std::shared_ptr<TextureResource> Resolve( Graphics& gfx,const std::string& path,const Options& options = {} );
+		static std::string GenerateUID( const std::string& path,const Options& options );
+		// reads and decodes without touching the gpu, safe on any thread
+		static std::shared_ptr<Decoded> Decode( const std::string& path );
+		// decodes now and hands the result to the next Resolve of path, for as long as the caller keeps it alive
+		static std::shared_ptr<Decoded> Prefetch( const std::string& path );
+		static Stats GetStats();
+		// one line summary of the stats for logs
+		static std::string GetStatsReport();
+		ID3D11ShaderResourceView* GetView() const noexcept;
+		bool HasAlpha() const noexcept;
+		bool IsPending() const noexcept;
+		// gpu memory of the texture and its mips, streamed textures report it from the file header while pending
+		size_t GetSizeBytes() const noexcept;
+		// true for the first caller only, so budgets that sum over bindings count the image once
+		bool ClaimSize() noexcept;
+		const std::string& GetPath() const noexcept;
+	private:
+		void Create( Graphics& gfx,const Decoded& decoded );
+		void CreateFromSurface( Graphics& gfx,const Surface& s );
+		void CreateFromCooked( Graphics& gfx,const DirectX::ScratchImage& scratch,const DirectX::TexMetadata& metadata );
+		static ID3D11ShaderResourceView* GetPlaceholderView( Graphics& gfx ) noexcept;
+		static std::shared_ptr<Decoded> TakePrefetched( const std::string& path );
+	private:
+		std::string path;
+		Options options;
+		bool hasAlpha = false;
+		bool pending = true;
+		size_t sizeBytes = 0u;
+		bool sizeClaimed = false;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pTextureView;
+	};
+}
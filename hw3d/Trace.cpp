@@ -0,0 +1,297 @@
+#include "Trace.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include "json.hpp"
+
+namespace jso = nlohmann;
+
+std::atomic<bool> Trace::enabled = false;
+
+namespace
+{
+	constexpr size_t ringMask = Trace::ringCapacity - 1u;
+	static_assert( (Trace::ringCapacity & ringMask) == 0u,"Trace ring capacity must be a power of two" );
+
+	struct Event
+	{
+		Trace::NameId name;
+		// 0 for zones, frame number + 1 for frame marks
+		std::uint32_t frame;
+		std::int64_t begin;
+		std::int64_t end;
+	};
+
+	// single producer (the owning thread) single consumer (Export, under the registry lock) ring
+	// head and tail only ever grow, the slot is the count masked by the capacity
+	struct ThreadBuffer
+	{
+		std::unique_ptr<Event[]> events{ new Event[Trace::ringCapacity] };
+		std::atomic<size_t> head = 0u;
+		std::atomic<size_t> tail = 0u;
+		std::atomic<size_t> dropped = 0u;
+		// set once the owning thread has exited, the buffer goes away after its last export
+		std::atomic<bool> retired = false;
+		std::uint32_t tid = 0u;
+		std::string name;
+	};
+
+	struct Registry
+	{
+		std::mutex threadMutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> threads;
+		std::uint32_t nextTid = 1u;
+		// totals of buffers already dropped from the list
+		size_t retiredRecorded = 0u;
+		size_t retiredDropped = 0u;
+
+		std::mutex nameMutex;
+		std::map<std::string,Trace::NameId,std::less<>> ids;
+		std::vector<std::string> names;
+
+		std::mutex captureMutex;
+		std::string capturePath;
+		std::atomic<unsigned int> captureFramesLeft = 0u;
+		std::atomic<std::uint32_t> frame = 0u;
+
+		const std::int64_t origin = Trace::Now();
+	};
+
+	Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	struct ThreadHandle
+	{
+		~ThreadHandle()
+		{
+			if( pBuffer )
+			{
+				pBuffer->retired.store( true,std::memory_order_release );
+			}
+		}
+		std::shared_ptr<ThreadBuffer> pBuffer;
+	};
+	thread_local ThreadHandle threadHandle;
+
+	// registers the calling thread on first use, null if that failed (out of memory)
+	ThreadBuffer* GetThreadBuffer() noexcept
+	{
+		if( !threadHandle.pBuffer )
+		{
+			try
+			{
+				auto pBuffer = std::make_shared<ThreadBuffer>();
+				auto& r = GetRegistry();
+				std::lock_guard lock{ r.threadMutex };
+				pBuffer->tid = r.nextTid++;
+				r.threads.push_back( pBuffer );
+				threadHandle.pBuffer = std::move( pBuffer );
+			}
+			catch( ... )
+			{
+				return nullptr;
+			}
+		}
+		return threadHandle.pBuffer.get();
+	}
+
+	void Push( const Event& e ) noexcept
+	{
+		const auto pBuffer = GetThreadBuffer();
+		if( !pBuffer )
+		{
+			return;
+		}
+		auto& b = *pBuffer;
+		const auto head = b.head.load( std::memory_order_relaxed );
+		if( head - b.tail.load( std::memory_order_acquire ) >= Trace::ringCapacity )
+		{
+			b.dropped.fetch_add( 1u,std::memory_order_relaxed );
+			return;
+		}
+		b.events[head & ringMask] = e;
+		b.head.store( head + 1u,std::memory_order_release );
+	}
+
+	double ToMicroseconds( std::int64_t ticks ) noexcept
+	{
+		using Period = Trace::Clock::period;
+		return double( ticks - GetRegistry().origin ) * 1.0e6 * double( Period::num ) / double( Period::den );
+	}
+}
+
+void Trace::SetEnabled( bool enable ) noexcept
+{
+	enabled.store( enable,std::memory_order_relaxed );
+}
+
+Trace::NameId Trace::Intern( std::string_view name )
+{
+	auto& r = GetRegistry();
+	std::lock_guard lock{ r.nameMutex };
+	if( const auto i = r.ids.find( name ); i != r.ids.end() )
+	{
+		return i->second;
+	}
+	const auto id = NameId( r.names.size() );
+	r.names.emplace_back( name );
+	r.ids.emplace( r.names.back(),id );
+	return id;
+}
+
+void Trace::SetThreadName( std::string name )
+{
+	if( const auto pBuffer = GetThreadBuffer() )
+	{
+		auto& r = GetRegistry();
+		std::lock_guard lock{ r.threadMutex };
+		pBuffer->name = std::move( name );
+	}
+}
+
+void Trace::Record( NameId name,std::int64_t begin,std::int64_t end ) noexcept
+{
+	Push( { name,0u,begin,end } );
+}
+
+void Trace::FrameMark()
+{
+	static const NameId frameName = Intern( "Frame" );
+	auto& r = GetRegistry();
+	const auto frame = r.frame.fetch_add( 1u,std::memory_order_relaxed );
+	if( IsEnabled() )
+	{
+		const auto t = Now();
+		Push( { frameName,frame + 1u,t,t } );
+	}
+	// only the frame that counts the capture down to zero exports it
+	auto left = r.captureFramesLeft.load( std::memory_order_relaxed );
+	while( left != 0u && !r.captureFramesLeft.compare_exchange_weak( left,left - 1u,std::memory_order_relaxed ) );
+	if( left == 1u )
+	{
+		std::string path;
+		{
+			std::lock_guard lock{ r.captureMutex };
+			path = std::move( r.capturePath );
+		}
+		SetEnabled( false );
+		Export( path );
+	}
+}
+
+void Trace::Capture( std::string path,unsigned int frames )
+{
+	auto& r = GetRegistry();
+	{
+		std::lock_guard lock{ r.captureMutex };
+		r.capturePath = std::move( path );
+	}
+	r.captureFramesLeft.store( std::max( frames,1u ),std::memory_order_relaxed );
+	SetEnabled( true );
+}
+
+bool Trace::IsCapturing() noexcept
+{
+	return GetRegistry().captureFramesLeft.load( std::memory_order_relaxed ) != 0u;
+}
+
+size_t Trace::Export( const std::string& path )
+{
+	auto& r = GetRegistry();
+	struct Collected
+	{
+		std::uint32_t tid;
+		Event e;
+	};
+	std::vector<Collected> collected;
+	auto events = jso::json::array();
+	jso::json dropped = 0u;
+	{
+		std::lock_guard lock{ r.threadMutex };
+		size_t droppedTotal = r.retiredDropped;
+		for( auto i = r.threads.begin(); i != r.threads.end(); )
+		{
+			auto& b = **i;
+			// read before draining, a retired thread writes nothing after it is seen retired
+			const bool retired = b.retired.load( std::memory_order_acquire );
+			const auto head = b.head.load( std::memory_order_acquire );
+			for( auto tail = b.tail.load( std::memory_order_relaxed ); tail != head; tail++ )
+			{
+				collected.push_back( { b.tid,b.events[tail & ringMask] } );
+			}
+			b.tail.store( head,std::memory_order_release );
+			droppedTotal += b.dropped.load( std::memory_order_relaxed );
+			events.push_back( {
+				{ "name","thread_name" },{ "ph","M" },{ "pid",1 },{ "tid",b.tid },
+				{ "args",{ { "name",b.name.empty() ? "Thread " + std::to_string( b.tid ) : b.name } } }
+			} );
+			if( retired )
+			{
+				r.retiredRecorded += head;
+				r.retiredDropped += b.dropped.load( std::memory_order_relaxed );
+				i = r.threads.erase( i );
+			}
+			else
+			{
+				++i;
+			}
+		}
+		dropped = droppedTotal;
+	}
+	// parents before children on each track, which is also the order viewers want
+	std::stable_sort( collected.begin(),collected.end(),[]( const Collected& a,const Collected& b )
+	{
+		return a.e.begin < b.e.begin || (a.e.begin == b.e.begin && a.e.end > b.e.end);
+	} );
+	{
+		std::lock_guard lock{ r.nameMutex };
+		for( const auto& c : collected )
+		{
+			const auto& name = r.names[c.e.name];
+			if( c.e.frame != 0u )
+			{
+				events.push_back( {
+					{ "name",name },{ "ph","i" },{ "s","g" },{ "ts",ToMicroseconds( c.e.begin ) },
+					{ "pid",1 },{ "tid",c.tid },{ "args",{ { "frame",c.e.frame - 1u } } }
+				} );
+			}
+			else
+			{
+				events.push_back( {
+					{ "name",name },{ "cat","cpu" },{ "ph","X" },{ "ts",ToMicroseconds( c.e.begin ) },
+					{ "dur",ToMicroseconds( c.e.end ) - ToMicroseconds( c.e.begin ) },{ "pid",1 },{ "tid",c.tid }
+				} );
+			}
+		}
+	}
+	const jso::json trace = {
+		{ "displayTimeUnit","ms" },
+		{ "traceEvents",std::move( events ) },
+		{ "otherData",{ { "dropped",std::move( dropped ) } } }
+	};
+	std::ofstream file( path );
+	file << trace.dump();
+	return collected.size();
+}
+
+Trace::Stats Trace::GetStats() noexcept
+{
+	auto& r = GetRegistry();
+	std::lock_guard lock{ r.threadMutex };
+	Stats stats;
+	stats.recorded = r.retiredRecorded;
+	stats.dropped = r.retiredDropped;
+	stats.threads = r.threads.size();
+	for( const auto& pBuffer : r.threads )
+	{
+		stats.recorded += pBuffer->head.load( std::memory_order_relaxed );
+		stats.dropped += pBuffer->dropped.load( std::memory_order_relaxed );
+	}
+	return stats;
+}
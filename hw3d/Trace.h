@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// set to 0 to compile every zone and frame mark out of the build
+#ifndef CHILI_TRACE
+#define CHILI_TRACE 1
+#endif
+
+// scoped cpu zones for chrome://tracing / ui.perfetto.dev
+// each thread records fixed-size events (interned name, begin, end) into its own ring, written only by that
+// thread and drained by Export, so recording never takes a lock; names are interned once per call site
+// while disabled a zone costs one relaxed load and a branch, nothing is allocated or written
+class Trace
+{
+public:
+	using NameId = std::uint32_t;
+	using Clock = std::chrono::steady_clock;
+	// events per thread between exports, recording into a full ring drops the new events (counted in stats)
+	static constexpr size_t ringCapacity = 1u << 16;
+	struct Stats
+	{
+		size_t recorded = 0;
+		size_t dropped = 0;
+		size_t threads = 0;
+	};
+	// times the scope it lives in on the calling thread, use through TRACE_ZONE
+	class Zone
+	{
+	public:
+		explicit Zone( NameId name ) noexcept
+			:
+			name( name ),
+			active( IsEnabled() )
+		{
+			if( active )
+			{
+				begin = Now();
+			}
+		}
+		// for names only known at runtime (passes, assets), interned per zone so only while enabled
+		explicit Zone( std::string_view runtimeName )
+			:
+			active( IsEnabled() )
+		{
+			if( active )
+			{
+				name = Intern( runtimeName );
+				begin = Now();
+			}
+		}
+		~Zone()
+		{
+			if( active )
+			{
+				Record( name,begin,Now() );
+			}
+		}
+		Zone( const Zone& ) = delete;
+		Zone& operator=( const Zone& ) = delete;
+	private:
+		NameId name = 0u;
+		bool active;
+		std::int64_t begin = 0;
+	};
+public:
+	static bool IsEnabled() noexcept
+	{
+		return enabled.load( std::memory_order_relaxed );
+	}
+	static void SetEnabled( bool enable ) noexcept;
+	// same string, same id; the string is copied the first time
+	static NameId Intern( std::string_view name );
+	// shown for the calling thread's track in exported traces
+	static void SetThreadName( std::string name );
+	// instant marker between frames, call once at the end of every frame (finishes captures)
+	static void FrameMark();
+	// enables tracing and exports to path after the given number of frame marks, then disables again
+	static void Capture( std::string path,unsigned int frames );
+	static bool IsCapturing() noexcept;
+	// moves everything recorded so far out of the rings into a trace-event json file
+	// returns the number of events written
+	static size_t Export( const std::string& path );
+	static Stats GetStats() noexcept;
+	static std::int64_t Now() noexcept
+	{
+		return Clock::now().time_since_epoch().count();
+	}
+private:
+	static void Record( NameId name,std::int64_t begin,std::int64_t end ) noexcept;
+private:
+	static std::atomic<bool> enabled;
+};
+
+#define TRACE_CONCAT_( a,b ) a##b
+#define TRACE_CONCAT( a,b ) TRACE_CONCAT_( a,b )
+#if CHILI_TRACE
+// name must be a string constant, it is interned the first time the line runs
+#define TRACE_ZONE( name ) \
+	static const Trace::NameId TRACE_CONCAT( traceName_,__LINE__ ) = Trace::Intern( name ); \
+	const Trace::Zone TRACE_CONCAT( traceZone_,__LINE__ ){ TRACE_CONCAT( traceName_,__LINE__ ) }
+// name can be any string, looked up on every run while tracing is enabled
+#define TRACE_ZONE_DYNAMIC( name ) const Trace::Zone TRACE_CONCAT( traceZone_,__LINE__ ){ std::string_view{ name } }
+#define TRACE_FRAME() Trace::FrameMark()
+#else
+#define TRACE_ZONE( name ) ((void)0)
+#define TRACE_ZONE_DYNAMIC( name ) ((void)0)
+#define TRACE_FRAME() ((void)0)
+#endif
@@ -1,4 +1,5 @@
 #include "TransformCbuf.h"
+#include "ConstantRingBuffer.h"
 
 namespace Bind
 {
@@ -39,6 +40,18 @@ namespace Bind
 	void TransformCbuf::UpdateBindImpl( Graphics& gfx,const Transforms& tf ) noxnd
 	{
 		assert( pParent != nullptr );
+		if( auto pRing = ConstantRingBuffer::Get( gfx ) )
+		{
+			// one copy serves every stage
+			const auto range = pRing->Write( gfx,&tf,sizeof( tf ) );
+			ConstantRingBuffer::BindVS( gfx,0u,range );
+			ConstantRingBuffer::BindPS( gfx,0u,range );
+			if( otherShaderIndex & 0b00000001 )
+			{
+				ConstantRingBuffer::BindDS( gfx,0u,range );
+			}
+			return;
+		}
 		pVcbuf->Update( gfx,tf );
 		pVcbuf->Bind( gfx );
 		pPcbuf->Update(gfx, tf);
@@ -1,6 +1,6 @@
 #include "ConstantsVS.hlsli"
 
-VSOut main(VSIn v)
+VSOut Trunk(VSIn v)
 {
     VSOut o;
 
@@ -33,4 +33,18 @@ VSOut main(VSIn v)
 
     GetVertexParameters(o, v);
     return o;
-}
\ No newline at end of file
+}
+
+#ifdef QuantizedVertices
+#include "QuantizedVertex.hlsli"
+
+VSOut main(QuantizedVSIn q)
+{
+    return Trunk(DecodeVertex(q));
+}
+#else
+VSOut main(VSIn v)
+{
+    return Trunk(v);
+}
+#endif
\ No newline at end of file
@@ -1,8 +1,121 @@
 #define DVTX_SOURCE_FILE
 #include "Vertex.h"
+#include <algorithm>
+#include <cmath>
 
 namespace Dvtx
 {
+	namespace dx = DirectX;
+	namespace dxp = DirectX::PackedVector;
+
+	// compact encodings
+	dx::XMFLOAT2 OctEncode( const dx::XMFLOAT3& v ) noexcept
+	{
+		const float l1 = std::abs( v.x ) + std::abs( v.y ) + std::abs( v.z );
+		if( l1 == 0.0f )
+		{
+			return { 0.0f,0.0f };
+		}
+		dx::XMFLOAT2 e = { v.x / l1,v.y / l1 };
+		// lower hemisphere folds over the diagonals
+		if( v.z < 0.0f )
+		{
+			e = {
+				(1.0f - std::abs( e.y )) * (e.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs( e.x )) * (e.y >= 0.0f ? 1.0f : -1.0f)
+			};
+		}
+		return e;
+	}
+	dx::XMFLOAT3 OctDecode( const dx::XMFLOAT2& e ) noexcept
+	{
+		dx::XMFLOAT3 v = { e.x,e.y,1.0f - std::abs( e.x ) - std::abs( e.y ) };
+		const float t = std::max( -v.z,0.0f );
+		v.x += v.x >= 0.0f ? -t : t;
+		v.y += v.y >= 0.0f ? -t : t;
+		dx::XMStoreFloat3( &v,dx::XMVector3Normalize( dx::XMLoadFloat3( &v ) ) );
+		return v;
+	}
+	dxp::XMSHORTN2 PackOctNormal( const dx::XMFLOAT3& n ) noexcept
+	{
+		const auto e = OctEncode( n );
+		return { e.x,e.y };
+	}
+	dx::XMFLOAT3 UnpackOctNormal( const dxp::XMSHORTN2& p ) noexcept
+	{
+		dx::XMFLOAT2 e;
+		dx::XMStoreFloat2( &e,dxp::XMLoadShortN2( &p ) );
+		return OctDecode( e );
+	}
+	dxp::XMUSHORT2 PackOctTangent( const dx::XMFLOAT3& t,bool flipBinormal ) noexcept
+	{
+		const auto e = OctEncode( t );
+		dxp::XMUSHORT2 p;
+		p.x = (uint16_t)std::lround( (e.x * 0.5f + 0.5f) * 65535.0f );
+		p.y = (uint16_t)(std::lround( (e.y * 0.5f + 0.5f) * 32767.0f ) | (flipBinormal ? 0x8000 : 0));
+		return p;
+	}
+	dx::XMFLOAT3 UnpackOctTangent( const dxp::XMUSHORT2& p,float& binormalSign ) noexcept
+	{
+		binormalSign = (p.y & 0x8000) ? -1.0f : 1.0f;
+		return OctDecode( {
+			float( p.x ) / 65535.0f * 2.0f - 1.0f,
+			float( p.y & 0x7FFF ) / 32767.0f * 2.0f - 1.0f
+		} );
+	}
+
+	PositionQuantization PositionQuantization::FromMesh( const aiMesh& mesh ) noexcept
+	{
+		return FromPositions( reinterpret_cast<const dx::XMFLOAT3*>(mesh.mVertices),mesh.mNumVertices,sizeof( aiVector3D ) );
+	}
+	PositionQuantization PositionQuantization::FromPositions( const dx::XMFLOAT3* pPositions,size_t count,size_t strideBytes ) noexcept
+	{
+		PositionQuantization q;
+		if( count == 0 )
+		{
+			return q;
+		}
+		const auto position = [&]( size_t i ) -> const dx::XMFLOAT3&
+		{
+			return *reinterpret_cast<const dx::XMFLOAT3*>(reinterpret_cast<const char*>(pPositions) + strideBytes * i);
+		};
+		dx::XMFLOAT3 lo = position( 0 );
+		dx::XMFLOAT3 hi = lo;
+		for( size_t i = 1; i < count; i++ )
+		{
+			const auto& v = position( i );
+			lo = { std::min( lo.x,v.x ),std::min( lo.y,v.y ),std::min( lo.z,v.z ) };
+			hi = { std::max( hi.x,v.x ),std::max( hi.y,v.y ),std::max( hi.z,v.z ) };
+		}
+		q.offset = { lo.x,lo.y,lo.z };
+		q.range = std::max( { hi.x - lo.x,hi.y - lo.y,hi.z - lo.z } );
+		if( q.range <= 0.0f )
+		{
+			q.range = 1.0f;
+		}
+		return q;
+	}
+	dxp::XMUSHORTN4 PositionQuantization::Quantize( const dx::XMFLOAT3& p ) const noexcept
+	{
+		return {
+			(p.x - offset.x) / range,
+			(p.y - offset.y) / range,
+			(p.z - offset.z) / range,
+			0.0f
+		};
+	}
+	dx::XMFLOAT3 PositionQuantization::Dequantize( const dxp::XMUSHORTN4& q ) const noexcept
+	{
+		dx::XMFLOAT3 p;
+		dx::XMStoreFloat3( &p,dx::XMVector3Transform( dxp::XMLoadUShortN4( &q ),GetDequantizeXM() ) );
+		return p;
+	}
+	dx::XMMATRIX PositionQuantization::GetDequantizeXM() const noexcept
+	{
+		return dx::XMMatrixScaling( range,range,range ) * dx::XMMatrixTranslation( offset.x,offset.y,offset.z );
+	}
+
+
 	// VertexLayout
 	const VertexLayout::Element& VertexLayout::ResolveByIndex( size_t i ) const noxnd
 	{
@@ -149,19 +262,44 @@ namespace Dvtx
 			buffer.resize( buffer.size() + layout.Size() * (newSize - size) );
 		}
 	}
+	VertexBuffer::VertexBuffer( VertexLayout layout_in,const void* pData,size_t sizeBytes ) noxnd
+		:
+		buffer( static_cast<const char*>(pData),static_cast<const char*>(pData) + sizeBytes ),
+		layout( std::move( layout_in ) )
+	{
+		assert( sizeBytes % layout.Size() == 0u );
+	}
 	const char* VertexBuffer::GetData() const noxnd
 	{
 		return buffer.data();
 	}
+	char* VertexBuffer::GetData() noxnd
+	{
+		return buffer.data();
+	}
 
 	template<VertexLayout::ElementType type>
 	struct AttributeAiMeshFill
 	{
 		static constexpr void Exec( VertexBuffer* pBuf,const aiMesh& mesh ) noxnd
 		{
+			const auto stream = pBuf->Stream<type>();
+			for( auto end = mesh.mNumVertices,i = 0u; i < end; i++ )
+			{
+				stream[i] = VertexLayout::Map<type>::Extract( mesh,i );
+			}
+		}
+	};
+	template<>
+	struct AttributeAiMeshFill<VertexLayout::QuantizedPosition3D>
+	{
+		static void Exec( VertexBuffer* pBuf,const aiMesh& mesh ) noxnd
+		{
+			const auto q = PositionQuantization::FromMesh( mesh );
+			const auto stream = pBuf->Stream<VertexLayout::QuantizedPosition3D>();
 			for( auto end = mesh.mNumVertices,i = 0u; i < end; i++ )
 			{
-				(*pBuf)[i].Attr<type>() = VertexLayout::Map<type>::Extract( mesh,i );
+				stream[i] = q.Quantize( *reinterpret_cast<const dx::XMFLOAT3*>(&mesh.mVertices[i]) );
 			}
 		}
 	};
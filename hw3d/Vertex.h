@@ -6,6 +6,7 @@
 #include "ConditionalNoexcept.h"
 #include <assimp/scene.h>
 #include <utility>
+#include <DirectXPackedVector.h>
 
 #define DVTX_ELEMENT_AI_EXTRACTOR(member) static SysType Extract( const aiMesh& mesh,size_t i ) noexcept {return *reinterpret_cast<const SysType*>(&mesh.member[i]);}
 #define mBinormals mBitangents
@@ -19,10 +20,39 @@
 	X( Float3Color ) \
 	X( Float4Color ) \
 	X( BGRAColor ) \
+	X( QuantizedPosition3D ) \
+	X( HalfTexture2D ) \
+	X( OctNormal ) \
+	X( OctTangent ) \
 	X( Count )
 
 namespace Dvtx
 {
+	// encodings behind the compact element types, the shaders decode them in QuantizedVertex.hlsli
+	// octahedral: a unit vector folded onto the octahedron and flattened to [-1,1]^2
+	DirectX::XMFLOAT2 OctEncode( const DirectX::XMFLOAT3& v ) noexcept;
+	DirectX::XMFLOAT3 OctDecode( const DirectX::XMFLOAT2& e ) noexcept;
+	DirectX::PackedVector::XMSHORTN2 PackOctNormal( const DirectX::XMFLOAT3& n ) noexcept;
+	DirectX::XMFLOAT3 UnpackOctNormal( const DirectX::PackedVector::XMSHORTN2& p ) noexcept;
+	// 16 + 15 bits, the top bit of y is set when the binormal is -cross( n,t ) (mirrored uvs)
+	DirectX::PackedVector::XMUSHORT2 PackOctTangent( const DirectX::XMFLOAT3& t,bool flipBinormal ) noexcept;
+	DirectX::XMFLOAT3 UnpackOctTangent( const DirectX::PackedVector::XMUSHORT2& p,float& binormalSign ) noexcept;
+
+	// QuantizedPosition3D stores positions relative to the mesh's bounding cube in 16-bit unorm
+	// one range for all three axes keeps the dequantization a uniform scale, so it folds into the
+	// mesh transform without skewing normals
+	struct PositionQuantization
+	{
+		DirectX::XMFLOAT3 offset = { 0.0f,0.0f,0.0f };
+		float range = 1.0f;
+		static PositionQuantization FromMesh( const aiMesh& mesh ) noexcept;
+		static PositionQuantization FromPositions( const DirectX::XMFLOAT3* pPositions,size_t count,size_t strideBytes ) noexcept;
+		DirectX::PackedVector::XMUSHORTN4 Quantize( const DirectX::XMFLOAT3& p ) const noexcept;
+		DirectX::XMFLOAT3 Dequantize( const DirectX::PackedVector::XMUSHORTN4& q ) const noexcept;
+		// unorm position -> object space, applied before the mesh transform
+		DirectX::XMMATRIX GetDequantizeXM() const noexcept;
+	};
+
 	class VertexLayout
 	{
 	public:
@@ -106,6 +136,49 @@ namespace Dvtx
 			static constexpr const char* code = "C8";
 			DVTX_ELEMENT_AI_EXTRACTOR( mColors[0] )
 		};
+		// filled from the whole mesh at once (the quantization depends on its bounds), so no per-vertex Extract
+		template<> struct Map<QuantizedPosition3D>
+		{
+			using SysType = DirectX::PackedVector::XMUSHORTN4;
+			static constexpr DXGI_FORMAT dxgiFormat = DXGI_FORMAT_R16G16B16A16_UNORM;
+			static constexpr const char* semantic = "Position";
+			static constexpr const char* code = "Pq";
+		};
+		template<> struct Map<HalfTexture2D>
+		{
+			using SysType = DirectX::PackedVector::XMHALF2;
+			static constexpr DXGI_FORMAT dxgiFormat = DXGI_FORMAT_R16G16_FLOAT;
+			static constexpr const char* semantic = "Texcoord";
+			static constexpr const char* code = "Th";
+			static SysType Extract( const aiMesh& mesh,size_t i ) noexcept
+			{
+				return { mesh.mTextureCoords[0][i].x,mesh.mTextureCoords[0][i].y };
+			}
+		};
+		template<> struct Map<OctNormal>
+		{
+			using SysType = DirectX::PackedVector::XMSHORTN2;
+			static constexpr DXGI_FORMAT dxgiFormat = DXGI_FORMAT_R16G16_SNORM;
+			static constexpr const char* semantic = "Normal";
+			static constexpr const char* code = "No";
+			static SysType Extract( const aiMesh& mesh,size_t i ) noexcept
+			{
+				return PackOctNormal( *reinterpret_cast<const DirectX::XMFLOAT3*>(&mesh.mNormals[i]) );
+			}
+		};
+		// replaces Tangent + Binormal, the binormal is rebuilt from the normal and the sign
+		template<> struct Map<OctTangent>
+		{
+			using SysType = DirectX::PackedVector::XMUSHORT2;
+			static constexpr DXGI_FORMAT dxgiFormat = DXGI_FORMAT_R16G16_UINT;
+			static constexpr const char* semantic = "Tangent";
+			static constexpr const char* code = "To";
+			static SysType Extract( const aiMesh& mesh,size_t i ) noexcept
+			{
+				const bool flip = ((mesh.mNormals[i] ^ mesh.mTangents[i]) * mesh.mBinormals[i]) < 0.0f;
+				return PackOctTangent( *reinterpret_cast<const DirectX::XMFLOAT3*>(&mesh.mTangents[i]),flip );
+			}
+		};
 		template<> struct Map<Count>
 		{
 			using SysType = long double;
@@ -240,12 +313,42 @@ namespace Dvtx
 		Vertex vertex;
 	};
 
+	// one element of every vertex in a buffer, with its offset resolved once instead of on every Attr()
+	template<typename T>
+	class ElementStream
+	{
+		using Byte = std::conditional_t<std::is_const_v<T>,const char,char>;
+	public:
+		ElementStream( Byte* pFirst,size_t stride,size_t count ) noexcept
+			:
+			pFirst( pFirst ),
+			stride( stride ),
+			count( count )
+		{}
+		T& operator[]( size_t i ) const noxnd
+		{
+			assert( i < count );
+			return *reinterpret_cast<T*>(pFirst + stride * i);
+		}
+		size_t Size() const noexcept
+		{
+			return count;
+		}
+	private:
+		Byte* pFirst;
+		size_t stride;
+		size_t count;
+	};
+
 	class VertexBuffer
 	{
 	public:
 		VertexBuffer( VertexLayout layout,size_t size = 0u ) noxnd;
 		VertexBuffer( VertexLayout layout,const aiMesh& mesh );
+		// takes vertices already laid out in layout (see VertexFormat), one copy of the bytes
+		VertexBuffer( VertexLayout layout,const void* pData,size_t sizeBytes ) noxnd;
 		const char* GetData() const noxnd;
+		char* GetData() noxnd;
 		const VertexLayout& GetLayout() const noexcept;
 		void Resize( size_t newSize ) noxnd;
 		size_t Size() const noxnd;
@@ -257,6 +360,16 @@ namespace Dvtx
 			buffer.resize( buffer.size() + layout.Size() );
 			Back().SetAttributeByIndex( 0u,std::forward<Params>( params )... );
 		}
+		template<VertexLayout::ElementType Type>
+		ElementStream<typename VertexLayout::Map<Type>::SysType> Stream() noxnd
+		{
+			return { buffer.data() + layout.Resolve<Type>().GetOffset(),layout.Size(),Size() };
+		}
+		template<VertexLayout::ElementType Type>
+		ElementStream<const typename VertexLayout::Map<Type>::SysType> Stream() const noxnd
+		{
+			return { buffer.data() + layout.Resolve<Type>().GetOffset(),layout.Size(),Size() };
+		}
 		Vertex Back() noxnd;
 		Vertex Front() noxnd;
 		Vertex operator[]( size_t i ) noxnd;
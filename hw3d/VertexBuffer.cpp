@@ -12,6 +12,20 @@ namespace Bind
 		stride( (UINT)vbuf.GetLayout().Size() ),
 		tag( tag ),
 		layout( vbuf.GetLayout() )
+	{
+		Create( gfx,vbuf.GetData(),vbuf.SizeBytes() );
+	}
+	VertexBuffer::VertexBuffer( Graphics& gfx,const std::string& tag,const Dvtx::VertexLayout& layout,const char* pData,size_t sizeBytes )
+		:
+		stride( (UINT)layout.Size() ),
+		tag( tag ),
+		layout( layout )
+	{
+		assert( sizeBytes % stride == 0 );
+		Create( gfx,pData,sizeBytes );
+	}
+
+	void VertexBuffer::Create( Graphics& gfx,const char* pData,size_t sizeBytes )
 	{
 		INFOMAN( gfx );
 
@@ -20,10 +34,11 @@ namespace Bind
 		bd.Usage = D3D11_USAGE_DEFAULT;
 		bd.CPUAccessFlags = 0u;
 		bd.MiscFlags = 0u;
-		bd.ByteWidth = UINT( vbuf.SizeBytes() );
+		bd.ByteWidth = UINT( sizeBytes );
+		this->sizeBytes = sizeBytes;
 		bd.StructureByteStride = stride;
 		D3D11_SUBRESOURCE_DATA sd = {};
-		sd.pSysMem = vbuf.GetData();
+		sd.pSysMem = pData;
 		GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &bd,&sd,&pVertexBuffer ) );
 	}
 
@@ -44,13 +59,36 @@ namespace Bind
 		assert( tag != "?" );
 		return Codex::Resolve<VertexBuffer>( gfx,tag,vbuf );
 	}
+	std::shared_ptr<VertexBuffer> VertexBuffer::Resolve( Graphics& gfx,const std::string& tag,
+		const Dvtx::VertexLayout& layout,const char* pData,size_t sizeBytes )
+	{
+		assert( tag != "?" );
+		return Codex::Resolve<VertexBuffer>( gfx,tag,layout,pData,sizeBytes );
+	}
+	std::shared_ptr<VertexBuffer> VertexBuffer::ResolveDeferred( Graphics& gfx,const std::string& tag,
+		const std::function<Dvtx::VertexBuffer()>& produce )
+	{
+		assert( tag != "?" );
+		return Codex::ResolveDeferred<VertexBuffer>( [&]()
+		{
+			return std::make_shared<VertexBuffer>( gfx,tag,produce() );
+		},tag );
+	}
 	std::string VertexBuffer::GenerateUID_( const std::string& tag )
 	{
 		using namespace std::string_literals;
 		return typeid(VertexBuffer).name() + "#"s + tag;
 	}
+	std::uint64_t VertexBuffer::GenerateKey_( const std::string& tag ) noexcept
+	{
+		return Codex::Hasher{ Codex::TypeKey<VertexBuffer>() }.Add( tag ).Get();
+	}
 	std::string VertexBuffer::GetUID() const noexcept
 	{
 		return GenerateUID( tag );
 	}
+	size_t VertexBuffer::GetSizeBytes() const noexcept
+	{
+		return sizeBytes;
+	}
 }
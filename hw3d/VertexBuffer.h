@@ -2,6 +2,7 @@
 #include "Bindable.h"
 #include "GraphicsThrowMacros.h"
 #include "Vertex.h"
+#include <functional>
 
 namespace Bind
 {
@@ -10,21 +11,37 @@ namespace Bind
 	public:
 		VertexBuffer( Graphics& gfx,const std::string& tag,const Dvtx::VertexBuffer& vbuf );
 		VertexBuffer( Graphics& gfx,const Dvtx::VertexBuffer& vbuf );
+		// raw interleaved bytes already in the given layout (e.g. a cooked model)
+		VertexBuffer( Graphics& gfx,const std::string& tag,const Dvtx::VertexLayout& layout,const char* pData,size_t sizeBytes );
 		void Bind( Graphics& gfx ) noxnd override;
 		const Dvtx::VertexLayout& GetLayout() const noexcept;
 		static std::shared_ptr<VertexBuffer> Resolve( Graphics& gfx,const std::string& tag,
 			const Dvtx::VertexBuffer& vbuf );
+		static std::shared_ptr<VertexBuffer> Resolve( Graphics& gfx,const std::string& tag,
+			const Dvtx::VertexLayout& layout,const char* pData,size_t sizeBytes );
+		// produce is only called when nothing is cached under tag yet
+		static std::shared_ptr<VertexBuffer> ResolveDeferred( Graphics& gfx,const std::string& tag,
+			const std::function<Dvtx::VertexBuffer()>& produce );
 		template<typename...Ignore>
 		static std::string GenerateUID( const std::string& tag,Ignore&&...ignore )
 		{
 			return GenerateUID_( tag );
 		}
+		template<typename...Ignore>
+		static std::uint64_t GenerateKey( const std::string& tag,Ignore&&...ignore ) noexcept
+		{
+			return GenerateKey_( tag );
+		}
 		std::string GetUID() const noexcept override;
+		size_t GetSizeBytes() const noexcept override;
 	private:
 		static std::string GenerateUID_( const std::string& tag );
+		static std::uint64_t GenerateKey_( const std::string& tag ) noexcept;
+		void Create( Graphics& gfx,const char* pData,size_t sizeBytes );
 	protected:
 		std::string tag;
 		UINT stride;
+		size_t sizeBytes = 0u;
 		Microsoft::WRL::ComPtr<ID3D11Buffer> pVertexBuffer;
 		Dvtx::VertexLayout layout;
 	};
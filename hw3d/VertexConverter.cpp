@@ -0,0 +1,278 @@
+#include "VertexConverter.h"
+#include <DirectXPackedVector.h>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "ParallelFor.h"
+
+namespace dx = DirectX;
+namespace dxp = DirectX::PackedVector;
+using Dvtx::VertexLayout;
+
+namespace
+{
+	// everything a block needs besides its vertex range
+	struct Context
+	{
+		const aiMesh* pMesh;
+		char* pVertices;
+		size_t stride;
+		// a full transform, not just the scale, so directions change too
+		bool turnsDirections;
+		float scale;
+		dx::XMFLOAT4X4 positionXM;
+		// inverse transpose for normals, the plain transform for tangents and binormals
+		dx::XMFLOAT4X4 normalXM;
+		dx::XMFLOAT4X4 directionXM;
+		// positions are quantized after the transform when there is one, unscaled otherwise
+		Dvtx::PositionQuantization quantization;
+	};
+
+	// element data of vertex i within the block's output
+	template<typename T>
+	T& At( char* pFirst,size_t stride,unsigned int i ) noexcept
+	{
+		return *reinterpret_cast<T*>(pFirst + stride * i);
+	}
+
+	// elements without a bulk kernel go through the per-vertex extractor
+	template<VertexLayout::ElementType type>
+	struct ElementExtract
+	{
+		static void Exec( const aiMesh& mesh,char* pFirst,size_t stride,unsigned int first,unsigned int count ) noxnd
+		{
+			using SysType = typename VertexLayout::Map<type>::SysType;
+			for( unsigned int i = 0; i < count; i++ )
+			{
+				At<SysType>( pFirst,stride,i ) = VertexLayout::Map<type>::Extract( mesh,first + i );
+			}
+		}
+	};
+	template<>
+	struct ElementExtract<VertexLayout::QuantizedPosition3D>
+	{
+		static void Exec( const aiMesh&,char*,size_t,unsigned int,unsigned int ) noxnd
+		{
+			assert( "Quantized positions have their own kernel" && false );
+		}
+	};
+
+	void CopyFloats( char* pFirst,size_t stride,const aiVector3D* pSource,size_t bytes,unsigned int count ) noexcept
+	{
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			std::memcpy( pFirst + stride * i,&pSource[i],bytes );
+		}
+	}
+
+	// direction stream through a 3x3 transform, renormalized (scales / shears in the transform)
+	void TransformDirections( char* pFirst,size_t stride,const aiVector3D* pSource,unsigned int count,const dx::XMFLOAT4X4& m ) noexcept
+	{
+		const auto pOut = reinterpret_cast<dx::XMFLOAT3*>(pFirst);
+		dx::XMVector3TransformNormalStream( pOut,stride,reinterpret_cast<const dx::XMFLOAT3*>(pSource),sizeof( aiVector3D ),
+			count,dx::XMLoadFloat4x4( &m )
+		);
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			auto& v = At<dx::XMFLOAT3>( pFirst,stride,i );
+			dx::XMStoreFloat3( &v,dx::XMVector3Normalize( dx::XMLoadFloat3( &v ) ) );
+		}
+	}
+
+	dx::XMFLOAT3 TransformDirection( const aiVector3D& v,dx::FXMMATRIX m ) noexcept
+	{
+		dx::XMFLOAT3 out = { v.x,v.y,v.z };
+		dx::XMStoreFloat3( &out,dx::XMVector3Normalize( dx::XMVector3TransformNormal( dx::XMLoadFloat3( &out ),m ) ) );
+		return out;
+	}
+
+	void ConvertBlock( const Context& ctx,const VertexLayout& layout,unsigned int first,unsigned int count ) noxnd
+	{
+		const auto& mesh = *ctx.pMesh;
+		const auto stride = ctx.stride;
+		for( size_t e = 0,end = layout.GetElementCount(); e < end; e++ )
+		{
+			const auto& element = layout.ResolveByIndex( e );
+			char* const pFirst = ctx.pVertices + stride * first + element.GetOffset();
+			switch( element.GetType() )
+			{
+			case VertexLayout::Position3D:
+				if( ctx.turnsDirections )
+				{
+					dx::XMVector3TransformCoordStream( reinterpret_cast<dx::XMFLOAT3*>(pFirst),stride,
+						reinterpret_cast<const dx::XMFLOAT3*>(&mesh.mVertices[first]),sizeof( aiVector3D ),
+						count,dx::XMLoadFloat4x4( &ctx.positionXM )
+					);
+				}
+				else if( ctx.scale != 1.0f )
+				{
+					// a plain multiply rounds exactly like scaling the finished buffer did
+					for( unsigned int i = 0; i < count; i++ )
+					{
+						auto& pos = At<dx::XMFLOAT3>( pFirst,stride,i );
+						dx::XMStoreFloat3( &pos,dx::XMVectorScale(
+							dx::XMLoadFloat3( reinterpret_cast<const dx::XMFLOAT3*>(&mesh.mVertices[first + i]) ),ctx.scale
+						) );
+					}
+				}
+				else
+				{
+					CopyFloats( pFirst,stride,&mesh.mVertices[first],sizeof( dx::XMFLOAT3 ),count );
+				}
+				break;
+			case VertexLayout::Normal:
+				if( ctx.turnsDirections )
+				{
+					TransformDirections( pFirst,stride,&mesh.mNormals[first],count,ctx.normalXM );
+				}
+				else
+				{
+					CopyFloats( pFirst,stride,&mesh.mNormals[first],sizeof( dx::XMFLOAT3 ),count );
+				}
+				break;
+			case VertexLayout::Tangent:
+			case VertexLayout::Binormal:
+			{
+				const auto pSource = element.GetType() == VertexLayout::Tangent ? mesh.mTangents : mesh.mBinormals;
+				if( ctx.turnsDirections )
+				{
+					TransformDirections( pFirst,stride,&pSource[first],count,ctx.directionXM );
+				}
+				else
+				{
+					CopyFloats( pFirst,stride,&pSource[first],sizeof( dx::XMFLOAT3 ),count );
+				}
+				break;
+			}
+			case VertexLayout::Texture2D:
+				CopyFloats( pFirst,stride,&mesh.mTextureCoords[0][first],sizeof( dx::XMFLOAT2 ),count );
+				break;
+			case VertexLayout::HalfTexture2D:
+				// u and v as two interleaved half streams
+				for( size_t c = 0; c < 2; c++ )
+				{
+					dxp::XMConvertFloatToHalfStream( reinterpret_cast<dxp::HALF*>(pFirst) + c,stride,
+						&mesh.mTextureCoords[0][first].x + c,sizeof( aiVector3D ),count
+					);
+				}
+				break;
+			case VertexLayout::QuantizedPosition3D:
+			{
+				const auto positionXM = dx::XMLoadFloat4x4( &ctx.positionXM );
+				const auto offset = dx::XMLoadFloat3( &ctx.quantization.offset );
+				const auto range = dx::XMVectorReplicate( ctx.quantization.range );
+				for( unsigned int i = 0; i < count; i++ )
+				{
+					auto p = dx::XMLoadFloat3( reinterpret_cast<const dx::XMFLOAT3*>(&mesh.mVertices[first + i]) );
+					if( ctx.turnsDirections )
+					{
+						p = dx::XMVector3TransformCoord( p,positionXM );
+					}
+					// divided like PositionQuantization::Quantize, w stays 0
+					dxp::XMStoreUShortN4( &At<dxp::XMUSHORTN4>( pFirst,stride,i ),
+						dx::XMVectorDivide( dx::XMVectorSubtract( p,offset ),range )
+					);
+				}
+				break;
+			}
+			case VertexLayout::OctNormal:
+			{
+				if( !ctx.turnsDirections )
+				{
+					VertexLayout::Bridge<ElementExtract>( element.GetType(),mesh,pFirst,stride,first,count );
+					break;
+				}
+				const auto normalXM = dx::XMLoadFloat4x4( &ctx.normalXM );
+				for( unsigned int i = 0; i < count; i++ )
+				{
+					At<dxp::XMSHORTN2>( pFirst,stride,i ) = Dvtx::PackOctNormal(
+						TransformDirection( mesh.mNormals[first + i],normalXM )
+					);
+				}
+				break;
+			}
+			case VertexLayout::OctTangent:
+			{
+				if( !ctx.turnsDirections )
+				{
+					VertexLayout::Bridge<ElementExtract>( element.GetType(),mesh,pFirst,stride,first,count );
+					break;
+				}
+				const auto normalXM = dx::XMLoadFloat4x4( &ctx.normalXM );
+				const auto directionXM = dx::XMLoadFloat4x4( &ctx.directionXM );
+				for( unsigned int i = 0; i < count; i++ )
+				{
+					const auto j = first + i;
+					const auto n = TransformDirection( mesh.mNormals[j],normalXM );
+					const auto t = TransformDirection( mesh.mTangents[j],directionXM );
+					const auto b = TransformDirection( mesh.mBinormals[j],directionXM );
+					// handedness after the transform, a mirroring transform flips it
+					const bool flip = dx::XMVectorGetX( dx::XMVector3Dot(
+						dx::XMVector3Cross( dx::XMLoadFloat3( &n ),dx::XMLoadFloat3( &t ) ),dx::XMLoadFloat3( &b )
+					) ) < 0.0f;
+					At<dxp::XMUSHORT2>( pFirst,stride,i ) = Dvtx::PackOctTangent( t,flip );
+				}
+				break;
+			}
+			default:
+				VertexLayout::Bridge<ElementExtract>( element.GetType(),mesh,pFirst,stride,first,count );
+				break;
+			}
+		}
+	}
+}
+
+VertexConverter::Result VertexConverter::Convert( Dvtx::VertexLayout layout,const aiMesh& mesh,const Options& options )
+{
+	const unsigned int vertexCount = mesh.mNumVertices;
+	Result result{ Dvtx::VertexBuffer{ std::move( layout ),vertexCount } };
+	const auto& outLayout = result.vertices.GetLayout();
+
+	Context ctx;
+	ctx.pMesh = &mesh;
+	ctx.pVertices = result.vertices.GetData();
+	ctx.stride = outLayout.Size();
+	ctx.scale = options.scale;
+	ctx.turnsDirections = options.transform.has_value();
+	auto positionXM = dx::XMMatrixScaling( options.scale,options.scale,options.scale );
+	auto directionXM = dx::XMMatrixIdentity();
+	if( options.transform )
+	{
+		directionXM = dx::XMLoadFloat4x4( &*options.transform );
+		positionXM = positionXM * directionXM;
+	}
+	dx::XMStoreFloat4x4( &ctx.positionXM,positionXM );
+	dx::XMStoreFloat4x4( &ctx.directionXM,directionXM );
+	dx::XMStoreFloat4x4( &ctx.normalXM,dx::XMMatrixTranspose( dx::XMMatrixInverse( nullptr,directionXM ) ) );
+
+	if( outLayout.Has( VertexLayout::QuantizedPosition3D ) )
+	{
+		if( ctx.turnsDirections )
+		{
+			// fitted to the transformed positions, that is the space the unorm positions are quantized in
+			std::vector<dx::XMFLOAT3> positions( vertexCount );
+			dx::XMVector3TransformCoordStream( positions.data(),sizeof( dx::XMFLOAT3 ),
+				reinterpret_cast<const dx::XMFLOAT3*>(mesh.mVertices),sizeof( aiVector3D ),vertexCount,positionXM
+			);
+			ctx.quantization = Dvtx::PositionQuantization::FromPositions( positions.data(),vertexCount,sizeof( dx::XMFLOAT3 ) );
+			result.positionQuantization = ctx.quantization;
+		}
+		else
+		{
+			ctx.quantization = Dvtx::PositionQuantization::FromMesh( mesh );
+			auto q = ctx.quantization;
+			q.offset = { q.offset.x * options.scale,q.offset.y * options.scale,q.offset.z * options.scale };
+			q.range *= options.scale;
+			result.positionQuantization = q;
+		}
+	}
+
+	const unsigned int blockVertices = std::max( options.blockVertices,1u );
+	const unsigned int blockCount = (vertexCount + blockVertices - 1u) / blockVertices;
+	ParallelFor( blockCount,vertexCount < 2u * blockVertices ? 1u : options.threads,[&]( size_t block )
+	{
+		const auto first = (unsigned int)block * blockVertices;
+		ConvertBlock( ctx,outLayout,first,std::min( blockVertices,vertexCount - first ) );
+	} );
+	return result;
+}
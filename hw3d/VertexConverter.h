@@ -0,0 +1,34 @@
+#pragma once
+#include "Vertex.h"
+#include <optional>
+
+// bulk conversion of an imported mesh into the interleaved vertex buffer of a layout
+// assimp keeps one array per attribute; every element is written in one strided pass over a block of
+// vertices, with DirectXMath's stream functions doing the transforms and the half conversion, instead of
+// VertexBuffer( layout,mesh ) extracting vertex by vertex and the caller scaling positions afterwards
+// blocks are independent, so large meshes are spread over worker threads
+class VertexConverter
+{
+public:
+	struct Options
+	{
+		// uniform scale on positions, applied before transform
+		float scale = 1.0f;
+		// full object transform (DirectXMath row-vector convention); normals and the tangent frame follow it
+		std::optional<DirectX::XMFLOAT4X4> transform;
+		// 0 uses every hardware thread, meshes smaller than two blocks stay on the calling thread
+		unsigned int threads = 0u;
+		unsigned int blockVertices = 8192u;
+	};
+	struct Result
+	{
+		Dvtx::VertexBuffer vertices;
+		// set when the layout holds QuantizedPosition3D, maps its unorm positions to the scaled / transformed space
+		std::optional<Dvtx::PositionQuantization> positionQuantization;
+	};
+public:
+	// elements the mesh lacks a stream for are not allowed (same as VertexBuffer( layout,mesh ))
+	// with only a scale the output is byte for byte what VertexBuffer( layout,mesh ) plus scaling the positions
+	// gives, quantized positions are quantized unscaled and the scale goes into the dequantization
+	static Result Convert( Dvtx::VertexLayout layout,const aiMesh& mesh,const Options& options );
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include "Vertex.h"
+#include <span>
+#include <vector>
+
+namespace Dvtx
+{
+	// a vertex layout fixed at compile time: Vertex is a plain struct with every element at a constant
+	// offset, packed exactly like the VertexLayout MakeLayout() builds, so arrays of them are vertex buffer
+	// contents as they are (VertexBuffer takes them with one copy, View() reinterprets a matching buffer)
+	// use it where the elements are known up front (procedural geometry, import into a known layout),
+	// Dvtx::VertexLayout stays the runtime description everything else is built from
+	template<VertexLayout::ElementType... Types>
+	class VertexFormat
+	{
+		static_assert( sizeof...(Types) > 0u,"Vertex format needs at least one element" );
+		static_assert( ((Types != VertexLayout::Count) && ...),"Count is not an element type" );
+	public:
+		template<VertexLayout::ElementType Type>
+		using SysType = typename VertexLayout::Map<Type>::SysType;
+		static constexpr size_t elementCount = sizeof...(Types);
+		static constexpr size_t size = (sizeof( SysType<Types> ) + ...);
+	private:
+		template<VertexLayout::ElementType Type>
+		static constexpr size_t IndexOf() noexcept
+		{
+			constexpr VertexLayout::ElementType types[] = { Types... };
+			size_t index = elementCount;
+			size_t matches = 0u;
+			for( size_t i = 0; i < elementCount; i++ )
+			{
+				if( types[i] == Type )
+				{
+					index = i;
+					matches++;
+				}
+			}
+			return matches == 1u ? index : elementCount;
+		}
+	public:
+		template<VertexLayout::ElementType Type>
+		static constexpr size_t OffsetOf() noexcept
+		{
+			constexpr auto index = IndexOf<Type>();
+			static_assert( index < elementCount,"Element type missing from vertex format (or listed twice)" );
+			constexpr size_t sizes[] = { sizeof( SysType<Types> )... };
+			size_t offset = 0u;
+			for( size_t i = 0; i < index; i++ )
+			{
+				offset += sizes[i];
+			}
+			return offset;
+		}
+		// every element type is a multiple of 4 bytes with at most 4 byte alignment, so there is no padding
+		struct alignas(4) Vertex
+		{
+			template<VertexLayout::ElementType Type>
+			SysType<Type>& Attr() noexcept
+			{
+				return *reinterpret_cast<SysType<Type>*>(bytes + OffsetOf<Type>());
+			}
+			template<VertexLayout::ElementType Type>
+			const SysType<Type>& Attr() const noexcept
+			{
+				return *reinterpret_cast<const SysType<Type>*>(bytes + OffsetOf<Type>());
+			}
+			char bytes[size];
+		};
+		static_assert( sizeof( Vertex ) == size );
+	public:
+		// elements in format order
+		static Vertex Make( const SysType<Types>&... values ) noexcept
+		{
+			Vertex v;
+			((v.template Attr<Types>() = values),...);
+			return v;
+		}
+		static VertexLayout MakeLayout() noxnd
+		{
+			VertexLayout layout;
+			(layout.Append( Types ),...);
+			return layout;
+		}
+		// same elements in the same order, i.e. identical bytes per vertex
+		static bool Describes( const VertexLayout& layout ) noexcept
+		{
+			constexpr VertexLayout::ElementType types[] = { Types... };
+			if( layout.GetElementCount() != elementCount )
+			{
+				return false;
+			}
+			for( size_t i = 0; i < elementCount; i++ )
+			{
+				if( layout.ResolveByIndex( i ).GetType() != types[i] )
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		static VertexBuffer MakeBuffer( std::span<const Vertex> vertices ) noxnd
+		{
+			return MakeBuffer( MakeLayout(),vertices );
+		}
+		// for callers that were handed the layout, which must be the one this format describes
+		static VertexBuffer MakeBuffer( VertexLayout layout,std::span<const Vertex> vertices ) noxnd
+		{
+			assert( Describes( layout ) && "Layout does not match vertex format" );
+			return { std::move( layout ),vertices.data(),vertices.size_bytes() };
+		}
+		static std::span<Vertex> View( VertexBuffer& buf ) noxnd
+		{
+			assert( Describes( buf.GetLayout() ) && "Layout does not match vertex format" );
+			return { reinterpret_cast<Vertex*>(buf.GetData()),buf.Size() };
+		}
+		static std::span<const Vertex> View( const VertexBuffer& buf ) noxnd
+		{
+			assert( Describes( buf.GetLayout() ) && "Layout does not match vertex format" );
+			return { reinterpret_cast<const Vertex*>(buf.GetData()),buf.Size() };
+		}
+		// the same conversion as VertexBuffer( layout,mesh ), a whole vertex at a time
+		static std::vector<Vertex> Extract( const aiMesh& mesh )
+		{
+			PositionQuantization q;
+			if constexpr( ((Types == VertexLayout::QuantizedPosition3D) || ...) )
+			{
+				q = PositionQuantization::FromMesh( mesh );
+			}
+			std::vector<Vertex> vertices( mesh.mNumVertices );
+			for( unsigned int i = 0; i < mesh.mNumVertices; i++ )
+			{
+				((vertices[i].template Attr<Types>() = ExtractElement<Types>( mesh,i,q )),...);
+			}
+			return vertices;
+		}
+	private:
+		template<VertexLayout::ElementType Type>
+		static SysType<Type> ExtractElement( const aiMesh& mesh,unsigned int i,const PositionQuantization& q ) noexcept
+		{
+			if constexpr( Type == VertexLayout::QuantizedPosition3D )
+			{
+				return q.Quantize( *reinterpret_cast<const DirectX::XMFLOAT3*>(&mesh.mVertices[i]) );
+			}
+			else
+			{
+				return VertexLayout::Map<Type>::Extract( mesh,i );
+			}
+		}
+	};
+}
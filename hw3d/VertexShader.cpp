@@ -44,4 +44,8 @@ namespace Bind
 	{
 		return GenerateUID( path );
 	}
+	const std::string& VertexShader::GetPath() const noexcept
+	{
+		return path;
+	}
 }
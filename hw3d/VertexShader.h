@@ -12,6 +12,7 @@ namespace Bind
 		static std::shared_ptr<VertexShader> Resolve( Graphics& gfx,const std::string& path );
 		static std::string GenerateUID( const std::string& path );
 		std::string GetUID() const noexcept override;
+		const std::string& GetPath() const noexcept;
 	protected:
 		std::string path;
 		Microsoft::WRL::ComPtr<ID3DBlob> pBytecodeBlob;
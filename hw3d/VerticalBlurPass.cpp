@@ -32,9 +32,7 @@ namespace Rgph
 	// see the note on HorizontalBlurPass::Execute
 	void VerticalBlurPass::Execute( Graphics& gfx ) const noxnd
 	{
-		auto buf = direction->GetBuffer();
-		buf["isHorizontal"] = false;
-		direction->SetBuffer( buf );
+		direction->EditBuffer()["isHorizontal"] = false;
 
 		direction->Bind( gfx );
 		FullscreenPass::Execute( gfx );